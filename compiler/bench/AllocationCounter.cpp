@@ -0,0 +1,65 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Counts heap allocations of the benchmark.
+ */
+
+#include <bench/AllocationCounter.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+using namespace solidity::frontend::bench;
+
+namespace
+{
+
+atomic<size_t> g_allocations{0};
+atomic<size_t> g_allocatedBytes{0};
+
+}
+
+size_t AllocationCounter::allocations()
+{
+	return g_allocations;
+}
+
+size_t AllocationCounter::allocatedBytes()
+{
+	return g_allocatedBytes;
+}
+
+void* operator new(size_t _size)
+{
+	++g_allocations;
+	g_allocatedBytes += _size;
+	if (void* memory = malloc(_size == 0 ? 1 : _size))
+		return memory;
+	throw bad_alloc();
+}
+
+void operator delete(void* _memory) noexcept
+{
+	free(_memory);
+}
+
+void operator delete(void* _memory, size_t) noexcept
+{
+	free(_memory);
+}
@@ -0,0 +1,38 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Counts heap allocations of the benchmark.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace solidity::frontend::bench
+{
+
+/// Global operator new is replaced in AllocationCounter.cpp, so that every allocation made with it is counted.
+/// The replacement lives in its own translation unit to keep it from being inlined into its callers.
+struct AllocationCounter
+{
+	/// @returns the number of allocations since the start of the program
+	static size_t allocations();
+	/// @returns the number of bytes allocated since the start of the program
+	static size_t allocatedBytes();
+};
+
+}
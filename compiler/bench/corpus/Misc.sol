@@ -0,0 +1,78 @@
+pragma solidity >= 0.6.0;
+pragma AbiHeader time;
+pragma AbiHeader pubkey;
+
+contract Misc {
+    enum Color { Red, Green, Blue }
+    struct Point { int32 x; int32 y; }
+    Point[] points;
+    Color color;
+    mapping(uint256 => bool) seen;
+    TvmCell stored;
+    uint16[] nums;
+
+    function addPoint(int32 x, int32 y) public returns (uint) {
+        tvm.accept();
+        points.push(Point(x, y));
+        if (x > y) {
+            color = Color.Red;
+        } else if (x == y) {
+            color = Color.Green;
+        } else {
+            color = Color.Blue;
+        }
+        return points.length;
+    }
+
+    function dist(uint i, uint j) public view returns (int32) {
+        Point a = points[i];
+        Point b = points[j];
+        int32 dx = a.x - b.x;
+        int32 dy = a.y - b.y;
+        if (dx < 0) dx = -dx;
+        if (dy < 0) dy = -dy;
+        return dx + dy;
+    }
+
+    function loops(uint n) public pure returns (uint s) {
+        uint i = 0;
+        while (i < n) {
+            if (i % 3 == 0) { i++; continue; }
+            if (i > 100) break;
+            s += i * 2 + 1;
+            i++;
+        }
+        do { s -= 1; } while (s > 1000);
+    }
+
+    function mark(uint256 h) public {
+        tvm.accept();
+        require(!seen[h], 300);
+        seen[h] = true;
+        delete nums;
+        nums.push(uint16(h));
+    }
+
+    function store(TvmCell c) public {
+        tvm.accept();
+        stored = c;
+        TvmSlice s = c.toSlice();
+        (uint8 a, uint16 b) = s.decode(uint8, uint16);
+        nums.push(a + b);
+    }
+
+    function strings(string a, string b) public pure returns (string, uint) {
+        string c = a;
+        bytes bb = bytes(b);
+        return (c, bb.length);
+    }
+
+    function minmax(uint a, uint b) public pure returns (uint, uint) {
+        return (a < b ? a : b, a < b ? b : a);
+    }
+
+    function getColor() public view returns (Color) {
+        tvm.log("getColor");
+        return color;
+    }
+}
@@ -0,0 +1,183 @@
+pragma solidity >= 0.6.0;
+pragma AbiHeader expire;
+pragma AbiHeader pubkey;
+
+contract MultisigWallet {
+    struct Transaction {
+        uint64 id;
+        uint32 confirmationsMask;
+        uint8 signsRequired;
+        uint8 signsReceived;
+        uint256 creator;
+        uint8 index;
+        address dest;
+        uint128 value;
+        uint16 sendFlags;
+        TvmCell payload;
+        bool bounce;
+    }
+
+    uint8 constant MAX_QUEUED_REQUESTS = 5;
+    uint64 constant EXPIRATION_TIME = 3600;
+    uint8 constant MAX_CUSTODIAN_COUNT = 32;
+
+    uint256 m_ownerKey;
+    uint256 m_requestsMask;
+    mapping(uint64 => Transaction) m_transactions;
+    mapping(uint256 => uint8) m_custodians;
+    uint8 m_custodianCount;
+    uint8 m_defaultRequiredConfirmations;
+
+    event TransferAccepted(bytes payload);
+
+    constructor(uint256[] owners, uint8 reqConfirms) public {
+        require(msg.pubkey() == tvm.pubkey(), 100);
+        require(owners.length > 0 && owners.length <= MAX_CUSTODIAN_COUNT, 117);
+        tvm.accept();
+        m_ownerKey = owners[0];
+        uint8 len = uint8(owners.length);
+        for (uint8 i = 0; i < len; i++) {
+            m_custodians[owners[i]] = i;
+        }
+        m_custodianCount = len;
+        m_defaultRequiredConfirmations = len < reqConfirms ? len : reqConfirms;
+    }
+
+    function _findCustodian(uint256 senderKey) private inline view returns (uint8) {
+        (bool exists, uint8 index) = m_custodians.fetch(senderKey);
+        require(exists, 100);
+        return index;
+    }
+
+    function _generateId() private inline view returns (uint64) {
+        return (uint64(now) << 32) | uint64(m_custodianCount);
+    }
+
+    function _getExpirationBound() private inline view returns (uint64) {
+        return (uint64(now) - EXPIRATION_TIME) << 32;
+    }
+
+    function _getSendFlags(uint128 value, bool allBalance) private inline pure returns (uint8, uint128) {
+        uint8 flags = 3;
+        if (allBalance) {
+            flags = 128;
+            value = 0;
+        }
+        return (flags, value);
+    }
+
+    function _getMaskValue(uint256 mask, uint8 index) private inline pure returns (uint8) {
+        return uint8((mask >> (8 * uint256(index))) & 0xFF);
+    }
+
+    function _incMaskValue(uint256 mask, uint8 index) private inline pure returns (uint256) {
+        return mask + (1 << (8 * uint256(index)));
+    }
+
+    function _decMaskValue(uint256 mask, uint8 index) private inline pure returns (uint256) {
+        return mask - (1 << (8 * uint256(index)));
+    }
+
+    function _isConfirmed(uint32 mask, uint8 custodianIndex) private inline pure returns (bool) {
+        return (mask & (uint32(1) << custodianIndex)) != 0;
+    }
+
+    function _removeExpiredTransactions() private {
+        uint64 marker = _getExpirationBound();
+        (uint64 trId, Transaction txn, bool success) = m_transactions.min();
+        bool needCleanup = success && (trId <= marker);
+        if (needCleanup) {
+            tvm.accept();
+            uint i = 0;
+            while (needCleanup && i < 10) {
+                i++;
+                m_requestsMask = _decMaskValue(m_requestsMask, txn.index);
+                delete m_transactions[trId];
+                (trId, txn, success) = m_transactions.next(trId);
+                needCleanup = success && (trId <= marker);
+            }
+            tvm.commit();
+        }
+    }
+
+    function sendTransaction(address dest, uint128 value, bool bounce, uint8 flags, TvmCell payload) public view {
+        require(m_custodianCount == 1, 108);
+        require(msg.pubkey() == m_ownerKey, 100);
+        tvm.accept();
+        dest.transfer(value, bounce, flags, payload);
+    }
+
+    function submitTransaction(address dest, uint128 value, bool bounce, bool allBalance, TvmCell payload)
+        public returns (uint64 transId)
+    {
+        uint256 senderKey = msg.pubkey();
+        uint8 index = _findCustodian(senderKey);
+        _removeExpiredTransactions();
+        require(_getMaskValue(m_requestsMask, index) < MAX_QUEUED_REQUESTS, 113);
+        tvm.accept();
+
+        (uint8 flags, uint128 realValue) = _getSendFlags(value, allBalance);
+        uint8 requiredSigns = m_defaultRequiredConfirmations;
+
+        if (requiredSigns == 1) {
+            dest.transfer(realValue, bounce, flags, payload);
+            return 0;
+        }
+        m_requestsMask = _incMaskValue(m_requestsMask, index);
+        uint64 trId = _generateId();
+        Transaction txn = Transaction(trId, 0, requiredSigns, 0, senderKey, index, dest, realValue, flags, payload, bounce);
+        _confirmTransaction(trId, txn, index);
+        return trId;
+    }
+
+    function confirmTransaction(uint64 transactionId) public {
+        uint8 index = _findCustodian(msg.pubkey());
+        _removeExpiredTransactions();
+        (bool trexists, Transaction txn) = m_transactions.fetch(transactionId);
+        require(trexists, 102);
+        require(!_isConfirmed(txn.confirmationsMask, index), 103);
+        tvm.accept();
+        _confirmTransaction(transactionId, txn, index);
+    }
+
+    function _confirmTransaction(uint64 transactionId, Transaction txn, uint8 custodianIndex) private {
+        if ((txn.signsReceived + 1) >= txn.signsRequired) {
+            txn.dest.transfer(txn.value, txn.bounce, txn.sendFlags, txn.payload);
+            m_requestsMask = _decMaskValue(m_requestsMask, txn.index);
+            delete m_transactions[transactionId];
+        } else {
+            txn.confirmationsMask |= uint32(1) << custodianIndex;
+            txn.signsReceived++;
+            m_transactions[transactionId] = txn;
+        }
+    }
+
+    function isConfirmed(uint32 mask, uint8 index) public pure returns (bool confirmed) {
+        confirmed = _isConfirmed(mask, index);
+    }
+
+    function getTransaction(uint64 transactionId) public view returns (Transaction trans) {
+        (bool exists, Transaction txn) = m_transactions.fetch(transactionId);
+        require(exists, 102);
+        trans = txn;
+    }
+
+    function getTransactions() public view returns (Transaction[] transactions) {
+        uint64 bound = _getExpirationBound();
+        (uint64 id, Transaction txn, bool success) = m_transactions.min();
+        while (success) {
+            if (id > bound) {
+                transactions.push(txn);
+            }
+            (id, txn, success) = m_transactions.next(id);
+        }
+    }
+
+    function getCustodianCount() public view returns (uint8) {
+        return m_custodianCount;
+    }
+
+    receive() external {
+        emit TransferAccepted(bytes(""));
+    }
+}
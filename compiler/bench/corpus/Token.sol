@@ -0,0 +1,99 @@
+pragma solidity >= 0.6.0;
+
+interface IReceiver {
+    function onTokens(uint128 amount) external;
+}
+
+contract Base {
+    uint64 public totalSupply;
+    mapping(address => uint128) balances;
+
+    function _mint(address to, uint128 amount) internal {
+        balances[to] += amount;
+        totalSupply += uint64(amount);
+    }
+
+    function name() public virtual pure returns (string) {
+        return "Base";
+    }
+}
+
+contract Ownable {
+    uint256 owner;
+    modifier onlyOwner() {
+        require(msg.pubkey() == owner, 200);
+        _;
+    }
+}
+
+contract Token is Base, Ownable {
+    struct Info {
+        uint32 created;
+        uint128 amount;
+        address holder;
+        bool frozen;
+    }
+    mapping(uint64 => Info) infos;
+    uint64 nextId;
+    string m_name;
+    bytes m_data;
+    uint8 constant DECIMALS = 9;
+
+    constructor(string name_) public {
+        tvm.accept();
+        owner = tvm.pubkey();
+        m_name = name_;
+    }
+
+    function name() public override pure returns (string) {
+        return "Token";
+    }
+
+    function mint(address to, uint128 amount) public onlyOwner {
+        tvm.accept();
+        _mint(to, amount);
+        infos[nextId] = Info(uint32(now), amount, to, false);
+        nextId++;
+        IReceiver(to).onTokens{value: 1e7}(amount);
+    }
+
+    function transfer(address to, uint128 amount) public {
+        require(balances[msg.sender] >= amount, 201);
+        balances[msg.sender] -= amount;
+        balances[to] += amount;
+    }
+
+    function freeze(uint64 id) public onlyOwner {
+        tvm.accept();
+        Info info = infos[id];
+        info.frozen = true;
+        infos[id] = info;
+    }
+
+    function getInfo(uint64 id) public view returns (uint32, uint128, address, bool) {
+        Info info = infos[id];
+        return (info.created, info.amount, info.holder, info.frozen);
+    }
+
+    function balanceOf(address a) public view returns (uint128) {
+        return balances[a];
+    }
+
+    function decimals() public pure returns (uint8) {
+        return DECIMALS;
+    }
+
+    function hashData() public view returns (uint256) {
+        TvmBuilder b;
+        b.store(m_data.length, nextId);
+        return tvm.hash(b.toCell());
+    }
+
+    fallback() external {
+    }
+
+    onBounce(TvmSlice body) external {
+        uint32 functionId = body.decode(uint32);
+        functionId;
+    }
+}
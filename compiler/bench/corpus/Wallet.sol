@@ -0,0 +1,71 @@
+pragma solidity >= 0.6.0;
+pragma AbiHeader expire;
+
+contract Wallet {
+    uint256 m_owner;
+    uint128 m_limit;
+    uint32 m_counter;
+    mapping(uint32 => uint128) m_history;
+    address m_last;
+
+    event Sent(address dest, uint128 value);
+
+    modifier onlyOwner {
+        require(msg.pubkey() == tvm.pubkey(), 100);
+        tvm.accept();
+        _;
+    }
+
+    constructor(uint128 limit) public {
+        require(tvm.pubkey() != 0, 101);
+        tvm.accept();
+        m_owner = tvm.pubkey();
+        m_limit = limit;
+    }
+
+    function sendTransaction(address dest, uint128 value, bool bounce) public onlyOwner {
+        require(value > 0 && value <= m_limit, 102);
+        m_counter++;
+        m_history[m_counter] = value;
+        m_last = dest;
+        dest.transfer(value, bounce, 3);
+        emit Sent(dest, value);
+    }
+
+    function setLimit(uint128 limit) public onlyOwner {
+        m_limit = limit;
+    }
+
+    function getLimit() public view returns (uint128) {
+        return m_limit;
+    }
+
+    function getHistory(uint32 from, uint32 count) public view returns (uint128[] values) {
+        for (uint32 i = from; i < from + count; i++) {
+            (bool ok, uint128 v) = m_history.fetch(i);
+            if (ok) {
+                values.push(v);
+            }
+        }
+    }
+
+    function sum(uint32 a, uint32 b) private pure returns (uint32) {
+        return a + b;
+    }
+
+    function total() public view returns (uint128 t) {
+        optional_loop();
+        (uint32 k, uint128 v, bool ok) = m_history.min();
+        while (ok) {
+            t += v;
+            (k, v, ok) = m_history.next(k);
+        }
+    }
+
+    function optional_loop() private pure {
+    }
+
+    receive() external {
+        m_counter += 1;
+    }
+}
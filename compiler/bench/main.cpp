@@ -0,0 +1,287 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Benchmark of the TVM backend. Compiles a corpus of contracts stage by stage
+ * (parse, analyze, TVM codegen, peephole optimizer) and prints wall time,
+ * heap allocations and instruction counts of every stage as JSON.
+ */
+
+#include <bench/AllocationCounter.h>
+
+#include <libsolidity/codegen/TVMOptimizations.hpp>
+#include <libsolidity/interface/CompilerStack.h>
+#include <libsolidity/interface/Version.h>
+
+#include <liblangutil/SourceReferenceFormatterHuman.h>
+
+#include <libsolutil/CommonIO.h>
+#include <libsolutil/JSON.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <sstream>
+
+using namespace std;
+using namespace solidity;
+using namespace solidity::frontend;
+using namespace solidity::frontend::bench;
+using namespace solidity::langutil;
+using namespace solidity::util;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+namespace
+{
+
+vector<string> const g_stages{"parse", "analyze", "codegen", "peephole"};
+
+struct StageResult
+{
+	/// Minimum over all repetitions
+	double seconds = numeric_limits<double>::max();
+	size_t allocations = 0;
+	size_t allocatedBytes = 0;
+	/// Number of instructions in the output, only for the codegen and peephole stages
+	optional<size_t> instructions;
+};
+
+/// Measures one run of a stage, allocations and instructions are the same in every run.
+template <typename F>
+void measure(StageResult& _result, F const& _stage)
+{
+	size_t allocations = AllocationCounter::allocations();
+	size_t allocatedBytes = AllocationCounter::allocatedBytes();
+	auto start = chrono::steady_clock::now();
+	_stage();
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	_result.seconds = min(_result.seconds, seconds);
+	_result.allocations = AllocationCounter::allocations() - allocations;
+	_result.allocatedBytes = AllocationCounter::allocatedBytes() - allocatedBytes;
+}
+
+/// Counts the commands of @a _code, not comments, directives (.blob, .selector, .loc, ...) or closing braces.
+size_t countInstructions(CodeLines const& _code)
+{
+	return size_t(count_if(_code.lines.begin(), _code.lines.end(), [](Instruction const& _instruction) {
+		return !_instruction.isCommentOrEmpty() && !_instruction.isDirective() && _instruction.opcode != Opcode::CONT_END;
+	}));
+}
+
+void printErrors(CompilerStack const& _compiler)
+{
+	SourceReferenceFormatterHuman formatter(cerr, false);
+	for (auto const& error: _compiler.errors())
+		formatter.printErrorInformation(*error);
+}
+
+/// Compiles the main contract of @a _path and @returns the results of all stages, or nothing if compilation fails.
+optional<map<string, StageResult>> benchmark(string const& _path, unsigned _repeat)
+{
+	map<string, StageResult> results;
+	ReadCallback::Callback readFile = [](string const& _kind, string const& _importPath)
+	{
+		if (_kind != ReadCallback::kindString(ReadCallback::Kind::ReadFile) || !fs::is_regular_file(_importPath))
+			return ReadCallback::Result{false, "File not found."};
+		return ReadCallback::Result{true, readFileAsString(_importPath)};
+	};
+
+	for (unsigned run = 0; run < _repeat; ++run)
+	{
+		ostringstream output;
+		CodeLines code;
+		{
+			CompilerStack compiler(readFile);
+			TVMSettings settings;
+			settings.tvmOption = TvmOption::Code;
+			compiler.setTVMSettings(settings);
+			compiler.setTVMOutputStream(&output);
+			compiler.setSources({{_path, readFileAsString(_path)}});
+
+			bool success = true;
+			measure(results["parse"], [&]() { success = compiler.parse(); });
+			if (success)
+				measure(results["analyze"], [&]() { success = compiler.analyze(); });
+			if (success)
+				measure(results["codegen"], [&]() { success = compiler.compile(); });
+			if (!success)
+			{
+				printErrors(compiler);
+				return {};
+			}
+		}
+
+		// The peephole optimizer runs on the whole unoptimized contract, as with solc --tvm-peephole
+		istringstream lines(output.str());
+		for (string line; getline(lines, line);)
+			code.push(line);
+		CodeLines optimized;
+		measure(results["peephole"], [&]() { optimized = optimize_code(code); });
+		results["codegen"].instructions = countInstructions(code);
+		results["peephole"].instructions = countInstructions(optimized);
+	}
+	return results;
+}
+
+Json::Value toJson(StageResult const& _result)
+{
+	Json::Value json(Json::objectValue);
+	json["seconds"] = _result.seconds;
+	json["allocations"] = Json::UInt64(_result.allocations);
+	json["allocatedBytes"] = Json::UInt64(_result.allocatedBytes);
+	if (_result.instructions)
+		json["instructions"] = Json::UInt64(*_result.instructions);
+	return json;
+}
+
+/// Prints changes of every contract and of the total against a result of a previous run.
+void compare(Json::Value const& _baseline, Json::Value const& _current, ostream& _out)
+{
+	auto ratio = [](Json::Value const& _old, Json::Value const& _new) -> string
+	{
+		if (!_old.isNumeric() || !_new.isNumeric() || _old.asDouble() == 0)
+			return "-";
+		return (boost::format("%+.1f%%") % ((_new.asDouble() / _old.asDouble() - 1) * 100)).str();
+	};
+
+	string const rowFormat = "%-32s %10s %12s %14s\n";
+	auto printRows = [&](string const& _name, Json::Value const& _before, Json::Value const& _after)
+	{
+		for (string const& stage: g_stages)
+			_out << boost::format(rowFormat) %
+				(_name + " " + stage) %
+				ratio(_before[stage]["seconds"], _after[stage]["seconds"]) %
+				ratio(_before[stage]["allocations"], _after[stage]["allocations"]) %
+				ratio(_before[stage]["instructions"], _after[stage]["instructions"]);
+	};
+	_out << boost::format(rowFormat) % "Stage" % "Time" % "Allocations" % "Instructions";
+	for (string const& contract: _current["contracts"].getMemberNames())
+		printRows(contract, _baseline["contracts"][contract], _current["contracts"][contract]);
+	printRows("total", _baseline["total"], _current["total"]);
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	po::options_description options(
+		R"(solc-tvm-bench, benchmark of the TVM backend.
+
+Usage: solc-tvm-bench [options] [file|directory ...]
+Compiles the main contract of every given file (by default, the bundled corpus) through
+parse, analyze, TVM codegen and the peephole optimizer and prints the wall time (minimum
+of all runs), heap allocations and output instruction counts of every stage in JSON.
+
+Allowed options)",
+		po::options_description::m_default_line_length,
+		po::options_description::m_default_line_length - 23
+	);
+	options.add_options()
+		("help", "Show this help screen.")
+		("repeat", po::value<unsigned>()->default_value(5)->value_name("N"), "Run every stage N times.")
+		(
+			"baseline",
+			po::value<string>()->value_name("file"),
+			"Print the changes against the JSON output of a previous run to stderr."
+		);
+	po::options_description allOptions = options;
+	allOptions.add_options()("input", po::value<vector<string>>(), "input file or directory");
+	po::positional_options_description positional;
+	positional.add("input", -1);
+
+	po::variables_map args;
+	try
+	{
+		po::store(po::command_line_parser(argc, argv).options(allOptions).positional(positional).run(), args);
+		po::notify(args);
+	}
+	catch (po::error const& _exception)
+	{
+		cerr << _exception.what() << endl;
+		return 1;
+	}
+	if (args.count("help"))
+	{
+		cout << options;
+		return 0;
+	}
+	unsigned repeat = max(args["repeat"].as<unsigned>(), 1u);
+
+	vector<string> inputs{SOLC_TVM_BENCH_CORPUS};
+	if (args.count("input"))
+		inputs = args["input"].as<vector<string>>();
+	vector<fs::path> files;
+	for (string const& input: inputs)
+		if (fs::is_directory(input))
+		{
+			for (fs::directory_entry const& entry: fs::directory_iterator(input))
+				if (entry.path().extension() == ".sol")
+					files.push_back(entry.path());
+		}
+		else
+			files.push_back(input);
+	sort(files.begin(), files.end());
+
+	Json::Value result(Json::objectValue);
+	result["version"] = VersionString;
+	result["repeat"] = repeat;
+	result["contracts"] = Json::objectValue;
+	map<string, StageResult> total;
+	for (fs::path const& file: files)
+	{
+		auto stages = benchmark(file.string(), repeat);
+		if (!stages)
+		{
+			cerr << "Failed to compile " << file.string() << endl;
+			return 1;
+		}
+		Json::Value& contract = result["contracts"][file.filename().string()];
+		for (auto const& [stage, stageResult]: *stages)
+		{
+			contract[stage] = toJson(stageResult);
+			StageResult& sum = total[stage];
+			sum.seconds = (sum.seconds == numeric_limits<double>::max() ? 0 : sum.seconds) + stageResult.seconds;
+			sum.allocations += stageResult.allocations;
+			sum.allocatedBytes += stageResult.allocatedBytes;
+			if (stageResult.instructions)
+				sum.instructions = sum.instructions.value_or(0) + *stageResult.instructions;
+		}
+	}
+	result["total"] = Json::objectValue;
+	for (auto const& [stage, stageResult]: total)
+		result["total"][stage] = toJson(stageResult);
+	cout << jsonPrettyPrint(result) << endl;
+
+	if (args.count("baseline"))
+	{
+		Json::Value baseline;
+		string errors;
+		if (!jsonParseStrict(readFileAsString(args["baseline"].as<string>()), baseline, &errors))
+		{
+			cerr << "Invalid baseline: " << errors << endl;
+			return 1;
+		}
+		compare(baseline, result, cerr);
+	}
+	return 0;
+}
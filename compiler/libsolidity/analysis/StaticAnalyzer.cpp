@@ -82,9 +82,9 @@ StaticAnalyzer::~StaticAnalyzer()
 {
 }
 
-bool StaticAnalyzer::analyze(SourceUnit const& _sourceUnit)
+bool StaticAnalyzer::analyze(ASTNode const& _astRoot)
 {
-	_sourceUnit.accept(*this);
+	_astRoot.accept(*this);
 	return Error::containsOnlyWarnings(m_errorReporter.errors());
 }
 
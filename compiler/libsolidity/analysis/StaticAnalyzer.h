@@ -52,9 +52,9 @@ public:
 	explicit StaticAnalyzer(langutil::ErrorReporter& _errorReporter);
 	~StaticAnalyzer();
 
-	/// Performs static analysis on the given source unit and all of its sub-nodes.
+	/// Performs static analysis on the given source unit or contract and all of its sub-nodes.
 	/// @returns true iff all checks passed. Note even if all checks passed, errors() can still contain warnings
-	bool analyze(SourceUnit const& _sourceUnit);
+	bool analyze(ASTNode const& _astRoot);
 
 private:
 
@@ -30,11 +30,19 @@
 #include <boost/algorithm/string.hpp>
 #include <algorithm>
 #include <functional>
+#include <mutex>
 
 using namespace std;
 using namespace solidity;
 using namespace solidity::frontend;
 
+namespace
+{
+/// Guards the interface caches of contracts. They are computed without the lock
+/// and published under it, as several threads may analyze the same base contract.
+mutex interfaceCacheMutex;
+}
+
 void Mapping::setLocation(DataLocation _location) {
 	m_location = _location;
 	if (auto map = dynamic_cast<Mapping*>(m_valueType.get()))
@@ -70,10 +78,22 @@ ASTNode::ASTNode(int64_t _id, SourceLocation const& _location):
 ASTAnnotation& ASTNode::annotation() const
 {
 	if (!m_annotation)
+	{
+		assertAnnotationsWritable();
 		m_annotation = make_unique<ASTAnnotation>();
+	}
 	return *m_annotation;
 }
 
+thread_local bool ASTNode::s_readOnlyAnnotations = false;
+
+void ASTNode::assertAnnotationsWritable() const
+{
+#ifndef NDEBUG
+	solAssert(!s_readOnlyAnnotations, "Annotation of node " + to_string(id()) + " created in a parallel pass.");
+#endif
+}
+
 SourceUnitAnnotation& SourceUnit::annotation() const
 {
 	return initAnnotation<SourceUnitAnnotation>();
@@ -177,59 +197,73 @@ FunctionDefinition const* ContractDefinition::receiveFunction() const
 
 vector<EventDefinition const*> const& ContractDefinition::interfaceEvents() const
 {
-	if (!m_interfaceEvents)
 	{
-		set<string> eventsSeen;
-		m_interfaceEvents = make_unique<vector<EventDefinition const*>>();
-		for (ContractDefinition const* contract: annotation().linearizedBaseContracts)
-			for (EventDefinition const* e: contract->events())
+		lock_guard<mutex> lock(interfaceCacheMutex);
+		if (m_interfaceEvents)
+			return *m_interfaceEvents;
+	}
+
+	set<string> eventsSeen;
+	auto interfaceEvents = make_unique<vector<EventDefinition const*>>();
+	for (ContractDefinition const* contract: annotation().linearizedBaseContracts)
+		for (EventDefinition const* e: contract->events())
+		{
+			/// NOTE: this requires the "internal" version of an Event,
+			///       though here internal strictly refers to visibility,
+			///       and not to function encoding (jump vs. call)
+			auto const& function = e->functionType(true);
+			solAssert(function, "");
+			string eventSignature = function->externalSignature();
+			if (eventsSeen.count(eventSignature) == 0)
 			{
-				/// NOTE: this requires the "internal" version of an Event,
-				///       though here internal strictly refers to visibility,
-				///       and not to function encoding (jump vs. call)
-				auto const& function = e->functionType(true);
-				solAssert(function, "");
-				string eventSignature = function->externalSignature();
-				if (eventsSeen.count(eventSignature) == 0)
-				{
-					eventsSeen.insert(eventSignature);
-					m_interfaceEvents->push_back(e);
-				}
+				eventsSeen.insert(eventSignature);
+				interfaceEvents->push_back(e);
 			}
-	}
+		}
+
+	lock_guard<mutex> lock(interfaceCacheMutex);
+	if (!m_interfaceEvents)
+		m_interfaceEvents = move(interfaceEvents);
 	return *m_interfaceEvents;
 }
 
 vector<pair<util::FixedHash<4>, FunctionTypePointer>> const& ContractDefinition::interfaceFunctionList() const
 {
-	if (!m_interfaceFunctionList)
 	{
-		set<string> signaturesSeen;
-		m_interfaceFunctionList = make_unique<vector<pair<util::FixedHash<4>, FunctionTypePointer>>>();
-		for (ContractDefinition const* contract: annotation().linearizedBaseContracts)
+		lock_guard<mutex> lock(interfaceCacheMutex);
+		if (m_interfaceFunctionList)
+			return *m_interfaceFunctionList;
+	}
+
+	set<string> signaturesSeen;
+	auto interfaceFunctionList = make_unique<vector<pair<util::FixedHash<4>, FunctionTypePointer>>>();
+	for (ContractDefinition const* contract: annotation().linearizedBaseContracts)
+	{
+		vector<FunctionTypePointer> functions;
+		for (FunctionDefinition const* f: contract->definedFunctions())
+			if (f->isPartOfExternalInterface())
+				functions.push_back(TypeProvider::function(*f, FunctionType::Kind::External));
+		for (VariableDeclaration const* v: contract->stateVariables())
+			if (v->isPartOfExternalInterface())
+				functions.push_back(TypeProvider::function(*v));
+		for (FunctionTypePointer const& fun: functions)
 		{
-			vector<FunctionTypePointer> functions;
-			for (FunctionDefinition const* f: contract->definedFunctions())
-				if (f->isPartOfExternalInterface())
-					functions.push_back(TypeProvider::function(*f, FunctionType::Kind::External));
-			for (VariableDeclaration const* v: contract->stateVariables())
-				if (v->isPartOfExternalInterface())
-					functions.push_back(TypeProvider::function(*v));
-			for (FunctionTypePointer const& fun: functions)
+			if (!fun->interfaceFunctionType())
+				// Fails hopefully because we already registered the error
+				continue;
+			string functionSignature = fun->externalSignature();
+			if (signaturesSeen.count(functionSignature) == 0)
 			{
-				if (!fun->interfaceFunctionType())
-					// Fails hopefully because we already registered the error
-					continue;
-				string functionSignature = fun->externalSignature();
-				if (signaturesSeen.count(functionSignature) == 0)
-				{
-					signaturesSeen.insert(functionSignature);
-					util::FixedHash<4> hash(util::keccak256(functionSignature));
-					m_interfaceFunctionList->emplace_back(hash, fun);
-				}
+				signaturesSeen.insert(functionSignature);
+				util::FixedHash<4> hash(util::keccak256(functionSignature));
+				interfaceFunctionList->emplace_back(hash, fun);
 			}
 		}
 	}
+
+	lock_guard<mutex> lock(interfaceCacheMutex);
+	if (!m_interfaceFunctionList)
+		m_interfaceFunctionList = move(interfaceFunctionList);
 	return *m_interfaceFunctionList;
 }
 
@@ -68,6 +68,9 @@ public:
 
 	/// @returns an identifier of this AST node that is unique for a single compilation run.
 	int64_t id() const { return m_id; }
+	/// Adds @a _offset to the identifier. Used to number the nodes of sources parsed by different
+	/// parsers as if they were parsed one after another.
+	void shiftID(int64_t _offset) { m_id += _offset; }
 
 	virtual void accept(ASTVisitor& _visitor) = 0;
 	virtual void accept(ASTConstVisitor& _visitor) const = 0;
@@ -103,18 +106,35 @@ public:
 	bool operator!=(ASTNode const& _other) const { return !operator==(_other); }
 	///@}
 
+	/// While an object of this class exists, the current thread only reads the annotations and
+	/// creating one fails an assertion in debug builds. The workers of the parallel passes hold one,
+	/// because the annotations are preloaded before them and the nodes are shared between threads.
+	class ReadOnlyAnnotationsScope: boost::noncopyable
+	{
+	public:
+		ReadOnlyAnnotationsScope() { s_readOnlyAnnotations = true; }
+		~ReadOnlyAnnotationsScope() { s_readOnlyAnnotations = false; }
+	};
+
 protected:
-	size_t const m_id = 0;
+	size_t m_id = 0;
 
 	template <class T>
 	T& initAnnotation() const
 	{
 		if (!m_annotation)
+		{
+			assertAnnotationsWritable();
 			m_annotation = std::make_unique<T>();
+		}
 		return dynamic_cast<T&>(*m_annotation);
 	}
 
 private:
+	void assertAnnotationsWritable() const;
+
+	static thread_local bool s_readOnlyAnnotations;
+
 	/// Annotation - is specialised in derived classes, is created upon request (because of polymorphism).
 	mutable std::unique_ptr<ASTAnnotation> m_annotation;
 	SourceLocation m_location;
@@ -444,7 +464,8 @@ public:
 		m_baseContracts(_baseContracts),
 		m_subNodes(_subNodes),
 		m_contractKind(_contractKind),
-		m_abstract(_abstract)
+		m_abstract(_abstract),
+		m_hasUsingForDirectives(!usingForDirectives().empty())
 	{}
 
 	void accept(ASTVisitor& _visitor) override;
@@ -453,6 +474,8 @@ public:
 	std::vector<ASTPointer<InheritanceSpecifier>> const& baseContracts() const { return m_baseContracts; }
 	std::vector<ASTPointer<ASTNode>> const& subNodes() const { return m_subNodes; }
 	std::vector<UsingForDirective const*> usingForDirectives() const { return filteredNodes<UsingForDirective>(m_subNodes); }
+	/// @returns true if the contract itself (not its bases) has `using for` directives.
+	bool hasUsingForDirectives() const { return m_hasUsingForDirectives; }
 	std::vector<StructDefinition const*> definedStructs() const { return filteredNodes<StructDefinition>(m_subNodes); }
 	std::vector<EnumDefinition const*> definedEnums() const { return filteredNodes<EnumDefinition>(m_subNodes); }
 	std::vector<VariableDeclaration const*> stateVariables() const { return filteredNodes<VariableDeclaration>(m_subNodes); }
@@ -504,6 +527,7 @@ private:
 	std::vector<ASTPointer<ASTNode>> m_subNodes;
 	ContractKind m_contractKind;
 	bool m_abstract{false};
+	bool m_hasUsingForDirectives = false;
 
 	mutable std::unique_ptr<std::vector<std::pair<util::FixedHash<4>, FunctionTypePointer>>> m_interfaceFunctionList;
 	mutable std::unique_ptr<std::vector<EventDefinition const*>> m_interfaceEvents;
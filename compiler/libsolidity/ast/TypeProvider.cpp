@@ -157,6 +157,8 @@ array<unique_ptr<MagicType>, 5> const TypeProvider::m_magics{{
 	// MetaType is stored separately
 }};
 
+mutex TypeProvider::m_mutex;
+
 inline void clearCache(Type const& type)
 {
 	type.clearCache();
@@ -179,7 +181,11 @@ inline void clearCaches(Container& container)
 
 void TypeProvider::reset()
 {
+	lock_guard<mutex> lock(m_mutex);
 	clearCache(m_boolean);
+	clearCache(m_tvmcell);
+	clearCache(m_tvmslice);
+	clearCache(m_tvmbuilder);
 	clearCache(m_inaccessibleDynamic);
 	clearCache(m_bytesStorage);
 	clearCache(m_bytesMemory);
@@ -188,22 +194,99 @@ void TypeProvider::reset()
 	clearCache(m_stringMemory);
 	clearCache(m_emptyTuple);
 	clearCache(m_address);
+	clearCache(m_varInteger);
 	clearCaches(instance().m_intM);
 	clearCaches(instance().m_uintM);
 	clearCaches(instance().m_bytesM);
 	clearCaches(instance().m_magics);
 
 	instance().m_generalTypes.clear();
+	instance().m_internedTypes.clear();
 	instance().m_stringLiteralTypes.clear();
 	instance().m_ufixedMxN.clear();
 	instance().m_fixedMxN.clear();
 }
 
+namespace
+{
+
+/// Functions appending the arguments of a factory function to the key of the created type.
+/// Types and AST nodes are identified by their addresses, types are interned already.
+void appendToKey(string& _key, void const* _pointer)
+{
+	_key += '|' + to_string(reinterpret_cast<uintptr_t>(_pointer));
+}
+
+void appendToKey(string& _key, bool _flag)
+{
+	_key += _flag ? "|1" : "|0";
+}
+
+template <typename Enum>
+enable_if_t<is_enum_v<Enum>> appendToKey(string& _key, Enum _value)
+{
+	_key += '|' + to_string(static_cast<int>(_value));
+}
+
+void appendToKey(string& _key, u256 const& _value)
+{
+	_key += '|' + _value.str();
+}
+
+void appendToKey(string& _key, rational const& _value)
+{
+	_key += '|' + _value.numerator().str() + '/' + _value.denominator().str();
+}
+
+void appendToKey(string& _key, string const& _value)
+{
+	// the length keeps the key unambiguous whatever characters the string contains
+	_key += '|' + to_string(_value.size()) + ':' + _value;
+}
+
+template <typename T>
+void appendToKey(string& _key, vector<T> const& _values)
+{
+	_key += "|[" + to_string(_values.size());
+	for (T const& value: _values)
+		appendToKey(_key, value);
+	_key += ']';
+}
+
+/// @returns the structural identity of the type created by @a _factory from @a _args.
+template <typename... Args>
+string typeKey(char const* _factory, Args const&... _args)
+{
+	string key = _factory;
+	(appendToKey(key, _args), ...);
+	return key;
+}
+
+}
+
 template <typename T, typename... Args>
-inline T const* TypeProvider::createAndGet(Args&& ... _args)
+inline T const* TypeProvider::getOrCreate(string _key, Args&& ... _args)
+{
+	if (Type const* type = findInterned(_key))
+		return static_cast<T const*>(type);
+	// Constructors of types may request other types, so the type is created without the lock.
+	return static_cast<T const*>(intern(move(_key), make_unique<T>(std::forward<Args>(_args)...)));
+}
+
+Type const* TypeProvider::findInterned(string const& _key)
+{
+	lock_guard<mutex> lock(m_mutex);
+	auto it = instance().m_internedTypes.find(_key);
+	return it == instance().m_internedTypes.end() ? nullptr : it->second;
+}
+
+Type const* TypeProvider::intern(string _key, unique_ptr<Type> _type)
 {
-	instance().m_generalTypes.emplace_back(make_unique<T>(std::forward<Args>(_args)...));
-	return static_cast<T const*>(instance().m_generalTypes.back().get());
+	lock_guard<mutex> lock(m_mutex);
+	auto [it, inserted] = instance().m_internedTypes.emplace(move(_key), _type.get());
+	if (inserted)
+		instance().m_generalTypes.emplace_back(move(_type));
+	return it->second;
 }
 
 Type const* TypeProvider::fromElementaryTypeName(ElementaryTypeNameToken const& _type)
@@ -309,6 +392,7 @@ TypePointer TypeProvider::fromElementaryTypeName(string const& _name)
 
 ArrayType const* TypeProvider::bytesStorage()
 {
+	lock_guard<mutex> lock(m_mutex);
 	if (!m_bytesStorage)
 		m_bytesStorage = make_unique<ArrayType>(DataLocation::Storage, false);
 	return m_bytesStorage.get();
@@ -316,6 +400,7 @@ ArrayType const* TypeProvider::bytesStorage()
 
 ArrayType const* TypeProvider::bytesMemory()
 {
+	lock_guard<mutex> lock(m_mutex);
 	if (!m_bytesMemory)
 		m_bytesMemory = make_unique<ArrayType>(DataLocation::Memory, false);
 	return m_bytesMemory.get();
@@ -323,6 +408,7 @@ ArrayType const* TypeProvider::bytesMemory()
 
 ArrayType const* TypeProvider::bytesCalldata()
 {
+	lock_guard<mutex> lock(m_mutex);
 	if (!m_bytesCalldata)
 		m_bytesCalldata = make_unique<ArrayType>(DataLocation::CallData, false);
 	return m_bytesCalldata.get();
@@ -330,6 +416,7 @@ ArrayType const* TypeProvider::bytesCalldata()
 
 ArrayType const* TypeProvider::stringStorage()
 {
+	lock_guard<mutex> lock(m_mutex);
 	if (!m_stringStorage)
 		m_stringStorage = make_unique<ArrayType>(DataLocation::Storage, true);
 	return m_stringStorage.get();
@@ -337,6 +424,7 @@ ArrayType const* TypeProvider::stringStorage()
 
 ArrayType const* TypeProvider::stringMemory()
 {
+	lock_guard<mutex> lock(m_mutex);
 	if (!m_stringMemory)
 		m_stringMemory = make_unique<ArrayType>(DataLocation::Memory, true);
 	return m_stringMemory.get();
@@ -380,6 +468,7 @@ RationalNumberType const* TypeProvider::rationalNumber(Literal const& _literal)
 
 StringLiteralType const* TypeProvider::stringLiteral(string const& literal)
 {
+	lock_guard<mutex> lock(m_mutex);
 	auto i = instance().m_stringLiteralTypes.find(literal);
 	if (i != instance().m_stringLiteralTypes.end())
 		return i->second.get();
@@ -389,6 +478,7 @@ StringLiteralType const* TypeProvider::stringLiteral(string const& literal)
 
 FixedPointType const* TypeProvider::fixedPoint(unsigned m, unsigned n, FixedPointType::Modifier _modifier)
 {
+	lock_guard<mutex> lock(m_mutex);
 	auto& map = _modifier == FixedPointType::Modifier::Unsigned ? instance().m_ufixedMxN : instance().m_fixedMxN;
 
 	auto i = map.find(make_pair(m, n));
@@ -406,7 +496,7 @@ TupleType const* TypeProvider::tuple(vector<Type const*> members)
 	if (members.empty())
 		return &m_emptyTuple;
 
-	return createAndGet<TupleType>(move(members));
+	return getOrCreate<TupleType>(typeKey("tuple", members), move(members));
 }
 
 ReferenceType const* TypeProvider::withLocation(ReferenceType const* _type, DataLocation _location, bool _isPointer)
@@ -414,28 +504,30 @@ ReferenceType const* TypeProvider::withLocation(ReferenceType const* _type, Data
 	if (_type->location() == _location && _type->isPointer() == _isPointer)
 		return _type;
 
-	instance().m_generalTypes.emplace_back(_type->copyForLocation(_location, _isPointer));
-	return static_cast<ReferenceType const*>(instance().m_generalTypes.back().get());
+	string key = typeKey("withLocation", _type, _location, _isPointer);
+	if (Type const* type = findInterned(key))
+		return static_cast<ReferenceType const*>(type);
+	return static_cast<ReferenceType const*>(intern(move(key), _type->copyForLocation(_location, _isPointer)));
 }
 
 FunctionType const* TypeProvider::function(FunctionDefinition const& _function, FunctionType::Kind _kind)
 {
-	return createAndGet<FunctionType>(_function, _kind);
+	return getOrCreate<FunctionType>(typeKey("function", &_function, _kind), _function, _kind);
 }
 
 FunctionType const* TypeProvider::function(VariableDeclaration const& _varDecl)
 {
-	return createAndGet<FunctionType>(_varDecl);
+	return getOrCreate<FunctionType>(typeKey("getter", &_varDecl), _varDecl);
 }
 
 FunctionType const* TypeProvider::function(EventDefinition const& _def)
 {
-	return createAndGet<FunctionType>(_def);
+	return getOrCreate<FunctionType>(typeKey("event", &_def), _def);
 }
 
 FunctionType const* TypeProvider::function(FunctionTypeName const& _typeName)
 {
-	return createAndGet<FunctionType>(_typeName);
+	return getOrCreate<FunctionType>(typeKey("functionTypeName", &_typeName), _typeName);
 }
 
 FunctionType const* TypeProvider::function(
@@ -446,7 +538,8 @@ FunctionType const* TypeProvider::function(
 	StateMutability _stateMutability
 )
 {
-	return createAndGet<FunctionType>(
+	return getOrCreate<FunctionType>(
+		typeKey("functionFromNames", _parameterTypes, _returnParameterTypes, _kind, _arbitraryParameters, _stateMutability),
 		_parameterTypes, _returnParameterTypes,
 		_kind, _arbitraryParameters, _stateMutability
 	);
@@ -468,7 +561,23 @@ FunctionType const* TypeProvider::function(
 	bool _flagSet
 )
 {
-	return createAndGet<FunctionType>(
+	return getOrCreate<FunctionType>(
+		typeKey(
+			"functionFromTypes",
+			_parameterTypes,
+			_returnParameterTypes,
+			_parameterNames,
+			_returnParameterNames,
+			_kind,
+			_arbitraryParameters,
+			_stateMutability,
+			_declaration,
+			_gasSet,
+			_valueSet,
+			_saltSet,
+			_bound,
+			_flagSet
+		),
 		_parameterTypes,
 		_returnParameterTypes,
 		_parameterNames,
@@ -487,7 +596,7 @@ FunctionType const* TypeProvider::function(
 
 RationalNumberType const* TypeProvider::rationalNumber(rational const& _value, Type const* _compatibleBytesType)
 {
-	return createAndGet<RationalNumberType>(_value, _compatibleBytesType);
+	return getOrCreate<RationalNumberType>(typeKey("rational", _value, _compatibleBytesType), _value, _compatibleBytesType);
 }
 
 ArrayType const* TypeProvider::array(DataLocation _location, bool _isString)
@@ -506,52 +615,52 @@ ArrayType const* TypeProvider::array(DataLocation _location, bool _isString)
 		if (_location == DataLocation::Memory)
 			return bytesMemory();
 	}
-	return createAndGet<ArrayType>(_location, _isString);
+	return getOrCreate<ArrayType>(typeKey("bytes", _location, _isString), _location, _isString);
 }
 
 ArrayType const* TypeProvider::array(DataLocation _location, Type const* _baseType)
 {
-	return createAndGet<ArrayType>(_location, _baseType);
+	return getOrCreate<ArrayType>(typeKey("array", _location, _baseType), _location, _baseType);
 }
 
 ArrayType const* TypeProvider::array(DataLocation _location, Type const* _baseType, u256 const& _length)
 {
-	return createAndGet<ArrayType>(_location, _baseType, _length);
+	return getOrCreate<ArrayType>(typeKey("fixedArray", _location, _baseType, _length), _location, _baseType, _length);
 }
 
 ArraySliceType const* TypeProvider::arraySlice(ArrayType const& _arrayType)
 {
-	return createAndGet<ArraySliceType>(_arrayType);
+	return getOrCreate<ArraySliceType>(typeKey("arraySlice", &_arrayType), _arrayType);
 }
 
 ContractType const* TypeProvider::contract(ContractDefinition const& _contractDef, bool _isSuper)
 {
-	return createAndGet<ContractType>(_contractDef, _isSuper);
+	return getOrCreate<ContractType>(typeKey("contract", &_contractDef, _isSuper), _contractDef, _isSuper);
 }
 
 EnumType const* TypeProvider::enumType(EnumDefinition const& _enumDef)
 {
-	return createAndGet<EnumType>(_enumDef);
+	return getOrCreate<EnumType>(typeKey("enum", &_enumDef), _enumDef);
 }
 
 ModuleType const* TypeProvider::module(SourceUnit const& _source)
 {
-	return createAndGet<ModuleType>(_source);
+	return getOrCreate<ModuleType>(typeKey("module", &_source), _source);
 }
 
 TypeType const* TypeProvider::typeType(Type const* _actualType)
 {
-	return createAndGet<TypeType>(_actualType);
+	return getOrCreate<TypeType>(typeKey("type", _actualType), _actualType);
 }
 
 StructType const* TypeProvider::structType(StructDefinition const& _struct, DataLocation _location)
 {
-	return createAndGet<StructType>(_struct, _location);
+	return getOrCreate<StructType>(typeKey("struct", &_struct, _location), _struct, _location);
 }
 
 ModifierType const* TypeProvider::modifier(ModifierDefinition const& _def)
 {
-	return createAndGet<ModifierType>(_def);
+	return getOrCreate<ModifierType>(typeKey("modifier", &_def), _def);
 }
 
 MagicType const* TypeProvider::magic(MagicType::Kind _kind)
@@ -563,14 +672,14 @@ MagicType const* TypeProvider::magic(MagicType::Kind _kind)
 MagicType const* TypeProvider::meta(Type const* _type)
 {
 	solAssert(_type && _type->category() == Type::Category::Contract, "Only contracts supported for now.");
-	return createAndGet<MagicType>(_type);
+	return getOrCreate<MagicType>(typeKey("meta", _type), _type);
 }
 
 MappingType const* TypeProvider::mapping(Type const* _keyType, Type const* _valueType, DataLocation _location)
 {
-	return createAndGet<MappingType>(_keyType, _valueType, _location);
+	return getOrCreate<MappingType>(typeKey("mapping", _keyType, _valueType, _location), _keyType, _valueType, _location);
 }
 
 ExtraCurrencyCollectionType const *TypeProvider::extraCurrencyCollection(DataLocation _location) {
-	return createAndGet<ExtraCurrencyCollectionType>(_location);
+	return getOrCreate<ExtraCurrencyCollectionType>(typeKey("extraCurrencyCollection", _location), _location);
 }
@@ -22,7 +22,10 @@
 #include <array>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <unordered_map>
 #include <utility>
 
 namespace solidity::frontend
@@ -36,6 +39,9 @@ namespace solidity::frontend
  *
  * It is not recommended to explicitly instantiate types unless you really know what and why
  * you are doing it.
+ *
+ * Types are interned: a factory function called twice with the same arguments returns the same
+ * pointer. Types can be requested from several threads at once.
  */
 class TypeProvider
 {
@@ -205,8 +211,16 @@ private:
 		return _provider;
 	}
 
+	/// @returns the type with the structural identity @a _key, creates it from @a _args if there is none yet.
 	template <typename T, typename... Args>
-	static inline T const* createAndGet(Args&& ... _args);
+	static inline T const* getOrCreate(std::string _key, Args&& ... _args);
+
+	/// @returns the type interned under @a _key or nullptr.
+	static Type const* findInterned(std::string const& _key);
+
+	/// Interns @a _type under @a _key unless another thread has done it meanwhile.
+	/// @returns the interned type.
+	static Type const* intern(std::string _key, std::unique_ptr<Type> _type);
 
 	static BoolType const m_boolean;
 	static TvmCellType const m_tvmcell;
@@ -229,10 +243,15 @@ private:
 	static std::array<std::unique_ptr<FixedBytesType>, 32> const m_bytesM;
 	static std::array<std::unique_ptr<MagicType>, 5> const m_magics;        ///< MagicType's except MetaType
 
+	/// Guards the lazy-initialized types and the containers of created types.
+	static std::mutex m_mutex;
+
 	std::map<std::pair<unsigned, unsigned>, std::unique_ptr<FixedPointType>> m_ufixedMxN{};
 	std::map<std::pair<unsigned, unsigned>, std::unique_ptr<FixedPointType>> m_fixedMxN{};
 	std::map<std::string, std::unique_ptr<StringLiteralType>> m_stringLiteralTypes{};
 	std::vector<std::unique_ptr<Type>> m_generalTypes{};
+	/// Types of m_generalTypes by their structural identity, i.e. the factory function and its arguments.
+	std::unordered_map<std::string, Type const*> m_internedTypes{};
 };
 
 }
@@ -43,6 +43,7 @@
 #include <boost/range/algorithm/copy.hpp>
 
 #include <limits>
+#include <mutex>
 
 using namespace std;
 using namespace solidity;
@@ -52,6 +53,22 @@ using namespace solidity::frontend;
 namespace
 {
 
+/// Guards Type::m_members and Type::m_sharedMembers. The members are computed without the lock,
+/// as computing them requests members and lazily computed values of other types.
+mutex membersMutex;
+
+/// @returns true if `using for` directives of @a _scope or of its bases can bind functions to types.
+bool hasUsingForDirectives(ContractDefinition const& _scope)
+{
+	for (ContractDefinition const* contract: _scope.annotation().linearizedBaseContracts)
+		if (contract->hasUsingForDirectives())
+			return true;
+	return false;
+}
+
+/// Guards the other lazily computed values of types, which are computed under the lock.
+recursive_mutex lazyValuesMutex;
+
 /// Check whether (_base ** _exp) fits into 4096 bits.
 bool fitsPrecisionExp(bigint const& _base, bigint const& _exp)
 {
@@ -151,6 +168,8 @@ util::Result<TypePointers> transformParametersToExternal(TypePointers const& _pa
 void Type::clearCache() const
 {
 	m_members.clear();
+	m_sharedMembersView = nullptr;
+	m_sharedMembers.reset();
 }
 
 void StorageOffsets::computeOffsets(TypePointers const& _types)
@@ -204,6 +223,7 @@ void MemberList::combine(MemberList const & _other)
 
 pair<u256, unsigned> const* MemberList::memberStorageOffset(string const& _name) const
 {
+	lock_guard<recursive_mutex> lock(lazyValuesMutex);
 	if (!m_storageOffsets)
 	{
 		TypePointers memberTypes;
@@ -307,14 +327,38 @@ TypePointer Type::commonType(Type const* _a, Type const* _b)
 
 MemberList const& Type::members(ContractDefinition const* _currentScope) const
 {
-	if (!m_members[_currentScope])
+	if (!nativeMembersDependOnScope() && !(_currentScope && hasUsingForDirectives(*_currentScope)))
 	{
-		MemberList::MemberMap members = nativeMembers(_currentScope);
-		if (_currentScope)
-			members += boundFunctions(*this, *_currentScope);
-		m_members[_currentScope] = make_unique<MemberList>(move(members));
+		if (MemberList const* sharedMembers = m_sharedMembersView.load(memory_order_acquire))
+			return *sharedMembers;
+		auto memberList = make_unique<MemberList>(nativeMembers(_currentScope));
+
+		lock_guard<mutex> lock(membersMutex);
+		if (!m_sharedMembers)
+		{
+			m_sharedMembers = move(memberList);
+			m_sharedMembersView.store(m_sharedMembers.get(), memory_order_release);
+		}
+		return *m_sharedMembers;
 	}
-	return *m_members[_currentScope];
+
+	{
+		lock_guard<mutex> lock(membersMutex);
+		auto it = m_members.find(_currentScope);
+		if (it != m_members.end())
+			return *it->second;
+	}
+	MemberList::MemberMap members = nativeMembers(_currentScope);
+	if (_currentScope)
+		members += boundFunctions(*this, *_currentScope);
+	auto memberList = make_unique<MemberList>(move(members));
+
+	lock_guard<mutex> lock(membersMutex);
+	// Another thread might have computed the same members meanwhile.
+	unique_ptr<MemberList>& cached = m_members[_currentScope];
+	if (!cached)
+		cached = move(memberList);
+	return *cached;
 }
 
 TypePointer Type::fullEncodingType(bool _inLibraryCall, bool _encoderV2, bool) const
@@ -1609,6 +1653,9 @@ string ArrayType::richIdentifier() const
 
 bool ArrayType::operator==(Type const& _other) const
 {
+	// equal types requested from TypeProvider share one pointer
+	if (&_other == this)
+		return true;
 	if (_other.category() != category())
 		return false;
 	ArrayType const& other = dynamic_cast<ArrayType const&>(_other);
@@ -1904,6 +1951,7 @@ TypePointer ArrayType::decodingType() const
 
 TypeResult ArrayType::interfaceType(bool _inLibrary) const
 {
+	lock_guard<recursive_mutex> lock(lazyValuesMutex);
 	if (_inLibrary && m_interfaceType_library.has_value())
 		return *m_interfaceType_library;
 
@@ -2053,6 +2101,7 @@ MemberList::MemberMap ContractType::nativeMembers(ContractDefinition const* _con
 
 FunctionType const* ContractType::newExpressionType() const
 {
+	lock_guard<recursive_mutex> lock(lazyValuesMutex);
 	if (!m_constructorType)
 		m_constructorType = FunctionType::newExpressionType(m_contract);
 	return m_constructorType;
@@ -2223,6 +2272,7 @@ MemberList::MemberMap StructType::nativeMembers(ContractDefinition const*) const
 
 TypeResult StructType::interfaceType(bool _inLibrary) const
 {
+	lock_guard<recursive_mutex> lock(lazyValuesMutex);
 	if (_inLibrary && m_interfaceType_library.has_value())
 		return *m_interfaceType_library;
 
@@ -2878,6 +2928,8 @@ string FunctionType::richIdentifier() const
 
 bool FunctionType::operator==(Type const& _other) const
 {
+	if (&_other == this)
+		return true;
 	if (_other.category() != category())
 		return false;
 	FunctionType const& other = dynamic_cast<FunctionType const&>(_other);
@@ -3508,6 +3560,8 @@ string MappingType::richIdentifier() const
 
 bool MappingType::operator==(Type const& _other) const
 {
+	if (&_other == this)
+		return true;
 	if (_other.category() != category())
 		return false;
 	MappingType const& other = dynamic_cast<MappingType const&>(_other);
@@ -3541,6 +3595,8 @@ string TypeType::richIdentifier() const
 
 bool TypeType::operator==(Type const& _other) const
 {
+	if (&_other == this)
+		return true;
 	if (_other.category() != category())
 		return false;
 	TypeType const& other = dynamic_cast<TypeType const&>(_other);
@@ -33,6 +33,7 @@
 
 #include <boost/rational.hpp>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <optional>
@@ -280,6 +281,8 @@ public:
 	}
 
 	/// Returns the list of all members of this type. Default implementation: no members apart from bound.
+	/// The list is built once and can be read from several threads. It is shared by all scopes unless
+	/// the native members depend on the scope or the scope has `using for` directives.
 	/// @param _currentScope scope in which the members are accessed.
 	MemberList const& members(ContractDefinition const* _currentScope) const;
 	/// Convenience method, returns the type of the given named member or an empty pointer if no such member exists.
@@ -336,9 +339,16 @@ protected:
 	{
 		return MemberList::MemberMap();
 	}
+	/// @returns true if nativeMembers depends on the given context.
+	virtual bool nativeMembersDependOnScope() const { return false; }
 
 	/// List of member types (parameterised by scape), will be lazy-initialized.
+	/// Only used for scopes with different members, see members().
 	mutable std::map<ContractDefinition const*, std::unique_ptr<MemberList>> m_members;
+	/// List of member types shared by the other scopes, will be lazy-initialized.
+	mutable std::unique_ptr<MemberList> m_sharedMembers;
+	/// m_sharedMembers once it is built, read without a lock.
+	mutable std::atomic<MemberList const*> m_sharedMembersView{nullptr};
 };
 
 /**
@@ -920,6 +930,7 @@ public:
 	std::string canonicalName() const override;
 
 	MemberList::MemberMap nativeMembers(ContractDefinition const* _currentScope) const override;
+	bool nativeMembersDependOnScope() const override { return true; }
 
 	Type const* encodingType() const override;
 
@@ -1290,6 +1301,7 @@ public:
 	unsigned sizeOnStack() const override;
 	bool hasSimpleZeroValueInMemory() const override { return false; }
 	MemberList::MemberMap nativeMembers(ContractDefinition const* _currentScope) const override;
+	bool nativeMembersDependOnScope() const override { return m_kind == Kind::Internal; }
 	TypePointer encodingType() const override;
 	TypeResult interfaceType(bool _inLibrary) const override;
 
@@ -1462,6 +1474,7 @@ public:
 	bool hasSimpleZeroValueInMemory() const override { solAssert(false, ""); }
 	std::string toString(bool _short) const override { return "type(" + m_actualType->toString(_short) + ")"; }
 	MemberList::MemberMap nativeMembers(ContractDefinition const* _currentScope) const override;
+	bool nativeMembersDependOnScope() const override { return m_actualType->category() == Category::Contract; }
 
 	BoolResult isExplicitlyConvertibleTo(Type const& _convertTo) const override;
 private:
@@ -17,15 +17,52 @@
  */
 
 
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <sstream>
+
+#include <libsolutil/PassTimer.h>
+
 #include "TVM.h"
 #include "TVMContractCompiler.hpp"
 #include "TVMTypeChecker.hpp"
 
 using namespace solidity::frontend;
 
-static string getLastContractName() {
-	string name;
-	for (auto c : TVMContractCompiler::m_allContracts) {
+namespace {
+
+// Buffer of files written by TVMCompilerSession::writeArtifact
+const size_t OutputBufferSize = 1 << 20;
+
+}
+
+void TVMCompilerSession::enable(TVMSettings const& settings) {
+	m_enabled = true;
+	m_settings = settings;
+}
+
+void TVMCompilerSession::setFileName(std::string const& sourceName) {
+	m_fileName = boost::filesystem::path(sourceName).stem().string();
+}
+
+void TVMCompilerSession::setAllContracts(std::vector<ContractDefinition const*> const& allContracts,
+										 std::string const& mainContract) {
+	m_allContracts = allContracts;
+	m_mainContractName = mainContract;
+}
+
+void TVMCompilerSession::reset() {
+	m_allContracts.clear();
+	m_mainContractName.clear();
+	m_fileName.clear();
+	m_outputProduced = false;
+	m_artifacts.clear();
+}
+
+std::string TVMCompilerSession::getLastContractName() const {
+	std::string name;
+	for (auto c : m_allContracts) {
 		if (c->canBeDeployed()) {
 			name = c->name();
 		}
@@ -33,66 +70,109 @@ static string getLastContractName() {
 	return name;
 }
 
-void TVMCompilerProceedContract(langutil::ErrorReporter* errorReporter, ContractDefinition const& _contract,
-								std::vector<PragmaDirective const *> const* pragmaDirectives) {
-	if (!TVMContractCompiler::m_optionsEnabled)
+void TVMCompilerSession::proceedContract(langutil::ErrorReporter* errorReporter, ContractDefinition const& _contract,
+										 std::vector<PragmaDirective const *> const* pragmaDirectives) {
+	if (!m_enabled)
 		return;
 
-	TVMContractCompiler::g_errorReporter = errorReporter;
+	ErrorReporterScope errorReporterScope{errorReporter};
 
-	std::string mainContract = (TVMContractCompiler::m_mainContractName.empty()) ?
-				getLastContractName() : TVMContractCompiler::m_mainContractName;
+	std::string mainContract = m_mainContractName.empty() ? getLastContractName() : m_mainContractName;
 
-	if (TVMContractCompiler::m_outputFolder.empty()) {
+	std::string fileName = m_fileName;
+	bool outputToFile = false;
+	if (m_settings.outputFolder.empty()) {
 		if (_contract.name() != mainContract)
 			return;
 	} else {
 		if (_contract.abstract() || _contract.isInterface())
 			return;
-		TVMContractCompiler::m_outputToFile = true;
+		outputToFile = true;
 		namespace fs = boost::filesystem;
-		TVMContractCompiler::m_fileName = (fs::path(TVMContractCompiler::m_outputFolder) / _contract.name()).string();
-    }
+		fileName = (fs::path(m_settings.outputFolder) / _contract.name()).string();
+	}
 
-	for (ContractDefinition const* c : TVMContractCompiler::m_allContracts) {
-		TVMTypeChecker::check(c, *pragmaDirectives);
+	{
+		util::PassTimer::Scope timer{m_passTimer, "TVMTypeChecker", _contract.name()};
+		for (ContractDefinition const* c : m_allContracts) {
+			TVMTypeChecker::check(c, *pragmaDirectives);
+		}
 	}
 
 	PragmaDirectiveHelper pragmaHelper{*pragmaDirectives};
-	switch (TVMContractCompiler::m_tvmOption) {
-		case TvmOption::Code:
-			TVMContractCompiler::proceedContract(&_contract, pragmaHelper);
+	switch (m_settings.tvmOption) {
+		case TvmOption::Code: {
+			TVMContractCompiler compiler{*this, fileName, outputToFile};
+			compiler.proceedContract(&_contract, pragmaHelper);
 			break;
-		case TvmOption::Abi:
-			TVMContractCompiler::generateABI(&_contract, *pragmaDirectives);
+		}
+		case TvmOption::Abi: {
+			TVMContractCompiler compiler{*this, fileName, outputToFile};
+			compiler.generateABI(&_contract, *pragmaDirectives);
 			break;
-		case TvmOption::DumpStorage:
-			TVMContractCompiler::proceedDumpStorage(&_contract, pragmaHelper);
+		}
+		case TvmOption::DumpStorage: {
+			TVMContractCompiler compiler{*this, fileName, outputToFile};
+			compiler.proceedDumpStorage(&_contract, pragmaHelper);
 			break;
-		case TvmOption::CodeAndAbi:
-			TVMContractCompiler::m_outputToFile = true;
-			TVMContractCompiler::proceedContract(&_contract, pragmaHelper);
-			TVMContractCompiler::generateABI(&_contract, *pragmaDirectives);
+		}
+		case TvmOption::CodeAndAbi: {
+			TVMContractCompiler compiler{*this, fileName, true};
+			compiler.proceedContract(&_contract, pragmaHelper);
+			compiler.generateABI(&_contract, *pragmaDirectives);
 			break;
+		}
 	}
 }
 
-void TVMCompilerEnable(const TvmOption tvmOption, bool without_logstr, bool optimize) {
-	TVMContractCompiler::m_optionsEnabled = true;
-	TVMContractCompiler::m_tvmOption = tvmOption;
-	TVMContractCompiler::g_without_logstr = without_logstr;
-	TVMContractCompiler::g_disable_optimizer = !optimize;
-}
+void TVMCompilerSession::writeArtifact(std::string const& what, std::string const& path, std::string const& content) {
+	if (m_settings.keepArtifactsInMemory || m_settings.recordArtifacts)
+		m_artifacts[path] = content;
+	if (m_settings.keepArtifactsInMemory)
+		return;
 
-void TVMSetAllContracts(const std::vector<ContractDefinition const*>& allContracts, const std::string& mainContract) {
-	TVMContractCompiler::m_allContracts = allContracts;
-	TVMContractCompiler::m_mainContractName = mainContract;
+	ensurePathExists();
+	std::ofstream ofile(path);
+	if (!ofile)
+		fatal_error("Failed to open the output file: " + path);
+	ofile << content;
+	ofile.close();
+	if (ofile.fail())
+		fatal_error("Failed to write the output file: " + path);
+	out() << what << " was generated and saved to file " << path << std::endl;
 }
 
-void TVMSetFileName(std::string _fileName) {
-	TVMContractCompiler::m_fileName = boost::filesystem::path(_fileName).stem().string();
+void TVMCompilerSession::writeArtifact(std::string const& what, std::string const& path,
+									   std::function<void(std::ostream&)> const& write) {
+	if (m_settings.keepArtifactsInMemory || m_settings.recordArtifacts) {
+		std::ostringstream content;
+		write(content);
+		writeArtifact(what, path, content.str());
+		return;
+	}
+
+	ensurePathExists();
+	std::vector<char> buffer(OutputBufferSize);
+	std::ofstream ofile;
+	ofile.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+	ofile.open(path);
+	if (!ofile)
+		fatal_error("Failed to open the output file: " + path);
+	write(ofile);
+	ofile.close();
+	if (ofile.fail())
+		fatal_error("Failed to write the output file: " + path);
+	out() << what << " was generated and saved to file " << path << std::endl;
 }
 
-bool TVMIsOutputProduced() {
-	return TVMContractCompiler::m_outputProduced;
+void TVMCompilerSession::ensurePathExists() const {
+	if (m_settings.outputFolder.empty())
+		return;
+
+	namespace fs = boost::filesystem;
+	// create directory if not existent
+	fs::path p(m_settings.outputFolder);
+	// Do not try creating the directory if the first item is . or ..
+	if (p.filename() != "." && p.filename() != "..")
+		fs::create_directories(p);
 }
@@ -18,6 +18,10 @@
 
 #pragma once
 
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
 #include <vector>
 #include <liblangutil/ErrorReporter.h>
 #include <libsolidity/ast/ASTForward.h>
@@ -29,11 +33,108 @@ enum class TvmOption {
 	CodeAndAbi
 };
 
-void TVMSetFileName(std::string _fileName);
-void TVMCompilerEnable(const TvmOption tvmOption, bool without_logstr, bool optimize);
-void TVMSetAllContracts(const std::vector<solidity::frontend::ContractDefinition const*>& allContracts,
-						const std::string& mainContract);
-bool TVMIsOutputProduced();
-void TVMCompilerProceedContract(solidity::langutil::ErrorReporter* errorReporter,
-								solidity::frontend::ContractDefinition const& _contract,
-                                std::vector<solidity::frontend::PragmaDirective const *> const* pragmaDirectives);
\ No newline at end of file
+// What automatic inlining of internal functions optimizes, see TVMSettings::autoInline
+enum class TvmAutoInline {
+	None,
+	Size,
+	Gas
+};
+
+namespace solidity::util {
+class PassTimer;
+}
+
+namespace solidity::frontend {
+
+struct TVMSettings {
+	TvmOption tvmOption = TvmOption::CodeAndAbi;
+	bool withoutLogstr = false;
+	bool optimize = false;
+	// Number of threads for function codegen, 0 means one thread per CPU core
+	unsigned jobs = 1;
+	// If not empty, artifacts of all deployable contracts are written to this folder
+	std::string outputFolder;
+	// If true, artifacts are not written to disk but only kept in TVMCompilerSession::artifacts()
+	bool keepArtifactsInMemory = false;
+	// If true, artifacts written to disk are kept in TVMCompilerSession::artifacts() too (e.g. for the cache).
+	// Otherwise code is streamed to the file without making a copy of it in memory.
+	bool recordArtifacts = true;
+	// If true, gas estimation of the generated functions is written along with the code (<contract>.gas.json)
+	bool gasReport = false;
+	// If true, c4_to_c7 doesn't decode state variables, each of them is decoded from c4 on its first access.
+	// c7_to_c4 then builds again only the cells of c4 with accessed variables and keeps the other ones
+	bool lazyStateLoad = false;
+	// If true, state variables are placed in the c4 cell tree by number of accesses:
+	// the most used ones get into the root cell and the rarely used ones into the deepest cells
+	bool hotColdLayout = false;
+	// Number of accesses of state variables by name, used by hotColdLayout instead of the static count
+	std::map<std::string, double> layoutProfile;
+	// If true, fields of structs and state variables are reordered in cells to use fewer cells and references
+	// (the order of struct members in ABI and tuples is kept). It doesn't change c4 if hotColdLayout is set.
+	bool packCells = false;
+	// Internal functions which aren't marked as inline are inlined if it makes the code smaller (Size)
+	// or if their code fits into one cell and inlining all calls adds one cell of code at most (Gas)
+	TvmAutoInline autoInline = TvmAutoInline::None;
+	// If true, repeated instruction sequences are moved to macros, see TVMOutliner. It makes the code smaller
+	// and calls more expensive in gas.
+	bool outline = false;
+	// If not empty, the contract is also assembled with this stdlib (lib/stdlib_sol.tvm) into the StateInit
+	// <contract>.boc by the experimental TVMAssembler. It isn't a .tvc, its layout differs from the one of tvm_linker.
+	std::string bocStdlib;
+};
+
+// State of the TVM backend for one compilation. Each CompilerStack owns its session,
+// so the backend keeps no state between compilations. The front end types are still
+// process-global, so only one CompilerStack may exist at a time.
+class TVMCompilerSession {
+public:
+	void enable(TVMSettings const& settings);
+	bool isEnabled() const { return m_enabled; }
+	TVMSettings const& settings() const { return m_settings; }
+
+	// Text printed by the backend (e.g. code or ABI if no file is written) goes to out
+	void setOutputStream(std::ostream* out) { m_out = out; }
+	std::ostream& out() const { return *m_out; }
+
+	void setFileName(std::string const& sourceName);
+	void setAllContracts(std::vector<ContractDefinition const*> const& allContracts, std::string const& mainContract);
+	std::vector<ContractDefinition const*> const& allContracts() const { return m_allContracts; }
+
+	// Clears results of the previous compilation, settings are kept
+	void reset();
+
+	void proceedContract(langutil::ErrorReporter* errorReporter,
+						 ContractDefinition const& _contract,
+						 std::vector<PragmaDirective const *> const* pragmaDirectives);
+
+	// Stores an artifact (e.g. "Wallet.code") and writes it to disk unless it should be kept in memory.
+	// what is the kind of the artifact for the user message, e.g. "Code" or "ABI".
+	void writeArtifact(std::string const& what, std::string const& path, std::string const& content);
+	// The same, but the content is written by write directly to the file (with buffering), if it isn't recorded
+	void writeArtifact(std::string const& what, std::string const& path, std::function<void(std::ostream&)> const& write);
+	// All artifacts written by the last compilation, path -> content
+	std::map<std::string, std::string> const& artifacts() const { return m_artifacts; }
+
+	void setOutputProduced() { m_outputProduced = true; }
+	bool isOutputProduced() const { return m_outputProduced; }
+
+	// Backend passes are timed if the timer is not null, see --time-passes
+	void setPassTimer(util::PassTimer* timer) { m_passTimer = timer; }
+	util::PassTimer* passTimer() const { return m_passTimer; }
+
+private:
+	std::string getLastContractName() const;
+	void ensurePathExists() const;
+
+	bool m_enabled = false;
+	TVMSettings m_settings;
+	std::ostream* m_out = &std::cout;
+	std::vector<ContractDefinition const*> m_allContracts;
+	std::string m_mainContractName;
+	std::string m_fileName;
+	bool m_outputProduced = false;
+	std::map<std::string, std::string> m_artifacts;
+	util::PassTimer* m_passTimer = nullptr;
+};
+
+}	// end solidity::frontend
@@ -12,9 +12,9 @@ TVMAnalyzer::TVMAnalyzer(ErrorReporter &_errorReporter, bool _structWarning):
 {
 }
 
-bool TVMAnalyzer::analyze(const SourceUnit &_sourceUnit)
+bool TVMAnalyzer::analyze(const ASTNode &_astRoot)
 {
-	_sourceUnit.accept(*this);
+	_astRoot.accept(*this);
 	return Error::containsOnlyWarnings(m_errorReporter.errors());
 }
 
@@ -36,9 +36,9 @@ public:
 	/// @param _structWarning provides the flag whether struct warning is needed.
 	explicit TVMAnalyzer(langutil::ErrorReporter& _errorReporter, bool _structWarning = false);
 
-	/// Performs analysis on the given source unit and all of its sub-nodes.
+	/// Performs analysis on the given source unit or contract and all of its sub-nodes.
 	/// @returns true if all checks passed. Note even if all checks passed, errors() can still contain warnings
-	bool analyze(SourceUnit const& _sourceUnit);
+	bool analyze(ASTNode const& _astRoot);
 
 private:
 
@@ -0,0 +1,887 @@
+/*
+ * Copyright 2018-2020 TON DEV SOLUTIONS LTD.
+ *
+ * Licensed under the  terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the  GNU General Public License for more details at: https://www.gnu.org/licenses/gpl-3.0.html
+ */
+/**
+ * @author TON Labs <connect@tonlabs.io>
+ * @date 2020
+ * Assembler of the generated code into TVM cells
+ */
+
+#include "TVMAssembler.hpp"
+#include "TVMConstants.hpp"
+
+using namespace solidity::frontend;
+
+namespace {
+
+const int FunctionIdLength = 32;
+// The longest edge label of a leaf of the function dictionary: hml_long$10, 6 bits of length and the key
+const int MaxLabelBits = 2 + 6 + FunctionIdLength;
+// CALLDICT takes an id of up to 14 bits
+const int64_t MaxCallId = (1 << 14) - 1;
+
+struct FixedEncoding {
+	uint32_t code;
+	int bits;
+};
+
+// Encodings of instructions without operands, see TVMOpcodes.hpp
+std::map<Opcode, FixedEncoding> const& fixedEncodings() {
+	static std::map<Opcode, FixedEncoding> const encodings{
+		{Opcode::NOP, {0x00, 8}}, {Opcode::SWAP, {0x01, 8}}, {Opcode::DUP, {0x20, 8}}, {Opcode::OVER, {0x21, 8}},
+		{Opcode::DROP, {0x30, 8}}, {Opcode::NIP, {0x31, 8}}, {Opcode::ROT, {0x58, 8}}, {Opcode::ROTREV, {0x59, 8}},
+		{Opcode::SWAP2, {0x5A, 8}}, {Opcode::DROP2, {0x5B, 8}}, {Opcode::DUP2, {0x5C, 8}}, {Opcode::OVER2, {0x5D, 8}},
+		{Opcode::PICK, {0x60, 8}}, {Opcode::PUSHX, {0x60, 8}}, {Opcode::ROLL, {0x61, 8}}, {Opcode::ROLLX, {0x61, 8}},
+		{Opcode::ROLLREV, {0x62, 8}}, {Opcode::BLKSWX, {0x63, 8}}, {Opcode::REVX, {0x64, 8}},
+		{Opcode::DROPX, {0x65, 8}}, {Opcode::TUCK, {0x66, 8}}, {Opcode::XCHGX, {0x67, 8}},
+		{Opcode::DEPTH, {0x68, 8}}, {Opcode::CHKDEPTH, {0x69, 8}}, {Opcode::ONLYTOPX, {0x6A, 8}},
+		{Opcode::ONLYX, {0x6B, 8}},
+
+		{Opcode::NULL_, {0x6D, 8}}, {Opcode::PUSHNULL, {0x6D, 8}}, {Opcode::ISNULL, {0x6E, 8}},
+		{Opcode::NIL, {0x6F00, 16}}, {Opcode::SINGLE, {0x6F01, 16}}, {Opcode::PAIR, {0x6F02, 16}},
+		{Opcode::TRIPLE, {0x6F03, 16}}, {Opcode::FIRST, {0x6F10, 16}}, {Opcode::SECOND, {0x6F11, 16}},
+		{Opcode::THIRD, {0x6F12, 16}}, {Opcode::UNPAIR, {0x6F22, 16}}, {Opcode::UNTRIPLE, {0x6F23, 16}},
+		{Opcode::TUPLEVAR, {0x6F80, 16}}, {Opcode::INDEXVAR, {0x6F81, 16}}, {Opcode::UNTUPLEVAR, {0x6F82, 16}},
+		{Opcode::SETINDEXVAR, {0x6F85, 16}}, {Opcode::TLEN, {0x6F88, 16}}, {Opcode::ISTUPLE, {0x6F8A, 16}},
+		{Opcode::LAST, {0x6F8B, 16}}, {Opcode::TPUSH, {0x6F8C, 16}}, {Opcode::TPOP, {0x6F8D, 16}},
+
+		{Opcode::ZERO, {0x70, 8}}, {Opcode::FALSE_, {0x70, 8}}, {Opcode::TRUE_, {0x7F, 8}},
+		{Opcode::PUSHNAN, {0x83FF, 16}},
+
+		{Opcode::ADD, {0xA0, 8}}, {Opcode::SUB, {0xA1, 8}}, {Opcode::SUBR, {0xA2, 8}}, {Opcode::NEGATE, {0xA3, 8}},
+		{Opcode::INC, {0xA4, 8}}, {Opcode::DEC, {0xA5, 8}}, {Opcode::MUL, {0xA8, 8}}, {Opcode::DIV, {0xA904, 16}},
+		{Opcode::DIVR, {0xA905, 16}}, {Opcode::DIVC, {0xA906, 16}}, {Opcode::MOD, {0xA908, 16}},
+		{Opcode::DIVMOD, {0xA90C, 16}}, {Opcode::MULDIV, {0xA984, 16}}, {Opcode::MULDIVR, {0xA985, 16}},
+		{Opcode::MULDIVMOD, {0xA98C, 16}}, {Opcode::LSHIFT, {0xAC, 8}}, {Opcode::RSHIFT, {0xAD, 8}},
+		{Opcode::POW2, {0xAE, 8}}, {Opcode::AND, {0xB0, 8}}, {Opcode::OR, {0xB1, 8}}, {Opcode::XOR, {0xB2, 8}},
+		{Opcode::NOT, {0xB3, 8}}, {Opcode::FITSX, {0xB600, 16}}, {Opcode::UFITSX, {0xB601, 16}},
+		{Opcode::BITSIZE, {0xB602, 16}}, {Opcode::UBITSIZE, {0xB603, 16}}, {Opcode::MIN_, {0xB608, 16}},
+		{Opcode::MAX_, {0xB609, 16}}, {Opcode::MINMAX, {0xB60A, 16}}, {Opcode::ABS, {0xB60B, 16}},
+
+		{Opcode::SGN, {0xB8, 8}}, {Opcode::LESS, {0xB9, 8}}, {Opcode::EQUAL, {0xBA, 8}}, {Opcode::LEQ, {0xBB, 8}},
+		{Opcode::GREATER, {0xBC, 8}}, {Opcode::NEQ, {0xBD, 8}}, {Opcode::GEQ, {0xBE, 8}}, {Opcode::CMP, {0xBF, 8}},
+		{Opcode::ISZERO, {0xC000, 16}}, {Opcode::ISNEG, {0xC100, 16}}, {Opcode::ISNPOS, {0xC101, 16}},
+		{Opcode::ISPOS, {0xC200, 16}}, {Opcode::ISNNEG, {0xC2FF, 16}}, {Opcode::ISNAN, {0xC4, 8}},
+		{Opcode::CHKNAN, {0xC5, 8}}, {Opcode::SEMPTY, {0xC700, 16}}, {Opcode::SDEMPTY, {0xC701, 16}},
+		{Opcode::SREMPTY, {0xC702, 16}}, {Opcode::SDLEXCMP, {0xC704, 16}}, {Opcode::SDEQ, {0xC705, 16}},
+
+		{Opcode::NEWC, {0xC8, 8}}, {Opcode::ENDC, {0xC9, 8}}, {Opcode::STREF, {0xCC, 8}},
+		{Opcode::STBREFR, {0xCD, 8}}, {Opcode::STSLICE, {0xCE, 8}}, {Opcode::STIX, {0xCF00, 16}},
+		{Opcode::STUX, {0xCF01, 16}}, {Opcode::STBREF, {0xCF11, 16}}, {Opcode::STB, {0xCF13, 16}},
+		{Opcode::STREFR, {0xCF14, 16}}, {Opcode::STSLICER, {0xCF16, 16}}, {Opcode::STBR, {0xCF17, 16}},
+		{Opcode::ENDXC, {0xCF23, 16}}, {Opcode::BBITS, {0xCF31, 16}}, {Opcode::BREFS, {0xCF32, 16}},
+		{Opcode::BBITREFS, {0xCF33, 16}}, {Opcode::BREMBITS, {0xCF35, 16}}, {Opcode::BREMREFS, {0xCF36, 16}},
+		{Opcode::BREMBITREFS, {0xCF37, 16}}, {Opcode::STZEROES, {0xCF40, 16}}, {Opcode::STONES, {0xCF41, 16}},
+		{Opcode::STGRAMS, {0xFA02, 16}}, {Opcode::STVARUINT32, {0xFA06, 16}}, {Opcode::STDICT, {0xF400, 16}},
+
+		{Opcode::CTOS, {0xD0, 8}}, {Opcode::ENDS, {0xD1, 8}}, {Opcode::LDREF, {0xD4, 8}},
+		{Opcode::LDREFRTOS, {0xD5, 8}}, {Opcode::PLDIX, {0xD702, 16}}, {Opcode::PLDUX, {0xD703, 16}},
+		{Opcode::LDSLICEX, {0xD718, 16}}, {Opcode::PLDSLICEX, {0xD719, 16}}, {Opcode::SDCUTFIRST, {0xD720, 16}},
+		{Opcode::SDSKIPFIRST, {0xD721, 16}}, {Opcode::SDSUBSTR, {0xD724, 16}}, {Opcode::SSKIPFIRST, {0xD731, 16}},
+		{Opcode::SPLIT, {0xD736, 16}}, {Opcode::PLDREFVAR, {0xD748, 16}}, {Opcode::SBITS, {0xD749, 16}},
+		{Opcode::SREFS, {0xD74A, 16}}, {Opcode::SBITREFS, {0xD74B, 16}}, {Opcode::PLDREF, {0xD74C, 16}},
+		{Opcode::CDATASIZE, {0xF941, 16}}, {Opcode::LDGRAMS, {0xFA00, 16}}, {Opcode::LDVARUINT32, {0xFA04, 16}},
+		{Opcode::LDMSGADDR, {0xFA40, 16}}, {Opcode::LDMSGADDRQ, {0xFA41, 16}},
+		{Opcode::PARSEMSGADDR, {0xFA42, 16}}, {Opcode::REWRITESTDADDR, {0xFA44, 16}},
+		{Opcode::SKIPDICT, {0xF401, 16}}, {Opcode::LDDICTS, {0xF402, 16}}, {Opcode::LDDICT, {0xF404, 16}},
+		{Opcode::PLDDICT, {0xF405, 16}}, {Opcode::LDDICTQ, {0xF406, 16}},
+
+		{Opcode::EXECUTE, {0xD8, 8}}, {Opcode::CALLX, {0xD8, 8}}, {Opcode::JMPX, {0xD9, 8}},
+		{Opcode::RET, {0xDB30, 16}}, {Opcode::RETALT, {0xDB31, 16}}, {Opcode::IFRET, {0xDC, 8}},
+		{Opcode::IFNOTRET, {0xDD, 8}}, {Opcode::IF, {0xDE, 8}}, {Opcode::IFNOT, {0xDF, 8}},
+		{Opcode::IFJMP, {0xE0, 8}}, {Opcode::IFNOTJMP, {0xE1, 8}}, {Opcode::IFELSE, {0xE2, 8}},
+		{Opcode::CONDSEL, {0xE304, 16}}, {Opcode::REPEAT, {0xE4, 8}}, {Opcode::UNTIL, {0xE6, 8}},
+		{Opcode::WHILE, {0xE8, 8}}, {Opcode::AGAIN, {0xEA, 8}}, {Opcode::PUSHROOT, {0xED44, 16}},
+		{Opcode::POPROOT, {0xED54, 16}}, {Opcode::BLESS, {0xED1E, 16}},
+
+		{Opcode::THROWANY, {0xF2F0, 16}}, {Opcode::THROWARGANY, {0xF2F1, 16}}, {Opcode::THROWANYIF, {0xF2F2, 16}},
+		{Opcode::THROWANYIFNOT, {0xF2F4, 16}}, {Opcode::THROWARGANYIFNOT, {0xF2F5, 16}},
+		{Opcode::TRY, {0xF2FF, 16}},
+
+		{Opcode::NEWDICT, {0x6D, 8}}, {Opcode::DICTEMPTY, {0x6E, 8}},
+		{Opcode::DICTGET, {0xF40A, 16}}, {Opcode::DICTGETREF, {0xF40B, 16}}, {Opcode::DICTIGET, {0xF40C, 16}},
+		{Opcode::DICTIGETREF, {0xF40D, 16}}, {Opcode::DICTUGET, {0xF40E, 16}}, {Opcode::DICTUGETREF, {0xF40F, 16}},
+		{Opcode::DICTSET, {0xF412, 16}}, {Opcode::DICTSETREF, {0xF413, 16}}, {Opcode::DICTISET, {0xF414, 16}},
+		{Opcode::DICTISETREF, {0xF415, 16}}, {Opcode::DICTUSET, {0xF416, 16}}, {Opcode::DICTUSETREF, {0xF417, 16}},
+		{Opcode::DICTSETGET, {0xF41A, 16}}, {Opcode::DICTISETGET, {0xF41C, 16}},
+		{Opcode::DICTUSETGET, {0xF41E, 16}}, {Opcode::DICTREPLACE, {0xF422, 16}},
+		{Opcode::DICTIREPLACE, {0xF424, 16}}, {Opcode::DICTUREPLACE, {0xF426, 16}},
+		{Opcode::DICTREPLACEGET, {0xF42A, 16}}, {Opcode::DICTIREPLACEGET, {0xF42C, 16}},
+		{Opcode::DICTUREPLACEGET, {0xF42E, 16}}, {Opcode::DICTADD, {0xF432, 16}}, {Opcode::DICTIADD, {0xF434, 16}},
+		{Opcode::DICTUADD, {0xF436, 16}}, {Opcode::DICTADDGET, {0xF43A, 16}}, {Opcode::DICTIADDGET, {0xF43C, 16}},
+		{Opcode::DICTUADDGET, {0xF43E, 16}}, {Opcode::DICTSETB, {0xF441, 16}}, {Opcode::DICTISETB, {0xF442, 16}},
+		{Opcode::DICTUSETB, {0xF443, 16}}, {Opcode::DICTDEL, {0xF459, 16}}, {Opcode::DICTIDEL, {0xF45A, 16}},
+		{Opcode::DICTUDEL, {0xF45B, 16}}, {Opcode::DICTDELGET, {0xF462, 16}}, {Opcode::DICTIDELGET, {0xF464, 16}},
+		{Opcode::DICTUDELGET, {0xF466, 16}}, {Opcode::DICTGETNEXT, {0xF474, 16}},
+		{Opcode::DICTGETNEXTEQ, {0xF475, 16}}, {Opcode::DICTGETPREV, {0xF476, 16}},
+		{Opcode::DICTGETPREVEQ, {0xF477, 16}}, {Opcode::DICTIGETNEXT, {0xF478, 16}},
+		{Opcode::DICTIGETNEXTEQ, {0xF479, 16}}, {Opcode::DICTIGETPREV, {0xF47A, 16}},
+		{Opcode::DICTIGETPREVEQ, {0xF47B, 16}}, {Opcode::DICTUGETNEXT, {0xF47C, 16}},
+		{Opcode::DICTUGETNEXTEQ, {0xF47D, 16}}, {Opcode::DICTUGETPREV, {0xF47E, 16}},
+		{Opcode::DICTUGETPREVEQ, {0xF47F, 16}}, {Opcode::DICTMIN, {0xF482, 16}}, {Opcode::DICTIMIN, {0xF484, 16}},
+		{Opcode::DICTUMIN, {0xF486, 16}}, {Opcode::DICTMAX, {0xF48A, 16}}, {Opcode::DICTIMAX, {0xF48C, 16}},
+		{Opcode::DICTUMAX, {0xF48E, 16}}, {Opcode::DICTIGETJMP, {0xF4A0, 16}}, {Opcode::DICTUGETJMP, {0xF4A1, 16}},
+		{Opcode::DICTIGETEXEC, {0xF4A2, 16}}, {Opcode::DICTUGETEXEC, {0xF4A3, 16}},
+
+		{Opcode::ACCEPT, {0xF800, 16}}, {Opcode::SETGASLIMIT, {0xF801, 16}}, {Opcode::COMMIT, {0xF80F, 16}},
+		{Opcode::RANDU256, {0xF810, 16}}, {Opcode::RAND, {0xF811, 16}}, {Opcode::SETRAND, {0xF814, 16}},
+		{Opcode::ADDRAND, {0xF815, 16}}, {Opcode::NOW, {0xF823, 16}}, {Opcode::BLOCKLT, {0xF824, 16}},
+		{Opcode::LTIME, {0xF825, 16}}, {Opcode::BALANCE, {0xF827, 16}}, {Opcode::MYADDR, {0xF828, 16}},
+		{Opcode::CONFIGROOT, {0xF829, 16}}, {Opcode::CONFIGPARAM, {0xF832, 16}},
+		{Opcode::GETGLOBVAR, {0xF840, 16}}, {Opcode::SETGLOBVAR, {0xF860, 16}}, {Opcode::HASHCU, {0xF900, 16}},
+		{Opcode::HASHSU, {0xF901, 16}}, {Opcode::SHA256U, {0xF902, 16}}, {Opcode::CHKSIGNU, {0xF910, 16}},
+		{Opcode::CHKSIGNS, {0xF911, 16}}, {Opcode::SENDRAWMSG, {0xFB00, 16}}, {Opcode::RAWRESERVE, {0xFB02, 16}},
+		{Opcode::SETCODE, {0xFB04, 16}},
+
+		{Opcode::DUMPSTK, {0xFE00, 16}}, {Opcode::STRDUMP, {0xFE14, 16}},
+	};
+	return encodings;
+}
+
+[[noreturn]]
+void assemblyError(Instruction const& line, std::string const& message) {
+	fatal_error("Failed to assemble \"" + line.text() + "\": " + message);
+}
+
+
+// decimal or hexadecimal (0x...) integer
+bigint parseInteger(Instruction const& line, std::string const& text) {
+	size_t i = 0;
+	const bool negative = !text.empty() && text[0] == '-';
+	if (negative) {
+		++i;
+	}
+	unsigned base = 10;
+	if (text.compare(i, 2, "0x") == 0 || text.compare(i, 2, "0X") == 0) {
+		base = 16;
+		i += 2;
+	}
+	if (i == text.size()) {
+		assemblyError(line, "expected an integer");
+	}
+	bigint value = 0;
+	for (; i < text.size(); ++i) {
+		const char ch = text[i];
+		if (base == 10 ? !isdigit(ch) : !isxdigit(ch)) {
+			assemblyError(line, "expected an integer");
+		}
+		value = value * base + (isdigit(ch) ? ch - '0' : tolower(ch) - 'a' + 10);
+	}
+	return negative ? -value : value;
+}
+
+int parseInteger(Instruction const& line, std::string const& text, int min, int max) {
+	bigint value = parseInteger(line, text);
+	if (value < min || value > max) {
+		assemblyError(line, "operand " + text + " is out of range " + toString(min) + ".." + toString(max));
+	}
+	return static_cast<int>(value);
+}
+
+// s(i) or c(i)
+int parseRegister(Instruction const& line, std::string const& text, char prefix, int max) {
+	if (text.size() < 2 || tolower(text[0]) != prefix) {
+		assemblyError(line, std::string{"expected a register "} + prefix + "(i)");
+	}
+	return parseInteger(line, text.substr(1), 0, max);
+}
+
+bool isControlRegister(std::string const& text) {
+	return !text.empty() && tolower(text[0]) == 'c';
+}
+
+// x{hex}, xhex, b{binary} or binary digits. Trailing '_' is the completion tag: the last one and the zeros after it
+// are removed.
+std::vector<bool> parseSlice(Instruction const& line, std::string text) {
+	std::vector<bool> bits;
+	bool hex = false;
+	if (!text.empty() && (text[0] == 'x' || text[0] == 'b')) {
+		hex = text[0] == 'x';
+		text = text.substr(1);
+		if (!text.empty() && text.front() == '{' && text.back() == '}') {
+			text = text.substr(1, text.size() - 2);
+		}
+	}
+	bool completionTag = !text.empty() && text.back() == '_';
+	if (completionTag) {
+		text.pop_back();
+	}
+	for (char ch : text) {
+		if (hex && isxdigit(ch)) {
+			const int digit = isdigit(ch) ? ch - '0' : tolower(ch) - 'a' + 10;
+			for (int k = 3; k >= 0; --k) {
+				bits.push_back(((digit >> k) & 1) != 0);
+			}
+		} else if (!hex && (ch == '0' || ch == '1')) {
+			bits.push_back(ch == '1');
+		} else {
+			assemblyError(line, "invalid slice");
+		}
+	}
+	if (completionTag) {
+		while (!bits.empty() && !bits.back()) {
+			bits.pop_back();
+		}
+		if (bits.empty()) {
+			assemblyError(line, "invalid completion tag");
+		}
+		bits.pop_back();
+	}
+	return bits;
+}
+
+// stores the bits with the completion tag, which fills `length` bits
+void storeWithCompletionTag(CellBuilder& builder, std::vector<bool> const& bits, int length) {
+	builder.storeBits(bits);
+	builder.storeBit(true);
+	for (int i = static_cast<int>(bits.size()) + 1; i < length; ++i) {
+		builder.storeBit(false);
+	}
+}
+
+// number of units of `unit` bits, which make at least `bits` bits together with `extra` bits
+int unitsFor(int bits, int extra, int unit) {
+	return std::max(0, (bits - extra + unit - 1) / unit);
+}
+
+bool fitsSigned(bigint const& value, int bits) {
+	bigint const limit = bigint(1) << (bits - 1);
+	return -limit <= value && value < limit;
+}
+
+void encodePushSlice(Instruction const& line, CellBuilder& builder, std::vector<bool> const& bits) {
+	const int length = static_cast<int>(bits.size()) + 1;
+	if (length <= 8 * 15 + 4) {
+		// 8Bxsss, 8x + 4 bits of data
+		const int x = unitsFor(length, 4, 8);
+		builder.storeUInt(0x8B, 8);
+		builder.storeUInt(static_cast<uint64_t>(x), 4);
+		storeWithCompletionTag(builder, bits, 8 * x + 4);
+	} else if (length <= 8 * 127 + 6) {
+		// 8Drxxsssss, no references and 8xx + 6 bits of data
+		const int xx = unitsFor(length, 6, 8);
+		builder.storeUInt(0x8D, 8);
+		builder.storeUInt(0, 3);
+		builder.storeUInt(static_cast<uint64_t>(xx), 7);
+		storeWithCompletionTag(builder, bits, 8 * xx + 6);
+	} else {
+		assemblyError(line, "slice is too long");
+	}
+}
+
+}
+
+TVMAssembler::TVMAssembler(CodeLines const& code, CodeLines const& stdlib,
+						   std::map<std::string, uint32_t> publicFunctionIds) :
+	m_publicFunctionIds{std::move(publicFunctionIds)}
+{
+	// functions of the contract take precedence over the functions of the stdlib with the same name
+	readSections(code);
+	readSections(stdlib);
+	if (!m_selector) {
+		fatal_error("Failed to assemble the contract: stdlib has no .selector");
+	}
+	assignIds();
+}
+
+void TVMAssembler::readSections(CodeLines const& code) {
+	auto function = [&](std::string const& name) -> Function& {
+		auto [it, inserted] = m_functionIndex.emplace(name, m_functions.size());
+		if (inserted) {
+			m_functions.emplace_back();
+			m_functions.back().name = name;
+		}
+		return m_functions[it->second];
+	};
+
+	Function* current = nullptr;
+	for (size_t i = 0; i < code.lines.size(); ++i) {
+		Instruction const& line = code.lines[i];
+		if (line.depth == 0 && line.isDirective()) {
+			const std::string name = line.operands.empty() ? "" : line.operands[0].name();
+			if (line.name == ".selector") {
+				m_selector = Function{};
+				m_selector->name = "selector";
+				current = &*m_selector;
+			} else if (line.name == ".macro" || line.name == ".globl" || line.name == ".internal") {
+				current = &function(name);
+				if (current->code && current->code != &code) {
+					current = nullptr;
+				}
+			} else if (line.name == ".public") {
+				if (current) {
+					current->isPublic = true;
+				}
+			} else if (line.name == ".internal-alias") {
+				Function& alias = function(name);
+				if (!alias.id) {
+					alias.id = static_cast<int64_t>(parseInteger(line, line.operands.size() > 1 ? line.operands[1].text : ""));
+				}
+				current = nullptr;
+			} else if (line.name != ".type") {
+				assemblyError(line, "unsupported directive");
+			}
+			if (current) {
+				current->code = &code;
+				current->begin = current->end = i + 1;
+			}
+			continue;
+		}
+		if (!current || line.isCommentOrEmpty()) {
+			continue;
+		}
+		current->end = i + 1;
+		for (Operand const& operand : line.operands) {
+			if (operand.kind == Operand::Kind::Function) {
+				current->callees.insert(operand.name());
+			}
+		}
+	}
+}
+
+void TVMAssembler::assignIds() {
+	std::set<int64_t> usedIds;
+	std::vector<Function*> queue;
+	for (Function& function : m_functions) {
+		if (function.isPublic) {
+			auto it = m_publicFunctionIds.find(function.name);
+			if (it == m_publicFunctionIds.end()) {
+				fatal_error("Failed to assemble the contract: unknown id of public function \"" + function.name + "\"");
+			}
+			function.id = it->second;
+		}
+		if (function.id) {
+			if (!usedIds.insert(*function.id).second) {
+				fatal_error("Failed to assemble the contract: functions have the same id " + toString(*function.id));
+			}
+			queue.push_back(&function);
+		}
+	}
+
+	std::set<std::string> reachable;
+	for (Function const* function : queue) {
+		reachable.insert(function->name);
+	}
+	while (!queue.empty()) {
+		Function const* function = queue.back();
+		queue.pop_back();
+		for (std::string const& name : function->callees) {
+			auto it = m_functionIndex.find(name);
+			if (it == m_functionIndex.end() || !m_functions[it->second].code) {
+				fatal_error("Failed to assemble the contract: function \"" + name + "\" is not found");
+			}
+			if (reachable.insert(name).second) {
+				queue.push_back(&m_functions[it->second]);
+			}
+		}
+	}
+
+	int64_t nextId = TvmConst::FunctionId::First;
+	for (Function& function : m_functions) {
+		if (function.id || !reachable.count(function.name)) {
+			continue;
+		}
+		while (usedIds.count(nextId)) {
+			++nextId;
+		}
+		if (nextId > MaxCallId) {
+			fatal_error("Failed to assemble the contract: too many functions");
+		}
+		function.id = nextId;
+		usedIds.insert(nextId);
+	}
+}
+
+Cell::Ptr TVMAssembler::assembleFragment(CodeLines const& code) {
+	TVMAssembler assembler;
+	Function fragment;
+	fragment.name = "fragment";
+	fragment.code = &code;
+	fragment.end = code.lines.size();
+	size_t i = 0;
+	std::vector<CellBuilder> chunks = assembler.encodeBlock(fragment, i);
+	if (i != fragment.end) {
+		assemblyError(code.lines[i], "unexpected '}'");
+	}
+	return pack(chunks, Cell::MaxBits).build();
+}
+
+bytes TVMAssembler::stateInit() {
+	// persistent data before the deployment: a dictionary with the public key by key 0, see c4_to_c7_with_init_storage
+	std::map<std::vector<bool>, CellBuilder> persistentData;
+	persistentData[std::vector<bool>(TvmConst::C4::KeyLength, false)].storeBits(std::vector<bool>(256, false));
+	CellBuilder data;
+	data.storeBit(true);
+	data.storeRef(buildDictionary(persistentData, TvmConst::C4::KeyLength));
+
+	// _ split_depth:(Maybe (## 5)) special:(Maybe TickTock) code:(Maybe ^Cell) data:(Maybe ^Cell)
+	//   library:(HashmapE 256 SimpleLib) = StateInit;
+	CellBuilder init;
+	init.storeBit(false);
+	init.storeBit(false);
+	init.storeBit(true);
+	init.storeRef(codeCell());
+	init.storeBit(true);
+	init.storeRef(data.build());
+	init.storeBit(false);
+	return serializeBagOfCells(init.build());
+}
+
+Cell::Ptr TVMAssembler::codeCell() {
+	m_dictionary = functionDictionary();
+
+	CellBuilder dispatcher;
+	// DICTPUSHCONST 32, DICTUGETJMP, THROW n: DICTUGETJMP goes on if there is no function with the id
+	dispatcher.storeUInt(0b11110100101001, 14);
+	dispatcher.storeUInt(FunctionIdLength, 10);
+	dispatcher.storeRef(m_dictionary);
+	dispatcher.storeUInt(0xF4A1, 16);
+	static_assert(TvmConst::Message::Exception::WrongFunctionId <= 63, "THROW n has a 6-bit form for n < 64");
+	dispatcher.storeUInt(0xF200 | TvmConst::Message::Exception::WrongFunctionId, 16);
+	m_dispatcher = dispatcher.build();
+
+	size_t i = m_selector->begin;
+	std::vector<CellBuilder> chunks = encodeBlock(*m_selector, i);
+	if (i != m_selector->end) {
+		assemblyError(m_selector->code->lines[i], "unexpected '}'");
+	}
+	return pack(chunks, Cell::MaxBits).build();
+}
+
+Cell::Ptr TVMAssembler::functionDictionary() {
+	std::map<std::vector<bool>, CellBuilder> functions;
+	for (Function const& function : m_functions) {
+		if (!function.id) {
+			continue;
+		}
+		CellBuilder body;
+		if (function.code) {
+			size_t i = function.begin;
+			std::vector<CellBuilder> chunks = encodeBlock(function, i);
+			if (i != function.end) {
+				assemblyError(function.code->lines[i], "unexpected '}'");
+			}
+			body = pack(chunks, Cell::MaxBits - MaxLabelBits);
+		} else {
+			// alias without code, e.g. general_purpose: jump to the function with the id on the stack
+			// PUSHCTR c3, JMPX
+			body.storeUInt(0xED43, 16);
+			body.storeUInt(0xD9, 8);
+		}
+		CellBuilder key;
+		key.storeUInt(static_cast<uint32_t>(*function.id), FunctionIdLength);
+		functions[key.data()] = body;
+	}
+	return buildDictionary(functions, FunctionIdLength);
+}
+
+std::vector<CellBuilder> TVMAssembler::encodeBlock(Function const& function, size_t& i) {
+	std::vector<CellBuilder> chunks;
+	for (; i < function.end; ++i) {
+		Instruction const& line = function.code->lines[i];
+		if (line.isCommentOrEmpty()) {
+			continue;
+		}
+		if (line.opcode == Opcode::CONT_END) {
+			break;
+		}
+		chunks.push_back(encode(function, line, i));
+	}
+	return chunks;
+}
+
+CellBuilder TVMAssembler::pack(std::vector<CellBuilder> const& chunks, int maxBits) {
+	// bits and references of chunks[i..]
+	std::vector<int> restBits(chunks.size() + 1);
+	std::vector<int> restRefs(chunks.size() + 1);
+	for (size_t i = chunks.size(); i-- > 0; ) {
+		restBits[i] = restBits[i + 1] + chunks[i].bits();
+		restRefs[i] = restRefs[i + 1] + chunks[i].refs();
+	}
+
+	CellBuilder cell;
+	for (size_t i = 0; i < chunks.size(); ++i) {
+		if (cell.bits() + restBits[i] <= maxBits && cell.refs() + restRefs[i] <= Cell::MaxRefs) {
+			for (; i < chunks.size(); ++i) {
+				cell.append(chunks[i]);
+			}
+			break;
+		}
+		// one reference is left for the rest of the code
+		if (cell.bits() + chunks[i].bits() <= maxBits && cell.refs() + chunks[i].refs() < Cell::MaxRefs) {
+			cell.append(chunks[i]);
+			continue;
+		}
+		solAssert(cell.bits() > 0 || cell.refs() > 0 || maxBits < Cell::MaxBits, "Instruction doesn't fit into a cell");
+		std::vector<CellBuilder> rest(chunks.begin() + static_cast<std::ptrdiff_t>(i), chunks.end());
+		cell.storeRef(pack(rest, Cell::MaxBits).build());
+		break;
+	}
+	return cell;
+}
+
+CellBuilder TVMAssembler::encode(Function const& function, Instruction const& line, size_t& i) {
+	CellBuilder builder;
+	std::vector<std::string> operands;
+	for (Operand const& operand : line.operands) {
+		// "$name$" is the id of the function
+		operands.push_back(operand.kind == Operand::Kind::Function ?
+			toString(*m_functions.at(m_functionIndex.at(operand.name())).id) : operand.str());
+	}
+	auto expectOperands = [&](size_t count) {
+		if (operands.size() != count) {
+			assemblyError(line, "expected " + toString(count) + " operand(s)");
+		}
+	};
+	auto arg = [&](size_t index, int min, int max) {
+		return parseInteger(line, operands.at(index), min, max);
+	};
+	auto stackArg = [&](size_t index, int max) {
+		return parseRegister(line, operands.at(index), 's', max);
+	};
+	auto store = [&](std::initializer_list<std::pair<int, int>> fields) {
+		for (auto const& [value, bits] : fields) {
+			builder.storeUInt(static_cast<uint64_t>(value), bits);
+		}
+	};
+
+	if (operands.empty()) {
+		auto it = fixedEncodings().find(line.opcode);
+		if (it != fixedEncodings().end()) {
+			builder.storeUInt(it->second.code, it->second.bits);
+			return builder;
+		}
+	}
+
+	switch (line.opcode) {
+	case Opcode::XCHG: {
+		if (operands.size() != 1) {
+			expectOperands(2);
+		}
+		int a = operands.size() == 1 ? 0 : stackArg(0, 255);
+		int b = stackArg(operands.size() - 1, 255);
+		if (a > b) {
+			std::swap(a, b);
+		}
+		if (a == b) {
+			assemblyError(line, "same registers");
+		} else if (a == 0 && b <= 15) {
+			store({{b, 8}});
+		} else if (a == 0) {
+			store({{0x11, 8}, {b, 8}});
+		} else if (a == 1 && b <= 15) {
+			store({{0x10 + b, 8}});
+		} else if (b <= 15) {
+			store({{0x10, 8}, {a, 4}, {b, 4}});
+		} else {
+			assemblyError(line, "unsupported registers");
+		}
+		break;
+	}
+	case Opcode::PUSH:
+	case Opcode::POP: {
+		expectOperands(1);
+		const bool push = line.opcode == Opcode::PUSH;
+		if (isControlRegister(operands[0])) {
+			store({{push ? 0xED4 : 0xED5, 12}, {parseRegister(line, operands[0], 'c', 15), 4}});
+		} else {
+			const int index = stackArg(0, 255);
+			if (index <= 15) {
+				store({{push ? 0x2 : 0x3, 4}, {index, 4}});
+			} else {
+				store({{push ? 0x56 : 0x57, 8}, {index, 8}});
+			}
+		}
+		break;
+	}
+	case Opcode::PUSHCTR:
+	case Opcode::POPCTR:
+		expectOperands(1);
+		store({{line.opcode == Opcode::PUSHCTR ? 0xED4 : 0xED5, 12}, {parseRegister(line, operands[0], 'c', 15), 4}});
+		break;
+	case Opcode::XCHG2:
+	case Opcode::XCPU:
+	case Opcode::PUSH2:
+		expectOperands(2);
+		store({{line.opcode == Opcode::XCHG2 ? 0x50 : line.opcode == Opcode::XCPU ? 0x51 : 0x53, 8},
+			   {stackArg(0, 15), 4}, {stackArg(1, 15), 4}});
+		break;
+	case Opcode::PUXC:
+		// 52ij is PUXC s(i), s(j - 1)
+		expectOperands(2);
+		store({{0x52, 8}, {stackArg(0, 15), 4}, {parseRegister(line, operands[1], 's', 14) + 1, 4}});
+		break;
+	case Opcode::XCHG3:
+		expectOperands(3);
+		store({{0x4, 4}, {stackArg(0, 15), 4}, {stackArg(1, 15), 4}, {stackArg(2, 15), 4}});
+		break;
+	case Opcode::PUSH3:
+		expectOperands(3);
+		store({{0x547, 12}, {stackArg(0, 15), 4}, {stackArg(1, 15), 4}, {stackArg(2, 15), 4}});
+		break;
+	case Opcode::BLKSWAP:
+		expectOperands(2);
+		store({{0x55, 8}, {arg(0, 1, 16) - 1, 4}, {arg(1, 1, 16) - 1, 4}});
+		break;
+	case Opcode::REVERSE:
+		expectOperands(2);
+		store({{0x5E, 8}, {arg(0, 2, 17) - 2, 4}, {arg(1, 0, 15), 4}});
+		break;
+	case Opcode::BLKDROP:
+		expectOperands(1);
+		store({{0x5F0, 12}, {arg(0, 0, 15), 4}});
+		break;
+	case Opcode::BLKPUSH:
+		expectOperands(2);
+		store({{0x5F, 8}, {arg(0, 1, 15), 4}, {arg(1, 0, 15), 4}});
+		break;
+	case Opcode::BLKDROP2:
+		expectOperands(2);
+		store({{0x6C, 8}, {arg(0, 1, 15), 4}, {arg(1, 0, 15), 4}});
+		break;
+	case Opcode::TUPLE:
+	case Opcode::INDEX:
+	case Opcode::UNTUPLE:
+	case Opcode::UNPACKFIRST:
+	case Opcode::SETINDEX:
+	case Opcode::INDEXQ:
+	case Opcode::SETINDEXQ: {
+		static std::map<Opcode, int> const prefixes{
+			{Opcode::TUPLE, 0x6F0}, {Opcode::INDEX, 0x6F1}, {Opcode::UNTUPLE, 0x6F2}, {Opcode::UNPACKFIRST, 0x6F3},
+			{Opcode::SETINDEX, 0x6F5}, {Opcode::INDEXQ, 0x6F6}, {Opcode::SETINDEXQ, 0x6F7}
+		};
+		expectOperands(1);
+		store({{prefixes.at(line.opcode), 12}, {arg(0, 0, 15), 4}});
+		break;
+	}
+	case Opcode::PUSHINT: {
+		expectOperands(1);
+		bigint value = parseInteger(line, operands[0]);
+		if (-5 <= value && value <= 10) {
+			store({{0x7, 4}, {static_cast<int>(value) & 0xF, 4}});
+		} else if (fitsSigned(value, 8)) {
+			builder.storeUInt(0x80, 8);
+			builder.storeInt(value, 8);
+		} else if (fitsSigned(value, 16)) {
+			builder.storeUInt(0x81, 8);
+			builder.storeInt(value, 16);
+		} else {
+			// 82lxxx, 8l + 19 bits of the value
+			int l = 0;
+			while (l <= 30 && !fitsSigned(value, 8 * l + 19)) {
+				++l;
+			}
+			if (l > 30) {
+				assemblyError(line, "integer is too big");
+			}
+			store({{0x82, 8}, {l, 5}});
+			builder.storeInt(value, 8 * l + 19);
+		}
+		break;
+	}
+	case Opcode::PUSHPOW2:
+	case Opcode::PUSHPOW2DEC:
+	case Opcode::PUSHNEGPOW2:
+		expectOperands(1);
+		store({{line.opcode == Opcode::PUSHPOW2 ? 0x83 : line.opcode == Opcode::PUSHPOW2DEC ? 0x84 : 0x85, 8},
+			   {arg(0, 1, 256) - 1, 8}});
+		break;
+	case Opcode::PUSHSLICE:
+		expectOperands(1);
+		encodePushSlice(line, builder, parseSlice(line, operands[0]));
+		break;
+	case Opcode::PUSHCONT: {
+		if (line.operands.size() != 1 || line.operands[0].kind != Operand::Kind::Continuation) {
+			assemblyError(line, "expected '{'");
+		}
+		++i;
+		std::vector<CellBuilder> chunks = encodeBlock(function, i);
+		if (i == function.end) {
+			assemblyError(line, "'}' is not found");
+		}
+		CellBuilder body = pack(chunks, Cell::MaxBits);
+		const int bytes = body.bits() / 8;
+		if (body.bits() % 8 == 0 && body.refs() == 0 && bytes <= 15) {
+			// 9xccc
+			store({{0x9, 4}, {bytes, 4}});
+			builder.append(body);
+		} else if (body.bits() % 8 == 0 && body.refs() <= 3 && body.bits() + 16 <= Cell::MaxBits) {
+			// 8F_rxxcccc
+			store({{0b1000111, 7}, {body.refs(), 2}, {bytes, 7}});
+			builder.append(body);
+		} else {
+			// PUSHREFCONT
+			store({{0x8A, 8}});
+			builder.storeRef(body.build());
+		}
+		break;
+	}
+	case Opcode::PUSHREFCONT:
+		// the continuation of the selector which becomes c3
+		if (!m_selector || &function != &*m_selector) {
+			assemblyError(line, "supported only in .selector");
+		}
+		expectOperands(0);
+		store({{0x8A, 8}});
+		builder.storeRef(m_dispatcher);
+		break;
+	case Opcode::DICTPUSHCONST:
+		// the dictionary of functions
+		if (!m_selector || &function != &*m_selector) {
+			assemblyError(line, "supported only in .selector");
+		}
+		expectOperands(1);
+		arg(0, FunctionIdLength, FunctionIdLength);
+		store({{0b11110100101001, 14}, {FunctionIdLength, 10}});
+		builder.storeRef(m_dictionary);
+		break;
+	case Opcode::ADDCONST:
+	case Opcode::MULCONST:
+	case Opcode::EQINT:
+	case Opcode::LESSINT:
+	case Opcode::GTINT:
+	case Opcode::NEQINT: {
+		static std::map<Opcode, int> const prefixes{
+			{Opcode::ADDCONST, 0xA6}, {Opcode::MULCONST, 0xA7}, {Opcode::EQINT, 0xC0}, {Opcode::LESSINT, 0xC1},
+			{Opcode::GTINT, 0xC2}, {Opcode::NEQINT, 0xC3}
+		};
+		expectOperands(1);
+		store({{prefixes.at(line.opcode), 8}, {arg(0, -128, 127) & 0xFF, 8}});
+		break;
+	}
+	case Opcode::LSHIFT:
+	case Opcode::RSHIFT:
+	case Opcode::FITS:
+	case Opcode::UFITS:
+	case Opcode::STI:
+	case Opcode::STU:
+	case Opcode::LDI:
+	case Opcode::LDU:
+	case Opcode::LDSLICE:
+	case Opcode::STIR:
+	case Opcode::STUR:
+	case Opcode::PLDI:
+	case Opcode::PLDU:
+	case Opcode::LDIQ:
+	case Opcode::LDUQ:
+	case Opcode::PLDSLICE: {
+		// the operand is a number of bits cc + 1
+		static std::map<Opcode, std::pair<int, int>> const prefixes{
+			{Opcode::LSHIFT, {0xAA, 8}}, {Opcode::RSHIFT, {0xAB, 8}}, {Opcode::FITS, {0xB4, 8}},
+			{Opcode::UFITS, {0xB5, 8}}, {Opcode::STI, {0xCA, 8}}, {Opcode::STU, {0xCB, 8}}, {Opcode::LDI, {0xD2, 8}},
+			{Opcode::LDU, {0xD3, 8}}, {Opcode::LDSLICE, {0xD6, 8}}, {Opcode::STIR, {0xCF0A, 16}},
+			{Opcode::STUR, {0xCF0B, 16}}, {Opcode::PLDI, {0xD70A, 16}}, {Opcode::PLDU, {0xD70B, 16}},
+			{Opcode::LDIQ, {0xD70C, 16}}, {Opcode::LDUQ, {0xD70D, 16}}, {Opcode::PLDSLICE, {0xD71D, 16}}
+		};
+		expectOperands(1);
+		auto const& [prefix, bits] = prefixes.at(line.opcode);
+		store({{prefix, bits}, {arg(0, 1, 256) - 1, 8}});
+		break;
+	}
+	case Opcode::STSLICECONST: {
+		expectOperands(1);
+		std::vector<bool> bits = parseSlice(line, operands[0]);
+		const int length = static_cast<int>(bits.size()) + 1;
+		if (length <= 8 * 7 + 2) {
+			// CFC0_xysss, no references and 8y + 2 bits of data
+			const int y = unitsFor(length, 2, 8);
+			store({{0b110011111, 9}, {0, 2}, {y, 3}});
+			storeWithCompletionTag(builder, bits, 8 * y + 2);
+		} else {
+			// PUSHSLICE sss, STSLICER
+			encodePushSlice(line, builder, bits);
+			store({{0xCF16, 16}});
+		}
+		break;
+	}
+	case Opcode::PLDREFIDX:
+		expectOperands(1);
+		store({{0xD74C + arg(0, 0, 3), 16}});
+		break;
+	case Opcode::CALLXARGS:
+		expectOperands(2);
+		store({{0xDA, 8}, {arg(0, 0, 15), 4}, {arg(1, 0, 15), 4}});
+		break;
+	case Opcode::JMPXARGS:
+		expectOperands(1);
+		store({{0xDB1, 12}, {arg(0, 0, 15), 4}});
+		break;
+	case Opcode::CALL:
+	case Opcode::JMP: {
+		expectOperands(1);
+		const int id = arg(0, 0, MaxCallId);
+		if (line.opcode == Opcode::CALL && id <= 255) {
+			store({{0xF0, 8}, {id, 8}});
+		} else {
+			// F12_n CALLDICT, F16_n JMPDICT
+			store({{line.opcode == Opcode::CALL ? 0b1111000100 : 0b1111000101, 10}, {id, 14}});
+		}
+		break;
+	}
+	case Opcode::THROW:
+	case Opcode::THROWIF:
+	case Opcode::THROWIFNOT: {
+		expectOperands(1);
+		const int code = arg(0, 0, 2047);
+		const int kind = line.opcode == Opcode::THROW ? 0 : line.opcode == Opcode::THROWIF ? 1 : 2;
+		if (code <= 63) {
+			// F22_, F26_, F2A_
+			store({{0b11110010, 8}, {kind, 2}, {code, 6}});
+		} else {
+			// F2C4_, F2D4_, F2E4_
+			store({{0b111100101, 9}, {kind + 4, 3}, {0, 1}, {code, 11}});
+		}
+		break;
+	}
+	case Opcode::THROWARG:
+	case Opcode::THROWARGIFNOT:
+		// F2CC_, F2EC_
+		expectOperands(1);
+		store({{0b111100101, 9}, {line.opcode == Opcode::THROWARG ? 4 : 6, 3}, {1, 1}, {arg(0, 0, 2047), 11}});
+		break;
+	case Opcode::GETPARAM:
+		expectOperands(1);
+		store({{0xF82, 12}, {arg(0, 0, 15), 4}});
+		break;
+	case Opcode::GETGLOB:
+	case Opcode::SETGLOB:
+		// F85_k, F87_k
+		expectOperands(1);
+		store({{line.opcode == Opcode::GETGLOB ? 0b11111000010 : 0b11111000011, 11}, {arg(0, 1, 31), 5}});
+		break;
+	case Opcode::PRINTSTR: {
+		// FEFnssss DEBUGSTR, n + 1 bytes of the string
+		std::string text = line.operandsText();
+		if (text.empty() || text.size() > 16) {
+			assemblyError(line, "string should have 1..16 characters");
+		}
+		store({{0xFEF, 12}, {static_cast<int>(text.size()) - 1, 4}});
+		for (char ch : text) {
+			builder.storeUInt(static_cast<uint8_t>(ch), 8);
+		}
+		break;
+	}
+	case Opcode::DUMP:
+		expectOperands(1);
+		store({{0xFE2, 12}, {stackArg(0, 15), 4}});
+		break;
+	default:
+		if (line.name == "SETCP") {
+			// SETCP isn't in TVMOpcodes.hpp, it is used by .selector only
+			expectOperands(1);
+			store({{0xFF, 8}, {arg(0, 0, 239), 8}});
+			break;
+		}
+		assemblyError(line, "unsupported instruction");
+	}
+	return builder;
+}
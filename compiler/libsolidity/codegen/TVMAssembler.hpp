@@ -0,0 +1,96 @@
+/*
+ * Copyright 2018-2020 TON DEV SOLUTIONS LTD.
+ *
+ * Licensed under the  terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the  GNU General Public License for more details at: https://www.gnu.org/licenses/gpl-3.0.html
+ */
+/**
+ * @author TON Labs <connect@tonlabs.io>
+ * @date 2020
+ * Assembler of the generated code into TVM cells
+ */
+
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <set>
+
+#include "TVMCell.hpp"
+#include "TVMPusher.hpp"
+
+namespace solidity::frontend {
+
+// Assembles the generated code of a contract together with the stdlib (lib/stdlib_sol.tvm) into
+// the StateInit of the contract without tvm_linker. The result is a format of its own, not the .tvc
+// of tvm_linker, see below.
+//
+// The root cell of the code is the .selector of the stdlib. Its DICTPUSHCONST pushes the dictionary
+// of all functions by 32-bit id and its PUSHREFCONT becomes c3, which jumps to the function with
+// the given id (or throws TvmConst::Message::Exception::WrongFunctionId if there is no such function),
+// so that "CALL n" (CALLDICT) calls function n:
+//  - internal functions (.internal) have the ids of their .internal-alias, e.g. main_external is -1;
+//  - public functions (.public) have the ids of ABI, publicFunctionIds;
+//  - private functions (.globl) and macros (.macro) get small consecutive ids in order of the code,
+//    "CALL $name$" becomes CALLDICT of the id. Only functions reachable from the entry points are assembled.
+// An .internal-alias without code (general_purpose) passes the function id on the stack to c3.
+//
+// Instructions are stored one after another; an instruction which doesn't fit into the current cell goes
+// with the rest of the code to a new cell, referenced last, where TVM continues by implicit JMPREF.
+// A continuation is pushed inline (PUSHCONT) if its code fits into one cell in whole bytes and as
+// a reference (PUSHREFCONT) otherwise.
+//
+// The assembler is experimental (--tvm-boc). Instructions are encoded as in cp0, but the ids of private
+// functions, the splitting of code into cells and the bag of cells (neither index nor CRC32C) are its own.
+// That's why the StateInit is saved to <contract>.boc rather than <contract>.tvc: tools which expect
+// the output of tvm_linker, e.g. to call functions of the contract by their linker ids, can't use it.
+class TVMAssembler {
+public:
+	TVMAssembler(CodeLines const& code, CodeLines const& stdlib, std::map<std::string, uint32_t> publicFunctionIds);
+
+	// StateInit of the contract with the code and the initial persistent data (an empty dictionary of
+	// public state variables with a zero public key), serialized as a bag of cells
+	bytes stateInit();
+
+	// Encodes the instructions into a chain of cells as the body of a function. The code may not
+	// call functions by name or contain the directives, it is used to test the encoding.
+	static Cell::Ptr assembleFragment(CodeLines const& code);
+
+private:
+	TVMAssembler() = default;
+
+	struct Function {
+		std::string name;
+		bool isPublic{};
+		std::optional<int64_t> id;
+		CodeLines const* code{};
+		size_t begin{};
+		size_t end{};
+		std::set<std::string> callees;
+	};
+
+	void readSections(CodeLines const& code);
+	void assignIds();
+	Cell::Ptr codeCell();
+	Cell::Ptr functionDictionary();
+	// Encodes the instructions from line i to the end of the section or to the closing '}'
+	std::vector<CellBuilder> encodeBlock(Function const& function, size_t& i);
+	CellBuilder encode(Function const& function, Instruction const& line, size_t& i);
+	// Stores the instructions in a chain of cells, the first cell gets no more than maxBits bits
+	static CellBuilder pack(std::vector<CellBuilder> const& chunks, int maxBits);
+
+	std::map<std::string, uint32_t> m_publicFunctionIds;
+	std::deque<Function> m_functions;
+	std::map<std::string, size_t> m_functionIndex;
+	std::optional<Function> m_selector;
+	Cell::Ptr m_dictionary;
+	Cell::Ptr m_dispatcher;
+};
+
+}	// end solidity::frontend
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2018-2020 TON DEV SOLUTIONS LTD.
+ *
+ * Licensed under the  terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the  GNU General Public License for more details at: https://www.gnu.org/licenses/gpl-3.0.html
+ */
+/**
+ * @author TON Labs <connect@tonlabs.io>
+ * @date 2020
+ * Call graph of the generated functions
+ */
+
+#include "TVMCallGraph.hpp"
+
+using namespace solidity::frontend;
+
+TVMCallGraph::TVMCallGraph(CodeLines const& code) : m_code{code} {
+	// lines before the first function are kept as is
+	m_functions.emplace_back();
+	m_functions.back().isEntryPoint = true;
+	bool inHeader = false;
+	for (size_t i = 0; i < m_code.lines.size(); ++i) {
+		Instruction const& line = m_code.lines[i];
+		if (line.depth == 0 && (line.name == ".globl" || line.name == ".macro" ||
+			line.name == ".internal-alias" || line.name == ".internal" ||
+			line.name == ".public" || line.name == ".type")) {
+			if (!inHeader) {
+				m_functions.back().end = i;
+				Function function;
+				function.name = line.operands.empty() ? "" : line.operands[0].name();
+				function.begin = i;
+				m_functions.push_back(function);
+				inHeader = true;
+			}
+			if (line.name == ".public" || line.name == ".internal" || line.name == ".internal-alias") {
+				m_functions.back().isEntryPoint = true;
+			}
+			continue;
+		}
+		inHeader = false;
+		for (Operand const& operand : line.operands) {
+			if (operand.kind == Operand::Kind::Function) {
+				m_functions.back().callees.insert(operand.name());
+			}
+		}
+	}
+	m_functions.back().end = m_code.lines.size();
+}
+
+std::set<std::string> TVMCallGraph::reachableFunctions() const {
+	std::map<std::string, std::vector<Function const*>> byName;
+	for (Function const& function : m_functions) {
+		byName[function.name].push_back(&function);
+	}
+
+	std::set<std::string> reachable;
+	std::vector<Function const*> queue;
+	for (Function const& function : m_functions) {
+		if (function.isEntryPoint) {
+			reachable.insert(function.name);
+			queue.push_back(&function);
+		}
+	}
+	while (!queue.empty()) {
+		Function const* function = queue.back();
+		queue.pop_back();
+		for (std::string const& callee : function->callees) {
+			if (reachable.insert(callee).second && byName.count(callee)) {
+				for (Function const* f : byName.at(callee)) {
+					queue.push_back(f);
+				}
+			}
+		}
+	}
+	return reachable;
+}
+
+void TVMCallGraph::removeUnreachableFunctions(CodeLines& code) {
+	TVMCallGraph const graph{code};
+	std::set<std::string> const reachable = graph.reachableFunctions();
+	size_t size = 0;
+	for (Function const& function : graph.m_functions) {
+		if (function.isEntryPoint || reachable.count(function.name)) {
+			for (size_t i = function.begin; i < function.end; ++i, ++size) {
+				if (size != i) {
+					code.lines[size] = std::move(code.lines[i]);
+				}
+			}
+		}
+	}
+	code.lines.resize(size);
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018-2020 TON DEV SOLUTIONS LTD.
+ *
+ * Licensed under the  terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the  GNU General Public License for more details at: https://www.gnu.org/licenses/gpl-3.0.html
+ */
+/**
+ * @author TON Labs <connect@tonlabs.io>
+ * @date 2020
+ * Call graph of the generated functions
+ */
+
+#pragma once
+
+#include "TVMPusher.hpp"
+
+namespace solidity::frontend {
+
+// Call graph of the functions of the generated assembly. A function calls another one if its code
+// mentions "$name$" anywhere, e.g. in "CALL $name$" or in a continuation pushed as a value of
+// a function type, so the graph is conservative.
+//
+// Public (.public) and internal (.internal) functions are entry points of the contract, private
+// functions (.globl) and macros (.macro) are used only if they are reachable from them.
+class TVMCallGraph {
+public:
+	explicit TVMCallGraph(CodeLines const& code);
+
+	std::set<std::string> reachableFunctions() const;
+	// Removes unreachable private functions and macros from the code in place
+	static void removeUnreachableFunctions(CodeLines& code);
+
+private:
+	struct Function {
+		std::string name;
+		bool isEntryPoint{};
+		size_t begin{};		// first line of the header
+		size_t end{};
+		std::set<std::string> callees;
+	};
+
+	CodeLines const& m_code;
+	std::vector<Function> m_functions;	// in order of the code
+};
+
+}	// end solidity::frontend
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2018-2020 TON DEV SOLUTIONS LTD.
+ *
+ * Licensed under the  terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the  GNU General Public License for more details at: https://www.gnu.org/licenses/gpl-3.0.html
+ */
+/**
+ * @author TON Labs <connect@tonlabs.io>
+ * @date 2020
+ * TVM cells, dictionaries and bags of cells
+ */
+
+#include <liblangutil/Exceptions.h>
+#include <libsolutil/CommonData.h>
+#include <libsolutil/picosha2.h>
+
+#include <algorithm>
+#include <functional>
+
+#include "TVMCell.hpp"
+
+using namespace solidity;
+using namespace solidity::frontend;
+
+namespace {
+
+// number of bits to store values 0..maxValue
+int bitLength(size_t maxValue) {
+	int result = 0;
+	while (maxValue > 0) {
+		++result;
+		maxValue >>= 1u;
+	}
+	return result;
+}
+
+// number of bytes to store values 0..maxValue, at least one
+int byteLength(size_t maxValue) {
+	return std::max(1, (bitLength(maxValue) + 7) / 8);
+}
+
+void appendUInt(bytes& out, uint64_t value, int length) {
+	for (int i = length - 1; i >= 0; --i) {
+		out.push_back(static_cast<uint8_t>(value >> (8u * static_cast<unsigned>(i))));
+	}
+}
+
+// HmLabel ~l m, the shortest of hml_short, hml_long and hml_same
+void storeLabel(CellBuilder& builder, std::vector<bool>::const_iterator begin, std::vector<bool>::const_iterator end,
+				int maxLength) {
+	const int length = static_cast<int>(end - begin);
+	const int lengthBits = bitLength(static_cast<size_t>(maxLength));
+	const int shortBits = 1 + (length + 1) + length;
+	const int longBits = 2 + lengthBits + length;
+	const int sameBits = 3 + lengthBits;
+	const bool same = length > 0 && std::all_of(begin, end, [&](bool bit) { return bit == *begin; });
+	if (same && sameBits < std::min(shortBits, longBits)) {
+		// hml_same$11 v:Bit n:(#<= m)
+		builder.storeUInt(0b11, 2);
+		builder.storeBit(*begin);
+		builder.storeUInt(static_cast<uint64_t>(length), lengthBits);
+	} else if (shortBits <= longBits) {
+		// hml_short$0 len:(Unary ~n) s:(n * Bit)
+		builder.storeBit(false);
+		for (int i = 0; i < length; ++i) {
+			builder.storeBit(true);
+		}
+		builder.storeBit(false);
+		builder.storeBits(std::vector<bool>(begin, end));
+	} else {
+		// hml_long$10 n:(#<= m) s:(n * Bit)
+		builder.storeUInt(0b10, 2);
+		builder.storeUInt(static_cast<uint64_t>(length), lengthBits);
+		builder.storeBits(std::vector<bool>(begin, end));
+	}
+}
+
+using DictEntry = std::pair<std::vector<bool>, CellBuilder const*>;
+
+// Hashmap n X for the entries with equal first `offset` bits of the keys, n = keyLength - offset
+Cell::Ptr buildHashmap(std::vector<DictEntry> const& entries, size_t from, size_t to, int offset, int keyLength) {
+	std::vector<bool> const& first = entries[from].first;
+	std::vector<bool> const& last = entries[to - 1].first;
+	// keys are sorted, so the common prefix of all of them is the common prefix of the first and the last ones
+	int prefixEnd = offset;
+	while (prefixEnd < keyLength && first[prefixEnd] == last[prefixEnd]) {
+		++prefixEnd;
+	}
+
+	CellBuilder builder;
+	storeLabel(builder, first.begin() + offset, first.begin() + prefixEnd, keyLength - offset);
+	if (prefixEnd == keyLength) {
+		solAssert(to - from == 1, "Duplicate keys in a dictionary");
+		CellBuilder const& value = *entries[from].second;
+		solAssert(builder.canAppend(value.bits(), value.refs()), "Value doesn't fit into a dictionary leaf");
+		builder.append(value);
+	} else {
+		size_t middle = from;
+		while (!entries[middle].first[prefixEnd]) {
+			++middle;
+		}
+		builder.storeRef(buildHashmap(entries, from, middle, prefixEnd + 1, keyLength));
+		builder.storeRef(buildHashmap(entries, middle, to, prefixEnd + 1, keyLength));
+	}
+	return builder.build();
+}
+
+}
+
+Cell::Cell(std::vector<bool> data, std::vector<Ptr> refs) :
+	m_data{std::move(data)},
+	m_refs{std::move(refs)}
+{
+	solAssert(m_data.size() <= MaxBits && m_refs.size() <= MaxRefs, "Cell overflow");
+	bytes representation = descriptorAndData();
+	for (Ptr const& ref : m_refs) {
+		m_depth = std::max(m_depth, ref->depth() + 1);
+		appendUInt(representation, static_cast<uint64_t>(ref->depth()), 2);
+	}
+	for (Ptr const& ref : m_refs) {
+		representation += ref->hash();
+	}
+	m_hash = picosha2::hash256(representation);
+}
+
+bytes Cell::descriptorAndData() const {
+	const size_t bits = m_data.size();
+	bytes result;
+	result.push_back(static_cast<uint8_t>(m_refs.size()));
+	result.push_back(static_cast<uint8_t>(bits / 8 + (bits + 7) / 8));
+	// a cell with an incomplete last byte is padded with the completion tag: a one and zeros
+	result.resize(2 + (bits + 7) / 8);
+	for (size_t i = 0; i < bits; ++i) {
+		if (m_data[i]) {
+			result[2 + i / 8] |= static_cast<uint8_t>(0x80u >> (i % 8));
+		}
+	}
+	if (bits % 8 != 0) {
+		result[2 + bits / 8] |= static_cast<uint8_t>(0x80u >> (bits % 8));
+	}
+	return result;
+}
+
+void CellBuilder::storeBits(std::vector<bool> const& bits) {
+	m_data.insert(m_data.end(), bits.begin(), bits.end());
+}
+
+void CellBuilder::storeUInt(uint64_t value, int bits) {
+	solAssert(0 <= bits && bits <= 64, "");
+	for (int i = bits - 1; i >= 0; --i) {
+		m_data.push_back(((value >> static_cast<unsigned>(i)) & 1u) != 0);
+	}
+}
+
+void CellBuilder::storeInt(bigint const& value, int bits) {
+	bigint twosComplement = value < 0 ? (bigint(1) << bits) + value : value;
+	solAssert(twosComplement >= 0 && twosComplement < (bigint(1) << bits), "Integer doesn't fit");
+	for (int i = bits - 1; i >= 0; --i) {
+		m_data.push_back(boost::multiprecision::bit_test(twosComplement, static_cast<unsigned>(i)));
+	}
+}
+
+void CellBuilder::storeRef(Cell::Ptr cell) {
+	m_refs.push_back(std::move(cell));
+}
+
+void CellBuilder::append(CellBuilder const& other) {
+	storeBits(other.m_data);
+	m_refs.insert(m_refs.end(), other.m_refs.begin(), other.m_refs.end());
+}
+
+bool CellBuilder::canAppend(int bits, int refs) const {
+	return this->bits() + bits <= Cell::MaxBits && this->refs() + refs <= Cell::MaxRefs;
+}
+
+Cell::Ptr CellBuilder::build() const {
+	return std::make_shared<Cell const>(m_data, m_refs);
+}
+
+Cell::Ptr solidity::frontend::buildDictionary(std::map<std::vector<bool>, CellBuilder> const& values, int keyLength) {
+	solAssert(!values.empty(), "");
+	std::vector<DictEntry> entries;
+	for (auto const& [key, value] : values) {
+		solAssert(static_cast<int>(key.size()) == keyLength, "");
+		entries.emplace_back(key, &value);
+	}
+	return buildHashmap(entries, 0, entries.size(), 0, keyLength);
+}
+
+bytes solidity::frontend::serializeBagOfCells(Cell::Ptr const& root) {
+	// every cell goes before the cells it refers to: reversed postorder of the DFS
+	std::map<bytes, size_t> visited;
+	std::vector<Cell const*> postorder;
+	std::function<void(Cell const&)> dfs = [&](Cell const& cell) {
+		if (visited.count(cell.hash())) {
+			return;
+		}
+		visited[cell.hash()] = 0;
+		for (Cell::Ptr const& ref : cell.refs()) {
+			dfs(*ref);
+		}
+		postorder.push_back(&cell);
+	};
+	dfs(*root);
+	std::vector<Cell const*> cells(postorder.rbegin(), postorder.rend());
+	for (size_t i = 0; i < cells.size(); ++i) {
+		visited[cells[i]->hash()] = i;
+	}
+
+	const int size = byteLength(cells.size());
+	bytes data;
+	for (Cell const* cell : cells) {
+		data += cell->descriptorAndData();
+		for (Cell::Ptr const& ref : cell->refs()) {
+			appendUInt(data, visited.at(ref->hash()), size);
+		}
+	}
+	const int offsetSize = byteLength(data.size());
+
+	// serialized_boc#b5ee9c72 has_idx:(## 1) has_crc32c:(## 1) has_cache_bits:(## 1) flags:(## 2) size:(## 3)
+	//   off_bytes:(## 8) cells roots absent tot_cells_size root_list cell_data
+	bytes result{0xb5, 0xee, 0x9c, 0x72};
+	result.push_back(static_cast<uint8_t>(size));
+	result.push_back(static_cast<uint8_t>(offsetSize));
+	appendUInt(result, cells.size(), size);
+	appendUInt(result, 1, size);
+	appendUInt(result, 0, size);
+	appendUInt(result, data.size(), offsetSize);
+	appendUInt(result, 0, size);
+	result += data;
+	return result;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2018-2020 TON DEV SOLUTIONS LTD.
+ *
+ * Licensed under the  terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the  GNU General Public License for more details at: https://www.gnu.org/licenses/gpl-3.0.html
+ */
+/**
+ * @author TON Labs <connect@tonlabs.io>
+ * @date 2020
+ * TVM cells, dictionaries and bags of cells
+ */
+
+#pragma once
+
+#include <libsolutil/Common.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace solidity::frontend {
+
+// Ordinary cell: up to 1023 bits of data and up to 4 references to other cells
+class Cell {
+public:
+	using Ptr = std::shared_ptr<Cell const>;
+
+	static constexpr int MaxBits = 1023;
+	static constexpr int MaxRefs = 4;
+
+	Cell(std::vector<bool> data, std::vector<Ptr> refs);
+
+	std::vector<bool> const& data() const { return m_data; }
+	std::vector<Ptr> const& refs() const { return m_refs; }
+	int depth() const { return m_depth; }
+	// representation hash (sha256), it identifies the cell in a bag of cells
+	bytes const& hash() const { return m_hash; }
+	// descriptor bytes d1, d2 and the data padded with the completion tag
+	bytes descriptorAndData() const;
+
+private:
+	std::vector<bool> m_data;
+	std::vector<Ptr> m_refs;
+	int m_depth{};
+	bytes m_hash;
+};
+
+class CellBuilder {
+public:
+	void storeBit(bool bit) { m_data.push_back(bit); }
+	void storeBits(std::vector<bool> const& bits);
+	// stores the lowest `bits` bits of value, big-endian
+	void storeUInt(uint64_t value, int bits);
+	// stores a signed value in two's complement form
+	void storeInt(bigint const& value, int bits);
+	void storeRef(Cell::Ptr cell);
+	// stores the data and the references of another builder
+	void append(CellBuilder const& other);
+
+	int bits() const { return static_cast<int>(m_data.size()); }
+	int refs() const { return static_cast<int>(m_refs.size()); }
+	std::vector<bool> const& data() const { return m_data; }
+	bool canAppend(int bits, int refs) const;
+
+	Cell::Ptr build() const;
+
+private:
+	std::vector<bool> m_data;
+	std::vector<Cell::Ptr> m_refs;
+};
+
+// Builds a non-empty dictionary (Hashmap n X) with keys of keyLength bits. Values are stored in the leaves.
+Cell::Ptr buildDictionary(std::map<std::vector<bool>, CellBuilder> const& values, int keyLength);
+
+// Serializes the tree of cells with the root as a bag of cells without index and checksum.
+// Equal cells are stored once.
+bytes serializeBagOfCells(Cell::Ptr const& root);
+
+}	// end solidity::frontend
@@ -46,20 +46,34 @@ bool ends_with(const string &str, const string &suffix) {
 	return 0 == str.compare(str.size()-suffix.size(), suffix.size(), suffix);
 }
 
+static thread_local ErrorReporter* g_errorReporter{};
+
+ErrorReporterScope::ErrorReporterScope(ErrorReporter* errorReporter) : m_previous{g_errorReporter} {
+	g_errorReporter = errorReporter;
+}
+
+ErrorReporterScope::~ErrorReporterScope() {
+	g_errorReporter = m_previous;
+}
+
 void cast_error(const ASTNode &node, const string &error_message) {
-	TVMContractCompiler::g_errorReporter->fatalParserError(node.location(), error_message);
+	g_errorReporter->fatalParserError(node.location(), error_message);
 	BOOST_THROW_EXCEPTION(FatalError()); // never throw, just for [[noreturn]]
 }
 
 void cast_warning(const ASTNode &node, const string &error_message) {
-	TVMContractCompiler::g_errorReporter->warning(node.location(), error_message);
+	g_errorReporter->warning(node.location(), error_message);
 }
 
 void fatal_error(const string &error_message) {
-	TVMContractCompiler::g_errorReporter->error(Error::Type::TypeError, SourceLocation(), error_message);
+	g_errorReporter->error(Error::Type::TypeError, SourceLocation(), error_message);
 	BOOST_THROW_EXCEPTION(FatalError()); // never throw, just for [[noreturn]]
 }
 
+void append_errors(const ErrorList& errors) {
+	g_errorReporter->append(errors);
+}
+
 const ContractDefinition *
 getSuperContract(const ContractDefinition *currentContract, const ContractDefinition *mainContract, const string &fname) {
 	ContractDefinition const* prev = nullptr;
@@ -73,8 +87,277 @@ getSuperContract(const ContractDefinition *currentContract, const ContractDefini
 }
 
 vector<FunctionDefinition const *> getContractFunctions(ContractDefinition const *contract) {
-	vector<FunctionDefinition const*> result;
-	for (auto &[functionDefinition, contractDefinition] : getContractFunctionPairs(contract)) {
+	return ContractFunctionIndex{contract}.functions();
+}
+
+StateVarAccessCounter::StateVarAccessCounter(ContractDefinition const& contract) {
+	for (ContractDefinition const* base : contract.annotation().linearizedBaseContracts) {
+		for (FunctionDefinition const* function : base->definedFunctions()) {
+			function->accept(*this);
+		}
+		for (ModifierDefinition const* modifier : base->functionModifiers()) {
+			modifier->accept(*this);
+		}
+	}
+}
+
+bool StateVarAccessCounter::visit(Identifier const& _node) {
+	count(_node.annotation().referencedDeclaration);
+	return true;
+}
+
+bool StateVarAccessCounter::visit(MemberAccess const& _node) {
+	count(_node.annotation().referencedDeclaration);
+	return true;
+}
+
+bool StateVarAccessCounter::visit(WhileStatement const&) {
+	m_weight *= LoopWeight;
+	return true;
+}
+
+void StateVarAccessCounter::endVisit(WhileStatement const&) {
+	m_weight /= LoopWeight;
+}
+
+bool StateVarAccessCounter::visit(ForStatement const&) {
+	m_weight *= LoopWeight;
+	return true;
+}
+
+void StateVarAccessCounter::endVisit(ForStatement const&) {
+	m_weight /= LoopWeight;
+}
+
+void StateVarAccessCounter::count(Declaration const* declaration) {
+	auto variable = to<VariableDeclaration>(declaration);
+	if (variable && variable->isStateVariable() && !variable->isConstant()) {
+		m_counts[variable] += m_weight;
+	}
+}
+
+InternalCallCounter::InternalCallCounter(ContractDefinition const& contract) {
+	for (ContractDefinition const* base : contract.annotation().linearizedBaseContracts) {
+		for (FunctionDefinition const* function : base->definedFunctions()) {
+			function->accept(*this);
+		}
+		for (ModifierDefinition const* modifier : base->functionModifiers()) {
+			modifier->accept(*this);
+		}
+	}
+}
+
+int InternalCallCounter::calls(std::string const& name) const {
+	auto it = m_calls.find(name);
+	return it == m_calls.end() ? 0 : it->second;
+}
+
+int InternalCallCounter::otherUses(std::string const& name) const {
+	auto it = m_otherUses.find(name);
+	return it == m_otherUses.end() ? 0 : it->second;
+}
+
+bool InternalCallCounter::visit(FunctionCall const& _node) {
+	auto identifier = to<Identifier>(&_node.expression());
+	if (identifier == nullptr || to<FunctionDefinition>(identifier->annotation().referencedDeclaration) == nullptr) {
+		return true;
+	}
+	++m_calls[identifier->name()];
+	for (ASTPointer<Expression const> const& argument : _node.arguments()) {
+		argument->accept(*this);
+	}
+	return false;
+}
+
+bool InternalCallCounter::visit(Identifier const& _node) {
+	if (to<FunctionDefinition>(_node.annotation().referencedDeclaration)) {
+		++m_otherUses[_node.name()];
+	}
+	return false;
+}
+
+StateWriteScanner::StateWriteScanner(ContractDefinition const& contract, FunctionDefinition const& function) :
+	m_contract{contract} {
+	scan(&function);
+}
+
+bool StateWriteScanner::visit(Assignment const& _node) {
+	if (isStateVariable(_node.leftHandSide())) {
+		m_canWriteState = true;
+	}
+	return !m_canWriteState;
+}
+
+bool StateWriteScanner::visit(UnaryOperation const& _node) {
+	switch (_node.getOperator()) {
+		case Token::Inc:
+		case Token::Dec:
+		case Token::Delete:
+			if (isStateVariable(_node.subExpression())) {
+				m_canWriteState = true;
+			}
+			break;
+		default:
+			break;
+	}
+	return !m_canWriteState;
+}
+
+bool StateWriteScanner::visit(FunctionCall const& _node) {
+	auto functionType = to<FunctionType>(_node.expression().annotation().type);
+	if (functionType == nullptr) {
+		return true; // type conversion or struct constructor
+	}
+
+	Declaration const* declaration = nullptr;
+	auto memberAccess = to<MemberAccess>(&_node.expression());
+	if (auto identifier = to<Identifier>(&_node.expression())) {
+		declaration = identifier->annotation().referencedDeclaration;
+	} else if (memberAccess) {
+		declaration = memberAccess->annotation().referencedDeclaration;
+	}
+
+	switch (functionType->kind()) {
+		case FunctionType::Kind::Internal:
+		case FunctionType::Kind::DelegateCall: {
+			auto function = to<FunctionDefinition>(declaration);
+			static std::set<std::string> const writingIntrinsics{
+				"tvm_reset_storage", "tvm_setglob", "tvm_migratePubkey", "tvm_poproot", "tvm_popctr"
+			};
+			if (function == nullptr || writingIntrinsics.count(function->name())) {
+				m_canWriteState = true; // unknown function or intrinsic which changes c4 or c7
+			} else {
+				scanOverrides(function);
+			}
+			break;
+		}
+		case FunctionType::Kind::TVMResetStorage:
+			m_canWriteState = true;
+			break;
+		// methods which don't change the object
+		case FunctionType::Kind::External:
+		case FunctionType::Kind::BareCall:
+		case FunctionType::Kind::BareCallCode:
+		case FunctionType::Kind::BareStaticCall:
+		case FunctionType::Kind::Send:
+		case FunctionType::Kind::Transfer:
+		case FunctionType::Kind::TVMTransfer:
+		case FunctionType::Kind::SetValue:
+		case FunctionType::Kind::AddressIsZero:
+		case FunctionType::Kind::AddressType:
+		case FunctionType::Kind::AddressUnpack:
+		case FunctionType::Kind::TVMCellToSlice:
+		case FunctionType::Kind::TVMSliceSize:
+		case FunctionType::Kind::TVMHash:
+		case FunctionType::Kind::MappingGetNextKey:
+		case FunctionType::Kind::MappingGetPrevKey:
+		case FunctionType::Kind::MappingGetMinMax:
+		case FunctionType::Kind::MappingFetch:
+		case FunctionType::Kind::MappingExists:
+		case FunctionType::Kind::MappingEmpty:
+		case FunctionType::Kind::StringMethod:
+			break;
+		default:
+			// e.g. push, delMin, replace, loadRef or store of a state variable
+			if (memberAccess && isStateVariable(memberAccess->expression())) {
+				m_canWriteState = true;
+			}
+			break;
+	}
+	return !m_canWriteState;
+}
+
+bool StateWriteScanner::visit(ModifierInvocation const& _node) {
+	if (auto modifier = to<ModifierDefinition>(_node.name()->annotation().referencedDeclaration)) {
+		scanOverrides(modifier);
+	}
+	return !m_canWriteState;
+}
+
+bool StateWriteScanner::visit(VariableDeclaration const& _node) {
+	// a storage pointer may be used to change a state variable
+	if (!_node.isStateVariable() && _node.referenceLocation() == VariableDeclaration::Location::Storage) {
+		m_canWriteState = true;
+	}
+	return !m_canWriteState;
+}
+
+bool StateWriteScanner::visit(InlineAssembly const&) {
+	m_canWriteState = true;
+	return false;
+}
+
+void StateWriteScanner::scan(CallableDeclaration const* callable) {
+	if (m_canWriteState || !m_scanned.insert(callable).second) {
+		return;
+	}
+	callable->accept(*this);
+}
+
+void StateWriteScanner::scanOverrides(CallableDeclaration const* callable) {
+	scan(callable);
+	for (ContractDefinition const* base : m_contract.annotation().linearizedBaseContracts) {
+		for (FunctionDefinition const* function : base->definedFunctions()) {
+			if (function->name() == callable->name()) {
+				scan(function);
+			}
+		}
+		for (ModifierDefinition const* modifier : base->functionModifiers()) {
+			if (modifier->name() == callable->name()) {
+				scan(modifier);
+			}
+		}
+	}
+}
+
+bool StateWriteScanner::isStateVariable(Expression const& expr) {
+	Expression const* e = &expr;
+	while (true) {
+		if (auto tuple = to<TupleExpression>(e)) {
+			for (ASTPointer<Expression> const& component : tuple->components()) {
+				if (component && isStateVariable(*component)) {
+					return true;
+				}
+			}
+			return false;
+		}
+		if (auto indexAccess = to<IndexAccess>(e)) {
+			e = &indexAccess->baseExpression();
+		} else if (auto indexRangeAccess = to<IndexRangeAccess>(e)) {
+			e = &indexRangeAccess->baseExpression();
+		} else if (auto memberAccess = to<MemberAccess>(e)) {
+			auto vd = to<VariableDeclaration>(memberAccess->annotation().referencedDeclaration);
+			if (vd && vd->isStateVariable()) {
+				return true; // Contract.variable
+			}
+			e = &memberAccess->expression();
+		} else {
+			break;
+		}
+	}
+	auto identifier = to<Identifier>(e);
+	if (identifier == nullptr) {
+		return false;
+	}
+	auto vd = to<VariableDeclaration>(identifier->annotation().referencedDeclaration);
+	return vd && vd->isStateVariable();
+}
+
+ContractFunctionIndex::ContractFunctionIndex(ContractDefinition const *contract) :
+	m_chain{getContractsChain(contract)},
+	m_functionPairs{getContractFunctionPairs(contract)} {
+	for (ContractDefinition const* c : m_chain) {
+		string_map<FunctionDefinition const*>& defined = m_definedFunctions[c];
+		for (FunctionDefinition const* f : c->definedFunctions()) {
+			defined.emplace(f->name(), f); // the first one wins as in getFunction
+		}
+	}
+	for (auto &[functionDefinition, contractDefinition] : m_functionPairs) {
+		(void)contractDefinition;	// suppress unused variable error
+		if (!functionDefinition->isConstructor())
+			m_functionsByName[functionName(functionDefinition)].push_back(functionDefinition);
+	}
+	for (auto &[functionDefinition, contractDefinition] : m_functionPairs) {
 		(void)contractDefinition;	// suppress unused variable error
 		if (functionDefinition->isConstructor())
 			continue;
@@ -82,11 +365,36 @@ vector<FunctionDefinition const *> getContractFunctions(ContractDefinition const
 		if (isTvmIntrinsic(funName))
 			continue;
 		// TODO: not needed check?
-		if (functionDefinition != getContractFunctions(contract, funName).back())
+		if (functionDefinition != m_functionsByName.at(funName).back())
 			continue;
-		result.push_back(functionDefinition);
+		m_functions.push_back(functionDefinition);
 	}
-	return result;
+}
+
+vector<FunctionDefinition const *> const& ContractFunctionIndex::functions(const string &funcName) const {
+	static vector<FunctionDefinition const*> const empty;
+	auto it = m_functionsByName.find(funcName);
+	return it == m_functionsByName.end() ? empty : it->second;
+}
+
+FunctionDefinition const *
+ContractFunctionIndex::function(ContractDefinition const *c, const string &functionName) const {
+	auto defined = m_definedFunctions.find(c);
+	if (defined == m_definedFunctions.end())
+		return getFunction(c, functionName);
+	return get_from_map(defined->second, functionName, nullptr);
+}
+
+ContractDefinition const *
+ContractFunctionIndex::superContract(ContractDefinition const *currentContract, const string &fname) const {
+	ContractDefinition const* prev = nullptr;
+	for (auto c : m_chain) {
+		if (c == currentContract)
+			break;
+		if (function(c, fname))
+			prev = c;
+	}
+	return prev;
 }
 
 const Type *getType(const VariableDeclaration *var) {
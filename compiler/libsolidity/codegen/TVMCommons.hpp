@@ -30,6 +30,7 @@
 #include <json/json.h>
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/noncopyable.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 #include <utility>
 
@@ -140,6 +141,76 @@ public:
 	bool havePrivateFunctionCall{};
 };
 
+// Static count of accesses of state variables in functions and modifiers of a contract and its bases.
+// An access in a loop is counted LoopWeight times per level of nesting.
+class StateVarAccessCounter: public ASTConstVisitor
+{
+public:
+	explicit StateVarAccessCounter(ContractDefinition const& contract);
+
+	std::map<VariableDeclaration const*, double> const& counts() const { return m_counts; }
+
+	bool visit(Identifier const& _node) override;
+	bool visit(MemberAccess const& _node) override;
+	bool visit(WhileStatement const& _node) override;
+	void endVisit(WhileStatement const& _node) override;
+	bool visit(ForStatement const& _node) override;
+	void endVisit(ForStatement const& _node) override;
+
+private:
+	void count(Declaration const* declaration);
+
+	static constexpr double LoopWeight = 10;
+	std::map<VariableDeclaration const*, double> m_counts;
+	double m_weight{1};
+};
+
+// Static count of calls of internal functions by name in functions and modifiers of a contract and its bases.
+// Other uses of a function (e.g. as a value of a function type) are counted separately.
+class InternalCallCounter: public ASTConstVisitor
+{
+public:
+	explicit InternalCallCounter(ContractDefinition const& contract);
+
+	int calls(std::string const& name) const;
+	int otherUses(std::string const& name) const;
+
+	bool visit(FunctionCall const& _node) override;
+	bool visit(Identifier const& _node) override;
+
+private:
+	std::map<std::string, int> m_calls;
+	std::map<std::string, int> m_otherUses;
+};
+
+// Conservatively checks if a function (with its modifiers and internal functions it calls) can change
+// state variables or other data saved in c4 by c7_to_c4 (e.g. the pubkey).
+class StateWriteScanner: public ASTConstVisitor
+{
+public:
+	StateWriteScanner(ContractDefinition const& contract, FunctionDefinition const& function);
+
+	bool canWriteState() const { return m_canWriteState; }
+
+	bool visit(Assignment const& _node) override;
+	bool visit(UnaryOperation const& _node) override;
+	bool visit(FunctionCall const& _node) override;
+	bool visit(ModifierInvocation const& _node) override;
+	bool visit(VariableDeclaration const& _node) override;
+	bool visit(InlineAssembly const& _node) override;
+
+private:
+	void scan(CallableDeclaration const* callable);
+	// Scans all functions (or modifiers) with the name in the contract and its bases, any of them can be called
+	// because of overriding
+	void scanOverrides(CallableDeclaration const* callable);
+	static bool isStateVariable(Expression const& expr);
+
+	ContractDefinition const& m_contract;
+	std::set<CallableDeclaration const*> m_scanned;
+	bool m_canWriteState{};
+};
+
 template <typename T>
 static bool doesAlways(const Statement* st) {
 	auto rec = [] (const Statement* s) {
@@ -281,6 +352,33 @@ const ContractDefinition* getSuperContract(const ContractDefinition* currentCont
 											const ContractDefinition* mainContract,
 											const string& fname);
 
+// Functions of a contract and its base contracts, indexed by name. It is built once per contract,
+// so that the lookups above don't rescan the inheritance chain (and each other) on every call.
+class ContractFunctionIndex {
+public:
+	explicit ContractFunctionIndex(ContractDefinition const* contract);
+
+	// Same as getContractFunctionPairs(contract)
+	vector<std::pair<FunctionDefinition const*, ContractDefinition const*>> const& functionPairs() const {
+		return m_functionPairs;
+	}
+	// Same as getContractFunctions(contract)
+	vector<FunctionDefinition const*> const& functions() const { return m_functions; }
+	// Same as getContractFunctions(contract, funcName)
+	vector<FunctionDefinition const*> const& functions(const string& funcName) const;
+	// Same as getFunction(c, functionName) for the contract or one of its bases
+	FunctionDefinition const* function(ContractDefinition const* c, const string& functionName) const;
+	// Same as getSuperContract(currentContract, contract, fname)
+	ContractDefinition const* superContract(ContractDefinition const* currentContract, const string& fname) const;
+
+private:
+	vector<ContractDefinition const*> m_chain;
+	vector<std::pair<FunctionDefinition const*, ContractDefinition const*>> m_functionPairs;
+	vector<FunctionDefinition const*> m_functions;
+	string_map<vector<FunctionDefinition const*>> m_functionsByName;
+	std::map<ContractDefinition const*, string_map<FunctionDefinition const*>> m_definedFunctions;
+};
+
 [[noreturn]]
 void cast_error(const ASTNode& node, const string& error_message);
 
@@ -289,6 +387,18 @@ void cast_warning(const ASTNode& node, const string& error_message);
 [[noreturn]]
 void fatal_error(const string &error_message);
 
+// Adds errors collected by another reporter (e.g. in another thread) to the current one
+void append_errors(const ErrorList& errors);
+
+// While alive, cast_error, cast_warning and fatal_error of the current thread report to errorReporter
+class ErrorReporterScope: private boost::noncopyable {
+public:
+	explicit ErrorReporterScope(ErrorReporter* errorReporter);
+	~ErrorReporterScope();
+private:
+	ErrorReporter* m_previous;
+};
+
 class PragmaDirectiveHelper {
 public:
 	explicit PragmaDirectiveHelper(std::vector<PragmaDirective const *> const& _pragmaDirectives) :
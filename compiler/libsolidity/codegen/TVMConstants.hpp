@@ -27,6 +27,8 @@ namespace TvmConst {
 	}
 	namespace C7 {
 		const int TempFunctionReturnBuffer = 8;
+		// bits of the mask of lazily loaded state variables, see TVMCompilerContext::lazyStateMaskGlobal
+		const int LazyStateMaskBits = 256;
 	}
 	namespace SENDRAWMSG {
 		const int DefaultFlag = 1;
@@ -45,9 +47,16 @@ namespace TvmConst {
 			const int ReplayProtection  = 52;
 			const int AddressUnpackException = 53;
 			const int InsertPubkeyException = 55;
+			const int WrongFunctionId = 60;
 		}
 	}
 	const int CellBitLength = 1023;
+	namespace CodeSize {
+		// Calls of functions and macros become "CALL $name$", i.e. CALLDICT with a short id
+		const int CallBits = 16;
+		// A function in the code dictionary: the key, the edge label and the implicit return
+		const int FunctionBits = 40;
+	}
 	const int ArrayKeyLength = 32;
 	const int MaxPushSliceLength = 249; // PUSHSLICE xSSSS;    SSSS.length() <= MaxPushSliceLength
 	const int MaxSTSLICECONST = 7 * 8; // STSLICECONST xSSSS;    SSSS.length() <= MaxSTSLICECONST
@@ -16,15 +16,27 @@
  * AST to TVM bytecode contract compiler
  */
 
+#include <atomic>
+#include <optional>
+#include <thread>
+
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/range/adaptor/map.hpp>
 
+#include <libsolutil/CommonIO.h>
+#include <libsolutil/JSON.h>
+#include <libsolutil/PassTimer.h>
+
 #include "TVMABI.hpp"
+#include "TVMAssembler.hpp"
+#include "TVMCallGraph.hpp"
 #include "TVMContractCompiler.hpp"
 #include "TVMExpressionCompiler.hpp"
 #include "TVMFunctionCompiler.hpp"
+#include "TVMGasEstimator.hpp"
 #include "TVMInlineFunctionChecker.hpp"
 #include "TVMOptimizations.hpp"
+#include "TVMOutliner.hpp"
 
 using namespace solidity::frontend;
 
@@ -173,103 +185,175 @@ SETGLOB 6
 )");
 }
 
-bool TVMContractCompiler::m_optionsEnabled = false;
-TvmOption TVMContractCompiler::m_tvmOption = TvmOption::Code;
-bool TVMContractCompiler::m_outputProduced = false;
-bool TVMContractCompiler::g_without_logstr = false;
-bool TVMContractCompiler::g_disable_optimizer = false;
-langutil::ErrorReporter* TVMContractCompiler::g_errorReporter{};
-std::vector<ContractDefinition const*> TVMContractCompiler::m_allContracts;
-std::string TVMContractCompiler::m_mainContractName;
-std::string TVMContractCompiler::m_fileName;
-std::string TVMContractCompiler::m_outputFolder;
-bool TVMContractCompiler::m_outputToFile = false;
+TVMContractCompiler::TVMContractCompiler(TVMCompilerSession& session, std::string fileName, bool outputToFile) :
+	m_session{session},
+	m_fileName{std::move(fileName)},
+	m_outputToFile{outputToFile} {
+
+}
 
 void TVMContractCompiler::generateABI(ContractDefinition const *contract,
 												  std::vector<PragmaDirective const *> const &pragmaDirectives) {
-	m_outputProduced = true;
+	util::PassTimer::Scope timer{m_session.passTimer(), "ABI", contract->name()};
+	m_session.setOutputProduced();
 
 	if (m_outputToFile) {
-		ofstream ofile;
-		ensurePathExists();
-		ofile.open(m_fileName + ".abi.json");
-		if (!ofile)
-			fatal_error("Failed to open the output file: " + m_fileName + ".abi.json");
-		TVMABI::generateABI(contract, pragmaDirectives, &ofile);
-		ofile.close();
-		cout << "ABI was generated and saved to file " << m_fileName << ".abi.json" << endl;
+		ostringstream abi;
+		TVMABI::generateABI(contract, pragmaDirectives, &abi);
+		m_session.writeArtifact("ABI", m_fileName + ".abi.json", abi.str());
 	} else {
-		TVMABI::generateABI(contract, pragmaDirectives);
+		TVMABI::generateABI(contract, pragmaDirectives, &m_session.out());
 	}
 
 }
 
-void TVMContractCompiler::printStorageScheme(int v, const std::vector<StructCompiler::Node> &nodes, const int tabs) {
+double TVMContractCompiler::printStorageScheme(int v, const std::vector<StructCompiler::Node> &nodes,
+												TVMCompilerContext const& ctx, const int tabs) {
+	// every cell on the path to a field costs loading of a reference
+	double cost = 0;
 	for (int i = 0; i < tabs; ++i) {
-		std::cout << " ";
+		m_session.out() << " ";
 	}
 	for (const StructCompiler::Field& field : nodes[v].getFields()) {
-		std::cout << " " << field.member->name();
+		m_session.out() << " " << field.member->name();
+		cost += tabs * ctx.stateVarAccessCount(field.member);
 	}
-	std::cout << std::endl;
+	m_session.out() << std::endl;
 
 	for (const int to : nodes[v].getChildren()) {
-		printStorageScheme(to, nodes, tabs + 1);
+		cost += printStorageScheme(to, nodes, ctx, tabs + 1);
 	}
+	return cost;
 }
 
 void
 TVMContractCompiler::proceedDumpStorage(ContractDefinition const *contract, PragmaDirectiveHelper const &pragmaHelper) {
-	m_outputProduced = true;
+	m_session.setOutputProduced();
 
-	TVMCompilerContext ctx(contract, pragmaHelper);
+	TVMCompilerContext ctx(contract, pragmaHelper, m_session.settings());
 	CodeLines code;
 	StackPusherHelper pusher{&ctx};
 	const std::vector<StructCompiler::Node>& nodes = pusher.structCompiler().getNodes();
-	printStorageScheme(0, nodes);
+	double cost = printStorageScheme(0, nodes, ctx);
+	if (m_session.settings().hotColdLayout) {
+		m_session.out() << "Estimated cost (accesses * depth): " << cost << std::endl;
+	}
+	if (m_session.settings().packCells) {
+		// the layouts without packing
+		const int skipData = 256 + (ctx.storeTimestampInC4()? 64 : 0) + 1;
+		StructCompiler c4{nullptr, ctx.c4StateVariables(), skipData, true};
+		m_session.out() << "Cells: " << nodes.size() << " (" << c4.getNodes().size() << " without packing)" << std::endl;
+		for (ContractDefinition const* base : contract->annotation().linearizedBaseContracts) {
+			for (StructDefinition const* structDefinition : base->definedStructs()) {
+				std::vector<VariableDeclaration const*> members;
+				for (ASTPointer<VariableDeclaration> const& member : structDefinition->members()) {
+					members.push_back(member.get());
+				}
+				StructCompiler packed{&pusher, members, 0, false};
+				StructCompiler unpacked{nullptr, members, 0, false};
+				if (packed.getNodes().size() < unpacked.getNodes().size()) {
+					m_session.out() << "Struct " << structDefinition->name() << ": " << packed.getNodes().size() <<
+						" cells (" << unpacked.getNodes().size() << " without packing)" << std::endl;
+				}
+			}
+		}
+	}
 
 }
 
 void TVMContractCompiler::proceedContract(ContractDefinition const *contract, PragmaDirectiveHelper const &pragmaHelper) {
-	m_outputProduced = true;
+	m_session.setOutputProduced();
 	CodeLines code;
-	if (getFunction(contract, "tvm_mode0")) {
-		code = proceedContractMode0(contract, pragmaHelper);
-	} else {
-		code = proceedContractMode1(contract, pragmaHelper);
+	{
+		util::PassTimer::Scope timer{m_session.passTimer(), "TVM codegen", contract->name()};
+		if (getFunction(contract, "tvm_mode0")) {
+			code = proceedContractMode0(contract, pragmaHelper);
+		} else {
+			code = proceedContractMode1(contract, pragmaHelper);
+		}
 	}
 
 	if (m_outputToFile) {
-		ofstream ofile;
-		ensurePathExists();
-		ofile.open(m_fileName + ".code");
-		if (!ofile)
-			fatal_error("Failed to open the output file: " + m_fileName + ".code");
-		ofile << code.str();
-		ofile.close();
-		cout << "Code was generated and saved to file " << m_fileName << ".code" << endl;
+		m_session.writeArtifact("Code", m_fileName + ".code", [&](std::ostream& out) {
+			code.print(out);
+		});
 	} else {
-		cout << code.str();
+		code.print(m_session.out());
+	}
+
+	if (m_session.settings().gasReport) {
+		std::string report;
+		{
+			util::PassTimer::Scope timer{m_session.passTimer(), "TVM gas estimator", contract->name()};
+			report = util::jsonPrettyPrint(TVMGasEstimator{code}.report()) + "\n";
+		}
+		if (m_outputToFile) {
+			m_session.writeArtifact("Gas report", m_fileName + ".gas.json", report);
+		} else {
+			m_session.out() << report;
+		}
 	}
 
+	if (!m_session.settings().bocStdlib.empty()) {
+		assembleContract(contract, pragmaHelper, code);
+	}
 }
 
-static void optimize_and_append_code(CodeLines& code, const StackPusherHelper& pusher, bool disable_optimizer) {
-	if (disable_optimizer)
-		code.append(pusher.code());
-	else
-		code.append(optimize_code(pusher.code()));
+void TVMContractCompiler::assembleContract(ContractDefinition const* contract, PragmaDirectiveHelper const& pragmaHelper,
+										   CodeLines const& code) {
+	util::PassTimer::Scope timer{m_session.passTimer(), "TVM assembler", contract->name()};
+	CodeLines stdlib;
+	std::istringstream stdlibText{util::readFileAsString(m_session.settings().bocStdlib)};
+	for (std::string line; std::getline(stdlibText, line); ) {
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		stdlib.lines.push_back(Instruction::parse(line));
+	}
+
+	// ids of public functions are the same as in ABI, see TVMABI::generateABI
+	TVMCompilerContext ctx(contract, pragmaHelper, m_session.settings());
+	StackPusherHelper pusher{&ctx};
+	EncodeFunctionParams encoder{&pusher};
+	std::map<std::string, uint32_t> publicFunctionIds;
+	if (FunctionDefinition const* constructor = contract->constructor()) {
+		publicFunctionIds["constructor"] = encoder.calculateFunctionID(constructor) & 0x7FFFFFFFu;
+	} else {
+		auto v = ast_vec<VariableDeclaration>();
+		publicFunctionIds["constructor"] = encoder.calculateFunctionID("constructor", v, &v) & 0x7FFFFFFFu;
+	}
+	for (ContractDefinition const* base : contract->annotation().linearizedBaseContracts) {
+		for (FunctionDefinition const* function : base->definedFunctions()) {
+			if (function->isPublic() && !isTvmIntrinsic(function->name()) && !function->isConstructor() &&
+				!function->isReceive() && !function->isFallback() && !function->isOnBounce()) {
+				const uint32_t id = function->functionID() != 0 ? function->functionID() :
+									encoder.calculateFunctionID(function) & 0x7FFFFFFFu;
+				publicFunctionIds.emplace(function->name(), id);
+			}
+		}
+	}
+
+	bytes stateInit = TVMAssembler{code, stdlib, std::move(publicFunctionIds)}.stateInit();
+	// not .tvc, the layout differs from the one of tvm_linker
+	m_session.writeArtifact("StateInit", m_fileName + ".boc", std::string(stateInit.begin(), stateInit.end()));
+}
+
+CodeLines TVMContractCompiler::optimizeIfNeed(StackPusherHelper const& pusher) const {
+	if (!m_session.settings().optimize)
+		return pusher.code();
+	util::PassTimer::Scope timer{m_session.passTimer(), "TVM optimizer", pusher.ctx().getContract()->name()};
+	return optimize_code(pusher.code());
 }
 
 CodeLines
 TVMContractCompiler::proceedContractMode0(ContractDefinition const *contract, PragmaDirectiveHelper const &pragmaHelper) {
 	CodeLines code;
 	for (FunctionDefinition const* _function : getContractFunctions(contract)) {
-		TVMCompilerContext ctx(contract, pragmaHelper);
+		TVMCompilerContext ctx(contract, pragmaHelper, m_session.settings());
 		StackPusherHelper pusher{&ctx};
 		TVMFunctionCompiler tvm(pusher, false, 0, _function, 0);
 		tvm.generatePrivateFunctionWithoutHeader();
-		optimize_and_append_code(code, pusher, g_disable_optimizer);
+		code.append(optimizeIfNeed(pusher));
 	}
 
 	return code;
@@ -277,17 +361,27 @@ TVMContractCompiler::proceedContractMode0(ContractDefinition const *contract, Pr
 
 CodeLines
 TVMContractCompiler::proceedContractMode1(ContractDefinition const *contract, PragmaDirectiveHelper const &pragmaHelper) {
-	TVMCompilerContext ctx(contract, pragmaHelper);
-	CodeLines code;
+	TVMCompilerContext ctx(contract, pragmaHelper, m_session.settings());
+	std::vector<CodegenJob> jobs;
 
 	fillInlineFunctions(ctx, contract);
 
+	// Adds a job generating one function (or nullptr for the contract-wide ones) with generate
+	auto addJob = [&](std::string name, FunctionDefinition const* function,
+					  std::function<void(StackPusherHelper&)> generate) {
+		jobs.push_back({std::move(name), [this, function, generate = std::move(generate)](TVMCompilerContext& ctx) {
+			ctx.m_currentFunction = function;
+			StackPusherHelper pusher{&ctx};
+			generate(pusher);
+			return optimizeIfNeed(pusher);
+		}});
+	};
+
 	// generate global constructor which inlines all contract constructors
 	if (!ctx.isStdlib()) {
-		StackPusherHelper pusher{&ctx};
-		TVMConstructorCompiler compiler(pusher);
-		compiler.generateConstructors();
-		optimize_and_append_code(code, pusher, g_disable_optimizer);
+		addJob("constructor", nullptr, [](StackPusherHelper& pusher) {
+			TVMConstructorCompiler(pusher).generateConstructors();
+		});
 	}
 
 	for (ContractDefinition const* c : contract->annotation().linearizedBaseContracts | boost::adaptors::reversed) {
@@ -297,90 +391,215 @@ TVMContractCompiler::proceedContractMode1(ContractDefinition const *contract, Pr
 			    isFunctionForInlining(_function)) {
 				continue;
 			}
-			ctx.m_currentFunction = _function;
 			if (_function->visibility() == Visibility::TvmGetter) {
-				StackPusherHelper pusher{&ctx};
-				TVMFunctionCompiler tvm(pusher, true, 0, _function, 0);
-				tvm.generateTvmGetter(_function);
-				optimize_and_append_code(code, pusher, g_disable_optimizer);
+				addJob(_function->name(), _function, [_function](StackPusherHelper& pusher) {
+					TVMFunctionCompiler(pusher, true, 0, _function, 0).generateTvmGetter(_function);
+				});
 			} else if (isMacro(_function->name())) {
-				// TODO: These four lines below are copied many times across this file.
-				// 		 Would it be possible to shorted it by making a pattern?
-				StackPusherHelper pusher{&ctx};
-				TVMFunctionCompiler tvm(pusher, false, 0, _function, 0);
-				tvm.generateMacro();
-				optimize_and_append_code(code, pusher, g_disable_optimizer);
+				addJob(_function->name(), _function, [_function](StackPusherHelper& pusher) {
+					TVMFunctionCompiler(pusher, false, 0, _function, 0).generateMacro();
+				});
 			} else if (_function->name() == "onCodeUpgrade") {
-				StackPusherHelper pusher{&ctx};
-				TVMFunctionCompiler tvm(pusher, false, 0, _function, 0);
-				tvm.generateOnCodeUpgrade();
-				optimize_and_append_code(code, pusher, g_disable_optimizer);
+				addJob(_function->name(), _function, [_function](StackPusherHelper& pusher) {
+					TVMFunctionCompiler(pusher, false, 0, _function, 0).generateOnCodeUpgrade();
+				});
 			} else if (_function->name() == "onTickTock") {
-				StackPusherHelper pusher{&ctx};
-				TVMFunctionCompiler tvm(pusher, false, 0, _function, 0);
-				tvm.generateOnTickTock();
-				optimize_and_append_code(code, pusher, g_disable_optimizer);
+				addJob(_function->name(), _function, [_function](StackPusherHelper& pusher) {
+					TVMFunctionCompiler(pusher, false, 0, _function, 0).generateOnTickTock();
+				});
 			} else if (_function->name() == "offchainConstructor") {
-				StackPusherHelper pusher{&ctx};
-				TVMConstructorCompiler constructorCompiler(pusher);
-				constructorCompiler.generateOffChainConstructor();
-				optimize_and_append_code(code, pusher, g_disable_optimizer);
+				addJob(_function->name(), _function, [](StackPusherHelper& pusher) {
+					TVMConstructorCompiler(pusher).generateOffChainConstructor();
+				});
 			} else {
 				if (_function->isPublic()) {
-					bool isBaseMethod = _function != getContractFunctions(contract, _function->name()).back();
+					bool isBaseMethod = _function != ctx.functionIndex().functions(_function->name()).back();
 					if (!isBaseMethod) {
-						StackPusherHelper pusher0{&ctx};
-						TVMFunctionCompiler tvm0(pusher0, true, 0, _function, 0);
-						tvm0.generatePublicFunction();
-						optimize_and_append_code(code, pusher0, g_disable_optimizer);
+						addJob(_function->name(), _function, [_function](StackPusherHelper& pusher) {
+							TVMFunctionCompiler(pusher, true, 0, _function, 0).generatePublicFunction();
+						});
 					}
 				}
-				StackPusherHelper pusher{&ctx};
-				TVMFunctionCompiler tvm(pusher, false, 0, _function, 0);
-				tvm.generatePrivateFunction();
-				optimize_and_append_code(code, pusher, g_disable_optimizer);
+				addJob(ctx.getFunctionInternalName(_function), _function, [_function](StackPusherHelper& pusher) {
+					TVMFunctionCompiler(pusher, false, 0, _function, 0).generatePrivateFunction();
+				});
 			}
 		}
 	}
 
 	if (!ctx.isStdlib()) {
-		{
-			StackPusherHelper pusher{&ctx};
-			TVMFunctionCompiler tvm(pusher);
-			tvm.generateMainExternal();
-			optimize_and_append_code(code, pusher, g_disable_optimizer);
-		}
-		{
-			StackPusherHelper pusher{&ctx};
+		addJob("main_external", nullptr, [](StackPusherHelper& pusher) {
+			TVMFunctionCompiler(pusher).generateMainExternal();
+		});
+		addJob("c7_to_c4", nullptr, [](StackPusherHelper& pusher) {
 			pusher.generateC7ToT4Macro();
-			optimize_and_append_code(code, pusher, g_disable_optimizer);
+		});
+		addJob("c4_to_c7", nullptr, [](StackPusherHelper& pusher) {
+			TVMFunctionCompiler(pusher).generateC4ToC7(false);
+		});
+		addJob("c4_to_c7_with_init_storage", nullptr, [](StackPusherHelper& pusher) {
+			TVMFunctionCompiler(pusher).generateC4ToC7(true);
+		});
+		if (ctx.lazyStateLoad()) {
+			for (VariableDeclaration const* variable : ctx.notConstantStateVariables()) {
+				addJob("lazy_c4_to_c7_" + variable->name(), nullptr, [variable](StackPusherHelper& pusher) {
+					TVMFunctionCompiler(pusher).generateLazyC4ToC7(variable);
+				});
+			}
 		}
-		{
-			StackPusherHelper pusher{&ctx};
-			TVMFunctionCompiler tvm(pusher);
-			tvm.generateC4ToC7(false);
-			optimize_and_append_code(code, pusher, g_disable_optimizer);
+		addJob("main_internal", nullptr, [](StackPusherHelper& pusher) {
+			TVMFunctionCompiler(pusher).generateMainInternal();
+		});
+	}
+
+	CodeLines code = runCodegenJobs(ctx, jobs);
+	if (ctx.isStdlib()) {
+		// all macros of stdlib are used by the linker
+		return code;
+	}
+	{
+		util::PassTimer::Scope timer{m_session.passTimer(), "TVM dead code elimination", contract->name()};
+		TVMCallGraph::removeUnreachableFunctions(code);
+	}
+	if (m_session.settings().outline) {
+		util::PassTimer::Scope timer{m_session.passTimer(), "TVM outliner", contract->name()};
+		code = TVMOutliner{std::move(code)}.outline();
+	}
+	return code;
+}
+
+namespace {
+
+// Codegen reads annotations of AST nodes that are created on first access.
+// Touch all of them once, so that worker threads only read the AST.
+class AnnotationPreloader: public ASTConstVisitor {
+protected:
+	bool visitNode(ASTNode const& _node) override {
+		_node.annotation();
+		return true;
+	}
+};
+
+}
+
+CodeLines TVMContractCompiler::runCodegenJobs(TVMCompilerContext& ctx, std::vector<CodegenJob> const& jobs) {
+	std::vector<CodeLines> results(jobs.size());
+	unsigned jobQty = m_session.settings().jobs;
+	unsigned threadQty = jobQty == 0 ? std::thread::hardware_concurrency() : jobQty;
+	threadQty = std::min<size_t>(threadQty, jobs.size());
+	std::string const& contractName = ctx.getContract()->name();
+	auto generate = [&](size_t i, TVMCompilerContext& jobCtx) {
+		util::PassTimer::Scope timer{m_session.passTimer(), "TVM function codegen", contractName + "." + jobs[i].name};
+		results[i] = jobs[i].generate(jobCtx);
+	};
+
+	if (threadQty <= 1) {
+		for (size_t i = 0; i < jobs.size(); ++i) {
+			generate(i, ctx);
 		}
-		{
-			StackPusherHelper pusher{&ctx};
-			TVMFunctionCompiler tvm(pusher);
-			tvm.generateC4ToC7(true);
-			optimize_and_append_code(code, pusher, g_disable_optimizer);
+	} else {
+		AnnotationPreloader preloader;
+		for (ContractDefinition const* c : m_session.allContracts()) {
+			c->accept(preloader);
 		}
-		{
-			StackPusherHelper pusher{&ctx};
-			TVMFunctionCompiler tvm(pusher);
-			tvm.generateMainInternal();
-			optimize_and_append_code(code, pusher, g_disable_optimizer);
+
+		// Each job reports to its own error list. The lists are merged in job order
+		// below, so diagnostics are the same as in the serial build.
+		std::vector<ErrorList> errors(jobs.size());
+		std::vector<std::exception_ptr> failures(jobs.size());
+		std::atomic<size_t> nextJob{0};
+		std::atomic<size_t> firstFailure{jobs.size()};
+		auto worker = [&]() {
+			ASTNode::ReadOnlyAnnotationsScope readOnlyAnnotations;
+			TVMCompilerContext localCtx = ctx;
+			for (size_t i = nextJob++; i < jobs.size() && i < firstFailure; i = nextJob++) {
+				ErrorReporter errorReporter{errors[i]};
+				ErrorReporterScope errorReporterScope{&errorReporter};
+				try {
+					generate(i, localCtx);
+				} catch (...) {
+					failures[i] = std::current_exception();
+					size_t expected = firstFailure;
+					while (i < expected && !firstFailure.compare_exchange_weak(expected, i)) {
+					}
+				}
+			}
+		};
+		std::vector<std::thread> threads;
+		for (unsigned t = 0; t < threadQty; ++t) {
+			threads.emplace_back(worker);
+		}
+		for (std::thread& t : threads) {
+			t.join();
+		}
+
+		for (size_t i = 0; i < jobs.size(); ++i) {
+			append_errors(errors[i]);
+			if (failures[i]) {
+				std::rethrow_exception(failures[i]);
+			}
 		}
 	}
 
+	size_t lineQty = 0;
+	for (const CodeLines& result : results) {
+		lineQty += result.lines.size();
+	}
+	CodeLines code;
+	code.lines.reserve(lineQty);
+	for (CodeLines& result : results) {
+		code.append(std::move(result));
+	}
 	return code;
 }
 
+namespace {
+
+// In gas mode a function is inlined if its code fits into one cell and all the copies of it make
+// the code longer by one cell at most
+const int MaxGasInlineBits = TvmConst::CellBitLength;
+
+// Internal functions which may be inlined by TVMSettings::autoInline
+std::set<FunctionDefinition const*> autoInlineCandidates(TVMCompilerContext const& ctx, ContractDefinition const* contract) {
+	std::set<FunctionDefinition const*> candidates;
+	if (ctx.autoInline() == TvmAutoInline::None || ctx.isStdlib()) {
+		return candidates;
+	}
+	for (ContractDefinition const* base : contract->annotation().linearizedBaseContracts) {
+		for (FunctionDefinition const* f : base->definedFunctions()) {
+			// overridden functions are called only via super
+			if (ctx.getLocalFunction(f->name()) != f || !f->isImplemented() || f->isConstructor() ||
+				isFunctionForInlining(f) || isMacro(f->name()) || isTvmIntrinsic(f->name()) ||
+				f->visibility() == Visibility::External || f->visibility() == Visibility::TvmGetter ||
+				isIn(f->name(), "onCodeUpgrade", "onTickTock", "offchainConstructor", "afterSignatureCheck")) {
+				continue;
+			}
+			candidates.insert(f);
+		}
+	}
+	return candidates;
+}
+
+bool isWorthInlining(TvmAutoInline mode, int bits, int calls, bool keepsFunction) {
+	if (calls == 0) {
+		return false;
+	}
+	// the function is dropped as unused if all calls are inlined and it isn't used as a value
+	const int inlinedBits = calls * bits + (keepsFunction ? bits + TvmConst::CodeSize::FunctionBits : 0);
+	const int calledBits = calls * TvmConst::CodeSize::CallBits + bits + TvmConst::CodeSize::FunctionBits;
+	if (mode == TvmAutoInline::Gas) {
+		// Each inlined call saves CALL, RET and the load of the function's cell, but the callers get longer
+		// and each extra cell of their code is one more load. So a function called many times is inlined
+		// only if it's short.
+		return bits <= MaxGasInlineBits && inlinedBits - calledBits <= MaxGasInlineBits;
+	}
+	return inlinedBits <= calledBits;
+}
+
+}
+
 void TVMContractCompiler::fillInlineFunctions(TVMCompilerContext &ctx, ContractDefinition const *contract) {
 	std::map<std::string, FunctionDefinition const*> inlineFunctions;
-	TVMInlineFunctionChecker inlineFunctionChecker;
 	for (ContractDefinition const* base : contract->annotation().linearizedBaseContracts | boost::adaptors::reversed) {
 		for (FunctionDefinition const* function : base->definedFunctions()) {
 			if (isFunctionForInlining(function)) {
@@ -388,14 +607,55 @@ void TVMContractCompiler::fillInlineFunctions(TVMCompilerContext &ctx, ContractD
 			}
 		}
 	}
+
+	std::set<FunctionDefinition const*> autoInline = autoInlineCandidates(ctx, contract);
+	auto isInlined = [&](FunctionDefinition const* f) {
+		return isFunctionForInlining(f) || autoInline.count(f) != 0;
+	};
+	if (!autoInline.empty()) {
+		// recursive functions can't be inlined
+		TVMInlineFunctionChecker callGraph{isInlined};
+		for (FunctionDefinition const* function : inlineFunctions | boost::adaptors::map_values) {
+			function->accept(callGraph);
+		}
+		for (FunctionDefinition const* function : autoInline) {
+			function->accept(callGraph);
+		}
+		for (FunctionDefinition const* function : callGraph.recursiveFunctions()) {
+			autoInline.erase(function);
+		}
+	}
+
+	TVMInlineFunctionChecker inlineFunctionChecker{isInlined};
 	for (FunctionDefinition const* function : inlineFunctions | boost::adaptors::map_values) {
 		function->accept(inlineFunctionChecker);
 	}
+	for (FunctionDefinition const* function : autoInline) {
+		function->accept(inlineFunctionChecker);
+	}
 
 	std::vector<FunctionDefinition const*> order = inlineFunctionChecker.functionOrder();
+	std::optional<InternalCallCounter> callCounter;
+	if (!autoInline.empty()) {
+		callCounter.emplace(*contract);
+	}
 
 	for (const auto& function : order) {
 		std::string fname = functionName(function);
+		if (autoInline.count(function)) {
+			// Callees are compiled first, the ones which are inlined get into m_autoInlinedFunctions
+			// before their callers are compiled. Other calls stay CALL $name$.
+			ctx.m_currentFunction = function;
+			StackPusherHelper pusher{&ctx};
+			TVMFunctionCompiler compiler{pusher, false, 0, function, 0};
+			compiler.makeInlineFunctionCall(true);
+			if (isWorthInlining(ctx.autoInline(), pusher.code().bits(), callCounter->calls(fname),
+								callCounter->otherUses(fname) != 0)) {
+				ctx.m_inlinedFunctions[fname] = pusher.code();
+				ctx.m_autoInlinedFunctions.insert(function);
+			}
+			continue;
+		}
 		CodeLines code;
 		CodeLines codeWithout;
 		bool isFunctionForMainInternal =
@@ -418,7 +678,8 @@ void TVMContractCompiler::fillInlineFunctions(TVMCompilerContext &ctx, ContractD
 			codeWithout.append(pusher.code());
 
 			if (isFunctionForMainInternal) {
-				if (function->stateMutability() >= StateMutability::NonPayable) {
+				if (function->stateMutability() >= StateMutability::NonPayable &&
+					StateWriteScanner{*contract, *function}.canWriteState()) {
 					code.push("CALL $c7_to_c4$");
 					codeWithout.push("CALL $c7_to_c4$");
 				}
@@ -429,16 +690,3 @@ void TVMContractCompiler::fillInlineFunctions(TVMCompilerContext &ctx, ContractD
 		ctx.m_inlinedFunctions[fname + "_without"] = codeWithout;
 	}
 }
-
-void TVMContractCompiler::ensurePathExists()
-{
-	if (m_outputFolder.empty())
-		return;
-
-	namespace fs = boost::filesystem;
-	// create directory if not existent
-	fs::path p(m_outputFolder);
-	// Do not try creating the directory if the first item is . or ..
-	if (p.filename() != "." && p.filename() != "..")
-		fs::create_directories(p);
-}
@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "TVM.h"
 #include "TVMStructCompiler.hpp"
 #include "TVMPusher.hpp"
@@ -42,30 +44,36 @@ private:
 	void c4ToC7WithMemoryInitAndConstructorProtection();
 };
 
+// Generates (and optimizes) code of one function of the contract.
+struct CodegenJob {
+	std::string name;	// function or macro name, used by --time-passes
+	std::function<CodeLines(TVMCompilerContext&)> generate;
+};
+
 class TVMContractCompiler: private boost::noncopyable {
-public:
-	static std::vector<ContractDefinition const*> m_allContracts;
-	static std::string m_mainContractName;
-	static bool m_outputToFile;
-	static std::string m_fileName;
-	static std::string m_outputFolder;
-	static bool m_optionsEnabled;
-	static TvmOption m_tvmOption;
-	static bool m_outputProduced;
-	static bool g_without_logstr;
-	static bool g_disable_optimizer;
-	static langutil::ErrorReporter* g_errorReporter;
+	TVMCompilerSession& m_session;
+	std::string m_fileName;
+	bool m_outputToFile;
 
 public:
-	static void generateABI(ContractDefinition const* contract, std::vector<PragmaDirective const *> const& pragmaDirectives);
-	static void printStorageScheme(int v, const std::vector<StructCompiler::Node>& nodes, const int tabs = 0);
-	static void proceedDumpStorage(ContractDefinition const* contract, PragmaDirectiveHelper const& pragmaHelper);
-	static void proceedContract(ContractDefinition const* contract, PragmaDirectiveHelper const& pragmaHelper);
-	static CodeLines proceedContractMode0(ContractDefinition const* contract, PragmaDirectiveHelper const& pragmaHelper);
-	static CodeLines proceedContractMode1(ContractDefinition const* contract, PragmaDirectiveHelper const& pragmaHelper);
+	TVMContractCompiler(TVMCompilerSession& session, std::string fileName, bool outputToFile);
+
+	void generateABI(ContractDefinition const* contract, std::vector<PragmaDirective const *> const& pragmaDirectives);
+	// returns the estimated cost of the accesses of the state vars in the subtree
+	double printStorageScheme(int v, const std::vector<StructCompiler::Node>& nodes, TVMCompilerContext const& ctx,
+							  const int tabs = 0);
+	void proceedDumpStorage(ContractDefinition const* contract, PragmaDirectiveHelper const& pragmaHelper);
+	void proceedContract(ContractDefinition const* contract, PragmaDirectiveHelper const& pragmaHelper);
+	CodeLines proceedContractMode0(ContractDefinition const* contract, PragmaDirectiveHelper const& pragmaHelper);
+	CodeLines proceedContractMode1(ContractDefinition const* contract, PragmaDirectiveHelper const& pragmaHelper);
 	static void fillInlineFunctions(TVMCompilerContext& ctx, ContractDefinition const* contract);
+	CodeLines runCodegenJobs(TVMCompilerContext& ctx, std::vector<CodegenJob> const& jobs);
+	// Writes the StateInit of the contract (<contract>.boc) assembled from the code, see TVMSettings::bocStdlib
+	void assembleContract(ContractDefinition const* contract, PragmaDirectiveHelper const& pragmaHelper,
+						  CodeLines const& code);
 
-	static void ensurePathExists();
+private:
+	CodeLines optimizeIfNeed(StackPusherHelper const& pusher) const;
 };
 
 }	// end solidity::frontend
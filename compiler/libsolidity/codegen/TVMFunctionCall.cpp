@@ -108,10 +108,10 @@ bool FunctionCallCompiler::checkForSuper(MemberAccess const &_node, Type::Catego
 		return false;
 	m_pusher.push(0, ";; super");
 	string fname = _node.memberName();
-	auto super = getSuperContract(m_pusher.ctx().getContract(m_pusher.ctx().m_currentFunction),
-	                              m_pusher.ctx().getContract(), fname);
+	ContractFunctionIndex const& index = m_pusher.ctx().functionIndex();
+	auto super = index.superContract(m_pusher.ctx().getContract(m_pusher.ctx().m_currentFunction), fname);
 	solAssert(super, "#1000");
-	if (getFunction(super, fname)) {
+	if (index.function(super, fname)) {
 		auto functionName = super->name() + "_" + fname;
 		m_pusher.push( 0, ";; Super call " + functionName);
 		if (auto ft = to<FunctionType>(getType(&_node))) {
@@ -899,7 +899,7 @@ bool FunctionCallCompiler::checkForTvmFunction(const MemberAccess &_node) {
 		if (auto literal = to<Literal>(logstr)) {
 			if (literal->value().length() > 15)
 				cast_error(_node, "Parameter string should have length no more than 15 chars");
-			if (!TVMContractCompiler::g_without_logstr) {
+			if (!m_pusher.ctx().withoutLogstr()) {
 				m_pusher.push(0, "PRINTSTR " + literal->value());
 			}
 		} else {
@@ -1122,7 +1122,7 @@ bool FunctionCallCompiler::checkLocalFunctionCall(const Identifier *identifier)
 	for (const auto& arg : m_arguments) {
 		acceptExpr(arg.get());
 	}
-	if (isFunctionForInlining(funDef)) {
+	if (isFunctionForInlining(funDef) || m_pusher.ctx().isInlined(function)) {
 		auto &codeLines = m_pusher.ctx().m_inlinedFunctions.at(functionName);
 		int nParams = functionType->parameterTypes().size();
 		int nRetVals = functionType->returnParameterTypes().size();
@@ -1236,7 +1236,7 @@ bool FunctionCallCompiler::checkForIdentifier() {
 		if (auto literal = to<Literal>(logstr)) {
 			if (literal->value().length() > 15)
 				cast_error(m_functionCall, "Parameter string should have length no more than 15 chars");
-			if (TVMContractCompiler::g_without_logstr) {
+			if (m_pusher.ctx().withoutLogstr()) {
 				return true;
 			}
 			m_pusher.push(0, "PRINTSTR " + literal->value());
@@ -154,7 +154,14 @@ LDU 1       ; pubkey [timestamp] constructor_flag memory
 )");
 	if (!pusherHelper.ctx().notConstantStateVariables().empty()) {
 		pusherHelper.getStack().change(+1); // slice
-		pusherHelper.structCompiler().sliceToStateVarsToC7();
+		if (pusherHelper.ctx().lazyStateLoad()) {
+			// state vars are decoded from this slice on first access, see generateLazyC4ToC7
+			pusherHelper.setGlob(pusherHelper.ctx().lazyStateSliceGlobal());
+			pusherHelper.pushInt(0);
+			pusherHelper.setGlob(pusherHelper.ctx().lazyStateMaskGlobal());
+		} else {
+			pusherHelper.structCompiler().sliceToStateVarsToC7();
+		}
 	} else {
 		pusherHelper.push(0, "ENDS");
 	}
@@ -194,6 +201,11 @@ PUSHCONT {
 	PLDDICT   ; D
 )");
 		m_pusher.addTabs();
+		if (m_pusher.ctx().lazyStateLoad() && !m_pusher.ctx().notConstantStateVariables().empty()) {
+			// all state vars are set below, there is nothing to load from c4
+			m_pusher.pushInt(-1);
+			m_pusher.setGlob(m_pusher.ctx().lazyStateMaskGlobal());
+		}
 		int shift = 0;
 		for (VariableDeclaration const* v : m_pusher.ctx().getContract()->stateVariablesIncludingInherited()) {
 			if (v->isConstant()) {
@@ -247,6 +259,22 @@ IFELSE
 	m_pusher.push(0, " ");
 }
 
+void TVMFunctionCompiler::generateLazyC4ToC7(VariableDeclaration const* variable) {
+	// Decodes the state var from the rest of c4 saved by c4_to_c7 if it isn't loaded yet
+	m_pusher.generateMacro("lazy_c4_to_c7_" + variable->name());
+	m_pusher.getGlob(m_pusher.ctx().lazyStateMaskGlobal());
+	m_pusher.pushLazyStateBit(variable);
+	m_pusher.push(-1, "AND");
+	m_pusher.startContinuation();
+	m_pusher.getGlob(m_pusher.ctx().lazyStateSliceGlobal());
+	m_pusher.structCompiler().pushMember(variable->name(), false, false);
+	m_pusher.setGlob(m_pusher.ctx().getStateVarIndex(variable));
+	m_pusher.markStateVarAsLoaded(variable);
+	m_pusher.endContinuation();
+	m_pusher.push(-1, "IFNOT");
+	m_pusher.push(0, " ");
+}
+
 void TVMFunctionCompiler::generateTvmGetter(FunctionDefinition const *_function) {
 	m_pusher.generateGlobl(_function->name(), true);
 	decodeFunctionParamsAndLocateVars();
@@ -315,7 +343,8 @@ void TVMFunctionCompiler::generateOnTickTock() {
 
 	visitFunctionWithModifiers();
 
-	if (m_function->stateMutability() != StateMutability::Pure) {
+	if (m_function->stateMutability() != StateMutability::Pure &&
+		StateWriteScanner{*m_pusher.ctx().getContract(), *m_function}.canWriteState()) {
 		m_pusher.pushPrivateFunctionOrMacroCall(0, "c7_to_c4");
 	}
 	m_pusher.push(0, " ");
@@ -371,8 +400,11 @@ ISNULL
 	visitFunctionWithModifiers();
 
 	// c7_to_c4 if need
+	// If the function can't change the state, c4 is saved only for external messages
+	// because of the timestamp of replay protection and afterSignatureCheck
 	solAssert(m_pusher.getStack().size() == 0, "");
-	if (m_function->stateMutability() == StateMutability::NonPayable) {
+	if (m_function->stateMutability() == StateMutability::NonPayable &&
+		StateWriteScanner{*m_pusher.ctx().getContract(), *m_function}.canWriteState()) {
 		m_pusher.pushPrivateFunctionOrMacroCall(0, "c7_to_c4");
 	} else {
 		m_pusher.push(0, "EQINT -1"); // is it ext msg?
@@ -391,7 +423,7 @@ ISNULL
 
 void TVMFunctionCompiler::generatePrivateFunction() {
 	std::string name = m_pusher.ctx().getFunctionInternalName(m_function);
-	if (m_function != getContractFunctions(m_pusher.ctx().getContract(), m_function->name()).back()) {
+	if (m_function != m_pusher.ctx().functionIndex().functions(m_function->name()).back()) {
 		name = m_function->annotation().contract->name() + "_" + m_function->name();
 	}
 	m_pusher.generateGlobl(name, false);
@@ -552,7 +584,7 @@ void TVMFunctionCompiler::visitFunctionAfterModifiers() {
 		// stack: transaction_id return-params...
 		const int retQty = m_function->returnParameters().size();
 		const int targetStackSize = m_pusher.getStack().size() - retQty;
-		bool emitReturn = getFunction(m_pusher.ctx().getContract(), "tvm_dont_emit_events_on_return") == nullptr;
+		bool emitReturn = m_pusher.ctx().functionIndex().function(m_pusher.ctx().getContract(), "tvm_dont_emit_events_on_return") == nullptr;
 		if (emitReturn) {
 			emitOnPublicFunctionReturn();
 		}
@@ -722,11 +754,12 @@ bool TVMFunctionCompiler::visit(IfStatement const &_ifStatement) {
 	bool reverseOpcode = false;
 	if (_ifStatement.falseStatement() == nullptr) {
 		while(true) {
-			if (std::regex_match(m_pusher.code().lines.back(), std::regex("(\t*)EQINT 0")) ||
-				std::regex_match(m_pusher.code().lines.back(), std::regex("(\t*)NOT"))) {
+			const Instruction& lastLine = m_pusher.code().lines.back();
+			const bool isZero = lastLine.operands.size() == 1 && lastLine.operands[0] == Operand::integer(0);
+			if ((lastLine.opcode == Opcode::EQINT && isZero) || (lastLine.opcode == Opcode::NOT && lastLine.operands.empty())) {
 				m_pusher.pollLastOpcode();
 				reverseOpcode ^= true;
-			} else if (std::regex_match(m_pusher.code().lines.back(), std::regex("(\t*)NEQINT 0"))) {
+			} else if (lastLine.opcode == Opcode::NEQINT && isZero) {
 				m_pusher.pollLastOpcode();
 			} else {
 				break;
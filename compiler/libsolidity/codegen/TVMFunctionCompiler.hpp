@@ -61,6 +61,7 @@ public:
 	void makeInlineFunctionCall(bool alloc);
 
 	void generateC4ToC7(bool withInitMemory);
+	void generateLazyC4ToC7(VariableDeclaration const* variable);
 	void generateMacro();
 	void generateMainExternal();
 	void generateMainInternal();
@@ -0,0 +1,341 @@
+/*
+ * Copyright 2018-2020 TON DEV SOLUTIONS LTD.
+ *
+ * Licensed under the  terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the  GNU General Public License for more details at: https://www.gnu.org/licenses/gpl-3.0.html
+ */
+/**
+ * @author TON Labs <connect@tonlabs.io>
+ * @date 2020
+ * Static estimation of gas used by the generated functions
+ */
+
+#include <boost/range/adaptor/map.hpp>
+
+#include "TVMGasEstimator.hpp"
+
+using namespace solidity::frontend;
+
+namespace {
+
+const long long BasicGas = 10;
+const long long CellLoadGas = 100;
+const long long CellCreateGas = 500;
+const long long ImplicitRetGas = 5;
+// Length of instructions which are not in the opcode table, most TVM instructions take 16 bits
+const int UnknownInstructionBits = 16;
+
+}
+
+TVMGasEstimator::Cost TVMGasEstimator::Cost::unreachable() {
+	Cost cost;
+	cost.reachable = false;
+	return cost;
+}
+
+void TVMGasEstimator::Cost::add(long long gas_) {
+	gas.min += gas_;
+	gas.max += gas_;
+}
+
+void TVMGasEstimator::Cost::add(Cost const& next) {
+	if (!reachable || !next.reachable) {
+		*this = unreachable();
+		return;
+	}
+	unbounded = unbounded || next.unbounded;
+	gas.min += next.gas.min;
+	gas.max += next.gas.max;
+	loops.insert(next.loops.begin(), next.loops.end());
+}
+
+void TVMGasEstimator::Cost::merge(Cost const& other) {
+	if (!other.reachable) {
+		return;
+	}
+	if (!reachable) {
+		*this = other;
+		return;
+	}
+	unbounded = unbounded || other.unbounded;
+	gas.min = std::min(gas.min, other.gas.min);
+	gas.max = std::max(gas.max, other.gas.max);
+	loops.insert(other.loops.begin(), other.loops.end());
+}
+
+TVMGasEstimator::TVMGasEstimator(CodeLines const& code) : m_code{code} {
+	Function* current = nullptr;
+	for (size_t i = 0; i < m_code.lines.size(); ++i) {
+		Instruction const& line = m_code.lines[i];
+		if (line.depth != 0 || !line.isDirective()) {
+			continue;
+		}
+		const std::string name = line.operands.empty() ? "" : line.operands[0].name();
+		if (line.name == ".globl" || line.name == ".macro" || line.name == ".internal") {
+			if (current) {
+				current->end = i;
+			}
+			Function function;
+			function.kind = line.name == ".globl" ? "private" : line.name.substr(1);
+			function.begin = i + 1;
+			function.end = m_code.lines.size();
+			auto [it, inserted] = m_functions.emplace(name, function);
+			current = inserted ? &it->second : nullptr;
+			if (inserted) {
+				m_functionOrder.push_back(name);
+			}
+		} else if (line.name == ".internal-alias") {
+			if (current) {
+				current->end = i;
+			}
+			current = nullptr;
+			Operand const id = line.operands.size() == 2 ? Operand::parse(line.operands[1].text) : Operand{};
+			if (id.kind == Operand::Kind::Integer) {
+				m_functionIds.emplace(id.value, name);
+			}
+		} else if (line.name == ".public") {
+			auto it = m_functions.find(name);
+			if (it != m_functions.end()) {
+				it->second.kind = "public";
+			}
+		}
+	}
+}
+
+Json::Value TVMGasEstimator::report() {
+	Json::Value functions(Json::objectValue);
+	for (std::string const& name : m_functionOrder) {
+		Cost cost = functionCost(name);
+		Function const& function = m_functions.at(name);
+		Json::Value& json = functions[name];
+		json["kind"] = function.kind;
+		json["loops"] = Json::arrayValue;
+		if (cost.reachable) {
+			json["min"] = Json::Int64(cost.gas.min);
+			json["max"] = cost.unbounded ? Json::Value{} : Json::Value{Json::Int64(cost.gas.max)};
+			for (Range const& loop : cost.loops | boost::adaptors::map_values) {
+				Json::Value iteration(Json::objectValue);
+				iteration["min"] = Json::Int64(loop.min);
+				iteration["max"] = Json::Int64(loop.max);
+				json["loops"].append(iteration);
+			}
+		} else {
+			// every path throws an exception
+			json["min"] = Json::nullValue;
+			json["max"] = Json::nullValue;
+		}
+		if (cost.reachable && cost.unbounded) {
+			json["unbounded"] = true;
+		}
+		if (function.recursive) {
+			json["recursive"] = true;
+		}
+	}
+	Json::Value result(Json::objectValue);
+	result["functions"] = functions;
+	return result;
+}
+
+TVMGasEstimator::Cost TVMGasEstimator::functionCost(std::string const& name) {
+	Function& function = m_functions.at(name);
+	if (function.cost) {
+		return *function.cost;
+	}
+	if (function.inProgress) {
+		// the cost of the recursive call is unknown
+		function.recursive = true;
+		return Cost{};
+	}
+	function.inProgress = true;
+	size_t i = function.begin;
+	Cost cost = blockCost(i, function.end);
+	function.inProgress = false;
+	function.cost = cost;
+	return cost;
+}
+
+TVMGasEstimator::Cost TVMGasEstimator::blockCost(size_t& i, size_t end) {
+	Cost current;
+	Cost finished = Cost::unreachable(); // paths which left the block by RET, IFJMP and so on
+	std::vector<Cost> conts; // continuations pushed on the stack
+	auto popCont = [&]() {
+		if (conts.empty()) {
+			// e.g. a value of a function type, its code is unknown
+			Cost unknown;
+			unknown.unbounded = true;
+			return unknown;
+		}
+		Cost cont = conts.back();
+		conts.pop_back();
+		return cont;
+	};
+	auto addLoop = [&](Cost const& iteration) {
+		if (current.reachable && iteration.reachable) {
+			current.loops.emplace(i - 1, iteration.gas);
+			current.loops.insert(iteration.loops.begin(), iteration.loops.end());
+		}
+	};
+	auto jumpTo = [&](Cost const& cont) {
+		Cost jump = current;
+		jump.add(cont);
+		finished.merge(jump);
+	};
+	auto maybe = [](Cost const& cont) {
+		Cost skip;
+		skip.merge(cont);
+		return skip;
+	};
+
+	while (i < end) {
+		Instruction const& instruction = m_code.lines[i++];
+		if (instruction.isCommentOrEmpty() || instruction.isDirective()) {
+			continue;
+		}
+		if (instruction.opcode == Opcode::CONT_END) {
+			break;
+		}
+		current.add(instructionGas(instruction));
+
+		if (!instruction.operands.empty() && instruction.operands.back().kind == Operand::Kind::Continuation) {
+			Cost body = blockCost(i, end);
+			switch (instruction.opcode) {
+				case Opcode::IFREF:
+				case Opcode::IFNOTREF:
+					current.add(maybe(body));
+					break;
+				case Opcode::IFJMPREF:
+				case Opcode::IFNOTJMPREF:
+					jumpTo(body);
+					break;
+				case Opcode::CALLREF:
+					current.add(body);
+					break;
+				case Opcode::JMPREF:
+					jumpTo(body);
+					current = Cost::unreachable();
+					break;
+				default: // PUSHCONT
+					conts.push_back(body);
+					break;
+			}
+			continue;
+		}
+
+		switch (instruction.opcode) {
+			case Opcode::RET:
+			case Opcode::RETALT:
+				finished.merge(current);
+				current = Cost::unreachable();
+				break;
+			case Opcode::IFRET:
+			case Opcode::IFNOTRET:
+				finished.merge(current);
+				break;
+			case Opcode::IF:
+			case Opcode::IFNOT:
+				current.add(maybe(popCont()));
+				break;
+			case Opcode::IFELSE: {
+				Cost falseBranch = popCont();
+				Cost trueBranch = popCont();
+				trueBranch.merge(falseBranch);
+				current.add(trueBranch);
+				break;
+			}
+			case Opcode::CONDSEL:
+				if (conts.size() >= 2) {
+					Cost second = popCont();
+					Cost first = popCont();
+					first.merge(second);
+					conts.push_back(first);
+				}
+				break;
+			case Opcode::CALLX:
+				current.add(popCont());
+				break;
+			case Opcode::JMPX:
+			case Opcode::JMPXARGS:
+				jumpTo(popCont());
+				current = Cost::unreachable();
+				break;
+			case Opcode::IFJMP:
+			case Opcode::IFNOTJMP:
+				jumpTo(popCont());
+				break;
+			case Opcode::WHILE: {
+				Cost body = popCont();
+				Cost condition = popCont();
+				current.add(condition);
+				condition.add(body);
+				addLoop(condition);
+				break;
+			}
+			case Opcode::UNTIL: {
+				Cost body = popCont();
+				current.add(body);
+				addLoop(body);
+				break;
+			}
+			case Opcode::REPEAT:
+			case Opcode::AGAIN:
+				addLoop(popCont());
+				break;
+			case Opcode::CALL: {
+				if (instruction.operands.size() == 1 && instruction.operands[0].kind == Operand::Kind::Function) {
+					const std::string name = instruction.operands[0].name();
+					if (m_functions.count(name)) {
+						current.add(functionCost(name));
+					}
+				}
+				break;
+			}
+			case Opcode::JMP: {
+				// a tail call of a function by id, e.g. of the selector of public functions
+				auto it = instruction.operands.size() == 1 && instruction.operands[0].kind == Operand::Kind::Integer ?
+					m_functionIds.find(instruction.operands[0].value) : m_functionIds.end();
+				if (it != m_functionIds.end() && m_functions.count(it->second)) {
+					jumpTo(functionCost(it->second));
+				} else {
+					Cost unknown;
+					unknown.unbounded = true;
+					jumpTo(unknown);
+				}
+				current = Cost::unreachable();
+				break;
+			}
+			case Opcode::THROW:
+			case Opcode::THROWARG:
+			case Opcode::THROWANY:
+			case Opcode::THROWARGANY:
+				current = Cost::unreachable(); // an exception
+				break;
+			default:
+				break;
+		}
+	}
+
+	current.add(ImplicitRetGas);
+	finished.merge(current);
+	return finished;
+}
+
+long long TVMGasEstimator::instructionGas(Instruction const& instruction) {
+	if (instruction.opcode == Opcode::Unknown) {
+		return BasicGas + UnknownInstructionBits;
+	}
+	OpcodeInfo const& info = opcodeInfo(instruction.opcode);
+	long long gas = BasicGas + info.bits;
+	if (info.has(OpCellLoad)) {
+		gas += CellLoadGas;
+	}
+	if (info.has(OpCellCreate)) {
+		gas += CellCreateGas;
+	}
+	return gas;
+}
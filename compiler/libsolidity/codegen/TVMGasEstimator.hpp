@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018-2020 TON DEV SOLUTIONS LTD.
+ *
+ * Licensed under the  terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the  GNU General Public License for more details at: https://www.gnu.org/licenses/gpl-3.0.html
+ */
+/**
+ * @author TON Labs <connect@tonlabs.io>
+ * @date 2020
+ * Static estimation of gas used by the generated functions
+ */
+
+#pragma once
+
+#include <json/json.h>
+
+#include <optional>
+
+#include "TVMPusher.hpp"
+
+namespace solidity::frontend {
+
+// Estimates gas of every function (.globl, .macro and .internal) of the generated assembly:
+// an instruction costs 10 + its length in bits (see TVMOpcodes.hpp), loading a cell costs 100 and
+// creating one 500 more, reaching the end of a continuation (implicit RET) costs 5.
+// Calls of functions ("CALL $name$") and continuations run by IF, CALLX and so on are added to the caller.
+//
+// Only paths which don't end in an exception are counted. min and max are the cheapest and the most
+// expensive paths if every loop runs zero times (a loop condition is still computed once), each loop
+// then adds the cost of one iteration per iteration.
+//
+// "JMP id" adds the cost of the function with that id (.internal-alias) if it is in the code. Otherwise,
+// and for continuations whose code is unknown (e.g. values of function types), the path goes on in code
+// which isn't estimated: the function is reported as "unbounded" without max, min is a lower bound.
+class TVMGasEstimator {
+public:
+	explicit TVMGasEstimator(CodeLines const& code);
+
+	// {"functions": {name: {"kind", "min", "max", "loops": [{"min", "max"}], "unbounded"?, "recursive"?}}}
+	Json::Value report();
+
+private:
+	struct Range {
+		long long min{};
+		long long max{};
+	};
+
+	struct Cost {
+		bool reachable{true};	// false if every path throws an exception
+		bool unbounded{};		// true if some path goes on in code which isn't estimated
+		Range gas;
+		std::map<size_t, Range> loops;	// one iteration of every loop on some of the paths, by line of the loop
+
+		static Cost unreachable();
+		void add(long long gas);
+		void add(Cost const& next);	// sequence of this and next
+		void merge(Cost const& other);	// either this or other
+	};
+
+	struct Function {
+		std::string kind;	// "public", "private", "macro" or "internal"
+		size_t begin{};		// first line of the body
+		size_t end{};
+		std::optional<Cost> cost;
+		bool inProgress{};
+		bool recursive{};
+	};
+
+	Cost functionCost(std::string const& name);
+	// Cost of the lines from i to the closing '}' (or end), i is moved past the closing '}'
+	Cost blockCost(size_t& i, size_t end);
+	static long long instructionGas(Instruction const& instruction);
+
+	CodeLines const& m_code;
+	std::map<std::string, Function> m_functions;
+	std::vector<std::string> m_functionOrder;
+	std::map<long long, std::string> m_functionIds;	// by .internal-alias, targets of JMP
+};
+
+}	// end solidity::frontend
@@ -22,10 +22,14 @@
 
 using namespace solidity::frontend;
 
+TVMInlineFunctionChecker::TVMInlineFunctionChecker(std::function<bool(FunctionDefinition const*)> isInlined) :
+	isInlined{isInlined ? std::move(isInlined) : isFunctionForInlining} {
+}
+
 bool TVMInlineFunctionChecker::visit(Identifier const &_identifier) {
 	auto functionType = to<FunctionType>(_identifier.annotation().type);
 	auto funDef = to<FunctionDefinition>(_identifier.annotation().referencedDeclaration);
-	if (functionType && funDef && isFunctionForInlining(funDef)) {
+	if (functionType && funDef && isInlined(funDef)) {
 		graph[currentFunctionDefinition].insert(funDef);
 	}
 	return false;
@@ -34,7 +38,7 @@ bool TVMInlineFunctionChecker::visit(Identifier const &_identifier) {
 bool TVMInlineFunctionChecker::visit(FunctionDefinition const &_node) {
 	currentFunctionDefinition = &_node;
 	graph[currentFunctionDefinition];
-	solAssert(isFunctionForInlining(currentFunctionDefinition), "");
+	solAssert(isInlined(currentFunctionDefinition), "");
 	return ASTConstVisitor::visit(_node);
 }
 
@@ -89,4 +93,28 @@ std::vector<FunctionDefinition const*> TVMInlineFunctionChecker::functionOrder()
 	}
 
 	return order;
-}
\ No newline at end of file
+}
+
+std::set<FunctionDefinition const*> TVMInlineFunctionChecker::recursiveFunctions() const {
+	std::set<FunctionDefinition const*> recursive;
+	for (FunctionDefinition const* start : graph | boost::adaptors::map_keys) {
+		std::set<FunctionDefinition const*> visited;
+		std::vector<FunctionDefinition const*> stack{start};
+		while (!stack.empty() && !recursive.count(start)) {
+			FunctionDefinition const* v = stack.back();
+			stack.pop_back();
+			auto it = graph.find(v);
+			if (it == graph.end()) {
+				continue;
+			}
+			for (FunctionDefinition const* to : it->second) {
+				if (to == start) {
+					recursive.insert(start);
+				} else if (visited.insert(to).second) {
+					stack.push_back(to);
+				}
+			}
+		}
+	}
+	return recursive;
+}
@@ -19,17 +19,23 @@
 
 #include <libsolidity/ast/ASTVisitor.h>
 
+#include <functional>
+
 namespace solidity::frontend {
 
 class TVMInlineFunctionChecker : public ASTConstVisitor {
 public:
-	TVMInlineFunctionChecker() = default;
+	// isInlined tells which functions are inlined, by default the ones marked as inline (see isFunctionForInlining)
+	explicit TVMInlineFunctionChecker(std::function<bool(FunctionDefinition const*)> isInlined = {});
 	bool visit(Identifier const& _node) override;
 	bool visit(FunctionDefinition const& _node) override;
 	bool dfs(FunctionDefinition const* v);
 	std::vector<FunctionDefinition const*> functionOrder();
+	// Visited functions which call themselves directly or through other inlined functions
+	std::set<FunctionDefinition const*> recursiveFunctions() const;
 
 private:
+	std::function<bool(FunctionDefinition const*)> isInlined;
 	FunctionDefinition const* currentFunctionDefinition{};
 	std::map<FunctionDefinition const*, std::set<FunctionDefinition const*>> graph;
 
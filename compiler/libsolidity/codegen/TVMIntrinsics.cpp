@@ -79,7 +79,7 @@ bool IntrinsicsCompiler::checkTvmIntrinsic(FunctionCall const &_functionCall) {
 		if (auto literal = to<Literal>(logstr)) {
 			if (literal->value().length() > 15)
 				cast_error(_functionCall, "tvm_logstr param should be no more than 15 chars");
-			if (TVMContractCompiler::g_without_logstr) {
+			if (m_pusher.ctx().withoutLogstr()) {
 				return true;
 			}
 			m_pusher.push(0, "PRINTSTR " + literal->value());
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2018-2020 TON DEV SOLUTIONS LTD.
+ *
+ * Licensed under the  terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the  GNU General Public License for more details at: https://www.gnu.org/licenses/gpl-3.0.html
+ */
+/**
+ * @author TON Labs <connect@tonlabs.io>
+ * @date 2020
+ * Table of TVM instructions
+ */
+
+#include "TVMOpcodes.hpp"
+
+#include <liblangutil/Exceptions.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+namespace solidity::frontend {
+
+namespace {
+
+OpcodeInfo const g_opcodes[] = {
+	{Opcode::Unknown, "", 0, 0, 0, 0},
+#define O(name, mnemonic, inputs, outputs, flags, bits) {Opcode::name, mnemonic, inputs, outputs, flags, bits},
+	TVM_OPCODE_LIST(O)
+#undef O
+};
+
+static_assert(sizeof(g_opcodes) / sizeof(g_opcodes[0]) == static_cast<size_t>(Opcode::NUM_OPCODES), "");
+
+uint32_t hashMnemonic(string_view s, uint32_t seed) {
+	// FNV-1a
+	uint32_t h = 2166136261u ^ seed;
+	for (char ch : s) {
+		h ^= static_cast<unsigned char>(ch);
+		h *= 16777619u;
+	}
+	return h ^ (h >> 15);
+}
+
+// Perfect hash of all mnemonics of the table (hash and displace): a mnemonic is hashed with seed 0
+// to pick a bucket, each bucket has its own seed which maps all its mnemonics to distinct slots.
+// So a lookup takes two hashes and one string comparison.
+class OpcodeIndex {
+public:
+	OpcodeIndex() : m_seeds(BucketCount), m_slots(SlotCount, Opcode::Unknown) {
+		vector<vector<Opcode>> buckets(BucketCount);
+		for (OpcodeInfo const& info : g_opcodes) {
+			if (info.opcode != Opcode::Unknown) {
+				buckets[hashMnemonic(info.mnemonic, 0) % BucketCount].push_back(info.opcode);
+			}
+		}
+		vector<size_t> order(BucketCount);
+		for (size_t b = 0; b < BucketCount; ++b) {
+			order[b] = b;
+		}
+		stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return buckets[a].size() > buckets[b].size();
+		});
+
+		vector<size_t> slots;
+		for (size_t b : order) {
+			if (buckets[b].empty()) {
+				break;
+			}
+			for (uint32_t seed = 1; ; ++seed) {
+				solAssert(seed < 1000000, "Failed to build perfect hash of TVM opcodes");
+				slots.clear();
+				for (Opcode opcode : buckets[b]) {
+					size_t slot = hashMnemonic(opcodeInfo(opcode).mnemonic, seed) % SlotCount;
+					if (m_slots[slot] != Opcode::Unknown || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+						break;
+					}
+					slots.push_back(slot);
+				}
+				if (slots.size() == buckets[b].size()) {
+					m_seeds[b] = seed;
+					for (size_t i = 0; i < slots.size(); ++i) {
+						m_slots[slots[i]] = buckets[b][i];
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	Opcode find(string_view mnemonic) const {
+		uint32_t seed = m_seeds[hashMnemonic(mnemonic, 0) % BucketCount];
+		Opcode opcode = m_slots[hashMnemonic(mnemonic, seed) % SlotCount];
+		if (opcode != Opcode::Unknown && mnemonic == opcodeInfo(opcode).mnemonic) {
+			return opcode;
+		}
+		return Opcode::Unknown;
+	}
+
+private:
+	static constexpr size_t BucketCount = 128;
+	static constexpr size_t SlotCount = 512;
+	static_assert(static_cast<size_t>(Opcode::NUM_OPCODES) <= SlotCount, "");
+
+	vector<uint32_t> m_seeds;
+	vector<Opcode> m_slots;
+};
+
+}
+
+OpcodeInfo const& opcodeInfo(Opcode opcode) {
+	return g_opcodes[static_cast<size_t>(opcode)];
+}
+
+Opcode findOpcode(string_view mnemonic) {
+	static OpcodeIndex const index;
+	return index.find(mnemonic);
+}
+
+}	// end solidity::frontend
@@ -0,0 +1,446 @@
+/*
+ * Copyright 2018-2020 TON DEV SOLUTIONS LTD.
+ *
+ * Licensed under the  terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the  GNU General Public License for more details at: https://www.gnu.org/licenses/gpl-3.0.html
+ */
+/**
+ * @author TON Labs <connect@tonlabs.io>
+ * @date 2020
+ * Table of TVM instructions
+ */
+
+#pragma once
+
+#include <string_view>
+
+namespace solidity::frontend {
+
+enum OpcodeFlags : unsigned {
+	// Stack effect is exactly `inputs` values -> `outputs` values and no other stack element is
+	// touched, so the optimizer may move the command across the stack simulation
+	OpSimple		= 1u << 0,
+	// The optimizer drops SWAP before the command
+	OpCommutative	= 1u << 1,
+	// Control never reaches the next command, so the optimizer deletes the commands after it in the same
+	// continuation. Only RET, THROW and THROWANY are marked, jumps are handled by TVMGasEstimator itself
+	OpNoFallThrough	= 1u << 2,
+	// Number of inputs (outputs) is the first integer operand, e.g. TUPLE 3 or BLKPUSH 2, 1
+	OpVarInputs		= 1u << 3,
+	OpVarOutputs	= 1u << 4,
+	// Loads a cell (100 gas) or creates one (500 gas). Dictionary operations are counted as one load
+	// (and one creation if they modify the dictionary), whatever the depth of the dictionary
+	OpCellLoad		= 1u << 5,
+	OpCellCreate	= 1u << 6,
+};
+
+// O(name, mnemonic, inputs, outputs, flags, bits)
+//
+// inputs/outputs: values taken from and put on the stack, not counting values addressed by index (e.g. PUSH S3)
+// bits: length of the shortest encoding of the instruction without inline data (slices, continuations)
+// and references
+//
+// Names which clash with well-known macros get a trailing underscore.
+#define TVM_OPCODE_LIST(O)																\
+	/* Pseudo instruction closing PUSHCONT, IFREF and so on */							\
+	O(CONT_END,			"}",				0, 0, 0,							0)		\
+																						\
+	/* Stack manipulation */															\
+	O(NOP,				"NOP",				0, 0, 0,							8)		\
+	O(SWAP,				"SWAP",				2, 2, OpSimple,						8)		\
+	O(XCHG,				"XCHG",				0, 0, 0,							8)		\
+	O(PUSH,				"PUSH",				0, 1, 0,							8)		\
+	O(DUP,				"DUP",				0, 1, 0,							8)		\
+	O(OVER,				"OVER",				0, 1, 0,							8)		\
+	O(POP,				"POP",				1, 0, 0,							8)		\
+	O(DROP,				"DROP",				1, 0, OpSimple,						8)		\
+	O(NIP,				"NIP",				1, 0, 0,							8)		\
+	O(XCHG2,			"XCHG2",			0, 0, 0,							16)		\
+	O(XCHG3,			"XCHG3",			0, 0, 0,							16)		\
+	O(XCPU,				"XCPU",				0, 1, 0,							16)		\
+	O(PUXC,				"PUXC",				0, 1, 0,							16)		\
+	O(PUSH2,			"PUSH2",			0, 2, 0,							16)		\
+	O(PUSH3,			"PUSH3",			0, 3, 0,							24)		\
+	O(BLKSWAP,			"BLKSWAP",			0, 0, 0,							16)		\
+	O(ROT,				"ROT",				3, 3, OpSimple,						8)		\
+	O(ROTREV,			"ROTREV",			3, 3, OpSimple,						8)		\
+	O(SWAP2,			"SWAP2",			4, 4, 0,							8)		\
+	O(DROP2,			"DROP2",			2, 0, 0,							8)		\
+	O(DUP2,				"DUP2",				0, 2, 0,							8)		\
+	O(OVER2,			"OVER2",			0, 2, 0,							8)		\
+	O(REVERSE,			"REVERSE",			0, 0, 0,							16)		\
+	O(BLKDROP,			"BLKDROP",			0, 0, OpVarInputs,					16)		\
+	O(BLKPUSH,			"BLKPUSH",			0, 0, OpVarOutputs,					16)		\
+	O(PICK,				"PICK",				1, 1, 0,							8)		\
+	O(PUSHX,			"PUSHX",			1, 1, 0,							8)		\
+	O(ROLL,				"ROLL",				1, 0, 0,							8)		\
+	O(ROLLX,			"ROLLX",			1, 0, 0,							8)		\
+	O(ROLLREV,			"ROLLREV",			1, 0, 0,							8)		\
+	O(BLKSWX,			"BLKSWX",			2, 0, 0,							8)		\
+	O(REVX,				"REVX",				2, 0, 0,							8)		\
+	O(DROPX,			"DROPX",			1, 0, 0,							8)		\
+	O(TUCK,				"TUCK",				2, 3, 0,							8)		\
+	O(XCHGX,			"XCHGX",			1, 0, 0,							8)		\
+	O(DEPTH,			"DEPTH",			0, 1, 0,							8)		\
+	O(CHKDEPTH,			"CHKDEPTH",			1, 0, 0,							8)		\
+	O(ONLYTOPX,			"ONLYTOPX",			1, 0, 0,							8)		\
+	O(ONLYX,			"ONLYX",			1, 0, 0,							8)		\
+	O(BLKDROP2,			"BLKDROP2",			0, 0, 0,							16)		\
+																						\
+	/* Null and tuples */																\
+	O(NULL_,			"NULL",				0, 1, 0,							8)		\
+	O(PUSHNULL,			"PUSHNULL",			0, 1, 0,							8)		\
+	O(ISNULL,			"ISNULL",			1, 1, 0,							8)		\
+	O(TUPLE,			"TUPLE",			0, 1, OpSimple | OpVarInputs,		16)		\
+	O(NIL,				"NIL",				0, 1, 0,							16)		\
+	O(SINGLE,			"SINGLE",			1, 1, 0,							16)		\
+	O(PAIR,				"PAIR",				2, 1, OpSimple,						16)		\
+	O(TRIPLE,			"TRIPLE",			3, 1, 0,							16)		\
+	O(INDEX,			"INDEX",			1, 1, OpSimple,						16)		\
+	O(FIRST,			"FIRST",			1, 1, OpSimple,						16)		\
+	O(SECOND,			"SECOND",			1, 1, OpSimple,						16)		\
+	O(THIRD,			"THIRD",			1, 1, OpSimple,						16)		\
+	O(UNTUPLE,			"UNTUPLE",			1, 0, OpSimple | OpVarOutputs,		16)		\
+	O(UNPAIR,			"UNPAIR",			1, 2, OpSimple,						16)		\
+	O(UNTRIPLE,			"UNTRIPLE",			1, 3, 0,							16)		\
+	O(UNPACKFIRST,		"UNPACKFIRST",		1, 0, OpVarOutputs,					16)		\
+	O(SETINDEX,			"SETINDEX",			2, 1, OpSimple,						16)		\
+	O(INDEXQ,			"INDEXQ",			1, 1, 0,							16)		\
+	O(SETINDEXQ,		"SETINDEXQ",		2, 1, 0,							16)		\
+	O(TUPLEVAR,			"TUPLEVAR",			1, 1, 0,							16)		\
+	O(INDEXVAR,			"INDEXVAR",			2, 1, OpSimple,						16)		\
+	O(UNTUPLEVAR,		"UNTUPLEVAR",		2, 0, 0,							16)		\
+	O(SETINDEXVAR,		"SETINDEXVAR",		3, 1, OpSimple,						16)		\
+	O(TLEN,				"TLEN",				1, 1, 0,							16)		\
+	O(ISTUPLE,			"ISTUPLE",			1, 1, 0,							16)		\
+	O(LAST,				"LAST",				1, 1, 0,							16)		\
+	O(TPUSH,			"TPUSH",			2, 1, 0,							16)		\
+	O(TPOP,				"TPOP",				1, 2, 0,							16)		\
+																						\
+	/* Constants */																		\
+	O(PUSHINT,			"PUSHINT",			0, 1, OpSimple,						8)		\
+	O(ZERO,				"ZERO",				0, 1, OpSimple,						8)		\
+	O(TRUE_,			"TRUE",				0, 1, OpSimple,						8)		\
+	O(FALSE_,			"FALSE",			0, 1, OpSimple,						8)		\
+	O(PUSHPOW2,			"PUSHPOW2",			0, 1, 0,							16)		\
+	O(PUSHPOW2DEC,		"PUSHPOW2DEC",		0, 1, 0,							16)		\
+	O(PUSHNEGPOW2,		"PUSHNEGPOW2",		0, 1, 0,							16)		\
+	O(PUSHNAN,			"PUSHNAN",			0, 1, 0,							16)		\
+	O(PUSHREF,			"PUSHREF",			0, 1, 0,							8)		\
+	O(PUSHREFSLICE,		"PUSHREFSLICE",		0, 1, 0,							8)		\
+	O(PUSHREFCONT,		"PUSHREFCONT",		0, 1, 0,							8)		\
+	O(PUSHSLICE,		"PUSHSLICE",		0, 1, OpSimple,						12)		\
+	O(PUSHCONT,			"PUSHCONT",			0, 1, 0,							8)		\
+																						\
+	/* Arithmetic */																	\
+	O(ADD,				"ADD",				2, 1, OpSimple | OpCommutative,		8)		\
+	O(SUB,				"SUB",				2, 1, OpSimple,						8)		\
+	O(SUBR,				"SUBR",				2, 1, OpSimple,						8)		\
+	O(NEGATE,			"NEGATE",			1, 1, 0,							8)		\
+	O(INC,				"INC",				1, 1, OpSimple,						8)		\
+	O(DEC,				"DEC",				1, 1, OpSimple,						8)		\
+	O(ADDCONST,			"ADDCONST",			1, 1, 0,							16)		\
+	O(MULCONST,			"MULCONST",			1, 1, 0,							16)		\
+	O(MUL,				"MUL",				2, 1, OpSimple | OpCommutative,		8)		\
+	O(DIV,				"DIV",				2, 1, OpSimple,						16)		\
+	O(DIVR,				"DIVR",				2, 1, 0,							16)		\
+	O(DIVC,				"DIVC",				2, 1, 0,							16)		\
+	O(MOD,				"MOD",				2, 1, OpSimple,						16)		\
+	O(DIVMOD,			"DIVMOD",			2, 2, 0,							16)		\
+	O(MULDIV,			"MULDIV",			3, 1, 0,							16)		\
+	O(MULDIVR,			"MULDIVR",			3, 1, 0,							16)		\
+	O(MULDIVMOD,		"MULDIVMOD",		3, 2, 0,							16)		\
+	O(LSHIFT,			"LSHIFT",			2, 1, 0,							8)		\
+	O(RSHIFT,			"RSHIFT",			2, 1, 0,							8)		\
+	O(POW2,				"POW2",				1, 1, 0,							8)		\
+	O(AND,				"AND",				2, 1, OpSimple | OpCommutative,		8)		\
+	O(OR,				"OR",				2, 1, OpSimple | OpCommutative,		8)		\
+	O(XOR,				"XOR",				2, 1, OpCommutative,				8)		\
+	O(NOT,				"NOT",				1, 1, OpSimple,						8)		\
+	O(FITS,				"FITS",				1, 1, OpSimple,						16)		\
+	O(UFITS,			"UFITS",			1, 1, OpSimple,						16)		\
+	O(FITSX,			"FITSX",			2, 1, 0,							16)		\
+	O(UFITSX,			"UFITSX",			2, 1, 0,							16)		\
+	O(BITSIZE,			"BITSIZE",			1, 1, 0,							16)		\
+	O(UBITSIZE,			"UBITSIZE",			1, 1, 0,							16)		\
+	O(MIN_,				"MIN",				2, 1, 0,							16)		\
+	O(MAX_,				"MAX",				2, 1, 0,							16)		\
+	O(MINMAX,			"MINMAX",			2, 2, 0,							16)		\
+	O(ABS,				"ABS",				1, 1, 0,							16)		\
+																						\
+	/* Comparison */																	\
+	O(SGN,				"SGN",				1, 1, 0,							8)		\
+	O(LESS,				"LESS",				2, 1, OpSimple,						8)		\
+	O(EQUAL,			"EQUAL",			2, 1, OpCommutative,				8)		\
+	O(LEQ,				"LEQ",				2, 1, 0,							8)		\
+	O(GREATER,			"GREATER",			2, 1, OpSimple,						8)		\
+	O(NEQ,				"NEQ",				2, 1, OpSimple | OpCommutative,		8)		\
+	O(GEQ,				"GEQ",				2, 1, 0,							8)		\
+	O(CMP,				"CMP",				2, 1, 0,							8)		\
+	O(EQINT,			"EQINT",			1, 1, OpSimple,						16)		\
+	O(ISZERO,			"ISZERO",			1, 1, 0,							16)		\
+	O(LESSINT,			"LESSINT",			1, 1, 0,							16)		\
+	O(ISNEG,			"ISNEG",			1, 1, 0,							16)		\
+	O(ISNPOS,			"ISNPOS",			1, 1, 0,							16)		\
+	O(GTINT,			"GTINT",			1, 1, 0,							16)		\
+	O(ISPOS,			"ISPOS",			1, 1, 0,							16)		\
+	O(ISNNEG,			"ISNNEG",			1, 1, 0,							16)		\
+	O(NEQINT,			"NEQINT",			1, 1, 0,							16)		\
+	O(ISNAN,			"ISNAN",			1, 1, 0,							8)		\
+	O(CHKNAN,			"CHKNAN",			1, 1, 0,							8)		\
+	O(SEMPTY,			"SEMPTY",			1, 1, 0,							16)		\
+	O(SDEMPTY,			"SDEMPTY",			1, 1, 0,							16)		\
+	O(SREMPTY,			"SREMPTY",			1, 1, 0,							16)		\
+	O(SDLEXCMP,			"SDLEXCMP",			2, 1, 0,							16)		\
+	O(SDEQ,				"SDEQ",				2, 1, 0,							16)		\
+																						\
+	/* Cell serialization */															\
+	O(NEWC,				"NEWC",				0, 1, OpSimple,						8)		\
+	O(ENDC,				"ENDC",				1, 1, OpSimple | OpCellCreate,		8)		\
+	O(STI,				"STI",				2, 1, 0,							16)		\
+	O(STU,				"STU",				2, 1, 0,							16)		\
+	O(STREF,			"STREF",			2, 1, 0,							8)		\
+	O(STBREFR,			"STBREFR",			2, 1, OpCellCreate,					8)		\
+	O(STSLICE,			"STSLICE",			2, 1, OpSimple,						8)		\
+	O(STIX,				"STIX",				3, 1, 0,							16)		\
+	O(STUX,				"STUX",				3, 1, 0,							16)		\
+	O(STIR,				"STIR",				2, 1, 0,							24)		\
+	O(STUR,				"STUR",				2, 1, 0,							24)		\
+	O(STREFR,			"STREFR",			2, 1, 0,							16)		\
+	O(STBREF,			"STBREF",			2, 1, OpCellCreate,					16)		\
+	O(STSLICER,			"STSLICER",			2, 1, 0,							16)		\
+	O(STB,				"STB",				2, 1, 0,							16)		\
+	O(STBR,				"STBR",				2, 1, 0,							16)		\
+	O(STREFCONST,		"STREFCONST",		1, 1, 0,							16)		\
+	O(STSLICECONST,		"STSLICECONST",		1, 1, 0,							16)		\
+	O(STZEROES,			"STZEROES",			2, 1, 0,							16)		\
+	O(STONES,			"STONES",			2, 1, 0,							16)		\
+	O(STGRAMS,			"STGRAMS",			2, 1, 0,							16)		\
+	O(STVARUINT32,		"STVARUINT32",		2, 1, 0,							16)		\
+	O(STDICT,			"STDICT",			2, 1, 0,							16)		\
+	O(BBITS,			"BBITS",			1, 1, 0,							16)		\
+	O(BREFS,			"BREFS",			1, 1, 0,							16)		\
+	O(BBITREFS,			"BBITREFS",			1, 2, 0,							16)		\
+	O(BREMBITS,			"BREMBITS",			1, 1, 0,							16)		\
+	O(BREMREFS,			"BREMREFS",			1, 1, 0,							16)		\
+	O(BREMBITREFS,		"BREMBITREFS",		1, 2, 0,							16)		\
+	O(ENDXC,			"ENDXC",			2, 1, OpCellCreate,					16)		\
+																						\
+	/* Cell deserialization */															\
+	O(CTOS,				"CTOS",				1, 1, OpSimple | OpCellLoad,		8)		\
+	O(ENDS,				"ENDS",				1, 0, OpSimple,						8)		\
+	O(LDI,				"LDI",				1, 2, 0,							16)		\
+	O(LDU,				"LDU",				1, 2, 0,							16)		\
+	O(LDIQ,				"LDIQ",				1, 3, 0,							24)		\
+	O(LDUQ,				"LDUQ",				1, 3, 0,							24)		\
+	O(LDREF,			"LDREF",			1, 2, 0,							8)		\
+	O(LDREFRTOS,		"LDREFRTOS",		1, 2, OpCellLoad,					8)		\
+	O(LDSLICE,			"LDSLICE",			1, 2, 0,							16)		\
+	O(LDSLICEX,			"LDSLICEX",			2, 2, 0,							16)		\
+	O(PLDSLICE,			"PLDSLICE",			1, 1, 0,							24)		\
+	O(PLDSLICEX,		"PLDSLICEX",		2, 1, 0,							16)		\
+	O(PLDI,				"PLDI",				1, 1, 0,							24)		\
+	O(PLDU,				"PLDU",				1, 1, 0,							24)		\
+	O(PLDIX,			"PLDIX",			2, 1, 0,							16)		\
+	O(PLDUX,			"PLDUX",			2, 1, OpSimple,						16)		\
+	O(PLDREF,			"PLDREF",			1, 1, 0,							16)		\
+	O(PLDREFIDX,		"PLDREFIDX",		1, 1, 0,							16)		\
+	O(PLDREFVAR,		"PLDREFVAR",		2, 1, 0,							16)		\
+	O(SDCUTFIRST,		"SDCUTFIRST",		2, 1, 0,							16)		\
+	O(SDSKIPFIRST,		"SDSKIPFIRST",		2, 1, 0,							16)		\
+	O(SDSUBSTR,			"SDSUBSTR",			3, 1, 0,							16)		\
+	O(SSKIPFIRST,		"SSKIPFIRST",		3, 1, 0,							16)		\
+	O(SPLIT,			"SPLIT",			3, 2, 0,							16)		\
+	O(SBITS,			"SBITS",			1, 1, OpSimple,						16)		\
+	O(SREFS,			"SREFS",			1, 1, 0,							16)		\
+	O(SBITREFS,			"SBITREFS",			1, 2, 0,							16)		\
+	O(CDATASIZE,		"CDATASIZE",		2, 3, 0,							16)		\
+	O(LDGRAMS,			"LDGRAMS",			1, 2, 0,							16)		\
+	O(LDVARUINT32,		"LDVARUINT32",		1, 2, 0,							16)		\
+	O(LDMSGADDR,		"LDMSGADDR",		1, 2, 0,							16)		\
+	O(LDMSGADDRQ,		"LDMSGADDRQ",		1, 3, 0,							16)		\
+	O(PARSEMSGADDR,		"PARSEMSGADDR",		1, 1, OpSimple,						16)		\
+	O(REWRITESTDADDR,	"REWRITESTDADDR",	1, 2, 0,							16)		\
+	O(LDDICT,			"LDDICT",			1, 2, 0,							16)		\
+	O(LDDICTQ,			"LDDICTQ",			1, 3, 0,							16)		\
+	O(LDDICTS,			"LDDICTS",			1, 2, 0,							16)		\
+	O(PLDDICT,			"PLDDICT",			1, 1, 0,							16)		\
+	O(SKIPDICT,			"SKIPDICT",			1, 1, 0,							16)		\
+																						\
+	/* Continuations and control flow */												\
+	O(EXECUTE,			"EXECUTE",			1, 0, 0,							8)		\
+	O(CALLX,			"CALLX",			1, 0, 0,							8)		\
+	O(JMPX,				"JMPX",				1, 0, 0,							8)		\
+	O(CALLXARGS,		"CALLXARGS",		1, 0, 0,							16)		\
+	O(JMPXARGS,			"JMPXARGS",			1, 0, 0,							16)		\
+	O(RET,				"RET",				0, 0, OpNoFallThrough,				16)		\
+	O(RETALT,			"RETALT",			0, 0, 0,							16)		\
+	O(IFRET,			"IFRET",			1, 0, 0,							8)		\
+	O(IFNOTRET,			"IFNOTRET",			1, 0, 0,							8)		\
+	O(IF,				"IF",				2, 0, 0,							8)		\
+	O(IFNOT,			"IFNOT",			2, 0, 0,							8)		\
+	O(IFJMP,			"IFJMP",			2, 0, 0,							8)		\
+	O(IFNOTJMP,			"IFNOTJMP",			2, 0, 0,							8)		\
+	O(IFELSE,			"IFELSE",			3, 0, 0,							8)		\
+	O(IFREF,			"IFREF",			1, 0, 0,							16)		\
+	O(IFNOTREF,			"IFNOTREF",			1, 0, 0,							16)		\
+	O(IFJMPREF,			"IFJMPREF",			1, 0, 0,							16)		\
+	O(IFNOTJMPREF,		"IFNOTJMPREF",		1, 0, 0,							16)		\
+	O(CONDSEL,			"CONDSEL",			3, 1, 0,							16)		\
+	O(REPEAT,			"REPEAT",			2, 0, 0,							8)		\
+	O(UNTIL,			"UNTIL",			1, 0, 0,							8)		\
+	O(WHILE,			"WHILE",			2, 0, 0,							8)		\
+	O(AGAIN,			"AGAIN",			1, 0, 0,							8)		\
+	O(CALLREF,			"CALLREF",			0, 0, 0,							16)		\
+	O(JMPREF,			"JMPREF",			0, 0, 0,							16)		\
+	O(CALL,				"CALL",				0, 0, 0,							16)		\
+	O(JMP,				"JMP",				0, 0, 0,							24)		\
+	O(PUSHCTR,			"PUSHCTR",			0, 1, 0,							16)		\
+	O(POPCTR,			"POPCTR",			1, 0, 0,							16)		\
+	O(PUSHROOT,			"PUSHROOT",			0, 1, 0,							16)		\
+	O(POPROOT,			"POPROOT",			1, 0, 0,							16)		\
+	O(BLESS,			"BLESS",			1, 1, 0,							16)		\
+																						\
+	/* Exceptions */																	\
+	O(THROW,			"THROW",			0, 0, OpNoFallThrough,				16)		\
+	O(THROWIF,			"THROWIF",			1, 0, OpSimple,						16)		\
+	O(THROWIFNOT,		"THROWIFNOT",		1, 0, OpSimple,						16)		\
+	O(THROWARG,			"THROWARG",			1, 0, 0,							24)		\
+	O(THROWARGIFNOT,	"THROWARGIFNOT",	2, 0, 0,							24)		\
+	O(THROWANY,			"THROWANY",			1, 0, OpSimple | OpNoFallThrough,	16)		\
+	O(THROWARGANY,		"THROWARGANY",		2, 0, 0,							16)		\
+	O(THROWANYIF,		"THROWANYIF",		2, 0, 0,							16)		\
+	O(THROWANYIFNOT,	"THROWANYIFNOT",	2, 0, 0,							16)		\
+	O(THROWARGANYIFNOT,	"THROWARGANYIFNOT",	3, 0, 0,							16)		\
+	O(TRY,				"TRY",				2, 0, 0,							16)		\
+																						\
+	/* Dictionaries */																	\
+	O(NEWDICT,			"NEWDICT",			0, 1, OpSimple,						8)		\
+	O(DICTEMPTY,		"DICTEMPTY",		1, 1, 0,							8)		\
+	O(DICTGET,			"DICTGET",			3, 2, OpCellLoad,					16)		\
+	O(DICTIGET,			"DICTIGET",			3, 2, OpCellLoad,					16)		\
+	O(DICTUGET,			"DICTUGET",			3, 2, OpCellLoad,					16)		\
+	O(DICTGETREF,		"DICTGETREF",		3, 2, OpCellLoad,					16)		\
+	O(DICTIGETREF,		"DICTIGETREF",		3, 2, OpCellLoad,					16)		\
+	O(DICTUGETREF,		"DICTUGETREF",		3, 2, OpCellLoad,					16)		\
+	O(DICTSET,			"DICTSET",			4, 1, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTISET,			"DICTISET",			4, 1, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTUSET,			"DICTUSET",			4, 1, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTSETREF,		"DICTSETREF",		4, 1, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTISETREF,		"DICTISETREF",		4, 1, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTUSETREF,		"DICTUSETREF",		4, 1, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTSETB,			"DICTSETB",			4, 1, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTISETB,		"DICTISETB",		4, 1, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTUSETB,		"DICTUSETB",		4, 1, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTSETGET,		"DICTSETGET",		4, 3, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTISETGET,		"DICTISETGET",		4, 3, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTUSETGET,		"DICTUSETGET",		4, 3, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTREPLACE,		"DICTREPLACE",		4, 2, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTIREPLACE,		"DICTIREPLACE",		4, 2, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTUREPLACE,		"DICTUREPLACE",		4, 2, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTREPLACEGET,	"DICTREPLACEGET",	4, 3, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTIREPLACEGET,	"DICTIREPLACEGET",	4, 3, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTUREPLACEGET,	"DICTUREPLACEGET",	4, 3, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTADD,			"DICTADD",			4, 2, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTIADD,			"DICTIADD",			4, 2, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTUADD,			"DICTUADD",			4, 2, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTADDGET,		"DICTADDGET",		4, 3, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTIADDGET,		"DICTIADDGET",		4, 3, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTUADDGET,		"DICTUADDGET",		4, 3, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTDEL,			"DICTDEL",			3, 2, OpSimple | OpCellLoad | OpCellCreate,	16)		\
+	O(DICTIDEL,			"DICTIDEL",			3, 2, OpSimple | OpCellLoad | OpCellCreate,	16)		\
+	O(DICTUDEL,			"DICTUDEL",			3, 2, OpSimple | OpCellLoad | OpCellCreate,	16)		\
+	O(DICTDELGET,		"DICTDELGET",		3, 3, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTIDELGET,		"DICTIDELGET",		3, 3, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTUDELGET,		"DICTUDELGET",		3, 3, OpCellLoad | OpCellCreate,	16)		\
+	O(DICTMIN,			"DICTMIN",			2, 3, OpCellLoad,					16)		\
+	O(DICTIMIN,			"DICTIMIN",			2, 3, OpCellLoad,					16)		\
+	O(DICTUMIN,			"DICTUMIN",			2, 3, OpCellLoad,					16)		\
+	O(DICTMAX,			"DICTMAX",			2, 3, OpCellLoad,					16)		\
+	O(DICTIMAX,			"DICTIMAX",			2, 3, OpCellLoad,					16)		\
+	O(DICTUMAX,			"DICTUMAX",			2, 3, OpCellLoad,					16)		\
+	O(DICTGETNEXT,		"DICTGETNEXT",		3, 3, OpCellLoad,					16)		\
+	O(DICTGETNEXTEQ,	"DICTGETNEXTEQ",	3, 3, OpCellLoad,					16)		\
+	O(DICTGETPREV,		"DICTGETPREV",		3, 3, OpCellLoad,					16)		\
+	O(DICTGETPREVEQ,	"DICTGETPREVEQ",	3, 3, OpCellLoad,					16)		\
+	O(DICTIGETNEXT,		"DICTIGETNEXT",		3, 3, OpCellLoad,					16)		\
+	O(DICTIGETNEXTEQ,	"DICTIGETNEXTEQ",	3, 3, OpCellLoad,					16)		\
+	O(DICTIGETPREV,		"DICTIGETPREV",		3, 3, OpCellLoad,					16)		\
+	O(DICTIGETPREVEQ,	"DICTIGETPREVEQ",	3, 3, OpCellLoad,					16)		\
+	O(DICTUGETNEXT,		"DICTUGETNEXT",		3, 3, OpCellLoad,					16)		\
+	O(DICTUGETNEXTEQ,	"DICTUGETNEXTEQ",	3, 3, OpCellLoad,					16)		\
+	O(DICTUGETPREV,		"DICTUGETPREV",		3, 3, OpCellLoad,					16)		\
+	O(DICTUGETPREVEQ,	"DICTUGETPREVEQ",	3, 3, OpCellLoad,					16)		\
+	O(DICTIGETJMP,		"DICTIGETJMP",		3, 0, OpCellLoad,					16)		\
+	O(DICTUGETJMP,		"DICTUGETJMP",		3, 0, OpCellLoad,					16)		\
+	O(DICTIGETEXEC,		"DICTIGETEXEC",		3, 0, OpCellLoad,					16)		\
+	O(DICTUGETEXEC,		"DICTUGETEXEC",		3, 0, OpCellLoad,					16)		\
+	O(DICTPUSHCONST,	"DICTPUSHCONST",	0, 2, 0,							24)		\
+																						\
+	/* Application-specific primitives */												\
+	O(ACCEPT,			"ACCEPT",			0, 0, 0,							16)		\
+	O(SETGASLIMIT,		"SETGASLIMIT",		1, 0, 0,							16)		\
+	O(COMMIT,			"COMMIT",			0, 0, 0,							16)		\
+	O(RANDU256,			"RANDU256",			0, 1, 0,							16)		\
+	O(RAND,				"RAND",				1, 1, 0,							16)		\
+	O(SETRAND,			"SETRAND",			1, 0, 0,							16)		\
+	O(ADDRAND,			"ADDRAND",			1, 0, 0,							16)		\
+	O(GETPARAM,			"GETPARAM",			0, 1, 0,							16)		\
+	O(NOW,				"NOW",				0, 1, OpSimple,						16)		\
+	O(BLOCKLT,			"BLOCKLT",			0, 1, 0,							16)		\
+	O(LTIME,			"LTIME",			0, 1, 0,							16)		\
+	O(BALANCE,			"BALANCE",			0, 1, 0,							16)		\
+	O(MYADDR,			"MYADDR",			0, 1, 0,							16)		\
+	O(CONFIGROOT,		"CONFIGROOT",		0, 1, 0,							16)		\
+	O(CONFIGPARAM,		"CONFIGPARAM",		1, 2, 0,							16)		\
+	O(GETGLOB,			"GETGLOB",			0, 1, OpSimple,						16)		\
+	O(GETGLOBVAR,		"GETGLOBVAR",		1, 1, 0,							16)		\
+	O(SETGLOB,			"SETGLOB",			1, 0, OpSimple,						16)		\
+	O(SETGLOBVAR,		"SETGLOBVAR",		2, 0, 0,							16)		\
+	O(HASHCU,			"HASHCU",			1, 1, OpSimple,						16)		\
+	O(HASHSU,			"HASHSU",			1, 1, OpSimple,						16)		\
+	O(SHA256U,			"SHA256U",			1, 1, OpSimple,						16)		\
+	O(CHKSIGNU,			"CHKSIGNU",			3, 1, 0,							16)		\
+	O(CHKSIGNS,			"CHKSIGNS",			3, 1, 0,							16)		\
+	O(SENDRAWMSG,		"SENDRAWMSG",		2, 0, 0,							16)		\
+	O(RAWRESERVE,		"RAWRESERVE",		2, 0, 0,							16)		\
+	O(SETCODE,			"SETCODE",			1, 0, 0,							16)		\
+																						\
+	/* Debug primitives */																\
+	O(DUMPSTK,			"DUMPSTK",			0, 0, 0,							16)		\
+	O(DUMP,				"DUMP",				0, 0, 0,							16)		\
+	O(STRDUMP,			"STRDUMP",			0, 0, 0,							16)		\
+	O(PRINTSTR,			"PRINTSTR",			0, 0, 0,							16)		\
+
+enum class Opcode : unsigned short {
+	// Not a TVM instruction: directives (e.g. ".macro"), unknown mnemonics and empty lines
+	Unknown,
+#define O(name, mnemonic, inputs, outputs, flags, bits) name,
+	TVM_OPCODE_LIST(O)
+#undef O
+	NUM_OPCODES
+};
+
+struct OpcodeInfo {
+	Opcode opcode;
+	char const* mnemonic;
+	int inputs;
+	int outputs;
+	unsigned flags;
+	int bits;
+
+	bool has(OpcodeFlags flag) const { return (flags & flag) != 0; }
+};
+
+OpcodeInfo const& opcodeInfo(Opcode opcode);
+
+// Returns Opcode::Unknown if mnemonic is not in the table
+Opcode findOpcode(std::string_view mnemonic);
+
+}	// end solidity::frontend
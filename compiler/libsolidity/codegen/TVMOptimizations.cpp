@@ -18,81 +18,80 @@
 
 #include "TVMOptimizations.hpp"
 #include "TVMPusher.hpp"
-#include <boost/format.hpp>
+
+#include <limits>
 
 namespace solidity::frontend {
 
 struct TVMOptimizer {
-	vector<string>	lines_;
-
-	static bool is_space(char ch) {
-		return ch == ' ' || ch == '\t';
-	}
+	struct Cmd;
+	struct Line;
+	// Position of a command line. Comment and empty lines are not positions, see Line::comments_.
+	using Pos = list<Line>::iterator;
 
-	static bool is_comment_or_empty_line(const string& str) {
-		for (auto ch : str) {
-			if (is_space(ch))
-				continue;
-			return ch == ';';
-		}
-		// empty line
-		return true;
-	}
+	list<Line>			lines_;
+	// comment and empty lines after the last command
+	list<Instruction>	tail_;
 
 	struct Cmd {
-		string prefix_, cmd_, rest_, comment_;
+		Instruction instruction_;
+		Opcode op_{Opcode::Unknown};
 
 		bool is_simple_command_{false};
 		int inputs_count_{0}, outputs_count_{0};
 
-		explicit Cmd(const string& str) {
-			int i = 0, n = str.size();
-			while (i < n && is_space(str[i]))
-				prefix_.push_back(str[i++]);
-			while (i < n && !is_space(str[i]) && str[i] != ';')
-				cmd_.push_back(str[i++]);
-			while (i < n && is_space(str[i]))
-				i++;
-			while (i < n && str[i] != ';')
-				rest_.push_back(str[i++]);
+		Cmd() = default;
+
+		explicit Cmd(Instruction instruction) :
+			instruction_{std::move(instruction)},
+			op_{instruction_.opcode} {
 			analyze();
 		}
 
-		bool is(const string& cmd) const {
-			return cmd_ == cmd;
+		bool is(Opcode op) const {
+			return op_ == op;
+		}
+
+		bool has(OpcodeFlags flag) const {
+			return opcodeInfo(op_).has(flag);
+		}
+
+		int depth() const {
+			return instruction_.depth;
+		}
+
+		const vector<Operand>& operands() const {
+			return instruction_.operands;
 		}
 
 		string rest() const {
-			return rest_;
+			return instruction_.operandsText();
+		}
+
+		Instruction without_prefix() const {
+			Instruction res = instruction_;
+			res.depth = 0;
+			res.comment.clear();
+			return res;
 		}
 
-		string without_prefix() const {
-			if (rest_.empty()) return cmd_;
-			return cmd_ + " " + rest_;
+		// The first operand is an integer which fits in int. Big constants, e.g. of uint128, aren't fetched.
+		bool has_int() const {
+			return has_int(0);
 		}
 
-		// TODO: Function fetch_int return int. And don't check integer overflow.
-		//		 What if there is big number. For example 128 unsigned int.
-		//		 Maybe use using u256 = boost::multiprecision::number<boost::multiprecision::cpp_int_backend<256, 256, boost::multiprecision::unsigned_magnitude, boost::multiprecision::unchecked, void>>;
-		//		 from libsolutil/Common.h or something else
 		int fetch_int() const {
-			return atoi(rest_.c_str());
+			return fetch_int(0);
 		}
 
 		int fetch_first_int() const {
-			size_t i = rest_.find(',');
-			solAssert(i != string::npos, "");
-			return atoi(rest_.substr(0, i).c_str());
+			solAssert(operands().size() >= 2, "");
+			return fetch_int(0);
 		}
 
 		int fetch_second_int() const {
-			size_t i = rest_.find(',');
-			solAssert(i != string::npos, "");
-			i++;
-			while (i < rest_.size() && is_space(rest_[i]))
-				i++;
-			solAssert(i != rest_.size(), "");
-			return atoi(rest_.substr(i).c_str());
+			solAssert(operands().size() >= 2, "");
+			return fetch_int(1);
 		}
 
 		bool is_drop_kind() const {
@@ -102,31 +101,34 @@ struct TVMOptimizer {
 		int get_drop_index() const {
 			if (is_DROP())
 				return 1;
-			if (is("DROP2"))
+			if (is(Opcode::DROP2))
 				return 2;
-			if (is("BLKDROP"))
+			if (is(Opcode::BLKDROP))
 				return fetch_int();
 			return 0;
 		}
 
-		int sumBLKSWAP() {
-			if (is("ROT") || is("ROTREV")) {
+		int sumBLKSWAP() const {
+			if (is(Opcode::ROT) || is(Opcode::ROTREV)) {
 				return 3;
 			}
-			if (is("SWAP2")) {
+			if (is(Opcode::SWAP2)) {
 				return 4;
 			}
-			if (is("BLKSWAP")) {
+			if (is(Opcode::BLKSWAP)) {
 				return fetch_first_int() + fetch_second_int();
 			}
 			solAssert(false, "");
 		}
 
+		// e.g. PUSH s1, but not PUSH c4 or XCHG s1, s2
+		bool has_stack_register() const {
+			return operands().size() == 1 && operands()[0].kind == Operand::Kind::StackRegister;
+		}
+
 		int get_index() const {
-			string s = rest();
-			solAssert(isIn(s.at(0), 's', 'S'), "");
-			s.erase(s.begin()); // skipping char S
-			return atoi(s.c_str());
+			solAssert(has_stack_register(), "");
+			return static_cast<int>(operands()[0].value);
 		}
 
 		int get_push_index() const {
@@ -136,44 +138,36 @@ struct TVMOptimizer {
 		}
 
 		std::pair<int, int> get_push2_indexes() const {
-			solAssert(is("PUSH2"), "");
-			std::string target = rest();
-			std::smatch sm;
-			std::regex re1(R"([S|s](\d+),\s*[S|s](\d+))");
-			std::regex_search(target, sm, re1);
-
-			int si = std::stoi(sm[1]);
-			int sj = std::stoi(sm[2]);
-			return {si, sj};
+			solAssert(is(Opcode::PUSH2), "");
+			solAssert(operands().size() == 2 && operands()[0].kind == Operand::Kind::StackRegister &&
+					  operands()[1].kind == Operand::Kind::StackRegister, "");
+			return {static_cast<int>(operands()[0].value), static_cast<int>(operands()[1].value)};
 		}
 
 		int get_pop_index() const {
 			solAssert(is_POP(), "");
-			string s = rest();
-			s.erase(s.begin());
-			return atoi(s.c_str());
+			return get_index();
 		}
 
 		bool is_commutative() const {
-			return is_ADD() || is_MUL() || is("AND") || is("OR") || is("XOR") ||
-					is("EQUAL") || is("NEQ");
+			return has(OpCommutative);
 		}
 
 		bool is_add_or_sub() const {
 			return is_ADD() || is_SUB();
 		}
 
-		bool is_ADD() const 	{ 	return is("ADD"); 		}
-		bool is_MUL() const 	{ 	return is("MUL");		}
-		bool is_SUB() const 	{ 	return is("SUB"); 		}
-		bool is_DROP() const 	{ 	return is("DROP"); 		}
-		bool is_NIP() const 	{ 	return is("NIP"); 		}
-		bool is_SWAP() const 	{ 	return is("SWAP"); 		}
-		bool is_DUP() const 	{ 	return is("DUP"); 		}
-		bool is_PUSH() const 	{ 	return is("PUSH") || is("DUP"); 		}
-		bool is_PUSHINT() const { 	return is("PUSHINT"); 	}
-		bool is_POP() const 	{ 	return is("POP"); 		}
-		bool isBLKSWAP() const  { return is("ROT") || is("ROTREV") || is("SWAP2") || is("BLKSWAP"); }
+		bool is_ADD() const 	{ 	return is(Opcode::ADD); 		}
+		bool is_MUL() const 	{ 	return is(Opcode::MUL);		}
+		bool is_SUB() const 	{ 	return is(Opcode::SUB); 		}
+		bool is_DROP() const 	{ 	return is(Opcode::DROP); 		}
+		bool is_NIP() const 	{ 	return is(Opcode::NIP); 		}
+		bool is_SWAP() const 	{ 	return is(Opcode::SWAP); 		}
+		bool is_DUP() const 	{ 	return is(Opcode::DUP); 		}
+		bool is_PUSH() const 	{ 	return (is(Opcode::PUSH) && has_stack_register()) || is(Opcode::DUP); }
+		bool is_PUSHINT() const { 	return is(Opcode::PUSHINT); 	}
+		bool is_POP() const 	{ 	return is(Opcode::POP) && has_stack_register(); }
+		bool isBLKSWAP() const  { return is(Opcode::ROT) || is(Opcode::ROTREV) || is(Opcode::SWAP2) || is(Opcode::BLKSWAP); }
 
 		bool is_simple_command(int inp, int outp) const {
 			return is_simple_command_ &&
@@ -182,143 +176,146 @@ struct TVMOptimizer {
 		}
 
 	private:
+		bool has_int(size_t index) const {
+			return index < operands().size() && operands()[index].kind == Operand::Kind::Integer &&
+				   std::numeric_limits<int>::min() <= operands()[index].value &&
+				   operands()[index].value <= std::numeric_limits<int>::max();
+		}
+
+		int fetch_int(size_t index) const {
+			solAssert(has_int(index), "");
+			return static_cast<int>(operands()[index].value);
+		}
+
 		void set_simple_command(int inp, int outp) {
 			is_simple_command_ = true;
 			inputs_count_  = inp;
 			outputs_count_ = outp;
 		}
 
-		bool try_simple_command(const set<string>& s, int inp, int outp) {
-			if (s.count(cmd_)) {
-				set_simple_command(inp, outp);
-				return true;
-			}
-			return false;
-		}
-
 		void analyze() {
-			static const set<string> s01 {
-				"PUSHINT", "GETGLOB", "PUSHSLICE", "TRUE", "FALSE", "ZERO", "NOW",
-				"NEWC", "NEWDICT"
-			};
-			static const set<string> s10 {
-				"DROP", "SETGLOB", "ENDS", "THROWIF", "THROWIFNOT", "THROWANY"
-			};
-			static const set<string> s11 {
-				"FITS", "UFITS", "INC", "DEC", "EQINT", "NOT",
-				"SHA256U", "HASHCU", "HASHSU", "CTOS", "INDEX",
-				"FIRST", "SECOND", "THIRD", "PARSEMSGADDR", "SBITS", "ENDC"
-			};
-			static const set<string> s21 {
-				"ADD", "MUL", "SUB", "SUBR", "DIV", "MOD",
-				"OR", "AND", "EQ", "LESS", "NEQ", "GREATER",
-				"SETINDEX", "PAIR", "PLDUX", "INDEXVAR", "STSLICE"
-			};
-			static const set<string> s32 {
-				"DICTUDEL", "DICTIDEL", "DICTDEL"
-			};
-
-			if (try_simple_command(s01, 0, 1)) return;
-			if (try_simple_command(s10, 1, 0)) return;
-			if (try_simple_command(s11, 1, 1)) return;
-			if (try_simple_command(s21, 2, 1)) return;
-			if (try_simple_command(s32, 3, 2)) return;
-
-			if (is("SWAP"))
-				return set_simple_command(2, 2);
-			if (is("ROT") || is("ROTREV"))
-				return set_simple_command(3, 3);
-			if (is("TUPLE"))
-				return set_simple_command(fetch_int(), 1);
-			if (is("UNTUPLE"))
-				return set_simple_command(1, fetch_int());
-			if (is("UNPAIR"))
-				return set_simple_command(1, 2);
-			if (is("SETINDEXVAR"))
-				return set_simple_command(3, 1);
+			const OpcodeInfo& info = opcodeInfo(op_);
+			if (!info.has(OpSimple))
+				return;
+			set_simple_command(info.has(OpVarInputs) ? fetch_int() : info.inputs,
+							   info.has(OpVarOutputs) ? fetch_int() : info.outputs);
 		}
 
 	};
 
-	static string get_cmd(const string& str) {
-		return Cmd(str).cmd_;
-	}
+	// Command line, decoded once when it is added to the optimizer
+	struct Line {
+		// comment and empty lines before the command. A list, so that they are moved to
+		// the replacement of the command in constant time
+		list<Instruction> comments_;
+		Cmd cmd_;
 
-	Cmd cmd(int idx) const {
-		if (valid(idx))
-			return Cmd(lines_[idx]);
-		return Cmd("");
+		explicit Line(Instruction instruction) :
+			cmd_{std::move(instruction)} {
+		}
+	};
+
+	explicit TVMOptimizer(const vector<Instruction>& lines) {
+		for (const Instruction& line : lines) {
+			if (line.isCommentOrEmpty()) {
+				tail_.push_back(line);
+			} else {
+				lines_.emplace_back(line);
+				lines_.back().comments_.splice(lines_.back().comments_.end(), tail_);
+			}
+		}
 	}
 
-	int next_command_line(int idx) const {
-		if (!valid(idx)) return -1;
-		idx++;
-		while (true) {
-			if (!valid(idx))
-				return -1;
-			if (!is_comment_or_empty_line(lines_[idx]))
-				return idx;
-			idx++;
+	vector<Instruction> result() const {
+		vector<Instruction> res;
+		for (const Line& line : lines_) {
+			res.insert(res.end(), line.comments_.begin(), line.comments_.end());
+			res.push_back(line.cmd_.instruction_);
 		}
+		res.insert(res.end(), tail_.begin(), tail_.end());
+		return res;
+	}
+
+	const Cmd& cmd(Pos idx) const {
+		static const Cmd empty;
+		if (valid(idx))
+			return idx->cmd_;
+		return empty;
 	}
 
-	bool valid(int idx) const {
-		return idx >= 0 && size_t(idx) < lines_.size();
+	Pos next_command_line(Pos idx) const {
+		if (!valid(idx)) return idx;
+		return std::next(idx);
 	}
 
-	void remove(int idx) {
-		lines_.erase(lines_.begin() + idx);
+	bool valid(Pos idx) const {
+		return idx != lines_.end();
 	}
 
-	void insert(int idx, const string& cmd, const string& pfx = "") {
-		lines_.insert(lines_.begin() + idx, pfx + cmd);
+	// Makes a line from cmd with the nesting level of a replaced line
+	static Instruction make_line(Instruction cmd, int depth) {
+		cmd.depth = depth;
+		return cmd;
 	}
 
-	bool is_cmd(int idx, const string& cmd) const {
-		return valid(idx) && get_cmd(lines_[idx]) == cmd;
+	bool is_cmd(Pos idx, Opcode op) const {
+		return valid(idx) && idx->cmd_.is(op);
 	}
 
 	struct Result {
 		bool continue_;
 		int remove_ = 0;
-		vector<string> commands_;
+		vector<Instruction> commands_;
 
-		Result(bool cont, int remove = 0, vector<string> commands = {}) :
+		Result(bool cont, int remove = 0, vector<Instruction> commands = {}) :
 			continue_(cont), remove_(remove), commands_{std::move(commands)} {
 
 		}
 
+		// Commands are instructions or text of a line, e.g. "PUSHINT 1"
 		template <class ...Args>
 		static Result Replace(int remove, Args... cmds) {
-			return Result(true, remove, {cmds...});
+			return Result(true, remove, {command(cmds)...});
 		}
 
 		static Result Comment(const string& cmd) {
 			Result res(false);
-			res.commands_.push_back(cmd);
+			res.commands_.push_back(Instruction::parse(cmd));
 			return res;
 		}
+
+		static Instruction command(const string& cmd) {
+			return Instruction::parse(cmd);
+		}
+
+		static Instruction command(Instruction cmd) {
+			return cmd;
+		}
+
+		static vector<Instruction> command(vector<Instruction> cmds) {
+			return cmds;
+		}
 	};
 
-	Result optimize_at(const int idx1) const {
-		int idx2 = next_command_line(idx1);
-		int idx3 = next_command_line(idx2);
-		int idx4 = next_command_line(idx3);
-		int idx5 = next_command_line(idx4);
-		Cmd cmd1 = cmd(idx1);
-		Cmd cmd2 = cmd(idx2);
-		Cmd cmd3 = cmd(idx3);
-		Cmd cmd4 = cmd(idx4);
-		Cmd cmd5 = cmd(idx5);
+	Result optimize_at(const Pos idx1) const {
+		Pos idx2 = next_command_line(idx1);
+		Pos idx3 = next_command_line(idx2);
+		Pos idx4 = next_command_line(idx3);
+		Pos idx5 = next_command_line(idx4);
+		const Cmd& cmd1 = cmd(idx1);
+		const Cmd& cmd2 = cmd(idx2);
+		const Cmd& cmd3 = cmd(idx3);
+		const Cmd& cmd4 = cmd(idx4);
+		const Cmd& cmd5 = cmd(idx5);
 		// TODO: INC + UFITS256...
 		if (cmd1.is_SWAP()) {
 			if (cmd2.is_SUB())		return Result::Replace(2, "SUBR");
-			if (cmd2.is("SUBR"))	return Result::Replace(2, "SUB");
+			if (cmd2.is(Opcode::SUBR))	return Result::Replace(2, "SUB");
 			if (cmd2.is_SWAP())		return Result::Replace(2);
 			if (cmd2.is_NIP())		return Result::Replace(2, "DROP");
 			if (cmd2.is_commutative())	return Result::Replace(1);
 		}
-		if (cmd1.is_PUSHINT() && cmd3.is_PUSHINT()) {
+		if (cmd1.is_PUSHINT() && cmd1.has_int() && cmd3.is_PUSHINT() && cmd3.has_int()) {
 			// TODO: consider INC/DEC as well
 			if (cmd2.is_add_or_sub() && cmd4.is_add_or_sub()) {
 				int sum = 0;
@@ -327,8 +324,8 @@ struct TVMOptimizer {
 				return Result::Replace(4, "PUSHINT " + toString(sum), "ADD");
 			}
 		}
-		if (cmd1.is_PUSHINT()) {
-			if (cmd1.rest() == "1") {
+		if (cmd1.is_PUSHINT() && cmd1.has_int()) {
+			if (cmd1.fetch_int() == 1) {
 				if (cmd2.is_ADD()) return Result::Replace(2, "INC");
 				if (cmd2.is_SUB()) return Result::Replace(2, "DEC");
 			}
@@ -341,31 +338,33 @@ struct TVMOptimizer {
 				if (cmd2.is_SUB()) return Result::Replace(2, "ADDCONST " + std::to_string(-value));
 			}
 		}
-		if (cmd1.is("RET") || cmd1.is("THROWANY") || cmd1.is("THROW")) {
-			// delete commands after noreturn opcode
-			if (cmd2.prefix_.length() >= cmd1.prefix_.length() &&  !cmd2.cmd_.empty())
+		if (cmd1.has(OpNoFallThrough)) {
+			// delete commands after an opcode that never falls through
+			if (cmd2.depth() >= cmd1.depth() && !cmd2.instruction_.isCommentOrEmpty())
 				return Result::Replace(2, cmd1.without_prefix());
 		}
-		if (cmd1.is("RET") && cmd2.is("}")) {
+		if (cmd1.is(Opcode::RET) && cmd2.is(Opcode::CONT_END)) {
 			return Result::Replace(2, "}");
 		}
 		if (cmd2.is_NIP() && cmd3.is_NIP()) {
 			// if (cmd1.is_PUSH() && cmd1.get_push_index() == 1) {
 				// return Result::Replace(3, "DROP");
 			// }
-			if (cmd1.is_PUSHINT() || cmd1.is("GETGLOB")) {
+			if (cmd1.is_PUSHINT() || cmd1.is(Opcode::GETGLOB)) {
 				return Result::Replace(3, "DROP2", cmd1.without_prefix());
 			}
 			// return Result::Comment(";;;;;;;;;;;;;; NIP+NIP");
 		}
 		if (cmd1.is_NIP() && cmd2.is_NIP() && cmd3.is_NIP()) {
-			int i = idx1, n = 0;
+			Pos i = idx1;
+			int n = 0;
 			while (cmd(i).is_NIP()) {
 				n++;
 				i = next_command_line(i);
 			}
 			if (n > 15) n = 15;
-			return Result::Replace(n, "BLKSWAP " + toString(n) + ", 1", "BLKDROP " + toString(n));
+			return Result::Replace(n, Instruction{Opcode::BLKSWAP, {Operand::integer(n), Operand::integer(1)}},
+								   Instruction{Opcode::BLKDROP, {Operand::integer(n)}});
 		}
 		if (cmd1.is_POP() && cmd1.get_pop_index() == 2 && cmd2.is_SWAP()) {
 			// TODO: generalize these cases...
@@ -375,8 +374,9 @@ struct TVMOptimizer {
 				return Result::Replace(4, cmd3.without_prefix(), cmd4.without_prefix(), "NIP");
 		}
 		if (cmd1.is_PUSHINT() && cmd2.is_PUSHINT() && cmd3.is_PUSHINT()) {
-			int i = idx1, n = 0;
-			while (cmd(i).is_PUSHINT() && cmd(i).fetch_int() == 0) {
+			Pos i = idx1;
+			int n = 0;
+			while (cmd(i).is_PUSHINT() && cmd(i).has_int() && cmd(i).fetch_int() == 0) {
 				n++;
 				i = next_command_line(i);
 			}
@@ -400,13 +400,14 @@ struct TVMOptimizer {
 			if (ok1 && ok2) {
 				if (cmd2.is_PUSH() && cmd2.get_push_index() == 0)
 					return Result::Replace(3, cmd1.without_prefix(), cmd2.without_prefix());
-				string s1 = cmd2.is_PUSH() ? make_PUSH(cmd2.get_push_index()-1) : cmd2.without_prefix();
-				string s2 = cmd1.is_PUSH() ? make_PUSH(cmd1.get_push_index()+1) : cmd1.without_prefix();
+				Instruction s1 = cmd2.is_PUSH() ? make_PUSH(cmd2.get_push_index()-1) : cmd2.without_prefix();
+				Instruction s2 = cmd1.is_PUSH() ? make_PUSH(cmd1.get_push_index()+1) : cmd1.without_prefix();
 				return Result::Replace(3, s1, s2);
 			}
 		}
 		if (cmd1.is_PUSH() && cmd2.is_PUSH()) {
-			int i = idx1, n = 0;
+			Pos i = idx1;
+			int n = 0;
 			while (cmd(i).is_PUSH() && cmd(i).get_push_index() == cmd1.get_push_index()) {
 				n++;
 				i = next_command_line(i);
@@ -423,7 +424,7 @@ struct TVMOptimizer {
 				return Result::Replace(2, make_DROP(cmd2.get_drop_index()-1));
 			}
 		}
-		if (cmd1.is("BLKPUSH") && cmd2.is_drop_kind()) {
+		if (cmd1.is(Opcode::BLKPUSH) && cmd2.is_drop_kind()) {
 			int diff = cmd1.fetch_first_int() - cmd2.get_drop_index();
 			if (diff == 0)
 				return Result::Replace(2);
@@ -439,7 +440,7 @@ struct TVMOptimizer {
 			return Result::Replace(2, make_DROP(q));
 		}
 		if (cmd1.is_simple_command_ && cmd1.inputs_count_ == 0 && cmd1.outputs_count_ == 1 && cmd2.is_NIP()) {
-			std::vector<std::string> dropOpcodes = make_DROP(1);
+			std::vector<Instruction> dropOpcodes = make_DROP(1);
 			dropOpcodes.push_back(cmd1.without_prefix());
 			return Result(true, 2, dropOpcodes);
 		}
@@ -453,7 +454,8 @@ struct TVMOptimizer {
 				return Result::Replace(2, cmd2.without_prefix());
 		}
 		if (cmd1.is_drop_kind() && cmd2.is_drop_kind()) {
-			int i = idx1, n = 0, total = 0;
+			Pos i = idx1;
+			int n = 0, total = 0;
 			while (cmd(i).is_drop_kind()) {
 				n++;
 				total += cmd(i).get_drop_index();
@@ -465,93 +467,93 @@ struct TVMOptimizer {
 		}
 		if (cmd1.is_PUSH() && cmd1.get_push_index() == 0) {
 			// Try to remove unneeded DUP..NIP/DROP pair
-			vector<string> commands;
+			vector<Instruction> commands;
 			int lines_to_remove = 1;
 			if (try_simulate(idx2, 2, lines_to_remove, commands))
 				return Result{true, lines_to_remove, commands};
 		}
 		if (cmd1.is_PUSH() && cmd1.get_push_index() == 1) {
 			// Try to remove unneeded PUSH S1..NIP/DROP pair
-			vector<string> commands{"SWAP"};
+			vector<Instruction> commands{Instruction{Opcode::SWAP}};
 			int lines_to_remove = 1;
 			if (try_simulate(idx2, 3, lines_to_remove, commands))
 				return Result{true, lines_to_remove, commands};
 		}
 		if (cmd1.is_simple_command(0, 1)) {
 			// Try to remove unneeded PUSHINT..NIP/DROP pair
-			vector<string> commands;
+			vector<Instruction> commands;
 			int lines_to_remove = 1;
 			if (try_simulate(idx2, 1, lines_to_remove, commands))
 				return Result{true, lines_to_remove, commands};
 		}
 		if (cmd1.is_SWAP()) {
 			// Try to remove unneeded SWAP..NIP/DROP pair
-			vector<string> commands{"DROP"};
+			vector<Instruction> commands{Instruction{Opcode::DROP}};
 			int lines_to_remove = 1;
 			if (try_simulate(idx2, 2, lines_to_remove, commands))
 				return Result{true, lines_to_remove, commands};
 		}
 		if (!cmd1.is_drop_kind()) {
 			// Check if topmost stack element can be dropped
-			vector<string> commands{"DROP"};
+			vector<Instruction> commands{Instruction{Opcode::DROP}};
 			int lines_to_remove = 0;
 			if (try_simulate(idx1, 1, lines_to_remove, commands))
 				return Result{true, lines_to_remove, commands};
 		}
 		if (false && !cmd1.is_NIP()) {	// TODO: disabled because this makes things worse
 			// Check if second topmost stack element can be dropped
-			vector<string> commands{"NIP"};
+			vector<Instruction> commands{Instruction{Opcode::NIP}};
 			int lines_to_remove = 0;
 			if (try_simulate(idx1, 2, lines_to_remove, commands))
 				return Result{true, lines_to_remove, commands};
 		}
-		if (cmd1.is("NEWC") && cmd2.is_simple_command(0, 1) &&
-			isIn(cmd3.cmd_, "STUR", "STIR", "STBR", "STBREFR", "STSLICER", "STREFR")) {
+		if (cmd1.is(Opcode::NEWC) && cmd2.is_simple_command(0, 1) &&
+			isIn(cmd3.op_, Opcode::STUR, Opcode::STIR, Opcode::STBR, Opcode::STBREFR, Opcode::STSLICER, Opcode::STREFR)) {
 			return Result::Replace(3,
 					cmd2.without_prefix(),
 					"NEWC",
-					cmd3.cmd_.substr(0, cmd3.cmd_.size() - 1) + " " + cmd3.rest());
+					Instruction{stored_to_new_builder(cmd3.op_), cmd3.operands()});
 		}
-		if (cmd1.is("PUSHCONT") && cmd2.is("}") && (cmd3.is("IF") || cmd3.is("IFNOT"))) {
+		if (cmd1.is(Opcode::PUSHCONT) && cmd2.is(Opcode::CONT_END) && (cmd3.is(Opcode::IF) || cmd3.is(Opcode::IFNOT))) {
 			return Result::Replace(3, "DROP");
 		}
-		if (cmd1.is("PUSHCONT") && cmd2.is("}") && cmd3.is("IFJMP")) {
+		if (cmd1.is(Opcode::PUSHCONT) && cmd2.is(Opcode::CONT_END) && cmd3.is(Opcode::IFJMP)) {
 			return Result::Replace(3, "IFRET");
 		}
-		if (cmd1.is("PUSHCONT") && cmd2.is("}") && cmd3.is("IFNOTJMP")) {
+		if (cmd1.is(Opcode::PUSHCONT) && cmd2.is(Opcode::CONT_END) && cmd3.is(Opcode::IFNOTJMP)) {
 			return Result::Replace(3, "IFNOTRET");
 		}
-		if (cmd1.is("PUSHCONT") &&
-			cmd2.is("THROW") &&
-			cmd3.is("}") &&
-			(cmd4.is("IF") || cmd4.is("IFJMP"))) {
-			return Result::Replace(4, "THROWIF " + cmd2.rest());
-		}
-		if (cmd1.is("PUSHCONT") &&
-		    cmd2.is("THROW") &&
-		    cmd3.is("}") &&
-		    (cmd4.is("IFNOT") || cmd4.is("IFNOTJMP"))) {
-			return Result::Replace(4, "THROWIFNOT " + cmd2.rest());
-		}
-		if (cmd1.is("GETGLOB") &&
-		    cmd2.is("ISNULL") &&
-		    cmd3.is("DROP")) {
+		if (cmd1.is(Opcode::PUSHCONT) &&
+			cmd2.is(Opcode::THROW) &&
+			cmd3.is(Opcode::CONT_END) &&
+			(cmd4.is(Opcode::IF) || cmd4.is(Opcode::IFJMP))) {
+			return Result::Replace(4, Instruction{Opcode::THROWIF, cmd2.operands()});
+		}
+		if (cmd1.is(Opcode::PUSHCONT) &&
+		    cmd2.is(Opcode::THROW) &&
+		    cmd3.is(Opcode::CONT_END) &&
+		    (cmd4.is(Opcode::IFNOT) || cmd4.is(Opcode::IFNOTJMP))) {
+			return Result::Replace(4, Instruction{Opcode::THROWIFNOT, cmd2.operands()});
+		}
+		if (cmd1.is(Opcode::GETGLOB) &&
+		    cmd2.is(Opcode::ISNULL) &&
+		    cmd3.is(Opcode::DROP)) {
 			return Result::Replace(3, "");
 		}
-		if ((cmd1.is("NOT") || (cmd1.is("EQINT") && cmd1.fetch_int() == 0)) &&
-		    cmd2.is("THROWIFNOT")) {
-			return Result::Replace(2, "THROWIF " + cmd2.rest());
+		if ((cmd1.is(Opcode::NOT) || (cmd1.is(Opcode::EQINT) && cmd1.fetch_int() == 0)) &&
+		    cmd2.is(Opcode::THROWIFNOT)) {
+			return Result::Replace(2, Instruction{Opcode::THROWIF, cmd2.operands()});
 		}
-		if (cmd1.is("NEQINT") && cmd1.fetch_int() == 0 &&
-		    cmd2.is("THROWIFNOT")) {
-			return Result::Replace(2, "THROWIFNOT " + cmd2.rest());
+		if (cmd1.is(Opcode::NEQINT) && cmd1.fetch_int() == 0 &&
+		    cmd2.is(Opcode::THROWIFNOT)) {
+			return Result::Replace(2, Instruction{Opcode::THROWIFNOT, cmd2.operands()});
 		}
-		if (cmd1.is("PUSH")) {
+		if (cmd1.is(Opcode::PUSH) && cmd1.has_stack_register()) {
 			// PUSH Sx
 			// XCHG n
 			// BLKDROP n
 			int pushIndex = cmd1.get_index();
-			if (cmd2.is("XCHG")) {
+			if (cmd2.is(Opcode::XCHG) && cmd2.has_stack_register()) {
 				int xghIndex = cmd2.get_index();
 				if (cmd3.is_drop_kind()) {
 					int dropedQty = cmd3.get_drop_index();
@@ -560,8 +562,10 @@ struct TVMOptimizer {
 						int j = std::max(pushIndex, xghIndex - 1);
 						if (i != j) {
 							if (pushIndex + 1 < dropedQty) {
-								std::vector<std::string> opcodes{"XCHG S" + toString(i) + ", S" + toString(j)};
-								std::vector<std::string> dropOpcodes = make_DROP(dropedQty - 1);
+								std::vector<Instruction> opcodes{
+									Instruction{Opcode::XCHG, {Operand::stackRegister(i, 'S'), Operand::stackRegister(j, 'S')}}
+								};
+								std::vector<Instruction> dropOpcodes = make_DROP(dropedQty - 1);
 								opcodes.insert(opcodes.end(), dropOpcodes.begin(), dropOpcodes.end());
 								return Result(true, 3, opcodes);
 							}
@@ -572,88 +576,82 @@ struct TVMOptimizer {
 				}
 			}
 		}
-		if (cmd1.is("ROT") && cmd2.is("ROTREV")) {
+		if (cmd1.is(Opcode::ROT) && cmd2.is(Opcode::ROTREV)) {
 			return Result::Replace(2);
 		}
-		if (cmd1.is("ROTREV") && cmd2.is("ROT")) {
+		if (cmd1.is(Opcode::ROTREV) && cmd2.is(Opcode::ROT)) {
 			return Result::Replace(2);
 		}
-		if (cmd1.is("PUSHINT") && cmd2.is("STZEROES") && cmd3.is("STSLICECONST") && cmd3.rest() == "0") {
-			return Result::Replace(3, "PUSHINT " + toString(cmd1.fetch_int() + 1), "STZEROES");
+		if (cmd1.is(Opcode::PUSHINT) && cmd1.has_int() && cmd2.is(Opcode::STZEROES) && cmd3.is(Opcode::STSLICECONST) &&
+			cmd3.rest() == "0") {
+			return Result::Replace(3, Instruction{Opcode::PUSHINT, {Operand::integer(cmd1.fetch_int() + 1)}}, "STZEROES");
 		}
 
-		if (cmd1.is("PUSHSLICE") &&
-			cmd2.is("NEWC") &&
-			cmd3.is("STSLICE") &&
-			cmd4.is("STSLICECONST")) {
+		if (cmd1.is(Opcode::PUSHSLICE) &&
+			cmd2.is(Opcode::NEWC) &&
+			cmd3.is(Opcode::STSLICE) &&
+			cmd4.is(Opcode::STSLICECONST)) {
 			std::vector<std::string> opcodes = unitSlices(cmd1.rest(), cmd4.rest());
 			if (opcodes.size() == 1) {
-				opcodes[0] = "PUSHSLICE " + opcodes[0];
-				opcodes.emplace_back("NEWC");
-				opcodes.emplace_back("STSLICE");
-				return Result(true, 4, opcodes);
+				return Result::Replace(4, make_slice(Opcode::PUSHSLICE, opcodes[0]), "NEWC", "STSLICE");
 			}
 		}
-		if (cmd1.is("PUSHSLICE") &&
-		    cmd2.is("STSLICER") &&
-		    cmd3.is("STSLICECONST")) {
+		if (cmd1.is(Opcode::PUSHSLICE) &&
+		    cmd2.is(Opcode::STSLICER) &&
+		    cmd3.is(Opcode::STSLICECONST)) {
 			std::vector<std::string> opcodes = unitSlices(cmd1.rest(), cmd3.rest());
 			if (opcodes.size() == 1) {
-				opcodes[0] = "PUSHSLICE " + opcodes[0];
-				opcodes.emplace_back("STSLICER");
-				return Result(true, 3, opcodes);
+				return Result::Replace(3, make_slice(Opcode::PUSHSLICE, opcodes[0]), "STSLICER");
 			}
 		}
-		if (cmd1.is("PUSHINT") &&
-		    cmd2.is("STZEROES") &&
-		    cmd3.is("STSLICECONST") && cmd3.rest().length() > 1) {
+		if (cmd1.is(Opcode::PUSHINT) && cmd1.has_int() &&
+		    cmd2.is(Opcode::STZEROES) &&
+		    cmd3.is(Opcode::STSLICECONST) && cmd3.rest().length() > 1) {
 			std::string::size_type integer = cmd1.fetch_int();
 			std::vector<std::string> opcodes = unitBitString(std::string(integer, '0'), toBitString(cmd3.rest()));
 			if (opcodes.size() == 1) {
-				opcodes[0] = "PUSHSLICE " + opcodes[0];
-				opcodes.emplace_back("STSLICER");
-				return Result(true, 3, opcodes);
+				return Result::Replace(3, make_slice(Opcode::PUSHSLICE, opcodes[0]), "STSLICER");
 			}
 		}
-		if (cmd1.is("STSLICECONST") &&
-		    cmd2.is("STSLICECONST")) {
+		if (cmd1.is(Opcode::STSLICECONST) &&
+		    cmd2.is(Opcode::STSLICECONST)) {
 			std::vector<std::string> opcodes = unitSlices(cmd1.rest(), cmd2.rest());
 			if (opcodes.size() == 1 && toBitString(opcodes[0]).length() <= TvmConst::MaxSTSLICECONST) {
-				return Result(true, 2, {"STSLICECONST " + opcodes[0]});
+				return Result::Replace(2, make_slice(Opcode::STSLICECONST, opcodes[0]));
 			}
 		}
-		if (cmd1.is("PUSHSLICE") &&
-			cmd2.is("NEWC") &&
-			cmd3.is("STSLICECONST") &&
-			cmd4.is("STSLICE")) {
+		if (cmd1.is(Opcode::PUSHSLICE) &&
+			cmd2.is(Opcode::NEWC) &&
+			cmd3.is(Opcode::STSLICECONST) &&
+			cmd4.is(Opcode::STSLICE)) {
 			std::vector<std::string> opcodes = unitSlices(cmd3.rest(), cmd1.rest());
 			if (opcodes.size() == 1) {
-				return Result(true, 4, {"PUSHSLICE " + opcodes[0], "NEWC", "STSLICE"});
+				return Result::Replace(4, make_slice(Opcode::PUSHSLICE, opcodes[0]), "NEWC", "STSLICE");
 			}
 		}
-		if (cmd1.is("PUSHSLICE") &&
-		    cmd2.is("NEWC") &&
-		    cmd3.is("STSLICE") &&
-		    cmd4.is("PUSHSLICE") &&
-			cmd5.is("STSLICER")) {
+		if (cmd1.is(Opcode::PUSHSLICE) &&
+		    cmd2.is(Opcode::NEWC) &&
+		    cmd3.is(Opcode::STSLICE) &&
+		    cmd4.is(Opcode::PUSHSLICE) &&
+			cmd5.is(Opcode::STSLICER)) {
 			std::vector<std::string> opcodes = unitSlices(cmd1.rest(), cmd4.rest());
 			if (opcodes.size() == 1) {
-				return Result(true, 5, {"PUSHSLICE " + opcodes[0], "NEWC", "STSLICE"});
+				return Result::Replace(5, make_slice(Opcode::PUSHSLICE, opcodes[0]), "NEWC", "STSLICE");
 			}
 		}
-		if (cmd1.is("TUPLE") &&
-		    cmd2.is("UNTUPLE") &&
+		if (cmd1.is(Opcode::TUPLE) &&
+		    cmd2.is(Opcode::UNTUPLE) &&
 		    cmd1.fetch_int() == cmd2.fetch_int()) {
 			return Result(true, 2, {});
 		}
-		if (cmd1.is("PAIR") &&
-		    cmd2.is("UNPAIR")) {
+		if (cmd1.is(Opcode::PAIR) &&
+		    cmd2.is(Opcode::UNPAIR)) {
 			return Result(true, 2, {});
 		}
-		if (cmd1.is("ROT") &&
-			(cmd2.is("SETGLOB") || (cmd2.is("POP") && cmd2.get_index() >= 3)) &&
-		    cmd3.is("SWAP")) {
-			return Result(true, 3, {"XCHG s2", cmd2.without_prefix()});
+		if (cmd1.is(Opcode::ROT) &&
+			(cmd2.is(Opcode::SETGLOB) || (cmd2.is_POP() && cmd2.get_index() >= 3)) &&
+		    cmd3.is(Opcode::SWAP)) {
+			return Result(true, 3, {Instruction{Opcode::XCHG, {Operand::stackRegister(2)}}, cmd2.without_prefix()});
 		}
 		return Result(false);
 	}
@@ -708,7 +706,7 @@ struct TVMOptimizer {
 		return opcodes;
 	}
 
-	bool try_simulate(int i, int stack_size, int& remove_count, vector<string>& commands) const {
+	bool try_simulate(Pos i, int stack_size, int& remove_count, vector<Instruction>& commands) const {
 		if (!valid(i))
 			return false;
 		bool first_time = true;
@@ -721,7 +719,7 @@ struct TVMOptimizer {
 			}
 			if (!valid(i))
 				return false;
-			Cmd c = cmd(i);
+			const Cmd& c = cmd(i);
 			// DBG(c.without_prefix() << " - " << stack_size);
 			if (c.is_PUSH()) {
 				if (c.get_push_index() + 1 == stack_size)
@@ -749,7 +747,7 @@ struct TVMOptimizer {
 				stack_size--;
 				continue;
 			}
-			if (c.is("BLKPUSH")) {
+			if (c.is(Opcode::BLKPUSH)) {
 				// check if the topmost element is not touched
 				if (c.fetch_second_int() + 1 < stack_size) {
 					commands.push_back(c.without_prefix());
@@ -775,7 +773,7 @@ struct TVMOptimizer {
 				int n = c.get_drop_index();
 				if (stack_size <= n) {
 					if (n > 1) {
-						std::vector<std::string> dropOpcodes = make_DROP(n - 1);
+						std::vector<Instruction> dropOpcodes = make_DROP(n - 1);
 						commands.insert(commands.end(), dropOpcodes.begin(), dropOpcodes.end());
 					}
 					remove_count++;
@@ -798,21 +796,21 @@ struct TVMOptimizer {
 		return true;
 	}
 
-	Result unsquash_push(const int idx1) const {
-		Cmd cmd1 = cmd(idx1);
-		if (cmd1.is("PUSH2")) {
+	Result unsquash_push(const Pos idx1) const {
+		const Cmd& cmd1 = cmd(idx1);
+		if (cmd1.is(Opcode::PUSH2)) {
 			auto [si, sj] = cmd1.get_push2_indexes();
 			return Result::Replace(1, make_PUSH(si), make_PUSH(sj + 1));
 		}
 		return Result(false);
 	}
 
-	Result squash_push(const int idx1) const {
-		int idx2 = next_command_line(idx1);
-		int idx3 = next_command_line(idx2);
-		Cmd cmd1 = cmd(idx1);
-		Cmd cmd2 = cmd(idx2);
-		Cmd cmd3 = cmd(idx3);
+	Result squash_push(const Pos idx1) const {
+		Pos idx2 = next_command_line(idx1);
+		Pos idx3 = next_command_line(idx2);
+		const Cmd& cmd1 = cmd(idx1);
+		const Cmd& cmd2 = cmd(idx2);
+		const Cmd& cmd3 = cmd(idx3);
 		if (cmd1.is_PUSH() && cmd2.is_PUSH() && cmd3.is_PUSH()) {
 			const int si = cmd1.get_push_index();
 			const int sj = cmd2.get_push_index() - 1 == -1? si : cmd2.get_push_index() - 1;
@@ -820,8 +818,8 @@ struct TVMOptimizer {
 					cmd3.get_push_index() - 2 == -2? sj : cmd3.get_push_index() - 2
 			);
 			if (si <= 15 && sj <= 15 && sk <= 15) {
-				const std::string newOpcode = (boost::format("PUSH3 S%d, S%d, S%d") % si % sj % sk).str();
-				return Result::Replace(3, newOpcode);
+				return Result::Replace(3, Instruction{Opcode::PUSH3, {Operand::stackRegister(si, 'S'), Operand::stackRegister(sj, 'S'),
+																	  Operand::stackRegister(sk, 'S')}});
 			}
 		}
 		if (cmd1.is_PUSH() && cmd2.is_PUSH()) {
@@ -831,16 +829,15 @@ struct TVMOptimizer {
 			const int si = cmd1.get_push_index();
 			const int sj = cmd2.get_push_index() - 1 == -1? si : cmd2.get_push_index() - 1;
 			if (si <= 15 && sj <= 15) {
-				const std::string newOpcode = (boost::format("PUSH2 S%d, S%d") % si % sj).str();
-				return Result::Replace(2, newOpcode);
+				return Result::Replace(2, Instruction{Opcode::PUSH2, {Operand::stackRegister(si, 'S'), Operand::stackRegister(sj, 'S')}});
 			}
 		}
-		if (cmd1.is("BLKPUSH")) {
+		if (cmd1.is(Opcode::BLKPUSH)) {
 			if (cmd1.fetch_first_int() == 2 && cmd1.fetch_second_int() == 1) {
 				return Result::Replace(1, "DUP2");
 			}
 		}
-		if (cmd1.is("BLKPUSH")) {
+		if (cmd1.is(Opcode::BLKPUSH)) {
 			if (cmd1.fetch_first_int() == 2 && cmd1.fetch_second_int() == 3) {
 				return Result::Replace(1, "OVER2");
 			}
@@ -848,89 +845,102 @@ struct TVMOptimizer {
 		return Result(false);
 	}
 
-	static std::vector<std::string> make_DROP(int n) {
+	static std::vector<Instruction> make_DROP(int n) {
 		solAssert(n > 0, "");
-		if (n == 1) return {"DROP"};
-		if (n == 2) return {"DROP2"};
-		if (n <= 15) return {"BLKDROP " + toString(n)};
-		return {"PUSHINT " + toString(n), "DROPX"};
+		if (n == 1) return {Instruction{Opcode::DROP}};
+		if (n == 2) return {Instruction{Opcode::DROP2}};
+		if (n <= 15) return {Instruction{Opcode::BLKDROP, {Operand::integer(n)}}};
+		return {Instruction{Opcode::PUSHINT, {Operand::integer(n)}}, Instruction{Opcode::DROPX}};
+	}
+
+	// e.g. STU for STUR, the new builder is below the value
+	static Opcode stored_to_new_builder(Opcode op) {
+		switch (op) {
+			case Opcode::STUR: return Opcode::STU;
+			case Opcode::STIR: return Opcode::STI;
+			case Opcode::STBR: return Opcode::STB;
+			case Opcode::STBREFR: return Opcode::STBREF;
+			case Opcode::STSLICER: return Opcode::STSLICE;
+			case Opcode::STREFR: return Opcode::STREF;
+			default: solAssert(false, "");
+		}
+	}
+
+	static Instruction make_slice(Opcode op, const string& slice) {
+		return Instruction{op, {Operand::slice(slice)}};
 	}
 
-	static string make_PUSH(int n) {
+	static Instruction make_PUSH(int n) {
 		solAssert(n >= 0, "");
-		if (n == 0) return "DUP";
-		return "PUSH S" + toString(n);
+		if (n == 0) return Instruction{Opcode::DUP};
+		return Instruction{Opcode::PUSH, {Operand::stackRegister(n, 'S')}};
 	}
 
-	static string make_POP(int n) {
+	static Instruction make_POP(int n) {
 		solAssert(n >= 0, "");
-		if (n == 0) return "DROP";
-		if (n == 1) return "NIP";
-		return "POP S" + toString(n);
+		if (n == 0) return Instruction{Opcode::DROP};
+		if (n == 1) return Instruction{Opcode::NIP};
+		return Instruction{Opcode::POP, {Operand::stackRegister(n, 'S')}};
 	}
 
-	static string make_BLKPUSH(int n, int m) {
+	static Instruction make_BLKPUSH(int n, int m) {
 		solAssert(n > 0, "");
 		solAssert(m >= 0 && m <= 15, "");
 		if (n == 1) return make_PUSH(m);
-		return "BLKPUSH " + toString(n) + ", " + toString(m);
+		return Instruction{Opcode::BLKPUSH, {Operand::integer(n), Operand::integer(m)}};
 	}
 
-	bool updateLines(int& idx1, const Result& res) {
-		deque<int> linesToRemove;
-		for (int i = idx1; linesToRemove.size() < size_t(res.remove_); i = next_command_line(i)) {
-			linesToRemove.push_front(i);
-		}
-
-		if (!res.commands_.empty()) {
-			string prefix = Cmd(lines_[idx1]).prefix_;
-			for (int i = idx1, iter = 0; iter < res.remove_; i = next_command_line(i), ++iter) {
-				string currentPrefix = Cmd(lines_[i]).prefix_;
-				if (prefix.size() > currentPrefix.size()) {
-					prefix = currentPrefix;
-				}
-			}
-
-			if (!linesToRemove.empty()) {
-				// We have removed something, so add replacement commands.
-				for (auto it = res.commands_.rbegin(); it != res.commands_.rend(); it++)
-					if (!it->empty()) {
-						insert(linesToRemove.front() + 1, *it, prefix);
-					}
-			} else {
-				// We add only a comment, check if it was not added before.
-				solAssert(res.commands_.size() == 1, "");
-				string cmd = res.commands_.front();
-				if (lines_[idx1] != prefix + cmd) {
-					if (lines_[idx1-1] != prefix + cmd) {
-						insert(idx1, cmd, prefix);
-						idx1++;
-					}
+	bool updateLines(Pos& idx1, const Result& res) {
+		if (res.remove_ == 0 && !res.commands_.empty()) {
+			// We add only a comment, check if it was not added before.
+			solAssert(res.commands_.size() == 1, "");
+			Instruction line = make_line(res.commands_.front(), idx1->cmd_.depth());
+			const Instruction* prev = nullptr;
+			if (!idx1->comments_.empty())
+				prev = &idx1->comments_.back();
+			else if (idx1 != lines_.begin())
+				prev = &std::prev(idx1)->cmd_.instruction_;
+			if (idx1->cmd_.instruction_ != line && (prev == nullptr || *prev != line))
+				idx1->comments_.push_back(line);
+		} else if (res.remove_ > 0) {
+			// The replacement commands take the place of the last removed command.
+			// Comments between removed commands are kept before them.
+			int depth = idx1->cmd_.depth();
+			list<Instruction> comments;
+			Pos end = idx1;
+			for (int iter = 0; iter < res.remove_; ++iter, ++end) {
+				solAssert(valid(end), "");
+				depth = std::min(depth, end->cmd_.depth());
+				comments.splice(comments.end(), end->comments_);
+			}
+
+			if (false) {
+				DBG("> Replacing");
+				for (Pos it = idx1; it != end; ++it)
+					DBG(it->cmd_.instruction_.str());
+				DBG("> with");
+				for (const Instruction& command : res.commands_)
+					DBG(command.str());
+			}
+
+			Pos first = end;
+			for (const Instruction& command : res.commands_) {
+				if (!command.empty()) {
+					Pos it = lines_.emplace(end, make_line(command, depth));
+					if (first == end)
+						first = it;
 				}
 			}
-		}
-
-		if (false && !linesToRemove.empty()) {
-			DBG("> Replacing");
-			for (auto it = linesToRemove.rbegin(); it != linesToRemove.rend(); it++)
-				DBG(lines_[*it]);
-			DBG("> with");
-			for (auto s : res.commands_)
-				DBG(s);
-		}
-
-		for (int l : linesToRemove) {
-			remove(l);
+			lines_.erase(idx1, first);
+			list<Instruction>& next = first != lines_.end() ? first->comments_ : tail_;
+			next.splice(next.begin(), comments);
+			idx1 = first;
 		}
 
 		if (res.continue_) {
 			// step back to several commands
-			int cnt = 10, i = idx1;
-			while (cnt > 0) {
-				i--;
-				if (!valid(i)) break;
-				if (!is_comment_or_empty_line(lines_[i])) cnt--;
-				idx1 = i;
+			for (int cnt = 0; cnt < 10 && idx1 != lines_.begin(); ++cnt) {
+				--idx1;
 			}
 			return true;
 		}
@@ -938,8 +948,8 @@ struct TVMOptimizer {
 		return false;
 	}
 
-	void optimize(const std::function<Result(int)> &f) {
-		int idx1 = 0;
+	void optimize(const std::function<Result(Pos)> &f) {
+		Pos idx1 = lines_.begin();
 		while (valid(idx1)) {
 			Result res = f(idx1);
 			if (updateLines(idx1, res)) {
@@ -953,11 +963,12 @@ struct TVMOptimizer {
 CodeLines optimize_code(const CodeLines& code0) {
 	auto code = code0;
 	TVMOptimizer optimizer{code.lines};
-	optimizer.optimize([&optimizer](int index){ return optimizer.unsquash_push(index);});
-	optimizer.optimize([&optimizer](int index){ return optimizer.optimize_at(index);});
-	optimizer.optimize([&optimizer](int index){ return optimizer.optimize_at(index);});
-	optimizer.optimize([&optimizer](int index){ return optimizer.squash_push(index);});
-	code.lines = optimizer.lines_;
+	using Pos = TVMOptimizer::Pos;
+	optimizer.optimize([&optimizer](Pos index){ return optimizer.unsquash_push(index);});
+	optimizer.optimize([&optimizer](Pos index){ return optimizer.optimize_at(index);});
+	optimizer.optimize([&optimizer](Pos index){ return optimizer.optimize_at(index);});
+	optimizer.optimize([&optimizer](Pos index){ return optimizer.squash_push(index);});
+	code.lines = optimizer.result();
 	return code;
 }
 
@@ -0,0 +1,295 @@
+/*
+ * Copyright 2018-2020 TON DEV SOLUTIONS LTD.
+ *
+ * Licensed under the  terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the  GNU General Public License for more details at: https://www.gnu.org/licenses/gpl-3.0.html
+ */
+/**
+ * @author TON Labs <connect@tonlabs.io>
+ * @date 2020
+ * Outlining of repeated instruction sequences into macros
+ */
+
+#include "TVMConstants.hpp"
+#include "TVMOutliner.hpp"
+
+using namespace solidity::frontend;
+
+namespace {
+
+const size_t MinSequenceLength = 2;
+const size_t MaxSequenceLength = 32;
+
+}
+
+TVMOutliner::TVMOutliner(CodeLines code) : m_lines{std::move(code.lines)} {
+	const size_t end = m_lines.size();
+	m_next.assign(end, end);
+	m_prev.assign(end, end);
+	m_keys.assign(end, -1);
+	m_removed.assign(end, false);
+	size_t last = end;
+	for (size_t i = 0; i < end; ++i) {
+		Instruction const& line = m_lines[i];
+		if (line.depth == 0 && (line.name == ".globl" || line.name == ".macro" || line.name == ".internal")) {
+			m_names.insert(line.operands.empty() ? "" : line.operands[0].name());
+		}
+		// Lines which may be outlined, comments are skipped. Other lines break sequences.
+		if (line.isCommentOrEmpty()) {
+			continue;
+		}
+		m_keys[i] = key(line);
+		m_prev[i] = last;
+		if (last != end) {
+			m_next[last] = i;
+		}
+		last = i;
+	}
+}
+
+CodeLines TVMOutliner::outline() {
+	for (size_t i = 0; i < m_lines.size(); ++i) {
+		if (!m_lines[i].isCommentOrEmpty()) {
+			updateSequences(i, i, true);
+		}
+	}
+	updateBest();
+	while (outlineBestSequence()) {
+	}
+
+	CodeLines code;
+	for (size_t i = 0; i < m_lines.size(); ++i) {
+		if (!m_removed[i]) {
+			code.lines.push_back(std::move(m_lines[i]));
+		}
+	}
+	for (CodeLines& macro : m_macros) {
+		code.append(std::move(macro));
+	}
+	return code;
+}
+
+bool TVMOutliner::canOutline(Instruction const& instruction) {
+	if (instruction.opcode == Opcode::Unknown || instruction.opcode == Opcode::CONT_END) {
+		return false;
+	}
+	for (Operand const& operand : instruction.operands) {
+		// e.g. PUSH c0, POP c1
+		if (operand.kind == Operand::Kind::Continuation ||
+			(operand.kind == Operand::Kind::ControlRegister && operand.value <= 3)) {
+			return false;
+		}
+	}
+	switch (instruction.opcode) {
+		case Opcode::CALL: // the callee returns to the macro
+			return true;
+		case Opcode::EXECUTE:
+		case Opcode::CALLX:
+		case Opcode::JMPX:
+		case Opcode::CALLXARGS:
+		case Opcode::JMPXARGS:
+		case Opcode::RET:
+		case Opcode::RETALT:
+		case Opcode::IFRET:
+		case Opcode::IFNOTRET:
+		case Opcode::IF:
+		case Opcode::IFNOT:
+		case Opcode::IFJMP:
+		case Opcode::IFNOTJMP:
+		case Opcode::IFELSE:
+		case Opcode::CONDSEL:
+		case Opcode::REPEAT:
+		case Opcode::UNTIL:
+		case Opcode::WHILE:
+		case Opcode::AGAIN:
+		case Opcode::JMP:
+		case Opcode::PUSHCTR:
+		case Opcode::POPCTR:
+		case Opcode::BLESS:
+		case Opcode::TRY:
+		case Opcode::DICTIGETJMP:
+		case Opcode::DICTUGETJMP:
+		case Opcode::DICTIGETEXEC:
+		case Opcode::DICTUGETEXEC:
+		case Opcode::DICTPUSHCONST:
+			return false;
+		default:
+			return true;
+	}
+}
+
+bool TVMOutliner::BestFirst::operator()(
+	std::pair<int, Sequence const*> const& a,
+	std::pair<int, Sequence const*> const& b
+) const {
+	if (a.first != b.first) {
+		return a.first > b.first;
+	}
+	if (a.second->size() != b.second->size()) {
+		return a.second->size() > b.second->size();
+	}
+	return *a.second < *b.second;
+}
+
+int TVMOutliner::key(Instruction const& instruction) {
+	if (!canOutline(instruction)) {
+		return -1;
+	}
+	std::string key = instruction.mnemonic() + " " + instruction.operandsText();
+	return m_keyIds.emplace(key, static_cast<int>(m_keyIds.size())).first->second;
+}
+
+void TVMOutliner::updateSequences(size_t start, size_t from, bool add) {
+	const size_t end = m_lines.size();
+	Sequence sequence;
+	int bits = 0;
+	for (size_t i = start; i != end && sequence.size() < MaxSequenceLength; i = m_next[i]) {
+		if (m_keys[i] < 0 || m_lines[i].depth != m_lines[start].depth) {
+			break;
+		}
+		sequence.push_back(m_keys[i]);
+		bits += m_lines[i].bits();
+		if (sequence.size() < MinSequenceLength || i < from) {
+			continue;
+		}
+		OccurrenceMap::value_type& entry = *m_occurrences.try_emplace(sequence).first;
+		Occurrences& occurrences = entry.second;
+		occurrences.bits = bits;
+		if (add) {
+			occurrences.ranges.emplace(start, i);
+		} else {
+			occurrences.ranges.erase(start);
+		}
+		if (!occurrences.isChanged) {
+			occurrences.isChanged = true;
+			m_changed.push_back(&entry);
+		}
+	}
+}
+
+void TVMOutliner::updateBest() {
+	// entries of unordered_map aren't moved on rehashing
+	for (OccurrenceMap::value_type* entry : m_changed) {
+		Occurrences& occurrences = entry->second;
+		occurrences.isChanged = false;
+		if (occurrences.saving > 0) {
+			m_best.erase({occurrences.saving, &entry->first});
+		}
+		if (occurrences.ranges.empty()) {
+			m_occurrences.erase(m_occurrences.find(entry->first));
+			continue;
+		}
+		occurrences.saving = saving(occurrences, occurrences.ranges.size());
+		occurrences.isExact = false;
+		if (occurrences.saving > 0) {
+			m_best.emplace(occurrences.saving, &entry->first);
+		}
+	}
+	m_changed.clear();
+}
+
+std::vector<std::pair<size_t, size_t>> TVMOutliner::chooseRanges(Occurrences const& occurrences) {
+	std::vector<std::pair<size_t, size_t>> chosen;
+	for (auto const& range : occurrences.ranges) {
+		if (chosen.empty() || chosen.back().second < range.first) {
+			chosen.push_back(range);
+		}
+	}
+	return chosen;
+}
+
+int TVMOutliner::saving(Occurrences const& occurrences, int qty) {
+	if (qty < 2) {
+		return 0;
+	}
+	const int bits = occurrences.bits;
+	return qty * (bits - TvmConst::CodeSize::CallBits) - (bits + TvmConst::CodeSize::FunctionBits);
+}
+
+bool TVMOutliner::outlineBestSequence() {
+	// Overlapping occurrences are found only for the best sequences
+	while (!m_best.empty() && !m_occurrences.at(*m_best.begin()->second).isExact) {
+		Sequence const* sequence = m_best.begin()->second;
+		m_best.erase(m_best.begin());
+		Occurrences& occurrences = m_occurrences.at(*sequence);
+		occurrences.saving = saving(occurrences, chooseRanges(occurrences).size());
+		occurrences.isExact = true;
+		if (occurrences.saving > 0) {
+			m_best.emplace(occurrences.saving, sequence);
+		}
+	}
+	if (m_best.empty()) {
+		return false;
+	}
+	const std::vector<std::pair<size_t, size_t>> ranges = chooseRanges(m_occurrences.at(*m_best.begin()->second));
+
+	const std::string name = newMacroName();
+	CodeLines macro;
+	macro.push(".macro " + name);
+	const auto [first, last] = ranges.front();
+	for (size_t i = first; i <= last; ++i) {
+		if (m_removed[i]) {
+			continue;
+		}
+		Instruction line = m_lines[i];
+		line.depth -= m_lines[first].depth;
+		macro.push(line);
+	}
+	macro.push(" ");
+	m_macros.push_back(macro);
+
+	// Only the sequences which overlap the occurrences change: the ones which start in them and
+	// the ones which start in MaxSequenceLength - 1 lines before them and get into them
+	const size_t end = m_lines.size();
+	std::vector<std::pair<size_t, size_t>> starts; // line -> first line of the occurrence it gets into
+	for (auto const& [from, to] : ranges) {
+		size_t i = from;
+		for (size_t k = 1; k < MaxSequenceLength && m_prev[i] != end; ++k) {
+			i = m_prev[i];
+			starts.emplace_back(i, from);
+		}
+		for (i = from; i != m_next[to]; i = m_next[i]) {
+			starts.emplace_back(i, i);
+		}
+	}
+	for (auto const& [start, from] : starts) {
+		updateSequences(start, from, false);
+	}
+
+	for (auto const& [from, to] : ranges) {
+		for (size_t i = from + 1; i <= to; ++i) {
+			m_removed[i] = true;
+		}
+		const int depth = m_lines[from].depth;
+		m_lines[from] = Instruction{Opcode::CALL, {Operand::function(name)}};
+		m_lines[from].depth = depth;
+		m_keys[from] = key(m_lines[from]);
+		m_next[from] = m_next[to];
+		if (m_next[to] != end) {
+			m_prev[m_next[to]] = from;
+		}
+	}
+
+	for (auto const& [start, from] : starts) {
+		if (!m_removed[start]) {
+			updateSequences(start, from, true);
+		}
+	}
+	updateBest();
+	return true;
+}
+
+std::string TVMOutliner::newMacroName() {
+	std::string name;
+	do {
+		name = "outlined_" + toString(m_macroQty++);
+	} while (m_names.count(name));
+	m_names.insert(name);
+	return name;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2018-2020 TON DEV SOLUTIONS LTD.
+ *
+ * Licensed under the  terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the  GNU General Public License for more details at: https://www.gnu.org/licenses/gpl-3.0.html
+ */
+/**
+ * @author TON Labs <connect@tonlabs.io>
+ * @date 2020
+ * Outlining of repeated instruction sequences into macros
+ */
+
+#pragma once
+
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
+
+#include "TVMPusher.hpp"
+
+namespace solidity::frontend {
+
+// Replaces instruction sequences which are repeated in the generated code (e.g. decoding of parameters,
+// building of messages or dictionary operations) with calls of new macros "outlined_N".
+//
+// A macro called by CALL works on the stack of the caller, so any sequence of instructions which don't
+// transfer control (RET, IFJMP, loops and so on) and don't change control registers can be outlined,
+// whatever its stack effect is. Sequences don't cross continuation boundaries ('{' and '}').
+//
+// The sequence which saves most bits is outlined first (see TvmConst::CodeSize), until no sequence
+// makes the code shorter. Every call adds a CALLDICT, so the code gets smaller but more expensive in gas.
+//
+// All sequences of the code are indexed once. Outlining a sequence only updates the sequences which
+// overlap its occurrences, so the code isn't rescanned after each new macro.
+class TVMOutliner {
+public:
+	explicit TVMOutliner(CodeLines code);
+
+	CodeLines outline();
+
+private:
+	using Sequence = std::vector<int>;	// keys of the instructions
+	struct Occurrences {
+		std::map<size_t, size_t> ranges;	// first line -> last line of each occurrence
+		int bits{};
+		// Saving of the sequence in m_best, 0 if it isn't there. It's an upper bound which assumes
+		// that the occurrences don't overlap until the sequence gets to the top of m_best.
+		int saving{};
+		bool isExact{};
+		bool isChanged{};
+	};
+	using OccurrenceMap = std::unordered_map<Sequence, Occurrences, boost::hash<Sequence>>;
+	// The best sequence first: by saving, then by length
+	struct BestFirst {
+		bool operator()(std::pair<int, Sequence const*> const& a, std::pair<int, Sequence const*> const& b) const;
+	};
+
+	static bool canOutline(Instruction const& instruction);
+	int key(Instruction const& instruction);
+	// Adds or removes the sequences which start at the line and end at the line @a from or after it
+	void updateSequences(size_t start, size_t from, bool add);
+	void updateBest();
+	// Not overlapping occurrences of the sequence
+	static std::vector<std::pair<size_t, size_t>> chooseRanges(Occurrences const& occurrences);
+	static int saving(Occurrences const& occurrences, int qty);
+	// Replaces the best repeated sequence with a new macro, returns false if there is no profitable one
+	bool outlineBestSequence();
+	std::string newMacroName();
+
+	std::vector<Instruction> m_lines;
+	std::vector<bool> m_removed;	// lines replaced by calls
+	// Lines which may be outlined are linked in order of the code, comments and removed lines are skipped
+	std::vector<size_t> m_next;
+	std::vector<size_t> m_prev;
+	std::vector<int> m_keys;	// the same key for the same instructions, -1 if the line can't be outlined
+	std::map<std::string, int> m_keyIds;
+	OccurrenceMap m_occurrences;
+	std::set<std::pair<int, Sequence const*>, BestFirst> m_best;	// sequences which save bits
+	std::vector<OccurrenceMap::value_type*> m_changed;	// sequences with new or removed occurrences
+	std::vector<CodeLines> m_macros;
+	std::set<std::string> m_names;	// names of the functions and macros of the code
+	int m_macroQty{};
+};
+
+}	// end solidity::frontend
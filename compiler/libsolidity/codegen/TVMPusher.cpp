@@ -57,14 +57,14 @@ void DictOperation::doDictOperation() {
 StackPusherHelper::StackPusherHelper(const TVMCompilerContext *ctx, const int stackSize) :
 		m_ctx(ctx),
 		m_structCompiler{new StructCompiler{this,
-											ctx->notConstantStateVariables(),
+											ctx->c4StateVariables(),
 											256 + (m_ctx->storeTimestampInC4()? 64 : 0) + 1, // pubkey + timestamp + constructor_flag
 											true}} {
 	m_stack.change(stackSize);
 }
 
 void StackPusherHelper::pushLog(const std::string& str) {
-	if (!TVMContractCompiler::g_without_logstr) {
+	if (!m_ctx->withoutLogstr()) {
 		push(0, "PRINTSTR " + str);
 	}
 }
@@ -250,7 +250,7 @@ void StackPusherHelper::tryPollLastRetOpcode() {
 	if (m_code.lines.empty()) {
 		return;
 	}
-	if (std::regex_match(m_code.lines.back(), std::regex("(\t*)RET"))) {
+	if (m_code.lines.back().opcode == Opcode::RET) {
 		m_code.lines.pop_back();
 	}
 }
@@ -276,8 +276,9 @@ void StackPusherHelper::pushCont(const CodeLines &cont, const string &comment) {
 		push(0, "PUSHCONT {");
 	else
 		push(0, "PUSHCONT { ; " + comment);
-	for (const auto& l : cont.lines)
-		push(0, string("\t") + l);
+	m_code.addTabs();
+	m_code.append(cont);
+	m_code.subTabs();
 	push(+1, "}"); // adjust stack // TODO delete +1. For ifelse it's a problem
 }
 
@@ -298,7 +299,7 @@ void StackPusherHelper::generateMacro(const string &functionName) {
 	push(0, ".macro " + functionName);
 }
 
-CodeLines StackPusherHelper::code() const {
+const CodeLines& StackPusherHelper::code() const {
 	return m_code;
 }
 
@@ -311,6 +312,11 @@ void StackPusherHelper::push(int stackDiff, const string &cmd) {
 	m_stack.change(stackDiff);
 }
 
+void StackPusherHelper::push(int stackDiff, Instruction instruction) {
+	m_code.push(std::move(instruction));
+	m_stack.change(stackDiff);
+}
+
 void StackPusherHelper::startContinuation() {
 	m_code.startContinuation();
 }
@@ -379,20 +385,66 @@ void StackPusherHelper::resetAllStateVars() {
 	push(0, ";; set default state vars");
 	for (VariableDeclaration const *variable: ctx().notConstantStateVariables()) {
 		pushDefaultValue(variable->type());
-		setGlob(variable);
+		setGlob(ctx().getStateVarIndex(variable));
+	}
+	if (ctx().lazyStateLoad()) {
+		// all state vars are set, there is nothing to load from c4
+		push(+1, "PUSHINT -1");
+		setGlob(ctx().lazyStateMaskGlobal());
 	}
 	push(0, ";; end set default state vars");
 }
 
+namespace {
+int lazyStateBit(TVMCompilerContext const& ctx, VariableDeclaration const *vd) {
+	// state vars are globals with indexes below 255, so there are fewer of them than bits in the mask
+	const int bit = ctx.getStateVarIndex(vd) - 10;
+	solAssert(0 <= bit && bit < TvmConst::C7::LazyStateMaskBits, "");
+	return bit;
+}
+}
+
+void StackPusherHelper::pushLazyStateBit(VariableDeclaration const *vd) {
+	const int bit = lazyStateBit(ctx(), vd);
+	if (bit == 0) {
+		// PUSHPOW2 takes 1..256
+		pushInt(1);
+	} else {
+		push(+1, "PUSHPOW2 " + toString(bit));
+	}
+}
+
+void StackPusherHelper::pushLazyStateMask(const std::vector<VariableDeclaration const*>& vds) {
+	if (vds.size() == 1) {
+		pushLazyStateBit(vds[0]);
+		return;
+	}
+	bigint mask = 0;
+	for (VariableDeclaration const* vd : vds) {
+		mask |= bigint(1) << lazyStateBit(ctx(), vd);
+	}
+	push(+1, "PUSHINT " + toString(mask));
+}
+
+void StackPusherHelper::markStateVarAsLoaded(VariableDeclaration const *vd) {
+	getGlob(ctx().lazyStateMaskGlobal());
+	pushLazyStateBit(vd);
+	push(-1, "OR");
+	setGlob(ctx().lazyStateMaskGlobal());
+}
+
 void StackPusherHelper::getGlob(VariableDeclaration const *vd) {
 	const int index = ctx().getStateVarIndex(vd);
+	if (ctx().lazyStateLoad()) {
+		pushPrivateFunctionOrMacroCall(0, "lazy_c4_to_c7_" + vd->name());
+	}
 	getGlob(index);
 }
 
 void StackPusherHelper::getGlob(int index) {
 	solAssert(index >= 0, "");
 	if (index <= 31) {
-		push(+1, "GETGLOB " + toString(index));
+		push(+1, Instruction{Opcode::GETGLOB, {Operand::integer(index)}});
 	} else {
 		solAssert(index < 255, "");
 		pushInt(index);
@@ -402,7 +454,7 @@ void StackPusherHelper::getGlob(int index) {
 
 void StackPusherHelper::setGlob(int index) {
 	if (index <= 31) {
-		push(-1, "SETGLOB " + toString(index));
+		push(-1, Instruction{Opcode::SETGLOB, {Operand::integer(index)}});
 	} else {
 		solAssert(index < 255, "");
 		pushInt(index);
@@ -414,19 +466,23 @@ void StackPusherHelper::setGlob(VariableDeclaration const *vd) {
 	const int index = ctx().getStateVarIndex(vd);
 	solAssert(index >= 0, "");
 	setGlob(index);
+	if (ctx().lazyStateLoad()) {
+		// the value in c4 is outdated, don't load it on the next access
+		markStateVarAsLoaded(vd);
+	}
 }
 
 void StackPusherHelper::pushS(int i) {
 	solAssert(i >= 0, "");
 	if (i == 0) {
-		push(+1, "DUP");
+		push(+1, Instruction{Opcode::DUP});
 	} else {
-		push(+1, "PUSH S" + toString(i));
+		push(+1, Instruction{Opcode::PUSH, {Operand::stackRegister(i, 'S')}});
 	}
 }
 
 void StackPusherHelper::pushInt(int i) {
-	push(+1, "PUSHINT " + toString(i));
+	push(+1, Instruction{Opcode::PUSHINT, {Operand::integer(i)}});
 }
 
 void StackPusherHelper::loadArray(bool directOrder) {
@@ -572,19 +628,22 @@ bool StackPusherHelper::tryImplicitConvert(Type const *leftType, Type const *rig
 }
 
 void StackPusherHelper::push(const CodeLines &codeLines) {
-	for (const std::string& s : codeLines.lines) {
-		push(0, s);
+	for (const Instruction& instruction : codeLines.lines) {
+		// the same as push(0, instruction.str()), which skips empty commands
+		if (!instruction.empty()) {
+			m_code.push(instruction);
+		}
 	}
 }
 
 void StackPusherHelper::pushPrivateFunctionOrMacroCall(const int stackDelta, const string &fname) {
-	push(stackDelta, "CALL $" + fname + "$");
+	push(stackDelta, Instruction{Opcode::CALL, {Operand::function(fname)}});
 }
 
 void StackPusherHelper::pushCall(const string &functionName, const FunctionType *ft) {
 	int params  = ft->parameterTypes().size();
 	int retVals = ft->returnParameterTypes().size();
-	push(-params + retVals, "CALL $" + functionName + "$");
+	push(-params + retVals, Instruction{Opcode::CALL, {Operand::function(functionName)}});
 }
 
 void StackPusherHelper::drop(int cnt) {
@@ -593,15 +652,15 @@ void StackPusherHelper::drop(int cnt) {
 		return;
 
 	if (cnt == 1) {
-		push(-1, "DROP");
+		push(-1, Instruction{Opcode::DROP});
 	} else if (cnt == 2) {
-		push(-2, "DROP2");
+		push(-2, Instruction{Opcode::DROP2});
 	} else {
 		if (cnt > 15) {
 			pushInt(cnt);
 			push(-(cnt + 1), "DROPX");
 		} else {
-			push(-cnt, "BLKDROP " + toString(cnt));
+			push(-cnt, Instruction{Opcode::BLKDROP, {Operand::integer(cnt)}});
 		}
 	}
 }
@@ -621,7 +680,7 @@ void StackPusherHelper::blockSwap(int m, int n) {
 	} else if (m == 2 && n == 2) {
 		push(0, "SWAP2");
 	} else if (n <= 16 && m <= 16) {
-		push(0, "BLKSWAP " + toString(m) + ", " + toString(n));
+		push(0, Instruction{Opcode::BLKSWAP, {Operand::integer(m), Operand::integer(n)}});
 	} else {
 		pushInt(m);
 		pushInt(n);
@@ -657,7 +716,7 @@ void StackPusherHelper::dropUnder(int leftCount, int droppedCount) {
 			push(-2, "BLKSWX");
 			drop(droppedCount);
 		} else {
-			push(-droppedCount, "BLKDROP2 " + toString(droppedCount) + ", " + toString(leftCount));
+			push(-droppedCount, Instruction{Opcode::BLKDROP2, {Operand::integer(droppedCount), Operand::integer(leftCount)}});
 		}
 	};
 
@@ -694,16 +753,14 @@ void StackPusherHelper::exchange(int i, int j) {
 	solAssert(j >= 1, "");
 	if (i == 0 && j <= 255) {
 		if (j == 1) {
-			push(0, "SWAP");
+			push(0, Instruction{Opcode::SWAP});
 		} else if (j <= 15) {
-			push(0, "XCHG s" + toString(j));
+			push(0, Instruction{Opcode::XCHG, {Operand::stackRegister(j)}});
 		} else {
-			push(0, "XCHG s0,s" + toString(j));
+			push(0, Instruction{Opcode::XCHG, {Operand::stackRegister(0), Operand::stackRegister(j)}});
 		}
-	} else if (i == 1 && 2 <= j && j <= 15) {
-		push(0, "XCHG s1,s" + toString(j));
 	} else if (1 <= i && i < j && j <= 15) {
-		push(0, "XCHG s" + toString(i) + ",s" + toString(j));
+		push(0, Instruction{Opcode::XCHG, {Operand::stackRegister(i), Operand::stackRegister(j)}});
 	} else if (j <= 255) {
 		exchange(0, i);
 		exchange(0, j);
@@ -1031,14 +1088,281 @@ void TVMStack::ensureSize(int savedStackSize, const string &location) const {
 										+ " vs " + toString(m_size) + " at " + location);
 }
 
-string CodeLines::str(const string &indent) const {
+Operand Operand::integer(int64_t value) {
+	Operand res;
+	res.kind = Kind::Integer;
+	res.value = value;
+	return res;
+}
+
+Operand Operand::stackRegister(int index, char prefix) {
+	Operand res;
+	res.kind = Kind::StackRegister;
+	res.value = index;
+	if (prefix != 's') {
+		res.text = prefix + toString(index);
+	}
+	return res;
+}
+
+Operand Operand::controlRegister(int index) {
+	Operand res;
+	res.kind = Kind::ControlRegister;
+	res.value = index;
+	return res;
+}
+
+Operand Operand::function(const string &name) {
+	Operand res;
+	res.kind = Kind::Function;
+	res.text = name;
+	return res;
+}
+
+Operand Operand::slice(const string &slice) {
+	Operand res;
+	res.kind = Kind::Slice;
+	res.text = slice;
+	return res;
+}
+
+Operand Operand::parse(const string &token) {
+	// digits of a decimal integer which fits in 64 bits
+	auto number = [&](size_t from, int64_t& value) {
+		if (from == token.size() || token.size() - from > 18) {
+			return false;
+		}
+		value = 0;
+		for (size_t i = from; i < token.size(); ++i) {
+			if (!isdigit(token[i])) {
+				return false;
+			}
+			value = value * 10 + (token[i] - '0');
+		}
+		return true;
+	};
+
+	Operand res;
+	if (token == "{") {
+		res.kind = Kind::Continuation;
+	} else if (token.size() > 2 && token.front() == '$' && token.back() == '$') {
+		res.kind = Kind::Function;
+		res.text = token.substr(1, token.size() - 2);
+	} else if (!token.empty() && isIn(token[0], 's', 'S', 'c', 'C') && number(1, res.value)) {
+		res.kind = tolower(token[0]) == 's' ? Kind::StackRegister : Kind::ControlRegister;
+		res.text = token;
+	} else if (!token.empty() && token[0] == '-' && number(1, res.value)) {
+		res.kind = Kind::Integer;
+		res.value = -res.value;
+		res.text = token;
+	} else if (number(0, res.value)) {
+		res.kind = Kind::Integer;
+		res.text = token;
+	} else {
+		res.text = token;
+	}
+	return res;
+}
+
+string Operand::name() const {
+	return !text.empty() && text[0] == ':' ? text.substr(1) : text;
+}
+
+string Operand::str() const {
+	switch (kind) {
+		case Kind::Integer:
+			return text.empty() ? std::to_string(value) : text;
+		case Kind::StackRegister:
+			return text.empty() ? "s" + std::to_string(value) : text;
+		case Kind::ControlRegister:
+			return text.empty() ? "c" + std::to_string(value) : text;
+		case Kind::Function:
+			return "$" + text + "$";
+		case Kind::Continuation:
+			return "{";
+		case Kind::Slice:
+		case Kind::Text:
+			break;
+	}
+	return text;
+}
+
+bool Operand::operator==(const Operand &oth) const {
+	if (kind != oth.kind || value != oth.value) {
+		return false;
+	}
+	// integers and registers are the same however they are spelled, e.g. S1 and s1
+	return isIn(kind, Kind::Integer, Kind::StackRegister, Kind::ControlRegister) || text == oth.text;
+}
+
+bool Operand::operator!=(const Operand &oth) const {
+	return !(*this == oth);
+}
+
+Instruction::Instruction(Opcode opcode, vector<Operand> operands) :
+	opcode{opcode},
+	operands{std::move(operands)} {
+}
+
+Instruction Instruction::parse(const string &line, int depth) {
+	auto isSpace = [](char ch) { return ch == ' ' || ch == '\t'; };
+	Instruction res;
+	res.depth = depth;
+	size_t i = 0, n = line.size();
+	while (i < n && line[i] == '\t') {
+		++res.depth;
+		++i;
+	}
+	while (i < n && isSpace(line[i]))
+		++i;
+	size_t start = i;
+	while (i < n && !isSpace(line[i]) && line[i] != ';')
+		++i;
+	const string mnemonic = line.substr(start, i - start);
+	res.opcode = findOpcode(mnemonic);
+	if (res.opcode == Opcode::Unknown) {
+		res.name = mnemonic;
+	}
+	while (i < n && isSpace(line[i]))
+		++i;
+	size_t end = line.find(';', i);
+	if (end == string::npos) {
+		end = n;
+	} else {
+		res.comment = line.substr(end);
+	}
+	while (end > i && isSpace(line[end - 1]))
+		--end;
+	if (i == end) {
+		return res;
+	}
+
+	const string operands = line.substr(i, end - i);
+	if (res.opcode == Opcode::PRINTSTR) {
+		res.operands.push_back(Operand{Operand::Kind::Text, 0, operands});
+		return res;
+	}
+	const bool isSlice = res.opcode == Opcode::PUSHSLICE || res.opcode == Opcode::STSLICECONST;
+	for (size_t from = 0; from <= operands.size(); ) {
+		size_t to = std::min(operands.find(',', from), operands.size());
+		size_t first = from, last = to;
+		while (first < last && isSpace(operands[first]))
+			++first;
+		while (last > first && isSpace(operands[last - 1]))
+			--last;
+		string token = operands.substr(first, last - first);
+		if (res.isDirective()) {
+			res.operands.push_back(Operand{Operand::Kind::Text, 0, std::move(token)});
+		} else if (isSlice) {
+			res.operands.push_back(Operand::slice(token));
+		} else {
+			res.operands.push_back(Operand::parse(token));
+		}
+		from = to + 1;
+	}
+	return res;
+}
+
+bool Instruction::empty() const {
+	return depth == 0 && isCommentOrEmpty() && operands.empty() && comment.empty();
+}
+
+bool Instruction::isCommentOrEmpty() const {
+	return opcode == Opcode::Unknown && name.empty();
+}
+
+bool Instruction::isDirective() const {
+	return !name.empty() && name[0] == '.';
+}
+
+string Instruction::mnemonic() const {
+	return opcode == Opcode::Unknown ? name : opcodeInfo(opcode).mnemonic;
+}
+
+int Instruction::bits() const {
+	if (isCommentOrEmpty() || isDirective() || opcode == Opcode::CONT_END) {
+		return 0;
+	}
+	if (opcode == Opcode::Unknown) {
+		return 16;
+	}
+	int result = opcodeInfo(opcode).bits;
+	if ((opcode == Opcode::PUSHSLICE || opcode == Opcode::STSLICECONST) && !operands.empty()) {
+		// x{hex digits}, xHEX or b{binary digits}
+		const string& slice = operands[0].text;
+		const int digitBits = !slice.empty() && slice[0] == 'b' ? 1 : 4;
+		for (size_t i = 1; i < slice.size(); ++i) {
+			if (isxdigit(slice[i])) {
+				result += digitBits;
+			}
+		}
+	}
+	return result;
+}
+
+string Instruction::operandsText() const {
+	string res;
+	for (const Operand& operand : operands) {
+		if (!res.empty()) {
+			res += ", ";
+		}
+		res += operand.str();
+	}
+	return res;
+}
+
+string Instruction::text() const {
 	std::ostringstream o;
-	for (const string& s : lines) {
-		o << indent << s << endl;
+	print(o);
+	return o.str().substr(depth);
+}
+
+string Instruction::str() const {
+	std::ostringstream o;
+	print(o);
+	return o.str();
+}
+
+void Instruction::print(ostream &out) const {
+	for (int i = 0; i < depth; ++i) {
+		out << '\t';
+	}
+	if (!isCommentOrEmpty()) {
+		out << (opcode == Opcode::Unknown ? name.c_str() : opcodeInfo(opcode).mnemonic);
+		for (size_t i = 0; i < operands.size(); ++i) {
+			// directives are separated from operands by a tab, e.g. ".globl\tname"
+			out << (i > 0 ? ", " : isDirective() ? "\t" : " ") << operands[i].str();
+		}
+		if (!comment.empty()) {
+			out << ' ';
+		}
 	}
+	out << comment;
+}
+
+bool Instruction::operator==(const Instruction &oth) const {
+	return depth == oth.depth && opcode == oth.opcode && name == oth.name && operands == oth.operands &&
+		   comment == oth.comment;
+}
+
+bool Instruction::operator!=(const Instruction &oth) const {
+	return !(*this == oth);
+}
+
+string CodeLines::str(const string &indent) const {
+	std::ostringstream o;
+	print(o, indent);
 	return o.str();
 }
 
+void CodeLines::print(ostream &out, const string &indent) const {
+	for (const Instruction& instruction : lines) {
+		out << indent;
+		instruction.print(out);
+		out << '\n';
+	}
+}
+
 void CodeLines::addTabs(const int qty) {
 	tabQty += qty;
 }
@@ -1065,17 +1389,40 @@ void CodeLines::push(const string &cmd) {
 
 	// space means empty line
 	if (cmd == " ")
-		lines.emplace_back("");
+		lines.emplace_back();
 	else {
 		solAssert(tabQty >= 0, "");
-		lines.push_back(std::string(tabQty, '\t') + cmd);
+		lines.push_back(Instruction::parse(cmd, tabQty));
 	}
 }
 
+void CodeLines::push(Instruction instruction) {
+	solAssert(tabQty >= 0, "");
+	instruction.depth += tabQty;
+	lines.push_back(std::move(instruction));
+}
+
 void CodeLines::append(const CodeLines &oth) {
-	for (const auto& s : oth.lines) {
-		lines.push_back(std::string(tabQty, '\t') + s);
+	for (const Instruction& instruction : oth.lines) {
+		lines.push_back(instruction);
+		lines.back().depth += tabQty;
+	}
+}
+
+void CodeLines::append(CodeLines &&oth) {
+	for (Instruction& instruction : oth.lines) {
+		lines.push_back(std::move(instruction));
+		lines.back().depth += tabQty;
 	}
+	oth.lines.clear();
+}
+
+int CodeLines::bits() const {
+	int result = 0;
+	for (const Instruction& instruction : lines) {
+		result += instruction.bits();
+	}
+	return result;
 }
 
 void TVMCompilerContext::addFunction(FunctionDefinition const *_function) {
@@ -1085,10 +1432,11 @@ void TVMCompilerContext::addFunction(FunctionDefinition const *_function) {
 	}
 }
 
-void TVMCompilerContext::initMembers(ContractDefinition const *contract) {
+void TVMCompilerContext::initMembers(ContractDefinition const *contract, TVMSettings const& settings) {
 	solAssert(!m_contract, "");
 	m_contract = contract;
-	for (const auto &pair : getContractFunctionPairs(contract)) {
+	m_functionIndex = std::make_shared<ContractFunctionIndex const>(contract);
+	for (const auto &pair : m_functionIndex->functionPairs()) {
 		m_function2contract.insert(pair);
 	}
 
@@ -1109,7 +1457,7 @@ void TVMCompilerContext::initMembers(ContractDefinition const *contract) {
 	}
 
 	ignoreIntOverflow |= m_pragmaHelper.haveIgnoreIntOverflow();
-	for (const auto f : getContractFunctions(contract)) {
+	for (const auto f : m_functionIndex->functions()) {
 		if (isPureFunction(f))
 			continue;
 		addFunction(f);
@@ -1117,17 +1465,67 @@ void TVMCompilerContext::initMembers(ContractDefinition const *contract) {
 	for (VariableDeclaration const *variable: notConstantStateVariables()) {
 		m_stateVarIndex[variable] = 10 + m_stateVarIndex.size();
 	}
+
+	m_c4StateVariables = notConstantStateVariables();
+	if (settings.hotColdLayout) {
+		m_stateVarAccessCount = StateVarAccessCounter{*contract}.counts();
+		if (!settings.layoutProfile.empty()) {
+			for (VariableDeclaration const *variable: m_c4StateVariables) {
+				auto it = settings.layoutProfile.find(variable->name());
+				m_stateVarAccessCount[variable] = it == settings.layoutProfile.end() ? 0 : it->second;
+			}
+		}
+		std::stable_sort(m_c4StateVariables.begin(), m_c4StateVariables.end(),
+			[this](VariableDeclaration const* a, VariableDeclaration const* b) {
+				return stateVarAccessCount(a) > stateVarAccessCount(b);
+			});
+	}
 }
 
 TVMCompilerContext::TVMCompilerContext(ContractDefinition const *contract,
-									   PragmaDirectiveHelper const &pragmaHelper) : m_pragmaHelper{pragmaHelper} {
-	initMembers(contract);
+									   PragmaDirectiveHelper const &pragmaHelper,
+									   TVMSettings const& settings) :
+	m_withoutLogstr{settings.withoutLogstr},
+	m_lazyStateLoad{settings.lazyStateLoad},
+	m_packStructCells{settings.packCells},
+	m_packC4Cells{settings.packCells && !settings.hotColdLayout},
+	m_autoInline{settings.autoInline},
+	m_pragmaHelper{pragmaHelper} {
+	initMembers(contract, settings);
 }
 
 int TVMCompilerContext::getStateVarIndex(VariableDeclaration const *variable) const {
 	return m_stateVarIndex.at(variable);
 }
 
+bool TVMCompilerContext::lazyStateLoad() const {
+	return m_lazyStateLoad;
+}
+
+bool TVMCompilerContext::packStructCells() const {
+	return m_packStructCells;
+}
+
+bool TVMCompilerContext::packC4Cells() const {
+	return m_packC4Cells;
+}
+
+TvmAutoInline TVMCompilerContext::autoInline() const {
+	return m_autoInline;
+}
+
+bool TVMCompilerContext::isInlined(FunctionDefinition const *f) const {
+	return isFunctionForInlining(f) || m_autoInlinedFunctions.count(f) != 0;
+}
+
+int TVMCompilerContext::lazyStateSliceGlobal() const {
+	return 10 + static_cast<int>(m_stateVarIndex.size());
+}
+
+int TVMCompilerContext::lazyStateMaskGlobal() const {
+	return lazyStateSliceGlobal() + 1;
+}
+
 std::vector<VariableDeclaration const *> TVMCompilerContext::notConstantStateVariables() const {
 	std::vector<VariableDeclaration const*> variableDeclarations;
 	std::vector<ContractDefinition const*> mainChain = getContractsChain(getContract());
@@ -1141,6 +1539,15 @@ std::vector<VariableDeclaration const *> TVMCompilerContext::notConstantStateVar
 	return variableDeclarations;
 }
 
+std::vector<VariableDeclaration const *> const& TVMCompilerContext::c4StateVariables() const {
+	return m_c4StateVariables;
+}
+
+double TVMCompilerContext::stateVarAccessCount(VariableDeclaration const *variable) const {
+	auto it = m_stateVarAccessCount.find(variable);
+	return it == m_stateVarAccessCount.end() ? 0 : it->second;
+}
+
 PragmaDirectiveHelper const &TVMCompilerContext::pragmaHelper() const {
 	return m_pragmaHelper;
 }
@@ -1198,6 +1605,10 @@ const FunctionDefinition *TVMCompilerContext::getLocalFunction(const string& fna
 	return get_from_map(m_functions, fname, nullptr);
 }
 
+ContractFunctionIndex const& TVMCompilerContext::functionIndex() const {
+	return *m_functionIndex;
+}
+
 bool TVMCompilerContext::haveFallbackFunction() const {
 	return haveFallback;
 }
@@ -1218,6 +1629,10 @@ bool TVMCompilerContext::haveOffChainConstructor() const {
 	return m_haveOffChainConstructor;
 }
 
+bool TVMCompilerContext::withoutLogstr() const {
+	return m_withoutLogstr;
+}
+
 FunctionDefinition const *TVMCompilerContext::afterSignatureCheck() const {
 	for (FunctionDefinition const* f : m_contract->definedFunctions()) {
 		if (f->name() == "afterSignatureCheck") {
@@ -27,7 +27,9 @@
 
 #include "TVMCommons.hpp"
 #include "TVMConstants.hpp"
+#include "TVMOpcodes.hpp"
 #include "TVMABI.hpp"
+#include "TVM.h"
 
 using namespace std;
 using namespace solidity;
@@ -76,17 +78,83 @@ public:
 	void ensureSize(int savedStackSize, const string& location) const;
 };
 
+// Operand of a TVM instruction or directive, e.g. "s1", "c4", "-5", "$name$" or "x{AB}"
+struct Operand {
+	enum class Kind {
+		Integer,			// decimal integer which fits in 64 bits
+		StackRegister,		// s(i)
+		ControlRegister,	// c(i)
+		Function,			// $name$, name of the called function or macro
+		Slice,				// operand of PUSHSLICE and STSLICECONST, e.g. x{AB}, x4_ or 0
+		Continuation,		// '{', the body follows on the next lines
+		Text				// operands of directives, other integers, string of PRINTSTR
+	};
+	Kind kind{Kind::Text};
+	int64_t value{};	// integer or index of the register
+	// name of the function, slice or text; for a parsed integer or register, its spelling (e.g. S1),
+	// which is printed instead of the canonical one (s1)
+	string text;
+
+	static Operand integer(int64_t value);
+	// prefix is 's' or 'S', the register is printed as written by codegen
+	static Operand stackRegister(int index, char prefix = 's');
+	static Operand controlRegister(int index);
+	static Operand function(const string& name);
+	static Operand slice(const string& slice);
+	static Operand parse(const string& token);
+	// name of the function or of the directive operand without ':', e.g. "main_internal" for ":main_internal"
+	string name() const;
+	string str() const;
+	bool operator==(const Operand& oth) const;
+	bool operator!=(const Operand& oth) const;
+};
+
+// One line of TVM assembly: an opcode with typed operands, a directive, a comment or an empty line.
+// Text pushed by codegen is parsed once, and the line is rendered with fixed separators when the code is
+// printed, so the whitespace of the pushed text isn't kept.
+struct Instruction {
+	int depth{};		// nesting level of continuations, printed as leading tabs
+	Opcode opcode{Opcode::Unknown};
+	string name;		// e.g. ".macro" for directives and unknown opcodes. Empty for known opcodes and comments
+	vector<Operand> operands;
+	string comment;		// the comment starting from ';'
+
+	Instruction() = default;
+	Instruction(Opcode opcode, vector<Operand> operands = {});
+
+	static Instruction parse(const string& line, int depth = 0);
+	bool empty() const;
+	bool isCommentOrEmpty() const;
+	bool isDirective() const;
+	string mnemonic() const;
+	// length of the instruction in bits with inline data, see TVMOpcodes.hpp. Zero for comments and directives
+	int bits() const;
+	// e.g. "s1, s2"
+	string operandsText() const;
+	// line without leading tabs
+	string text() const;
+	string str() const;
+	void print(ostream& out) const;
+	bool operator==(const Instruction& oth) const;
+	bool operator!=(const Instruction& oth) const;
+};
+
 struct CodeLines {
-	vector<string> lines;
+	vector<Instruction> lines;
 	int tabQty{};
 
 	string str(const string& indent = "") const;
+	// writes the lines without making a copy of the whole text, tabs are added here
+	void print(ostream& out, const string& indent = "") const;
 	void addTabs(const int qty = 1);
 	void subTabs(const int qty = 1);
 	void startContinuation();
 	void endContinuation();
 	void push(const string& cmd);
+	void push(Instruction instruction);
 	void append(const CodeLines& oth);
+	void append(CodeLines&& oth);
+	int bits() const;
 };
 
 class TVMCompilerContext {
@@ -99,20 +167,47 @@ class TVMCompilerContext {
 	bool haveReceive = false;
 	bool ignoreIntOverflow = false;
 	bool m_haveOffChainConstructor = false;
+	bool m_withoutLogstr = false;
+	bool m_lazyStateLoad = false;
+	bool m_packStructCells = false;
+	bool m_packC4Cells = false;
+	TvmAutoInline m_autoInline = TvmAutoInline::None;
 	PragmaDirectiveHelper const& m_pragmaHelper;
 	std::map<VariableDeclaration const *, int> m_stateVarIndex;
+	// state vars in order of placement in c4, see TVMSettings::hotColdLayout
+	std::vector<VariableDeclaration const *> m_c4StateVariables;
+	std::map<VariableDeclaration const *, double> m_stateVarAccessCount;
+	// shared by the copies of the context made for codegen threads
+	std::shared_ptr<ContractFunctionIndex const> m_functionIndex;
 
 	void addFunction(FunctionDefinition const* _function);
-	void initMembers(ContractDefinition const* contract);
+	void initMembers(ContractDefinition const* contract, TVMSettings const& settings);
 
 public:
-	TVMCompilerContext(ContractDefinition const* contract, PragmaDirectiveHelper const& pragmaHelper);
+	TVMCompilerContext(ContractDefinition const* contract, PragmaDirectiveHelper const& pragmaHelper,
+					   TVMSettings const& settings = TVMSettings{});
 
 	FunctionDefinition const* m_currentFunction = nullptr;
 	map<string, CodeLines> m_inlinedFunctions;
+	// Functions inlined because of TVMSettings::autoInline, their code is in m_inlinedFunctions too
+	std::set<FunctionDefinition const*> m_autoInlinedFunctions;
 
 	int getStateVarIndex(VariableDeclaration const *variable) const;
+	bool lazyStateLoad() const;
+	// See TVMSettings::packCells
+	bool packStructCells() const;
+	bool packC4Cells() const;
+	TvmAutoInline autoInline() const;
+	// Calls of the function are replaced with its code from m_inlinedFunctions
+	bool isInlined(FunctionDefinition const* f) const;
+	// Globals used if state variables are loaded lazily: the rest of c4 after the header
+	// and the mask of already loaded state variables (bit i for the variable with index 10 + i)
+	int lazyStateSliceGlobal() const;
+	int lazyStateMaskGlobal() const;
 	std::vector<VariableDeclaration const *> notConstantStateVariables() const;
+	std::vector<VariableDeclaration const *> const& c4StateVariables() const;
+	// Static (or profiled) number of accesses, accesses in loops have bigger weight
+	double stateVarAccessCount(VariableDeclaration const *variable) const;
 	PragmaDirectiveHelper const& pragmaHelper() const;
 	bool haveTimeInAbiHeader() const;
 	bool isStdlib() const;
@@ -122,11 +217,13 @@ public:
 	const ContractDefinition* getContract() const;
 	const ContractDefinition* getContract(const FunctionDefinition* f) const;
 	const FunctionDefinition* getLocalFunction(const string& fname) const;
+	ContractFunctionIndex const& functionIndex() const;
 	bool haveFallbackFunction() const;
 	bool haveReceiveFunction() const;
 	bool haveOnBounceHandler() const;
 	bool ignoreIntegerOverflow() const;
 	bool haveOffChainConstructor() const;
+	bool withoutLogstr() const;
 	FunctionDefinition const* afterSignatureCheck() const;
 	bool storeTimestampInC4() const;
 };
@@ -149,11 +246,12 @@ public:
 	void generateGlobl(const string& fname, const bool isPublic);
 	void generateInternal(const string& fname, const int id);
 	void generateMacro(const string& functionName);
-	CodeLines code() const;
+	const CodeLines& code() const;
 
 	[[nodiscard]]
 	const TVMCompilerContext& ctx() const;
 	void push(int stackDiff, const string& cmd);
+	void push(int stackDiff, Instruction instruction);
 	void startContinuation();
 	void endContinuation();
 	StructCompiler& structCompiler();
@@ -165,6 +263,11 @@ public:
 	void set_index(int index);
 	void tuple(int qty);
 	void resetAllStateVars();
+	// Pushes the bit of the state var in the mask of lazily loaded state vars
+	void pushLazyStateBit(VariableDeclaration const *vd);
+	// Pushes the bits of the state vars in the mask of lazily loaded state vars
+	void pushLazyStateMask(const std::vector<VariableDeclaration const*>& vds);
+	void markStateVarAsLoaded(VariableDeclaration const *vd);
 	void getGlob(VariableDeclaration const * vd);
 	void getGlob(int index);
 	void setGlob(int index);
@@ -174,66 +174,132 @@ StructCompiler::StructCompiler(StackPusherHelper *pusher, std::vector<VariableDe
 		pusher{pusher}
 	{
 
-	int memberIndex = 0;
+	std::vector<int> order;
+	for (int memberIndex = 0; memberIndex < static_cast<int>(variableDeclarations.size()); ++memberIndex) {
+		VariableDeclaration const* member = variableDeclarations[memberIndex];
+		nameToVariableDeclarations[member->name()] = member;
+		order.push_back(memberIndex);
+	}
+	nodes = makeNodes(order, skipData, isC4, false);
+
+	const bool pack = pusher != nullptr && (isC4 ? pusher->ctx().packC4Cells() : pusher->ctx().packStructCells());
+	// A struct in one cell can be decoded by SDK in the declaration order, so only layouts with several cells are changed
+	if (pack && nodes.size() > 1) {
+		// first fit in the declaration order or decreasing by bits or by refs
+		auto sorted = [&](auto less) {
+			std::vector<int> candidate = order;
+			std::stable_sort(candidate.begin(), candidate.end(), [&](int a, int b) {
+				return less(FieldSizeInfo{variableDeclarations[a]->type(), *variableDeclarations[a]},
+							FieldSizeInfo{variableDeclarations[b]->type(), *variableDeclarations[b]});
+			});
+			return candidate;
+		};
+		std::vector<std::vector<int>> candidates{
+			order,
+			sorted([](FieldSizeInfo const& a, FieldSizeInfo const& b) {
+				return a.maxBitLength > b.maxBitLength;
+			}),
+			sorted([](FieldSizeInfo const& a, FieldSizeInfo const& b) {
+				return std::make_pair(a.maxRefLength, a.maxBitLength) > std::make_pair(b.maxRefLength, b.maxBitLength);
+			}),
+			sorted([](FieldSizeInfo const& a, FieldSizeInfo const& b) {
+				return std::make_pair(-a.maxRefLength, a.maxBitLength) > std::make_pair(-b.maxRefLength, b.maxBitLength);
+			}),
+		};
+		for (const std::vector<int>& candidate : candidates) {
+			std::vector<Node> packed = makeNodes(candidate, skipData, isC4, true);
+			if (layoutCost(packed) < layoutCost(nodes)) {
+				nodes = std::move(packed);
+			}
+		}
+	}
+
+	std::vector<int> nodePath;
+	std::vector<int> refPath;
+	dfs(0, nodePath, refPath);
+}
+
+std::vector<StructCompiler::Node> StructCompiler::makeNodes(const std::vector<int>& order, const int skipData,
+															  const bool isC4, const bool firstFit) const {
+	std::vector<Node> cells;
 	int parent = 0;
-	nodes.emplace_back(Node(skipData));
-	for (const auto &member : variableDeclarations) {
-		const Field f{memberIndex, member};
-		bool ok = nodes.back().tryAddField(f);
+	cells.emplace_back(Node(skipData));
+	for (const int memberIndex : order) {
+		const Field f{memberIndex, variableDeclarations[memberIndex]};
+		bool ok = false;
+		if (firstFit) {
+			for (Node& cell : cells) {
+				if (cell.tryAddField(f)) {
+					ok = true;
+					break;
+				}
+			}
+		} else {
+			ok = cells.back().tryAddField(f);
+		}
 		if (!ok) {
-			nodes.emplace_back(Node(0));
-			solAssert(nodes.back().tryAddField(f), "");
+			cells.emplace_back(Node(0));
+			solAssert(cells.back().tryAddField(f), "");
 
-			int v = static_cast<int>(nodes.size()) - 1;
-			if (!nodes[parent].tryAddChild(v)) {
+			int v = static_cast<int>(cells.size()) - 1;
+			if (!cells[parent].tryAddChild(v)) {
 				++parent;
-				solAssert(nodes[parent].tryAddChild(v), "");
+				solAssert(cells[parent].tryAddChild(v), "");
 			}
 		}
-
-		nameToVariableDeclarations[member->name()] = member;
-		++memberIndex;
 	}
 
+	// Fields of a struct are kept in the declaration order unless they are packed
+	const bool anyOrder = isC4 || firstFit;
 	bool doSome{};
 	do {
 		doSome = false;
-		for (int v = 1; v < static_cast<int>(nodes.size()); ++v) {
+		for (int v = 1; v < static_cast<int>(cells.size()); ++v) {
 			for (int fieldInd = 0;
-			     !doSome && fieldInd < (isC4? static_cast<int>(nodes[v].getFields().size()) : std::min<int>(nodes[v].getFields().size(), 1));
+			     !doSome && fieldInd < (anyOrder? static_cast<int>(cells[v].getFields().size()) : std::min<int>(cells[v].getFields().size(), 1));
 				++fieldInd) {
-				for (int v0 = isC4 ? 0 : v - 1; !doSome && v0 < v; ++v0) {
-					if (nodes[v0].tryAddField(nodes[v].getFields()[fieldInd], true)) {
-						nodes[v].removeField(fieldInd);
+				for (int v0 = anyOrder ? 0 : v - 1; !doSome && v0 < v; ++v0) {
+					if (cells[v0].tryAddField(cells[v].getFields()[fieldInd], true)) {
+						cells[v].removeField(fieldInd);
 						doSome = true;
 					} else {
-						bool vIsChildOfV0 = std::find(nodes[v0].getChildren().begin(), nodes[v0].getChildren().end(), v) !=
-						                    nodes[v0].getChildren().end();
-						if (nodes[v].getFields().size() == 1 &&
+						bool vIsChildOfV0 = std::find(cells[v0].getChildren().begin(), cells[v0].getChildren().end(), v) !=
+						                    cells[v0].getChildren().end();
+						if (cells[v].getFields().size() == 1 &&
 							vIsChildOfV0 &&
-							v + 1 == static_cast<int>(nodes.size()) &&
-						    nodes[v0].tryAddField(nodes[v].getFields()[fieldInd], true, true)) {
-							nodes[v].removeField(fieldInd);
+							v + 1 == static_cast<int>(cells.size()) &&
+						    cells[v0].tryAddField(cells[v].getFields()[fieldInd], true, true)) {
+							cells[v].removeField(fieldInd);
 							doSome = true;
 						}
 					}
 				}
 			}
 		}
-		if (nodes.size() >= 2 && nodes.back().getFields().empty()) {
-			int v = static_cast<int>(nodes.size()) - 1;
-			for (Node &node : nodes) {
+		if (cells.size() >= 2 && cells.back().getFields().empty()) {
+			int v = static_cast<int>(cells.size()) - 1;
+			for (Node &node : cells) {
 				node.removeChildIfHave(v);
 			}
-			nodes.pop_back();
+			cells.pop_back();
 
 			doSome = true;
 		}
 	} while (doSome);
+	return cells;
+}
 
-	std::vector<int> nodePath;
-	std::vector<int> refPath;
-	dfs(0, nodePath, refPath);
+std::pair<int, int> StructCompiler::layoutCost(const std::vector<Node>& cells) {
+	// number of cells and sum of depths of the fields
+	std::vector<int> depth(cells.size());
+	int fieldDepth = 0;
+	for (int v = 0; v < static_cast<int>(cells.size()); ++v) {
+		for (const int to : cells[v].getChildren()) {
+			depth[to] = depth[v] + 1;
+		}
+		fieldDepth += depth[v] * static_cast<int>(cells[v].getFields().size());
+	}
+	return {static_cast<int>(cells.size()), fieldDepth};
 }
 
 void StructCompiler::createDefaultStruct(bool resultIsBuilder) {
@@ -317,7 +383,8 @@ void StructCompiler::tupleToBuilder() {
 }
 
 void StructCompiler::stateVarsToBuilder() {
-	stateVarsToBuilderDfs(0);
+	std::vector<int> refPath;
+	stateVarsToBuilderDfs(0, refPath);
 }
 
 void StructCompiler::expandStruct(const std::string &memberName, bool doPushMemberOnStack) {
@@ -413,6 +480,7 @@ void StructCompiler::convertSliceToTuple() {
 
 	std::vector<int> stackSize(nodes.size(), -1);
 	stackSize[0] = pusher->getStack().size();
+	std::vector<int> loadOrder; // member indexes of the fields on the stack
 
 	while (!q.empty()) {
 		int v = q.front();
@@ -440,9 +508,20 @@ void StructCompiler::convertSliceToTuple() {
 			} else {
 				load(f.member, false); // field struct
 			}
+			loadOrder.push_back(f.memberIndex);
 			++iter;
 		}
 	}
+
+	// fields may be packed not in the declaration order, see makeNodes
+	const int n = loadOrder.size();
+	for (int i = 0; i < n; ++i) {
+		if (loadOrder[i] != i) {
+			const int j = std::find(loadOrder.begin() + i, loadOrder.end(), i) - loadOrder.begin();
+			pusher->exchange(n - 1 - j, n - 1 - i);
+			std::swap(loadOrder[i], loadOrder[j]);
+		}
+	}
 	pusher->tuple(variableDeclarations.size());
 }
 
@@ -563,12 +642,21 @@ void StructCompiler::createStructDfs(const int v, const std::map<std::string, in
 	}
 }
 
-void StructCompiler::stateVarsToBuilderDfs(const int v) {
+void StructCompiler::stateVarsToBuilderDfs(const int v, std::vector<int> &refPath) {
+	// In the lazy mode the children are cells, see lazyStateVarsToCell
+	const bool lazy = pusher->ctx().lazyStateLoad();
 	int cntValues = 0;
+	int idRef = 0;
 	for (const int to : nodes[v].getChildren()) {
-		pusher->push(+1, "NEWC");
+		refPath.push_back(idRef++);
+		if (lazy) {
+			lazyStateVarsToCell(to, refPath);
+		} else {
+			pusher->push(+1, "NEWC");
+			stateVarsToBuilderDfs(to, refPath);
+		}
+		refPath.pop_back();
 		++cntValues;
-		stateVarsToBuilderDfs(to);
 	}
 	for (const Field &f : nodes[v].getFields()) {
 		pusher->getGlob(f.member);
@@ -585,13 +673,57 @@ void StructCompiler::stateVarsToBuilderDfs(const int v) {
 	}
 	for (const int to : nodes[v].getChildren()) {
 		(void) to;
-		pusher->push(-1, "STBREF");
+		pusher->push(-1, lazy ? "STREF" : "STBREF");
 	}
 	for (const Field &f : nodes[v].getFields()) {
 		store(f.member, false, false, true);
 	}
 }
 
+void StructCompiler::lazyStateVarsToCell(const int v, std::vector<int> &refPath) {
+	// If none of the state vars of the cell and its children is loaded, they are unchanged
+	// and the cell is taken from the rest of c4 saved by c4_to_c7. Otherwise it's built again.
+	std::vector<VariableDeclaration const*> members;
+	collectMembers(v, members);
+	pusher->getGlob(pusher->ctx().lazyStateMaskGlobal());
+	pusher->pushLazyStateMask(members);
+	pusher->push(-1, "AND");
+	pusher->push(-1, ""); // fix stack
+
+	pusher->startContinuation();
+	pusher->push(+1, "NEWC");
+	stateVarsToBuilderDfs(v, refPath);
+	pusher->push(0, "ENDC");
+	pusher->endContinuation();
+	pusher->push(-1, ""); // fix stack
+
+	pusher->startContinuation();
+	pusher->getGlob(pusher->ctx().lazyStateSliceGlobal());
+	for (std::size_t i = 0; i < refPath.size(); ++i) {
+		if (i > 0) {
+			pusher->push(0, "CTOS");
+		}
+		if (refPath[i] == 0) {
+			pusher->push(0, "PLDREF");
+		} else {
+			pusher->push(0, "PLDREFIDX " + toString(refPath[i]));
+		}
+	}
+	pusher->endContinuation();
+	pusher->push(-1, ""); // fix stack
+
+	pusher->push(+1, "IFELSE");
+}
+
+void StructCompiler::collectMembers(const int v, std::vector<VariableDeclaration const*> &members) const {
+	for (const Field &f : nodes[v].getFields()) {
+		members.push_back(f.member);
+	}
+	for (const int to : nodes[v].getChildren()) {
+		collectMembers(to, members);
+	}
+}
+
 void StructCompiler::sliceToStateVarsToC7Dfs(const int v) {
 	// slice
 	for (const int to : nodes[v].getChildren()) {
@@ -108,10 +108,16 @@ private:
 public:
 	const std::vector<Node>& getNodes() { return nodes; }
 private:
+	// Places the fields in cells in the given order (indexes in variableDeclarations). A field is added
+	// to the last cell or, if firstFit, to the first one with enough space
+	std::vector<Node> makeNodes(const std::vector<int>& order, int skipData, bool isC4, bool firstFit) const;
+	static std::pair<int, int> layoutCost(const std::vector<Node>& cells);
 	void dfs(int v, std::vector<int> &nodePath, std::vector<int> &refPath);
 	void createDefaultStructDfs(int v);
 	void createStructDfs(int v, const std::map<std::string, int>& argStackSize);
-	void stateVarsToBuilderDfs(const int v);
+	void stateVarsToBuilderDfs(int v, std::vector<int> &refPath);
+	void lazyStateVarsToCell(int v, std::vector<int> &refPath);
+	void collectMembers(int v, std::vector<VariableDeclaration const*> &members) const;
 	void sliceToStateVarsToC7Dfs(int v);
 	void load(const VariableDeclaration *vd, bool reverseOrder);
 	// return true if on stack there are (value, slice) else false if (slice, value)
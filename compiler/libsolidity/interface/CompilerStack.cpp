@@ -41,6 +41,7 @@
 #include <libsolidity/ast/AST.h>
 #include <libsolidity/ast/TypeProvider.h>
 #include <libsolidity/ast/ASTJsonImporter.h>
+#include <libsolidity/ast/ASTVisitor.h>
 #include <libsolidity/interface/Natspec.h>
 #include <libsolidity/interface/Version.h>
 #include <libsolidity/parsing/Parser.h>
@@ -57,6 +58,12 @@
 #include <boost/algorithm/string.hpp>
 #include <libsolidity/codegen/TVM.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 using namespace std;
 using namespace solidity;
 using namespace solidity::langutil;
@@ -184,12 +191,14 @@ void CompilerStack::reset(bool _keepSettings)
 		m_optimiserSettings = OptimiserSettings::minimal();
 		m_metadataLiteralSources = false;
 		m_metadataHash = MetadataHash::IPFS;
+		m_tvmSession = TVMCompilerSession{};
 	}
 	m_globalContext.reset();
 	m_scopes.clear();
 	m_sourceOrder.clear();
 	m_contracts.clear();
 	m_errorReporter.clear();
+	m_tvmSession.reset();
 	TypeProvider::reset();
 }
 
@@ -202,7 +211,7 @@ void CompilerStack::setSources(StringMap _sources)
 	for (auto source: _sources)
 		m_sources[source.first].scanner = make_shared<Scanner>(CharStream(/*content*/std::move(source.second), /*name*/source.first));
 	m_stackState = SourcesSet;
-	TVMSetFileName((m_sources.rbegin())->first);
+	m_tvmSession.setFileName((m_sources.rbegin())->first);
 }
 
 bool CompilerStack::parse()
@@ -214,6 +223,17 @@ bool CompilerStack::parse()
 //	if (SemVerVersion{string(VersionString)}.isPrerelease())
 //		m_errorReporter.warning("This is a pre-release compiler version, please do not use it in production.");
 
+	unsigned const jobQty = m_tvmSession.settings().jobs;
+	unsigned const threadQty = jobQty == 0 ? thread::hardware_concurrency() : jobQty;
+	if (threadQty > 1)
+	{
+		parseInParallel(threadQty);
+		m_stackState = ParsingPerformed;
+		if (!Error::containsOnlyWarnings(m_errorReporter.errors()))
+			m_hasError = true;
+		return !m_hasError;
+	}
+
 	Parser parser{m_errorReporter, m_evmVersion, m_parserErrorRecovery};
 
 	vector<string> sourcesToParse;
@@ -224,7 +244,10 @@ bool CompilerStack::parse()
 		string const& path = sourcesToParse[i];
 		Source& source = m_sources[path];
 		source.scanner->reset();
-		source.ast = parser.parse(source.scanner);
+		{
+			util::PassTimer::Scope timer{m_passTimer, "Parser", path};
+			source.ast = parser.parse(source.scanner);
+		}
 		if (!source.ast)
 			solAssert(!Error::containsOnlyWarnings(m_errorReporter.errors()), "Parser returned null but did not report error.");
 		else
@@ -246,6 +269,237 @@ bool CompilerStack::parse()
 	return !m_hasError;
 }
 
+namespace
+{
+/// Shifts the IDs of the nodes of a source unit, see ASTNode::shiftID
+class ASTNodeIDShifter: private ASTVisitor
+{
+public:
+	explicit ASTNodeIDShifter(int64_t _offset): m_offset(_offset) {}
+	void shift(SourceUnit& _sourceUnit) { _sourceUnit.accept(*this); }
+
+private:
+	bool visitNode(ASTNode& _node) override
+	{
+		// a node may be referred to from several places, its ID is shifted once
+		if (!m_visited.insert(&_node).second)
+			return false;
+		_node.shiftID(m_offset);
+		return true;
+	}
+
+	bool visit(ImportDirective& _node) override
+	{
+		// the symbols of an import are not visited by ImportDirective::accept
+		for (auto const& alias: _node.symbolAliases())
+			alias.symbol->accept(*this);
+		return visitNode(_node);
+	}
+
+	int64_t m_offset;
+	set<ASTNode const*> m_visited;
+};
+
+/// Creates the annotations of the nodes, which are otherwise created on first access,
+/// so that the analysis passes running in threads don't create them concurrently.
+class AnnotationPreloader: private ASTConstVisitor
+{
+public:
+	void preload(ASTNode const& _node) { _node.accept(*this); }
+
+private:
+	bool visitNode(ASTNode const& _node) override
+	{
+		_node.annotation();
+		return true;
+	}
+
+	bool visit(Identifier const& _identifier) override
+	{
+		// "this", "super" and the global variables are not part of the sources
+		if (Declaration const* declaration = _identifier.annotation().referencedDeclaration)
+			declaration->annotation();
+		return visitNode(_identifier);
+	}
+};
+}
+
+void CompilerStack::parseInParallel(unsigned _threadQty)
+{
+	// Workers parse the sources in any order, each source with its own parser and error list.
+	// The main thread takes the parsed sources in the order of the serial parse: it reports their errors,
+	// numbers their nodes after the nodes of the previous sources and schedules their imports.
+	struct ParseJob
+	{
+		string path;
+		shared_ptr<Scanner> scanner;
+		ASTPointer<SourceUnit> ast;
+		ErrorList errors;
+		int64_t nodeIDCount = 0;
+		exception_ptr failure;
+		bool done = false;
+	};
+	deque<ParseJob> jobs;
+	for (auto const& s: m_sources)
+	{
+		jobs.emplace_back();
+		jobs.back().path = s.first;
+		jobs.back().scanner = s.second.scanner;
+	}
+
+	mutex jobsMutex;
+	condition_variable jobsChanged;
+	size_t nextJob = 0;
+	bool finished = false;
+	auto worker = [&]()
+	{
+		unique_lock<mutex> lock(jobsMutex);
+		while (true)
+		{
+			jobsChanged.wait(lock, [&]() { return finished || nextJob < jobs.size(); });
+			if (finished)
+				return;
+			ParseJob& job = jobs[nextJob++];
+			lock.unlock();
+			try
+			{
+				util::PassTimer::Scope timer{m_passTimer, "Parser", job.path};
+				ErrorReporter errorReporter{job.errors};
+				Parser parser{errorReporter, m_evmVersion, m_parserErrorRecovery};
+				job.scanner->reset();
+				job.ast = parser.parse(job.scanner);
+				job.nodeIDCount = parser.nodeIDCount();
+			}
+			catch (...)
+			{
+				job.failure = current_exception();
+			}
+			lock.lock();
+			job.done = true;
+			jobsChanged.notify_all();
+		}
+	};
+	vector<thread> threads;
+	for (unsigned t = 0; t < _threadQty; ++t)
+		threads.emplace_back(worker);
+
+	exception_ptr failure;
+	int64_t nodeIDOffset = 0;
+	for (size_t i = 0; ; ++i)
+	{
+		unique_lock<mutex> lock(jobsMutex);
+		if (i == jobs.size())
+			break;
+		jobsChanged.wait(lock, [&]() { return jobs[i].done; });
+		ParseJob& job = jobs[i];
+		lock.unlock();
+
+		if (job.failure)
+		{
+			failure = job.failure;
+			break;
+		}
+		m_errorReporter.append(job.errors);
+		Source& source = m_sources[job.path];
+		source.ast = job.ast;
+		if (!source.ast)
+			solAssert(!Error::containsOnlyWarnings(m_errorReporter.errors()), "Parser returned null but did not report error.");
+		else
+		{
+			if (nodeIDOffset != 0)
+				ASTNodeIDShifter{nodeIDOffset}.shift(*source.ast);
+			source.ast->annotation().path = job.path;
+			for (auto const& newSource: loadMissingSources(*source.ast, job.path))
+			{
+				string const& newPath = newSource.first;
+				string const& newContents = newSource.second;
+				m_sources[newPath].scanner = make_shared<Scanner>(CharStream(newContents, newPath));
+				lock.lock();
+				jobs.emplace_back();
+				jobs.back().path = newPath;
+				jobs.back().scanner = m_sources[newPath].scanner;
+						jobsChanged.notify_all();
+				lock.unlock();
+			}
+		}
+		nodeIDOffset += job.nodeIDCount;
+	}
+
+	{
+		lock_guard<mutex> lock(jobsMutex);
+		finished = true;
+	}
+	jobsChanged.notify_all();
+	for (thread& t: threads)
+		t.join();
+	if (failure)
+		rethrow_exception(failure);
+}
+
+bool CompilerStack::runAnalysisPass(
+	vector<ASTNode const*> const& _nodes,
+	function<bool(size_t, ErrorReporter&)> const& _pass
+)
+{
+	unsigned const jobQty = m_tvmSession.settings().jobs;
+	unsigned const threadQty = min<size_t>(jobQty == 0 ? thread::hardware_concurrency() : jobQty, _nodes.size());
+	bool noErrors = true;
+	if (threadQty <= 1)
+	{
+		for (size_t i = 0; i < _nodes.size(); ++i)
+			if (!_pass(i, m_errorReporter))
+				noErrors = false;
+		return noErrors;
+	}
+
+	AnnotationPreloader preloader;
+	for (ASTNode const* node: _nodes)
+		preloader.preload(*node);
+
+	// A node that throws (e.g. a FatalError) stops the serial run, so the errors of the nodes
+	// after it are dropped and the exception is rethrown after the errors before it.
+	vector<ErrorList> errors(_nodes.size());
+	vector<char> results(_nodes.size(), true);
+	vector<exception_ptr> failures(_nodes.size());
+	atomic<size_t> nextNode{0};
+	atomic<size_t> firstFailure{_nodes.size()};
+	auto worker = [&]()
+	{
+		ASTNode::ReadOnlyAnnotationsScope readOnlyAnnotations;
+		for (size_t i = nextNode++; i < _nodes.size() && i < firstFailure; i = nextNode++)
+		{
+			ErrorReporter errorReporter{errors[i]};
+			try
+			{
+				results[i] = _pass(i, errorReporter);
+			}
+			catch (...)
+			{
+				failures[i] = current_exception();
+				size_t expected = firstFailure;
+				while (i < expected && !firstFailure.compare_exchange_weak(expected, i))
+				{
+				}
+			}
+		}
+	};
+	vector<thread> threads;
+	for (unsigned t = 0; t < threadQty; ++t)
+		threads.emplace_back(worker);
+	for (thread& t: threads)
+		t.join();
+
+	for (size_t i = 0; i < _nodes.size(); ++i)
+	{
+		m_errorReporter.append(errors[i]);
+		if (failures[i])
+			rethrow_exception(failures[i]);
+		if (!results[i])
+			noErrors = false;
+	}
+	return noErrors;
+}
+
 void CompilerStack::importASTs(map<string, Json::Value> const& _sources)
 {
 	if (m_stackState != Empty)
@@ -270,70 +524,98 @@ bool CompilerStack::analyze()
 {
 	if (m_stackState != ParsingPerformed || m_stackState >= AnalysisPerformed)
 		BOOST_THROW_EXCEPTION(CompilerError() << errinfo_comment("Must call analyze only after parsing was performed."));
-	resolveImports();
+	{
+		util::PassTimer::Scope timer{m_passTimer, "resolveImports"};
+		resolveImports();
+	}
 
 	bool noErrors = true;
 
 	try
 	{
-		SyntaxChecker syntaxChecker(m_errorReporter, m_optimiserSettings.runYulOptimiser);
-		for (Source const* source: m_sourceOrder)
-			if (source->ast && !syntaxChecker.checkSyntax(*source->ast))
-				noErrors = false;
+		{
+			util::PassTimer::Scope timer{m_passTimer, "SyntaxChecker"};
+			SyntaxChecker syntaxChecker(m_errorReporter, m_optimiserSettings.runYulOptimiser);
+			for (Source const* source: m_sourceOrder)
+				if (source->ast && !syntaxChecker.checkSyntax(*source->ast))
+					noErrors = false;
+		}
 
-		DocStringAnalyser docStringAnalyser(m_errorReporter);
-		for (Source const* source: m_sourceOrder)
-			if (source->ast && !docStringAnalyser.analyseDocStrings(*source->ast))
-				noErrors = false;
+		{
+			util::PassTimer::Scope timer{m_passTimer, "DocStringAnalyser"};
+			DocStringAnalyser docStringAnalyser(m_errorReporter);
+			for (Source const* source: m_sourceOrder)
+				if (source->ast && !docStringAnalyser.analyseDocStrings(*source->ast))
+					noErrors = false;
+		}
 
-		m_globalContext = make_shared<GlobalContext>();
-		NameAndTypeResolver resolver(*m_globalContext, m_evmVersion, m_scopes, m_errorReporter);
-		for (Source const* source: m_sourceOrder)
-			if (source->ast && !resolver.registerDeclarations(*source->ast))
-				return false;
+		{
+			util::PassTimer::Scope timer{m_passTimer, "NameAndTypeResolver"};
+			m_globalContext = make_shared<GlobalContext>();
+			NameAndTypeResolver resolver(*m_globalContext, m_evmVersion, m_scopes, m_errorReporter);
+			for (Source const* source: m_sourceOrder)
+				if (source->ast && !resolver.registerDeclarations(*source->ast))
+					return false;
 
-		map<string, SourceUnit const*> sourceUnitsByName;
-		for (auto& source: m_sources)
-			sourceUnitsByName[source.first] = source.second.ast.get();
-		for (Source const* source: m_sourceOrder)
-			if (source->ast && !resolver.performImports(*source->ast, sourceUnitsByName))
-				return false;
+			map<string, SourceUnit const*> sourceUnitsByName;
+			for (auto& source: m_sources)
+				sourceUnitsByName[source.first] = source.second.ast.get();
+			for (Source const* source: m_sourceOrder)
+				if (source->ast && !resolver.performImports(*source->ast, sourceUnitsByName))
+					return false;
 
-		// This is the main name and type resolution loop. Needs to be run for every contract, because
-		// the special variables "this" and "super" must be set appropriately.
-		for (Source const* source: m_sourceOrder)
-			if (source->ast)
-				for (ASTPointer<ASTNode> const& node: source->ast->nodes())
-				{
-					if (!resolver.resolveNamesAndTypes(*node))
-						return false;
-					if (ContractDefinition* contract = dynamic_cast<ContractDefinition*>(node.get()))
+			// This is the main name and type resolution loop. Needs to be run for every contract, because
+			// the special variables "this" and "super" must be set appropriately.
+			for (Source const* source: m_sourceOrder)
+				if (source->ast)
+					for (ASTPointer<ASTNode> const& node: source->ast->nodes())
 					{
-						// Note that we now reference contracts by their fully qualified names, and
-						// thus contracts can only conflict if declared in the same source file. This
-						// should already cause a double-declaration error elsewhere.
-						if (m_contracts.find(contract->fullyQualifiedName()) == m_contracts.end())
-							m_contracts[contract->fullyQualifiedName()].contract = contract;
-						else
-							solAssert(
-								m_errorReporter.hasErrors(),
-								"Contract already present (name clash?), but no error was reported."
-							);
-					}
+						if (!resolver.resolveNamesAndTypes(*node))
+							return false;
+						if (ContractDefinition* contract = dynamic_cast<ContractDefinition*>(node.get()))
+						{
+							// Note that we now reference contracts by their fully qualified names, and
+							// thus contracts can only conflict if declared in the same source file. This
+							// should already cause a double-declaration error elsewhere.
+							if (m_contracts.find(contract->fullyQualifiedName()) == m_contracts.end())
+								m_contracts[contract->fullyQualifiedName()].contract = contract;
+							else
+								solAssert(
+									m_errorReporter.hasErrors(),
+									"Contract already present (name clash?), but no error was reported."
+								);
+						}
 
-				}
+					}
+		}
 
 		// Next, we check inheritance, overrides, function collisions and other things at
 		// contract or function level.
 		// This also calculates whether a contract is abstract, which is needed by the
 		// type checker.
-		ContractLevelChecker contractLevelChecker(m_errorReporter);
+		{
+			util::PassTimer::Scope timer{m_passTimer, "ContractLevelChecker"};
+			ContractLevelChecker contractLevelChecker(m_errorReporter);
+			for (Source const* source: m_sourceOrder)
+				if (source->ast)
+					for (ASTPointer<ASTNode> const& node: source->ast->nodes())
+						if (ContractDefinition* contract = dynamic_cast<ContractDefinition*>(node.get()))
+							if (!contractLevelChecker.check(*contract))
+								noErrors = false;
+		}
+
+		// The passes below check every contract (or every top-level node of a source) on its own,
+		// so they are run on the contracts in several threads if --jobs is set.
+		vector<ASTNode const*> topLevelNodes;
+		vector<ASTNode const*> contracts;
 		for (Source const* source: m_sourceOrder)
 			if (source->ast)
 				for (ASTPointer<ASTNode> const& node: source->ast->nodes())
-					if (ContractDefinition* contract = dynamic_cast<ContractDefinition*>(node.get()))
-						if (!contractLevelChecker.check(*contract))
-							noErrors = false;
+				{
+					topLevelNodes.push_back(node.get());
+					if (dynamic_cast<ContractDefinition const*>(node.get()))
+						contracts.push_back(node.get());
+				}
 
 		// New we run full type checks that go down to the expression level. This
 		// cannot be done earlier, because we need cross-contract types and information
@@ -342,61 +624,72 @@ bool CompilerStack::analyze()
 		//
 		// Note: this does not resolve overloaded functions. In order to do that, types of arguments are needed,
 		// which is only done one step later.
-		TypeChecker typeChecker(m_evmVersion, m_errorReporter);
-		for (Source const* source: m_sourceOrder)
-			if (source->ast)
-				for (ASTPointer<ASTNode> const& node: source->ast->nodes())
-					if (ContractDefinition* contract = dynamic_cast<ContractDefinition*>(node.get()))
-						if (!typeChecker.checkTypeRequirements(*contract))
-							noErrors = false;
+		{
+			util::PassTimer::Scope timer{m_passTimer, "TypeChecker"};
+			if (!runAnalysisPass(contracts, [&](size_t _i, ErrorReporter& _errorReporter) {
+				return TypeChecker(m_evmVersion, _errorReporter).checkTypeRequirements(*contracts[_i]);
+			}))
+				noErrors = false;
+		}
 
 		if (noErrors)
 		{
 			// Checks that can only be done when all types of all AST nodes are known.
-			PostTypeChecker postTypeChecker(m_errorReporter);
-			for (Source const* source: m_sourceOrder)
-				if (source->ast && !postTypeChecker.check(*source->ast))
-					noErrors = false;
+			util::PassTimer::Scope timer{m_passTimer, "PostTypeChecker"};
+			if (!runAnalysisPass(topLevelNodes, [&](size_t _i, ErrorReporter& _errorReporter) {
+				return PostTypeChecker(_errorReporter).check(*topLevelNodes[_i]);
+			}))
+				noErrors = false;
 		}
 
 		if (noErrors)
 		{
 			// Control flow graph generator and analyzer. It can check for issues such as
 			// variable is used before it is assigned to.
-			CFG cfg(m_errorReporter);
-			for (Source const* source: m_sourceOrder)
-				if (source->ast && !cfg.constructFlow(*source->ast))
+			// A CFG uses its error reporter only in constructFlow, so it outlives the reporter.
+			vector<unique_ptr<CFG>> cfgs(topLevelNodes.size());
+			{
+				util::PassTimer::Scope timer{m_passTimer, "CFG"};
+				if (!runAnalysisPass(topLevelNodes, [&](size_t _i, ErrorReporter& _errorReporter) {
+					cfgs[_i] = make_unique<CFG>(_errorReporter);
+					return cfgs[_i]->constructFlow(*topLevelNodes[_i]);
+				}))
 					noErrors = false;
+			}
 
 			if (noErrors)
 			{
-				ControlFlowAnalyzer controlFlowAnalyzer(cfg, m_errorReporter);
-				for (Source const* source: m_sourceOrder)
-					if (source->ast && !controlFlowAnalyzer.analyze(*source->ast))
-						noErrors = false;
+				util::PassTimer::Scope timer{m_passTimer, "ControlFlowAnalyzer"};
+				if (!runAnalysisPass(topLevelNodes, [&](size_t _i, ErrorReporter& _errorReporter) {
+					return ControlFlowAnalyzer(*cfgs[_i], _errorReporter).analyze(*topLevelNodes[_i]);
+				}))
+					noErrors = false;
 			}
 		}
 
 		if (noErrors)
 		{
 			// Checks for common mistakes. Only generates warnings.
-			StaticAnalyzer staticAnalyzer(m_errorReporter);
-			for (Source const* source: m_sourceOrder)
-				if (source->ast && !staticAnalyzer.analyze(*source->ast))
-					noErrors = false;
+			util::PassTimer::Scope timer{m_passTimer, "StaticAnalyzer"};
+			if (!runAnalysisPass(topLevelNodes, [&](size_t _i, ErrorReporter& _errorReporter) {
+				return StaticAnalyzer(_errorReporter).analyze(*topLevelNodes[_i]);
+			}))
+				noErrors = false;
 		}
 
 		if (noErrors) {
 			//Checks for TVM specific issues.
-			TVMAnalyzer tvmAnalyzer(m_errorReporter, m_structWarning);
-			for (Source const* source: m_sourceOrder)
-				if (source->ast && !tvmAnalyzer.analyze(*source->ast))
-					noErrors = false;
+			util::PassTimer::Scope timer{m_passTimer, "TVMAnalyzer"};
+			if (!runAnalysisPass(topLevelNodes, [&](size_t _i, ErrorReporter& _errorReporter) {
+				return TVMAnalyzer(_errorReporter, m_structWarning).analyze(*topLevelNodes[_i]);
+			}))
+				noErrors = false;
 		}
 
 		if (noErrors)
 		{
 			// Check for state mutability in every function.
+			util::PassTimer::Scope timer{m_passTimer, "ViewPureChecker"};
 			vector<ASTPointer<ASTNode>> ast;
 			for (Source const* source: m_sourceOrder)
 				if (source->ast)
@@ -484,7 +777,8 @@ bool CompilerStack::compile()
 	if (!mainFound)
 		BOOST_THROW_EXCEPTION(CompilerError() << errinfo_comment("Specified contract was not found in sources."));
 
-	TVMSetAllContracts(allContracts, m_mainContract);
+	m_tvmSession.setAllContracts(allContracts, m_mainContract);
+	m_tvmSession.setPassTimer(m_passTimer);
 
 	// Only compile contracts individually which have been requested.
 	map<ContractDefinition const*, shared_ptr<Compiler const>> otherCompilers;
@@ -504,7 +798,7 @@ bool CompilerStack::compile()
 //					if (m_generateEwasm)
 //						generateEwasm(*contract);
 					try {
-						TVMCompilerProceedContract(&m_errorReporter, *contract, &pragmaDirectives);
+						m_tvmSession.proceedContract(&m_errorReporter, *contract, &pragmaDirectives);
 					} catch (FatalError const&) {
 						return false;
 					}
@@ -27,6 +27,7 @@
 #include <libsolidity/interface/OptimiserSettings.h>
 #include <libsolidity/interface/Version.h>
 #include <libsolidity/interface/DebugSettings.h>
+#include <libsolidity/codegen/TVM.h>
 // #include <libsolidity/formal/SolverInterface.h>
 
 #include <liblangutil/ErrorReporter.h>
@@ -35,6 +36,7 @@
 
 #include <libsolutil/Common.h>
 #include <libsolutil/FixedHash.h>
+#include <libsolutil/PassTimer.h>
 
 #include <boost/noncopyable.hpp>
 #include <json/json.h>
@@ -171,6 +173,22 @@ public:
 		m_mainContract = mainContract;
 	}
 
+	/// Enables TVM code generation with the given settings.
+	void setTVMSettings(TVMSettings const& _settings) {
+		m_tvmSession.enable(_settings);
+	}
+
+	/// Sets the stream for text output of the TVM backend, std::cout by default.
+	void setTVMOutputStream(std::ostream* _out) {
+		m_tvmSession.setOutputStream(_out);
+	}
+
+	/// Sets the timer of compilation passes, passes are not timed if it is null.
+	void setPassTimer(util::PassTimer* _timer) { m_passTimer = _timer; }
+
+	/// @returns the TVM backend state with the artifacts of the last compilation.
+	TVMCompilerSession const& tvmSession() const { return m_tvmSession; }
+
 	/// Enable experimental generation of Yul IR code.
 	void enableIRGeneration(bool _enable = true) { m_generateIR = _enable; }
 
@@ -331,6 +349,19 @@ private:
 		mutable std::unique_ptr<std::string const> runtimeSourceMapping;
 	};
 
+	/// Parses the sources and the sources imported by them in @a _threadQty threads.
+	/// The result and the errors are the same as in the serial parse.
+	void parseInParallel(unsigned _threadQty);
+
+	/// Runs an analysis pass on each of @a _nodes, in several threads if --jobs is set.
+	/// @a _pass gets the index of the node and the error reporter to use. In threads, each node
+	/// reports to its own error list and the lists are merged in the order of @a _nodes.
+	/// @returns false if @a _pass returned false for any node.
+	bool runAnalysisPass(
+		std::vector<ASTNode const*> const& _nodes,
+		std::function<bool(size_t, langutil::ErrorReporter&)> const& _pass
+	);
+
 	/// Loads the missing sources from @a _ast (named @a _path) using the callback
 	/// @a m_readFile and stores the absolute paths of all imports in the AST annotations.
 	/// @returns the newly loaded sources.
@@ -443,6 +474,8 @@ private:
 	bool m_release = VersionIsRelease;
 	bool m_structWarning = false;
 	std::string m_mainContract;
+	TVMCompilerSession m_tvmSession;
+	util::PassTimer* m_passTimer = nullptr;
 };
 
 }
@@ -48,6 +48,9 @@ public:
 
 	ASTPointer<SourceUnit> parse(std::shared_ptr<langutil::Scanner> const& _scanner);
 
+	/// @returns the number of AST node IDs used so far. The IDs of the next parsed source start after them.
+	int64_t nodeIDCount() const { return m_currentNodeID; }
+
 private:
 	class ASTNodeFactory;
 
@@ -0,0 +1,133 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file PassTimer.cpp
+ *
+ * Time and memory used by compilation passes.
+ */
+
+#include <libsolutil/PassTimer.h>
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+using namespace solidity::util;
+
+PassTimer::Scope::Scope(PassTimer* _timer, string _name, string _object):
+	m_timer(_timer),
+	m_name(std::move(_name)),
+	m_object(std::move(_object))
+{
+	if (!m_timer)
+		return;
+	m_startPeakRSS = peakRSS();
+	m_start = chrono::steady_clock::now();
+}
+
+PassTimer::Scope::~Scope()
+{
+	if (!m_timer)
+		return;
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - m_start).count();
+	long rss = peakRSS();
+	m_timer->record(m_name, m_object, seconds, rss - m_startPeakRSS, rss);
+}
+
+void PassTimer::record(string const& _name, string const& _object, double _seconds, long _peakRSSGrowth, long _peakRSS)
+{
+	lock_guard<mutex> lock(m_mutex);
+	auto it = find_if(m_passes.begin(), m_passes.end(), [&](Pass const& _pass) {
+		return _pass.name == _name && _pass.object == _object;
+	});
+	if (it == m_passes.end())
+	{
+		m_passes.push_back(Pass{_name, _object, 0, 0, 0, 0});
+		it = prev(m_passes.end());
+	}
+	++it->runs;
+	it->seconds += _seconds;
+	it->peakRSSGrowth += _peakRSSGrowth;
+	it->peakRSS = _peakRSS;
+}
+
+vector<PassTimer::Pass> PassTimer::passes() const
+{
+	lock_guard<mutex> lock(m_mutex);
+	return m_passes;
+}
+
+void PassTimer::clear()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_passes.clear();
+}
+
+void PassTimer::printTable(ostream& _out) const
+{
+	vector<Pass> const all = passes();
+	size_t nameWidth = 4;
+	for (Pass const& pass: all)
+		nameWidth = max(nameWidth, pass.name.size() + (pass.object.empty() ? 0 : pass.object.size() + 3));
+
+	string const rowFormat = "%-" + to_string(nameWidth) + "s %6s %12s %14s %14s\n";
+	_out << boost::format(rowFormat) % "Pass" % "Runs" % "Time, ms" % "Peak RSS +KiB" % "Peak RSS KiB";
+	for (Pass const& pass: all)
+		_out << boost::format(rowFormat) %
+			(pass.object.empty() ? pass.name : pass.name + " (" + pass.object + ")") %
+			pass.runs %
+			(boost::format("%.3f") % (pass.seconds * 1000)).str() %
+			pass.peakRSSGrowth %
+			pass.peakRSS;
+}
+
+Json::Value PassTimer::toJson() const
+{
+	Json::Value result(Json::arrayValue);
+	for (Pass const& pass: passes())
+	{
+		Json::Value item(Json::objectValue);
+		item["name"] = pass.name;
+		item["object"] = pass.object;
+		item["runs"] = Json::UInt64(pass.runs);
+		item["seconds"] = pass.seconds;
+		item["peakRSSGrowthKiB"] = Json::Int64(pass.peakRSSGrowth);
+		item["peakRSSKiB"] = Json::Int64(pass.peakRSS);
+		result.append(item);
+	}
+	return result;
+}
+
+long PassTimer::peakRSS()
+{
+#ifdef _WIN32
+	return 0;
+#else
+	rusage usage{};
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
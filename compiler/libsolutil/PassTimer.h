@@ -0,0 +1,88 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** @file PassTimer.h
+ *
+ * Time and memory used by compilation passes.
+ */
+
+#pragma once
+
+#include <json/json.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace solidity::util
+{
+
+/// Collects wall time and peak resident set size of compilation passes.
+/// A pass may run several times (e.g. for every source), runs of the same pass on the same object are summed up.
+/// Passes may be recorded from several threads.
+class PassTimer
+{
+public:
+	struct Pass
+	{
+		std::string name;
+		/// Source, contract or function the pass ran on, empty if the pass ran on everything
+		std::string object;
+		size_t runs = 0;
+		double seconds = 0;
+		/// Growth of the peak resident set size of the process during the runs, in KiB
+		long peakRSSGrowth = 0;
+		/// Peak resident set size after the last run, in KiB
+		long peakRSS = 0;
+	};
+
+	/// Measures the pass from construction to destruction. Does nothing if the timer is null.
+	class Scope: boost::noncopyable
+	{
+	public:
+		Scope(PassTimer* _timer, std::string _name, std::string _object = {});
+		~Scope();
+
+	private:
+		PassTimer* m_timer;
+		std::string m_name;
+		std::string m_object;
+		std::chrono::steady_clock::time_point m_start;
+		long m_startPeakRSS = 0;
+	};
+
+	void record(std::string const& _name, std::string const& _object, double _seconds, long _peakRSSGrowth, long _peakRSS);
+
+	/// @returns the passes in order of their first run
+	std::vector<Pass> passes() const;
+	void clear();
+
+	void printTable(std::ostream& _out) const;
+	Json::Value toJson() const;
+
+	/// @returns peak resident set size of the process in KiB or 0 if it is unknown
+	static long peakRSS();
+
+private:
+	mutable std::mutex m_mutex;
+	std::vector<Pass> m_passes;
+};
+
+}
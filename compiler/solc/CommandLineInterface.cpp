@@ -21,6 +21,7 @@
  * Solidity command line interface.
  */
 #include <solc/CommandLineInterface.h>
+#include <solc/CompilationCache.h>
 
 #include "solidity/BuildInfo.h"
 #include "license.h"
@@ -55,6 +56,7 @@
 	#define isatty _isatty
 	#define fileno _fileno
 #else // unix
+	#include <sys/stat.h>
 	#include <unistd.h>
 #endif
 
@@ -64,7 +66,6 @@
 
 #include <libsolidity/codegen/TVM.h>
 #include <libsolidity/codegen/TVMOptimizations.hpp>
-#include <libsolidity/codegen/TVMContractCompiler.hpp>
 
 #if !defined(STDERR_FILENO)
 	#define STDERR_FILENO 2
@@ -121,11 +122,24 @@ static string const g_argTvm = "tvm";
 static string const g_argTvmABI = "tvm-abi";
 static string const g_argTvmOptimize = "tvm-optimize";
 static string const g_argTvmUnsavedStructs = "tvm-unsaved-structs";
+static string const g_argGasReport = "gas-report";
+static string const g_argTvmLazyState = "tvm-lazy-state";
+static string const g_argTvmHotColdLayout = "tvm-hot-cold-layout";
+static string const g_argTvmPackCells = "tvm-pack-cells";
+static string const g_argTvmLayoutProfile = "tvm-layout-profile";
+static string const g_argTvmAutoInline = "tvm-auto-inline";
+static string const g_argTvmOutline = "tvm-outline";
+static string const g_argTvmBoc = "tvm-boc";
 static string const g_argTvmWithoutLogStr = "without-logstr";
 static string const g_argTvmDumpStorage = "dump-storage";
 static string const g_argTvmPeephole = "tvm-peephole";
 static string const g_argSetContract = "contract";
 static string const g_argTvmMuteFlagWarning = "tvm-mute";
+static string const g_argJobs = "jobs";
+static string const g_argServer = "server";
+static string const g_argCacheDir = "cache-dir";
+static string const g_argTimePasses = "time-passes";
+static string const g_argTimePassesJson = "time-passes-json";
 
 static void version()
 {
@@ -158,6 +172,24 @@ static bool needsHumanTargetedStdout(po::variables_map const& _args)
 	return false;
 }
 
+/// @returns the modification time of the file in nanoseconds, last_write_time has a precision of seconds
+static int64_t fileModificationTime(boost::filesystem::path const& _path)
+{
+#ifdef _WIN32
+	return int64_t(boost::filesystem::last_write_time(_path)) * 1000000000;
+#else
+	struct stat status;
+	if (::stat(_path.c_str(), &status) != 0)
+		return int64_t(boost::filesystem::last_write_time(_path)) * 1000000000;
+#if defined(__APPLE__)
+	timespec const& time = status.st_mtimespec;
+#else
+	timespec const& time = status.st_mtim;
+#endif
+	return int64_t(time.tv_sec) * 1000000000 + time.tv_nsec;
+#endif
+}
+
 void CommandLineInterface::handleNatspec(bool _natspecDev, string const& _contract)
 {
 	std::string argName;
@@ -278,6 +310,50 @@ Allowed options)",
 			(g_argSetContract + ",c").c_str(),
 			po::value<string>()->value_name("contract"),
 			"If given, sets the Contract from source file to be compiled, otherwise the last one is compiled."
+		)
+		(
+			(g_argJobs + ",j").c_str(),
+			po::value<unsigned>()->value_name("N"),
+			"Parse source files, analyze contracts and generate code of contract functions in N threads. "
+			"0 means one thread per CPU core. Default is 1."
+		)
+		(
+			g_argTvmLayoutProfile.c_str(),
+			po::value<string>()->value_name("file"),
+			"JSON object with numbers of accesses of state variables by name, used instead of the static count by "
+			"--tvm-hot-cold-layout (implies it)."
+		)
+		(
+			g_argTvmAutoInline.c_str(),
+			po::value<string>()->value_name("size|gas"),
+			"Inline internal functions which aren't marked as inline if it makes the code smaller (size) "
+			"or if their code fits into one cell and all the copies add one cell of code at most (gas)."
+		)
+		(
+			g_argTvmBoc.c_str(),
+			po::value<string>()->value_name("stdlib"),
+			"Experimental: assemble the contract with the given stdlib (stdlib_sol.tvm) into its StateInit and save "
+			"it to <contract>.boc, without tvm_linker. This is not a .tvc file of tvm_linker: function ids, the "
+			"layout of the code and of the bag of cells differ."
+		)
+		(
+			g_argCacheDir.c_str(),
+			po::value<string>()->value_name("path"),
+			"Store results of compilations in the given directory and reuse them if the sources and options are the same."
+		)
+		(
+			g_argTimePasses.c_str(),
+			"Print time and peak memory usage of compilation passes to stderr. Code generation is reported per function."
+		)
+		(
+			g_argTimePassesJson.c_str(),
+			"Same as --time-passes, but print the report in JSON format."
+		)
+		(
+			g_argServer.c_str(),
+			"Read compilation requests from stdin, one JSON object per line, and write one JSON result per line "
+			"to stdout. Other options are the defaults for all requests. Imports are read from the directories "
+			"of the \"files\" of the request only."
 		)
 			;
 	po::options_description outputComponents("Output Components");
@@ -293,6 +369,11 @@ Allowed options)",
 		(g_argTvmPeephole.c_str(), "Run peephole optimization pass")
 		(g_argTvmOptimize.c_str(), "Optimize produced TVM assembly code")
 		(g_argTvmUnsavedStructs.c_str(), "Enable struct usage analizer")
+		(g_argTvmHotColdLayout.c_str(), "Place the most used state variables in the root cell of the persistent data (changes the layout of c4)")
+		(g_argTvmPackCells.c_str(), "Reorder fields of structs and state variables in cells to use fewer cells (changes the layout of c4 and of structs in cells)")
+		(g_argTvmOutline.c_str(), "Move repeated instruction sequences to macros. Makes the code smaller and calls of the macros cost gas")
+		(g_argTvmLazyState.c_str(), "Decode a state variable from c4 on its first access instead of decoding all of them in c4_to_c7. c7_to_c4 keeps the cells of c4 whose variables were not accessed")
+		(g_argGasReport.c_str(), "Estimate gas of every function of the produced TVM assembly and save it to <contract>.gas.json")
 		(g_argTvmMuteFlagWarning.c_str(), "Mute warning about --tvm and --tvm-abi flags. Use at your own risk.");
 	desc.add(outputComponents);
 
@@ -331,7 +412,66 @@ Allowed options)",
 	else if (tvmDump) op = TvmOption::DumpStorage;
 	else if (tvmCode) op = TvmOption::Code;
 	else op = TvmOption::CodeAndAbi;
-	TVMCompilerEnable(op, m_args.count(g_argTvmWithoutLogStr), m_args.count(g_argTvmOptimize) > 0);
+	m_tvmSettings.tvmOption = op;
+	m_tvmSettings.withoutLogstr = m_args.count(g_argTvmWithoutLogStr);
+	m_tvmSettings.optimize = m_args.count(g_argTvmOptimize) > 0;
+	m_tvmSettings.gasReport = m_args.count(g_argGasReport) > 0;
+	m_tvmSettings.lazyStateLoad = m_args.count(g_argTvmLazyState) > 0;
+	if (m_args.count(g_argJobs))
+		m_tvmSettings.jobs = m_args[g_argJobs].as<unsigned>();
+	m_tvmSettings.hotColdLayout = m_args.count(g_argTvmHotColdLayout) > 0;
+	m_tvmSettings.packCells = m_args.count(g_argTvmPackCells) > 0;
+	m_tvmSettings.outline = m_args.count(g_argTvmOutline) > 0;
+	if (m_args.count(g_argTvmLayoutProfile))
+	{
+		string const path = m_args[g_argTvmLayoutProfile].as<string>();
+		if (!boost::filesystem::is_regular_file(path))
+		{
+			serr() << "Layout profile \"" << path << "\" is not found." << endl;
+			return false;
+		}
+		Json::Value profile;
+		string errors;
+		if (!jsonParseStrict(readFileAsString(path), profile, &errors) || !profile.isObject())
+		{
+			serr() << "Invalid layout profile: " << (errors.empty() ? "expected a JSON object." : errors) << endl;
+			return false;
+		}
+		for (string const& name: profile.getMemberNames())
+		{
+			if (!profile[name].isNumeric())
+			{
+				serr() << "Invalid layout profile: number of accesses of \"" << name << "\" is not a number." << endl;
+				return false;
+			}
+			m_tvmSettings.layoutProfile[name] = profile[name].asDouble();
+		}
+		m_tvmSettings.hotColdLayout = true;
+	}
+
+	if (m_args.count(g_argTvmAutoInline))
+	{
+		string const mode = m_args[g_argTvmAutoInline].as<string>();
+		if (mode == "size")
+			m_tvmSettings.autoInline = TvmAutoInline::Size;
+		else if (mode == "gas")
+			m_tvmSettings.autoInline = TvmAutoInline::Gas;
+		else
+		{
+			serr() << "Invalid value of --" << g_argTvmAutoInline << ": \"" << mode << "\". Expected \"size\" or \"gas\"." << endl;
+			return false;
+		}
+	}
+
+	if (m_args.count(g_argTvmBoc))
+	{
+		m_tvmSettings.bocStdlib = m_args[g_argTvmBoc].as<string>();
+		if (!boost::filesystem::is_regular_file(m_tvmSettings.bocStdlib))
+		{
+			serr() << "Stdlib \"" << m_tvmSettings.bocStdlib << "\" is not found." << endl;
+			return false;
+		}
+	}
 
 	const bool tvmMute = m_args.count(g_argTvmMuteFlagWarning);
 	if ((tvmAbi || tvmCode) && !tvmMute) {
@@ -377,81 +517,209 @@ Allowed options)",
 	return true;
 }
 
-bool CommandLineInterface::processInput()
+ReadCallback::Result CommandLineInterface::readFile(string const& _kind, string const& _path)
 {
-	ReadCallback::Callback fileReader = [this](string const& _kind, string const& _path)
+	try
 	{
-		try
+		if (_kind != ReadCallback::kindString(ReadCallback::Kind::ReadFile))
+			BOOST_THROW_EXCEPTION(InternalCompilerError() << errinfo_comment(
+				"ReadFile callback used as callback kind " +
+				_kind
+			));
+		auto path = boost::filesystem::path(_path);
+		auto canonicalPath = boost::filesystem::weakly_canonical(path);
+		bool isAllowed = false;
+		for (auto const& allowedDir: m_allowedDirectories)
 		{
-			if (_kind != ReadCallback::kindString(ReadCallback::Kind::ReadFile))
-				BOOST_THROW_EXCEPTION(InternalCompilerError() << errinfo_comment(
-					"ReadFile callback used as callback kind " +
-					_kind
-				));
-			auto path = boost::filesystem::path(_path);
-			auto canonicalPath = boost::filesystem::weakly_canonical(path);
-			bool isAllowed = false;
-			for (auto const& allowedDir: m_allowedDirectories)
+			// If dir is a prefix of boostPath, we are fine.
+			if (
+				std::distance(allowedDir.begin(), allowedDir.end()) <= std::distance(canonicalPath.begin(), canonicalPath.end()) &&
+				std::equal(allowedDir.begin(), allowedDir.end(), canonicalPath.begin())
+			)
 			{
-				// If dir is a prefix of boostPath, we are fine.
-				if (
-					std::distance(allowedDir.begin(), allowedDir.end()) <= std::distance(canonicalPath.begin(), canonicalPath.end()) &&
-					std::equal(allowedDir.begin(), allowedDir.end(), canonicalPath.begin())
-				)
-				{
-					isAllowed = true;
-					break;
-				}
+				isAllowed = true;
+				break;
 			}
-			if (!isAllowed)
-				return ReadCallback::Result{false, "File outside of allowed directories."};
+		}
+		if (!isAllowed)
+			return ReadCallback::Result{false, "File outside of allowed directories."};
+
+		if (!boost::filesystem::exists(canonicalPath))
+			return ReadCallback::Result{false, "File not found."};
+
+		if (!boost::filesystem::is_regular_file(canonicalPath))
+			return ReadCallback::Result{false, "Not a valid file."};
+
+		// Files imported by many requests of the server are read only once while they are not modified
+		uintmax_t const size = boost::filesystem::file_size(canonicalPath);
+		int64_t const modificationTime = fileModificationTime(canonicalPath);
+		auto cached = m_fileCache.find(canonicalPath.string());
+		if (
+			cached == m_fileCache.end() ||
+			cached->second.size != size ||
+			cached->second.modificationTime != modificationTime
+		)
+			cached = m_fileCache.insert_or_assign(
+				canonicalPath.string(),
+				CachedFile{size, modificationTime, readFileAsString(canonicalPath.string())}
+			).first;
+		string const& contents = cached->second.contents;
+		m_sourceCodes[path.generic_string()] = contents;
+		return ReadCallback::Result{true, contents};
+	}
+	catch (Exception const& _exception)
+	{
+		return ReadCallback::Result{false, "Exception in read callback: " + boost::diagnostic_information(_exception)};
+	}
+	catch (...)
+	{
+		return ReadCallback::Result{false, "Unknown exception in read callback."};
+	}
+}
 
-			if (!boost::filesystem::exists(canonicalPath))
-				return ReadCallback::Result{false, "File not found."};
+bool CommandLineInterface::processInput()
+{
+	if (m_args.count(g_argServer))
+		return true;
 
-			if (!boost::filesystem::is_regular_file(canonicalPath))
-				return ReadCallback::Result{false, "Not a valid file."};
+	if (!readInputFilesAndConfigureRemappings())
+		return false;
 
-			auto contents = readFileAsString(canonicalPath.string());
-			m_sourceCodes[path.generic_string()] = contents;
-			return ReadCallback::Result{true, contents};
-		}
-		catch (Exception const& _exception)
-		{
-			return ReadCallback::Result{false, "Exception in read callback: " + boost::diagnostic_information(_exception)};
-		}
-		catch (...)
+	m_compiler = make_unique<CompilerStack>([this](string const& _kind, string const& _path)
+	{
+		return readFile(_kind, _path);
+	});
+
+	if (m_args.count(g_argInputFile))
+		m_compiler->setRemappings(m_remappings);
+	m_compiler->setSources(m_sourceCodes);
+
+	if (m_args.count(g_argTvmUnsavedStructs))
+		m_compiler->setStructWarning(true);
+
+	if (m_args.count(g_argSetContract))
+		m_compiler->setMainContract(m_args[g_argSetContract].as<string>());
+
+	if (m_args.count(g_argOutputDir))
+		m_tvmSettings.outputFolder = m_args[g_argOutputDir].as<string>();
+	// Artifacts are kept in memory only to be stored in the cache. The cache keeps text artifacts only,
+	// so contracts assembled into .boc aren't cached.
+	bool const useCache = m_args.count(g_argCacheDir) && m_tvmSettings.bocStdlib.empty();
+	m_tvmSettings.recordArtifacts = useCache;
+	m_compiler->setTVMSettings(m_tvmSettings);
+	bool const timePasses = m_args.count(g_argTimePasses) || m_args.count(g_argTimePassesJson);
+	if (timePasses)
+		m_compiler->setPassTimer(&m_passTimer);
+
+	bool success;
+	// AST and documentation are printed from the compiler stack, so they can't be taken from the cache
+	if (useCache && !needsHumanTargetedStdout(m_args) && !m_args.count(g_argAstCompactJson))
+		success = compileWithCache();
+	else
+		success = compile(*m_compiler, serr(false), m_coloredOutput);
+
+	if (m_args.count(g_argTimePassesJson))
+		serr() << jsonPrettyPrint(m_passTimer.toJson()) << endl;
+	else if (timePasses)
+		m_passTimer.printTable(serr());
+	return success;
+}
+
+Json::Value CommandLineInterface::cacheInputs() const
+{
+	Json::Value inputs(Json::objectValue);
+	inputs["version"] = VersionString;
+	inputs["sources"] = Json::objectValue;
+	for (auto const& [name, content]: m_sourceCodes)
+		inputs["sources"][name] = content;
+	inputs["remappings"] = Json::arrayValue;
+	for (auto const& remapping: m_remappings)
+		inputs["remappings"].append(remapping.context + ":" + remapping.prefix + "=" + remapping.target);
+	inputs["contract"] = m_args.count(g_argSetContract) ? m_args[g_argSetContract].as<string>() : "";
+	inputs["outputDir"] = m_tvmSettings.outputFolder;
+	inputs["tvmOption"] = static_cast<int>(m_tvmSettings.tvmOption);
+	inputs["optimize"] = m_tvmSettings.optimize;
+	inputs["withoutLogstr"] = m_tvmSettings.withoutLogstr;
+	inputs["gasReport"] = m_tvmSettings.gasReport;
+	inputs["lazyStateLoad"] = m_tvmSettings.lazyStateLoad;
+	inputs["hotColdLayout"] = m_tvmSettings.hotColdLayout;
+	inputs["packCells"] = m_tvmSettings.packCells;
+	inputs["autoInline"] = static_cast<int>(m_tvmSettings.autoInline);
+	inputs["outline"] = m_tvmSettings.outline;
+	inputs["layoutProfile"] = Json::objectValue;
+	for (auto const& [name, count]: m_tvmSettings.layoutProfile)
+		inputs["layoutProfile"][name] = count;
+	inputs["unsavedStructs"] = m_args.count(g_argTvmUnsavedStructs) > 0;
+	inputs["coloredOutput"] = m_coloredOutput;
+	return inputs;
+}
+
+bool CommandLineInterface::compileWithCache()
+{
+	CompilationCache cache(m_args[g_argCacheDir].as<string>());
+	string const key = CompilationCache::key(jsonCompactPrint(cacheInputs()));
+
+	if (optional<CompilationCache::Entry> entry = cache.load(key))
+	{
+		for (auto const& [path, content]: entry->artifacts)
 		{
-			return ReadCallback::Result{false, "Unknown exception in read callback."};
+			auto parent = boost::filesystem::path(path).parent_path();
+			if (!parent.empty())
+				boost::filesystem::create_directories(parent);
+			ofstream file(path, ios::binary);
+			file << content;
+			if (!file)
+			{
+				serr() << "Failed to open the output file: " << path << endl;
+				return false;
+			}
 		}
-	};
+		sout() << entry->output;
+		serr(false) << entry->diagnostics;
+		g_hasOutput = !entry->artifacts.empty() || !entry->output.empty();
+		m_compiledFromCache = true;
+		return true;
+	}
 
-	if (!readInputFilesAndConfigureRemappings())
+	map<string, string> const sources = m_sourceCodes;
+	ostringstream output;
+	ostringstream diagnostics;
+	m_compiler->setTVMOutputStream(&output);
+	bool successful = compile(*m_compiler, diagnostics, m_coloredOutput);
+	sout() << output.str();
+	serr(false) << diagnostics.str();
+	if (!successful)
 		return false;
 
-	m_compiler = make_unique<CompilerStack>(fileReader);
+	CompilationCache::Entry entry;
+	// readFile adds imported files to m_sourceCodes
+	for (auto const& [path, content]: m_sourceCodes)
+		if (!sources.count(path))
+			entry.imports[path] = CompilationCache::contentHash(content);
+	entry.artifacts = m_compiler->tvmSession().artifacts();
+	entry.output = output.str();
+	entry.diagnostics = diagnostics.str();
+	try
+	{
+		cache.store(key, entry);
+	}
+	catch (boost::filesystem::filesystem_error const& _exception)
+	{
+		serr() << "Warning: failed to store the compilation result in the cache: " << _exception.what() << endl;
+	}
+	return true;
+}
 
+bool CommandLineInterface::compile(CompilerStack& _compiler, ostream& _err, bool _coloredOutput)
+{
 	unique_ptr<SourceReferenceFormatter> formatter;
-	formatter = make_unique<SourceReferenceFormatterHuman>(serr(false), m_coloredOutput);
+	formatter = make_unique<SourceReferenceFormatterHuman>(_err, _coloredOutput);
 
 	try
 	{
-		if (m_args.count(g_argInputFile))
-			m_compiler->setRemappings(m_remappings);
-		m_compiler->setSources(m_sourceCodes);
-
-		if (m_args.count(g_argTvmUnsavedStructs))
-			m_compiler->setStructWarning(true);
+		bool successful = _compiler.compile();
 
-		if (m_args.count(g_argSetContract))
-			m_compiler->setMainContract(m_args[g_argSetContract].as<string>());
-
-		if (m_args.count(g_argOutputDir))
-			TVMContractCompiler::m_outputFolder = m_args[g_argOutputDir].as<string>();
-
-		bool successful = m_compiler->compile();
-
-		for (auto const& error: m_compiler->errors())
+		for (auto const& error: _compiler.errors())
 		{
 			g_hasOutput = true;
 			formatter->printErrorInformation(*error);
@@ -470,7 +738,7 @@ bool CommandLineInterface::processInput()
 	}
 	catch (InternalCompilerError const& _exception)
 	{
-		serr() <<
+		_err <<
 			"Internal compiler error during compilation:" <<
 			endl <<
 			boost::diagnostic_information(_exception);
@@ -478,7 +746,7 @@ bool CommandLineInterface::processInput()
 	}
 	catch (UnimplementedFeatureError const& _exception)
 	{
-		serr() <<
+		_err <<
 			"Unimplemented feature:" <<
 			endl <<
 			boost::diagnostic_information(_exception);
@@ -487,7 +755,7 @@ bool CommandLineInterface::processInput()
 	catch (Error const& _error)
 	{
 		if (_error.type() == Error::Type::DocstringParsingError)
-			serr() << "Documentation parsing error: " << *boost::get_error_info<errinfo_comment>(_error) << endl;
+			_err << "Documentation parsing error: " << *boost::get_error_info<errinfo_comment>(_error) << endl;
 		else
 		{
 			g_hasOutput = true;
@@ -498,25 +766,180 @@ bool CommandLineInterface::processInput()
 	}
 	catch (Exception const& _exception)
 	{
-		serr() << "Exception during compilation: " << boost::diagnostic_information(_exception) << endl;
+		_err << "Exception during compilation: " << boost::diagnostic_information(_exception) << endl;
 		return false;
 	}
 	catch (std::exception const& _e)
 	{
-		serr() << "Unknown exception during compilation" << (
+		_err << "Unknown exception during compilation" << (
 			_e.what() ? ": " + string(_e.what()) : "."
 		) << endl;
 		return false;
 	}
 	catch (...)
 	{
-		serr() << "Unknown exception during compilation." << endl;
+		_err << "Unknown exception during compilation." << endl;
 		return false;
 	}
 
 	return true;
 }
 
+bool CommandLineInterface::serve()
+{
+	string line;
+	while (getline(std::cin, line))
+	{
+		if (boost::algorithm::trim_copy(line).empty())
+			continue;
+		Json::Value response;
+		try
+		{
+			response = serveRequest(line);
+		}
+		catch (std::exception const& _e)
+		{
+			response = Json::objectValue;
+			response["id"] = Json::nullValue;
+			response["success"] = false;
+			response["errors"] = "Invalid request: " + string(_e.what());
+		}
+		sout() << jsonCompactPrint(response) << endl;
+	}
+	return true;
+}
+
+Json::Value CommandLineInterface::serveRequest(string const& _request)
+{
+	Json::Value response(Json::objectValue);
+	response["id"] = Json::nullValue;
+	response["success"] = false;
+
+	Json::Value request;
+	string parseErrors;
+	if (!jsonParseStrict(_request, request, &parseErrors) || !request.isObject())
+	{
+		response["errors"] = "Invalid request: " + (parseErrors.empty() ? "expected a JSON object." : parseErrors);
+		return response;
+	}
+	response["id"] = request["id"];
+
+	Json::Value const& settings = request["settings"];
+	auto flag = [&](string const& _name, bool _default)
+	{
+		return settings.isObject() && settings[_name].isBool() ? settings[_name].asBool() : _default;
+	};
+
+	TVMSettings tvmSettings = m_tvmSettings;
+	tvmSettings.optimize = flag("optimize", tvmSettings.optimize);
+	tvmSettings.withoutLogstr = flag("withoutLogstr", tvmSettings.withoutLogstr);
+	tvmSettings.gasReport = flag("gasReport", tvmSettings.gasReport);
+	tvmSettings.lazyStateLoad = flag("lazyStateLoad", tvmSettings.lazyStateLoad);
+	tvmSettings.hotColdLayout = flag("hotColdLayout", tvmSettings.hotColdLayout);
+	tvmSettings.packCells = flag("packCells", tvmSettings.packCells);
+	tvmSettings.outline = flag("outline", tvmSettings.outline);
+	if (settings.isObject() && settings["layoutProfile"].isObject())
+	{
+		tvmSettings.layoutProfile.clear();
+		for (string const& name: settings["layoutProfile"].getMemberNames())
+			if (settings["layoutProfile"][name].isNumeric())
+				tvmSettings.layoutProfile[name] = settings["layoutProfile"][name].asDouble();
+		tvmSettings.hotColdLayout = true;
+	}
+	if (settings.isObject() && settings["autoInline"].isString())
+	{
+		static map<string, TvmAutoInline> const modes{
+			{"none", TvmAutoInline::None},
+			{"size", TvmAutoInline::Size},
+			{"gas", TvmAutoInline::Gas}
+		};
+		auto mode = modes.find(settings["autoInline"].asString());
+		if (mode == modes.end())
+		{
+			response["errors"] = "Invalid request: unknown autoInline mode \"" + settings["autoInline"].asString() + "\".";
+			return response;
+		}
+		tvmSettings.autoInline = mode->second;
+	}
+	if (settings.isObject() && settings["output"].isString())
+	{
+		static map<string, TvmOption> const outputs{
+			{"code", TvmOption::Code},
+			{"abi", TvmOption::Abi},
+			{"storage", TvmOption::DumpStorage},
+			{"codeAndAbi", TvmOption::CodeAndAbi}
+		};
+		auto output = outputs.find(settings["output"].asString());
+		if (output == outputs.end())
+		{
+			response["errors"] = "Invalid request: unknown output \"" + settings["output"].asString() + "\".";
+			return response;
+		}
+		tvmSettings.tvmOption = output->second;
+	}
+	// Artifacts are returned in the response and written to disk only if the request asks for it
+	tvmSettings.outputFolder = request["outputDir"].isString() ? request["outputDir"].asString() : "";
+	tvmSettings.keepArtifactsInMemory = tvmSettings.outputFolder.empty();
+	tvmSettings.recordArtifacts = true;
+	// Responses are JSON, binary .boc can't be returned
+	tvmSettings.bocStdlib.clear();
+
+	// Sources and allowed directories of the previous request must not leak into this one
+	vector<boost::filesystem::path> const allowedDirectories = m_allowedDirectories;
+	ScopeGuard restoreAllowedDirectories([&]() { m_allowedDirectories = allowedDirectories; });
+	m_sourceCodes.clear();
+
+	ostringstream errors;
+	for (auto const& path: request["files"])
+	{
+		auto infile = boost::filesystem::path(path.asString());
+		if (!boost::filesystem::is_regular_file(infile))
+		{
+			response["errors"] = path.asString() + " is not found.";
+			return response;
+		}
+		m_sourceCodes[infile.generic_string()] = readFileAsString(infile.string());
+		m_allowedDirectories.push_back(boost::filesystem::canonical(infile).remove_filename());
+	}
+	// Names of sources are chosen by the client, so they don't allow reading any files
+	for (auto const& name: request["sources"].getMemberNames())
+		m_sourceCodes[name] = request["sources"][name].asString();
+	if (m_sourceCodes.empty())
+	{
+		response["errors"] = "Invalid request: no \"sources\" or \"files\" given.";
+		return response;
+	}
+
+	CompilerStack compiler([this](string const& _kind, string const& _path)
+	{
+		return readFile(_kind, _path);
+	});
+	ostringstream output;
+	compiler.setTVMOutputStream(&output);
+	compiler.setRemappings(m_remappings);
+	compiler.setSources(m_sourceCodes);
+	compiler.setStructWarning(flag("unsavedStructs", m_args.count(g_argTvmUnsavedStructs) > 0));
+	if (request["contract"].isString())
+		compiler.setMainContract(request["contract"].asString());
+	else if (m_args.count(g_argSetContract))
+		compiler.setMainContract(m_args[g_argSetContract].as<string>());
+	compiler.setTVMSettings(tvmSettings);
+	PassTimer passTimer;
+	bool const timePasses = m_args.count(g_argTimePasses) || m_args.count(g_argTimePassesJson);
+	if (timePasses)
+		compiler.setPassTimer(&passTimer);
+
+	response["success"] = compile(compiler, errors, false);
+	response["errors"] = errors.str();
+	response["output"] = output.str();
+	response["artifacts"] = Json::objectValue;
+	for (auto const& [path, content]: compiler.tvmSession().artifacts())
+		response["artifacts"][path] = content;
+	if (timePasses)
+		response["timings"] = passTimer.toJson();
+	return response;
+}
+
 void CommandLineInterface::handleAst(string const& _argStr)
 {
 	string title;
@@ -548,6 +971,14 @@ void CommandLineInterface::handleAst(string const& _argStr)
 
 bool CommandLineInterface::actOnInput()
 {
+	if (m_args.count(g_argServer))
+		return serve();
+	if (m_compiledFromCache)
+	{
+		if (!g_hasOutput)
+			serr() << "Compiler run successful, no output requested." << endl;
+		return !m_error;
+	}
 	outputCompilationResults();
 	return !m_error;
 }
@@ -574,7 +1005,7 @@ void CommandLineInterface::outputCompilationResults()
 		handleNatspec(false, contract);
 	} // end of contracts iteration
 
-	g_hasOutput = TVMIsOutputProduced();
+	g_hasOutput = m_compiler->tvmSession().isOutputProduced();
 
 	if (!g_hasOutput)
 	{
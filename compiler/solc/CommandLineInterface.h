@@ -59,6 +59,21 @@ private:
 
 	void outputCompilationResults();
 
+	/// Reads a file imported by the sources if it is in one of the allowed directories
+	ReadCallback::Result readFile(std::string const& _kind, std::string const& _path);
+	/// Compiles the sources set in @a _compiler and prints errors to @a _err
+	/// @returns true on success.
+	bool compile(CompilerStack& _compiler, std::ostream& _err, bool _coloredOutput);
+	/// @returns everything the result of the compilation depends on except imported files, see --cache-dir
+	Json::Value cacheInputs() const;
+	/// Takes the result from the cache or compiles and stores the result there
+	/// @returns true on success.
+	bool compileWithCache();
+	/// Compiles the requests read from stdin until it is closed, see --server
+	bool serve();
+	/// @returns the result of one JSON request of the compile server
+	Json::Value serveRequest(std::string const& _request);
+
 //	void handleCombinedJSON();
 	void handleAst(std::string const& _argStr);
 //	void handleBinary(std::string const& _contract);
@@ -121,6 +136,21 @@ private:
 	CompilerStack::MetadataHash m_metadataHash = CompilerStack::MetadataHash::IPFS;
 	/// Whether or not to colorize diagnostics output.
 	bool m_coloredOutput = true;
+	/// Settings of the TVM backend
+	frontend::TVMSettings m_tvmSettings;
+	/// True if the result was taken from the cache and the compiler stack was not run
+	bool m_compiledFromCache = false;
+	/// A file read by readFile, with its size and modification time in nanoseconds when it was read
+	struct CachedFile
+	{
+		std::uintmax_t size = 0;
+		std::int64_t modificationTime = 0;
+		std::string contents;
+	};
+	/// Files read by readFile, kept between server requests
+	std::map<std::string, CachedFile> m_fileCache;
+	/// Time and memory of compilation passes, see --time-passes
+	util::PassTimer m_passTimer;
 };
 
 }
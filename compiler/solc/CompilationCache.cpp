@@ -0,0 +1,119 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * On-disk cache of compilation results of the command line interface.
+ */
+#include <solc/CompilationCache.h>
+
+#include <libsolutil/CommonIO.h>
+#include <libsolutil/JSON.h>
+#include <libsolutil/Keccak256.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+using namespace std;
+using namespace solidity;
+using namespace solidity::util;
+using namespace solidity::frontend;
+
+namespace fs = boost::filesystem;
+
+string CompilationCache::key(string const& _inputs)
+{
+	return keccak256(_inputs).hex();
+}
+
+string CompilationCache::contentHash(string const& _content)
+{
+	return keccak256(_content).hex();
+}
+
+fs::path CompilationCache::entryPath(string const& _key) const
+{
+	return m_directory / (_key + ".json");
+}
+
+optional<CompilationCache::Entry> CompilationCache::load(string const& _key) const
+{
+	fs::path path = entryPath(_key);
+	boost::system::error_code ec;
+	if (!fs::is_regular_file(path, ec))
+		return {};
+
+	Json::Value json;
+	if (!jsonParseStrict(readFileAsString(path.string()), json) || !json.isObject())
+		return {};
+
+	auto readMap = [](Json::Value const& _json, map<string, string>& _map)
+	{
+		if (!_json.isObject())
+			return false;
+		for (auto const& name: _json.getMemberNames())
+		{
+			if (!_json[name].isString())
+				return false;
+			_map[name] = _json[name].asString();
+		}
+		return true;
+	};
+
+	Entry entry;
+	if (
+		!readMap(json["imports"], entry.imports) ||
+		!readMap(json["artifacts"], entry.artifacts) ||
+		!json["output"].isString() ||
+		!json["diagnostics"].isString()
+	)
+		return {};
+	entry.output = json["output"].asString();
+	entry.diagnostics = json["diagnostics"].asString();
+
+	for (auto const& [importPath, hash]: entry.imports)
+		if (!fs::is_regular_file(importPath, ec) || contentHash(readFileAsString(importPath)) != hash)
+			return {};
+
+	return entry;
+}
+
+void CompilationCache::store(string const& _key, Entry const& _entry) const
+{
+	Json::Value json(Json::objectValue);
+	json["imports"] = Json::objectValue;
+	for (auto const& [path, hash]: _entry.imports)
+		json["imports"][path] = hash;
+	json["artifacts"] = Json::objectValue;
+	for (auto const& [path, content]: _entry.artifacts)
+		json["artifacts"][path] = content;
+	json["output"] = _entry.output;
+	json["diagnostics"] = _entry.diagnostics;
+
+	// Write to a unique temporary file and rename it, so that readers never see a partially written entry
+	fs::create_directories(m_directory);
+	fs::path temporary = m_directory / fs::unique_path(_key + "-%%%%%%%%.tmp");
+	{
+		ofstream file(temporary.string(), ios::binary);
+		file << jsonCompactPrint(json);
+		if (!file)
+			return;
+	}
+	boost::system::error_code ec;
+	fs::rename(temporary, entryPath(_key), ec);
+	if (ec)
+		fs::remove(temporary, ec);
+}
@@ -0,0 +1,67 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * On-disk cache of compilation results of the command line interface.
+ */
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+
+#include <map>
+#include <optional>
+#include <string>
+
+namespace solidity::frontend
+{
+
+/// Content-addressed cache of artifacts, see --cache-dir.
+/// An entry is found by the hash of everything known before parsing: the sources given on the command line,
+/// the compiler version and the options. Files reached by imports are known only after parsing, so the entry
+/// keeps their hashes and is valid only while the files on disk still have the same contents.
+class CompilationCache
+{
+public:
+	struct Entry
+	{
+		/// Imported files, i.e. sources not given on the command line, and hashes of their contents
+		std::map<std::string, std::string> imports;
+		/// Files written by the compilation, path -> content
+		std::map<std::string, std::string> artifacts;
+		/// Text printed to stdout and stderr
+		std::string output;
+		std::string diagnostics;
+	};
+
+	explicit CompilationCache(boost::filesystem::path _directory): m_directory(std::move(_directory)) {}
+
+	/// @returns the cache key of the given description of the compilation inputs
+	static std::string key(std::string const& _inputs);
+	/// @returns the hash of a source file stored in Entry::imports
+	static std::string contentHash(std::string const& _content);
+
+	/// @returns the entry of @a _key if it exists and all its imports are unchanged
+	std::optional<Entry> load(std::string const& _key) const;
+	/// Stores the entry, concurrent compilations with the same key may store it at the same time
+	void store(std::string const& _key, Entry const& _entry) const;
+
+private:
+	boost::filesystem::path entryPath(std::string const& _key) const;
+
+	boost::filesystem::path m_directory;
+};
+
+}
@@ -75,6 +75,37 @@ BOOST_AUTO_TEST_CASE(ufixed_types)
 	}
 }
 
+BOOST_AUTO_TEST_CASE(interned_types)
+{
+	Type const* uint8 = TypeProvider::uint(8);
+	BOOST_CHECK_EQUAL(
+		TypeProvider::mapping(uint8, TypeProvider::boolean(), DataLocation::Storage),
+		TypeProvider::mapping(uint8, TypeProvider::boolean(), DataLocation::Storage)
+	);
+	BOOST_CHECK(
+		TypeProvider::mapping(uint8, TypeProvider::boolean(), DataLocation::Storage) !=
+		TypeProvider::mapping(uint8, TypeProvider::boolean(), DataLocation::Memory)
+	);
+	BOOST_CHECK_EQUAL(
+		TypeProvider::array(DataLocation::Memory, uint8, 3),
+		TypeProvider::array(DataLocation::Memory, uint8, 3)
+	);
+	BOOST_CHECK(TypeProvider::array(DataLocation::Memory, uint8, 3) != TypeProvider::array(DataLocation::Memory, uint8, 4));
+	BOOST_CHECK_EQUAL(TypeProvider::tuple({uint8, uint8}), TypeProvider::tuple({uint8, uint8}));
+	BOOST_CHECK_EQUAL(
+		TypeProvider::withLocation(TypeProvider::bytesStorage(), DataLocation::Memory, true),
+		TypeProvider::withLocation(TypeProvider::bytesStorage(), DataLocation::Memory, true)
+	);
+	BOOST_CHECK_EQUAL(
+		TypeProvider::function(strings{"uint8"}, strings{}, FunctionType::Kind::Internal),
+		TypeProvider::function(strings{"uint8"}, strings{}, FunctionType::Kind::Internal)
+	);
+	BOOST_CHECK(
+		TypeProvider::function(strings{"uint8"}, strings{}, FunctionType::Kind::Internal) !=
+		TypeProvider::function(strings{"uint8"}, strings{}, FunctionType::Kind::External)
+	);
+}
+
 BOOST_AUTO_TEST_CASE(storage_layout_simple)
 {
 	MemberList members(MemberList::MemberMap({
@@ -97,12 +128,14 @@ BOOST_AUTO_TEST_CASE(storage_layout_mapping)
 		{string("first"), TypeProvider::fromElementaryTypeName("uint128")},
 		{string("second"), TypeProvider::mapping(
 			TypeProvider::fromElementaryTypeName("uint8"),
-			TypeProvider::fromElementaryTypeName("uint8")
+			TypeProvider::fromElementaryTypeName("uint8"),
+			DataLocation::Storage
 		)},
 		{string("third"), TypeProvider::fromElementaryTypeName("uint16")},
 		{string("final"), TypeProvider::mapping(
 			TypeProvider::fromElementaryTypeName("uint8"),
-			TypeProvider::fromElementaryTypeName("uint8")
+			TypeProvider::fromElementaryTypeName("uint8"),
+			DataLocation::Storage
 		)},
 	}));
 	BOOST_REQUIRE_EQUAL(u256(4), members.storageSize());
@@ -118,13 +151,14 @@ BOOST_AUTO_TEST_CASE(storage_layout_mapping)
 
 BOOST_AUTO_TEST_CASE(storage_layout_arrays)
 {
+	// Arrays with a length are dynamically sized in TVM (see ArrayType), so each takes one slot
 	BOOST_CHECK(ArrayType(DataLocation::Storage, TypeProvider::fixedBytes(1), 32).storageSize() == 1);
-	BOOST_CHECK(ArrayType(DataLocation::Storage, TypeProvider::fixedBytes(1), 33).storageSize() == 2);
-	BOOST_CHECK(ArrayType(DataLocation::Storage, TypeProvider::fixedBytes(2), 31).storageSize() == 2);
-	BOOST_CHECK(ArrayType(DataLocation::Storage, TypeProvider::fixedBytes(7), 8).storageSize() == 2);
-	BOOST_CHECK(ArrayType(DataLocation::Storage, TypeProvider::fixedBytes(7), 9).storageSize() == 3);
-	BOOST_CHECK(ArrayType(DataLocation::Storage, TypeProvider::fixedBytes(31), 9).storageSize() == 9);
-	BOOST_CHECK(ArrayType(DataLocation::Storage, TypeProvider::fixedBytes(32), 9).storageSize() == 9);
+	BOOST_CHECK(ArrayType(DataLocation::Storage, TypeProvider::fixedBytes(1), 33).storageSize() == 1);
+	BOOST_CHECK(ArrayType(DataLocation::Storage, TypeProvider::fixedBytes(2), 31).storageSize() == 1);
+	BOOST_CHECK(ArrayType(DataLocation::Storage, TypeProvider::fixedBytes(7), 8).storageSize() == 1);
+	BOOST_CHECK(ArrayType(DataLocation::Storage, TypeProvider::fixedBytes(7), 9).storageSize() == 1);
+	BOOST_CHECK(ArrayType(DataLocation::Storage, TypeProvider::fixedBytes(31), 9).storageSize() == 1);
+	BOOST_CHECK(ArrayType(DataLocation::Storage, TypeProvider::fixedBytes(32), 9).storageSize() == 1);
 }
 
 BOOST_AUTO_TEST_CASE(type_identifier_escaping)
@@ -173,11 +207,12 @@ BOOST_AUTO_TEST_CASE(type_identifiers)
 	BOOST_CHECK_EQUAL(TypeProvider::fromElementaryTypeName("string memory")->identifier(), "t_string_memory_ptr");
 	BOOST_CHECK_EQUAL(TypeProvider::fromElementaryTypeName("string storage")->identifier(), "t_string_storage_ptr");
 	BOOST_CHECK_EQUAL(TypeProvider::fromElementaryTypeName("string calldata")->identifier(), "t_string_calldata_ptr");
+	// arrays with a length are dynamically sized in TVM, see ArrayType
 	ArrayType largeintArray(DataLocation::Memory, TypeProvider::fromElementaryTypeName("int128"), u256("2535301200456458802993406410752"));
-	BOOST_CHECK_EQUAL(largeintArray.identifier(), "t_array$_t_int128_$2535301200456458802993406410752_memory_ptr");
+	BOOST_CHECK_EQUAL(largeintArray.identifier(), "t_array$_t_int128_$dyn_memory_ptr");
 	TypePointer stringArray = TypeProvider::array(DataLocation::Storage, TypeProvider::fromElementaryTypeName("string"), u256("20"));
 	TypePointer multiArray = TypeProvider::array(DataLocation::Storage, stringArray);
-	BOOST_CHECK_EQUAL(multiArray->identifier(), "t_array$_t_array$_t_string_storage_$20_storage_$dyn_storage_ptr");
+	BOOST_CHECK_EQUAL(multiArray->identifier(), "t_array$_t_array$_t_string_storage_$dyn_storage_$dyn_storage_ptr");
 
 	ContractDefinition c(++id, SourceLocation{}, make_shared<string>("MyContract$"), {}, {}, {}, ContractKind::Contract);
 	BOOST_CHECK_EQUAL(c.type()->identifier(), "t_type$_t_contract$_MyContract$$$_$2_$");
@@ -190,7 +225,7 @@ BOOST_AUTO_TEST_CASE(type_identifiers)
 	BOOST_CHECK_EQUAL(e.type()->identifier(), "t_type$_t_enum$_Enum_$4_$");
 
 	TupleType t({e.type(), s.type(), stringArray, nullptr});
-	BOOST_CHECK_EQUAL(t.identifier(), "t_tuple$_t_type$_t_enum$_Enum_$4_$_$_t_type$_t_struct$_Struct_$3_storage_ptr_$_$_t_array$_t_string_storage_$20_storage_ptr_$__$");
+	BOOST_CHECK_EQUAL(t.identifier(), "t_tuple$_t_type$_t_enum$_Enum_$4_$_$_t_type$_t_struct$_Struct_$3_storage_ptr_$_$_t_array$_t_string_storage_$dyn_storage_ptr_$__$");
 
 	TypePointer keccak256fun = TypeProvider::function(strings{}, strings{}, FunctionType::Kind::KECCAK256);
 	BOOST_CHECK_EQUAL(keccak256fun->identifier(), "t_function_keccak256_nonpayable$__$returns$__$");
@@ -198,7 +233,7 @@ BOOST_AUTO_TEST_CASE(type_identifiers)
 	FunctionType metaFun(TypePointers{keccak256fun}, TypePointers{s.type()}, strings{""}, strings{""});
 	BOOST_CHECK_EQUAL(metaFun.identifier(), "t_function_internal_nonpayable$_t_function_keccak256_nonpayable$__$returns$__$_$returns$_t_type$_t_struct$_Struct_$3_storage_ptr_$_$");
 
-	TypePointer m = TypeProvider::mapping(TypeProvider::fromElementaryTypeName("bytes32"), s.type());
+	TypePointer m = TypeProvider::mapping(TypeProvider::fromElementaryTypeName("bytes32"), s.type(), DataLocation::Storage);
 	MappingType m2(TypeProvider::fromElementaryTypeName("uint64"), m);
 	BOOST_CHECK_EQUAL(m2.identifier(), "t_mapping$_t_uint64_$_t_mapping$_t_bytes32_$_t_type$_t_struct$_Struct_$3_storage_ptr_$_$_$");
 
@@ -233,12 +268,11 @@ BOOST_AUTO_TEST_CASE(encoded_sizes)
 		TypeProvider::uint(24),
 		9
 	);
-	BOOST_CHECK_EQUAL(uint24Array->calldataEncodedSize(true), 9 * 32);
-	BOOST_CHECK_EQUAL(uint24Array->calldataEncodedSize(false), 9 * 32);
+	// arrays with a length are dynamically sized in TVM (see ArrayType), so they have no static encoded size
+	BOOST_CHECK(uint24Array->isDynamicallyEncoded());
 
 	ArrayType twoDimArray(DataLocation::Memory, uint24Array, 3);
-	BOOST_CHECK_EQUAL(twoDimArray.calldataEncodedSize(true),  9 * 3 * 32);
-	BOOST_CHECK_EQUAL(twoDimArray.calldataEncodedSize(false), 9 * 3 * 32);
+	BOOST_CHECK(twoDimArray.isDynamicallyEncoded());
 }
 
 BOOST_AUTO_TEST_CASE(helper_bool_result)
@@ -263,7 +297,7 @@ BOOST_AUTO_TEST_CASE(helper_bool_result)
 
 	BoolResult r7{true};
 	// Attention: this will implicitly convert to bool.
-	BoolResult r8{"true"};
+	BoolResult r8("true");
 	r7.merge(r8, logical_and<bool>());
 	BOOST_REQUIRE_EQUAL(r7.get(), true);
 	BOOST_REQUIRE_EQUAL(r7.message(), "");
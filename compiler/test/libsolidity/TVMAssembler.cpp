@@ -0,0 +1,478 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Unit tests for the experimental TVM assembler: encodings of instructions, dictionaries and bags of cells.
+ */
+
+#include <libsolidity/codegen/TVMAssembler.hpp>
+#include <libsolidity/codegen/TVMCommons.hpp>
+
+#include <test/libsolidity/TVMFramework.h>
+
+#include <liblangutil/ErrorReporter.h>
+#include <liblangutil/Exceptions.h>
+
+#include <libsolutil/CommonData.h>
+
+#include <boost/algorithm/string/split.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace solidity::langutil;
+using namespace solidity::util;
+
+namespace solidity::frontend::test
+{
+
+namespace
+{
+
+/// @returns the bits as a string of hex digits, the number of bits has to be a multiple of four
+string toHexDigits(vector<bool> const& _bits)
+{
+	BOOST_REQUIRE_EQUAL(_bits.size() % 4, 0);
+	string result;
+	for (size_t i = 0; i < _bits.size(); i += 4)
+		result += "0123456789ABCDEF"[_bits[i] * 8 + _bits[i + 1] * 4 + _bits[i + 2] * 2 + _bits[i + 3]];
+	return result;
+}
+
+string toBinaryDigits(vector<bool> const& _bits)
+{
+	string result;
+	for (bool bit: _bits)
+		result += bit ? '1' : '0';
+	return result;
+}
+
+/// Assembles @a _code, lines separated by '\n', into one cell and @returns its data in hex.
+string assemble(string const& _code)
+{
+	vector<string> lines;
+	boost::algorithm::split(lines, _code, [](char _ch) { return _ch == '\n'; });
+	CodeLines code;
+	for (string const& line: lines)
+		code.push(line);
+	Cell::Ptr cell = TVMAssembler::assembleFragment(code);
+	BOOST_REQUIRE(cell->refs().empty());
+	return toHexDigits(cell->data());
+}
+
+/// @returns the error of assembling @a _code, which has to fail.
+string assemblyError(string const& _code)
+{
+	ErrorList errors;
+	ErrorReporter errorReporter(errors);
+	ErrorReporterScope scope(&errorReporter);
+	CodeLines code;
+	code.push(_code);
+	BOOST_CHECK_THROW(TVMAssembler::assembleFragment(code), FatalError);
+	BOOST_REQUIRE_EQUAL(errors.size(), 1);
+	return *errors.front()->comment();
+}
+
+/// Parses a bag of cells written by serializeBagOfCells: no index, no checksum and one root.
+Cell::Ptr parseBagOfCells(bytes const& _boc)
+{
+	BOOST_REQUIRE(_boc.size() >= 6);
+	BOOST_REQUIRE(bytes(_boc.begin(), _boc.begin() + 4) == fromHex("b5ee9c72"));
+	size_t const size = _boc[4];
+	size_t const offsetSize = _boc[5];
+	size_t position = 6;
+	auto read = [&](size_t _length) {
+		size_t value = 0;
+		for (size_t i = 0; i < _length; ++i)
+		{
+			BOOST_REQUIRE(position < _boc.size());
+			value = (value << 8u) | _boc[position++];
+		}
+		return value;
+	};
+	size_t const cellCount = read(size);
+	BOOST_REQUIRE_EQUAL(read(size), 1);
+	BOOST_REQUIRE_EQUAL(read(size), 0);
+	size_t const totalSize = read(offsetSize);
+	BOOST_REQUIRE_EQUAL(read(size), 0);
+	BOOST_REQUIRE_EQUAL(_boc.size(), position + totalSize);
+
+	vector<vector<bool>> data(cellCount);
+	vector<vector<size_t>> refs(cellCount);
+	for (size_t i = 0; i < cellCount; ++i)
+	{
+		size_t const refCount = read(1);
+		size_t const descriptor = read(1);
+		for (size_t k = 0; k < (descriptor + 1) / 2; ++k)
+		{
+			size_t const byte = read(1);
+			for (unsigned bit = 8; bit-- > 0;)
+				data[i].push_back(((byte >> bit) & 1u) != 0);
+		}
+		if (descriptor % 2 == 1)
+		{
+			// the completion tag
+			while (!data[i].back())
+				data[i].pop_back();
+			data[i].pop_back();
+		}
+		for (size_t k = 0; k < refCount; ++k)
+		{
+			refs[i].push_back(read(size));
+			// cells refer only to the cells after them
+			BOOST_REQUIRE(refs[i].back() > i && refs[i].back() < cellCount);
+		}
+	}
+
+	vector<Cell::Ptr> cells(cellCount);
+	for (size_t i = cellCount; i-- > 0;)
+	{
+		CellBuilder builder;
+		builder.storeBits(data[i]);
+		for (size_t ref: refs[i])
+			builder.storeRef(cells[ref]);
+		cells[i] = builder.build();
+	}
+	return cells.at(0);
+}
+
+/// @returns the value stored by @a _key in the dictionary (Hashmap n X) @a _root.
+optional<vector<bool>> lookup(Cell::Ptr _root, vector<bool> const& _key)
+{
+	size_t offset = 0;
+	while (true)
+	{
+		vector<bool> const& data = _root->data();
+		size_t const rest = _key.size() - offset;
+		size_t lengthBits = 0;
+		while ((size_t(1) << lengthBits) <= rest)
+			++lengthBits;
+		size_t position = 0;
+		auto readUInt = [&](size_t _bits) {
+			size_t value = 0;
+			for (size_t i = 0; i < _bits; ++i)
+				value = value * 2 + data.at(position++);
+			return value;
+		};
+
+		vector<bool> label;
+		if (!data.at(0))
+		{
+			// hml_short$0 len:(Unary ~n) s:(n * Bit)
+			position = 1;
+			size_t length = 0;
+			while (data.at(position++))
+				++length;
+			label.assign(data.begin() + long(position), data.begin() + long(position + length));
+			position += length;
+		}
+		else if (!data.at(1))
+		{
+			// hml_long$10 n:(#<= m) s:(n * Bit)
+			position = 2;
+			size_t const length = readUInt(lengthBits);
+			label.assign(data.begin() + long(position), data.begin() + long(position + length));
+			position += length;
+		}
+		else
+		{
+			// hml_same$11 v:Bit n:(#<= m)
+			position = 2;
+			bool const bit = data.at(position++);
+			label.assign(readUInt(lengthBits), bit);
+		}
+
+		BOOST_REQUIRE(label.size() <= rest);
+		if (!equal(label.begin(), label.end(), _key.begin() + long(offset)))
+			return nullopt;
+		offset += label.size();
+		if (offset == _key.size())
+			return vector<bool>(data.begin() + long(position), data.end());
+		BOOST_REQUIRE_EQUAL(_root->refs().size(), 2);
+		_root = _root->refs()[_key[offset]];
+		++offset;
+	}
+}
+
+vector<bool> keyBits(uint32_t _key)
+{
+	CellBuilder builder;
+	builder.storeUInt(_key, 32);
+	return builder.data();
+}
+
+/// @returns the first cell of the tree of @a _root whose data starts with @a _prefix (binary digits), or nullptr.
+Cell::Ptr findCell(Cell::Ptr const& _root, string const& _prefix)
+{
+	if (toBinaryDigits(_root->data()).compare(0, _prefix.size(), _prefix) == 0)
+		return _root;
+	for (Cell::Ptr const& ref: _root->refs())
+		if (Cell::Ptr cell = findCell(ref, _prefix))
+			return cell;
+	return nullptr;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(TVMAssemblerTest)
+
+BOOST_AUTO_TEST_CASE(stack_instructions)
+{
+	BOOST_CHECK_EQUAL(assemble("NOP"), "00");
+	BOOST_CHECK_EQUAL(assemble("SWAP"), "01");
+	BOOST_CHECK_EQUAL(assemble("XCHG s2"), "02");
+	BOOST_CHECK_EQUAL(assemble("XCHG s1, s2"), "12");
+	BOOST_CHECK_EQUAL(assemble("XCHG s2, s3"), "1023");
+	BOOST_CHECK_EQUAL(assemble("XCHG s16"), "1110");
+	BOOST_CHECK_EQUAL(assemble("PUSH s1"), "21");
+	BOOST_CHECK_EQUAL(assemble("PUSH S16"), "5610");
+	BOOST_CHECK_EQUAL(assemble("POP s1"), "31");
+	BOOST_CHECK_EQUAL(assemble("POP s16"), "5710");
+	BOOST_CHECK_EQUAL(assemble("PUSH c4"), "ED44");
+	BOOST_CHECK_EQUAL(assemble("POP c4"), "ED54");
+	BOOST_CHECK_EQUAL(assemble("XCHG2 s1, s2"), "5012");
+	BOOST_CHECK_EQUAL(assemble("XCPU s1, s2"), "5112");
+	BOOST_CHECK_EQUAL(assemble("PUXC s1, s2"), "5213");
+	BOOST_CHECK_EQUAL(assemble("PUSH2 s1, s2"), "5312");
+	BOOST_CHECK_EQUAL(assemble("XCHG3 s1, s2, s3"), "4123");
+	BOOST_CHECK_EQUAL(assemble("PUSH3 s1, s2, s3"), "547123");
+	BOOST_CHECK_EQUAL(assemble("BLKSWAP 1, 2"), "5501");
+	BOOST_CHECK_EQUAL(assemble("REVERSE 2, 0"), "5E00");
+	BOOST_CHECK_EQUAL(assemble("BLKDROP 5"), "5F05");
+	BOOST_CHECK_EQUAL(assemble("BLKPUSH 2, 3"), "5F23");
+	BOOST_CHECK_EQUAL(assemble("BLKDROP2 2, 1"), "6C21");
+	BOOST_CHECK_EQUAL(assemble("TUPLE 2"), "6F02");
+	BOOST_CHECK_EQUAL(assemble("INDEX 1"), "6F11");
+	BOOST_CHECK_EQUAL(assemble("UNTUPLE 2"), "6F22");
+	BOOST_CHECK_EQUAL(assemble("SETINDEX 1"), "6F51");
+}
+
+BOOST_AUTO_TEST_CASE(constants)
+{
+	BOOST_CHECK_EQUAL(assemble("PUSHINT 0"), "70");
+	BOOST_CHECK_EQUAL(assemble("PUSHINT 10"), "7A");
+	BOOST_CHECK_EQUAL(assemble("PUSHINT -1"), "7F");
+	BOOST_CHECK_EQUAL(assemble("PUSHINT -5"), "7B");
+	BOOST_CHECK_EQUAL(assemble("PUSHINT 100"), "8064");
+	BOOST_CHECK_EQUAL(assemble("PUSHINT -128"), "8080");
+	BOOST_CHECK_EQUAL(assemble("PUSHINT 1000"), "8103E8");
+	BOOST_CHECK_EQUAL(assemble("PUSHINT 0x10000"), "82010000");
+	BOOST_CHECK_EQUAL(assemble("PUSHPOW2 1"), "8300");
+	BOOST_CHECK_EQUAL(assemble("PUSHPOW2 256"), "83FF");
+	BOOST_CHECK_EQUAL(assemble("PUSHPOW2DEC 8"), "8407");
+	BOOST_CHECK_EQUAL(assemble("PUSHNEGPOW2 8"), "8507");
+	BOOST_CHECK_EQUAL(assemble("PUSHNAN"), "83FF");
+	BOOST_CHECK_EQUAL(assemble("PUSHSLICE x{}"), "8B08");
+	BOOST_CHECK_EQUAL(assemble("PUSHSLICE xAB"), "8B1AB8");
+	BOOST_CHECK_EQUAL(assemble("PUSHSLICE x{A_}"), "8B0A");
+	BOOST_CHECK_EQUAL(assemble("STSLICECONST 0"), "CF81");
+	BOOST_CHECK_EQUAL(assemble("STSLICECONST 1"), "CF83");
+}
+
+BOOST_AUTO_TEST_CASE(arithmetic_and_cells)
+{
+	BOOST_CHECK_EQUAL(assemble("ADD\nSUB\nMUL\nDIV\nMOD"), "A0A1A8A904A908");
+	BOOST_CHECK_EQUAL(assemble("INC\nDEC\nNEGATE"), "A4A5A3");
+	BOOST_CHECK_EQUAL(assemble("ADDCONST -1"), "A6FF");
+	BOOST_CHECK_EQUAL(assemble("EQINT 0"), "C000");
+	BOOST_CHECK_EQUAL(assemble("LESSINT 5"), "C105");
+	BOOST_CHECK_EQUAL(assemble("GTINT -1"), "C2FF");
+	BOOST_CHECK_EQUAL(assemble("NEQINT 3"), "C303");
+	BOOST_CHECK_EQUAL(assemble("ISNNEG"), "C2FF");
+	BOOST_CHECK_EQUAL(assemble("LSHIFT 8"), "AA07");
+	BOOST_CHECK_EQUAL(assemble("RSHIFT 8"), "AB07");
+	BOOST_CHECK_EQUAL(assemble("LSHIFT\nRSHIFT"), "ACAD");
+	BOOST_CHECK_EQUAL(assemble("FITS 8"), "B407");
+	BOOST_CHECK_EQUAL(assemble("UFITS 8"), "B507");
+	BOOST_CHECK_EQUAL(assemble("NEWC\nSTI 8\nSTU 32\nENDC"), "C8CA07CB1FC9");
+	BOOST_CHECK_EQUAL(assemble("STIR 8"), "CF0A07");
+	BOOST_CHECK_EQUAL(assemble("STUR 8"), "CF0B07");
+	BOOST_CHECK_EQUAL(assemble("CTOS\nLDI 8\nLDU 32\nLDSLICE 8\nENDS"), "D0D207D31FD607D1");
+	BOOST_CHECK_EQUAL(assemble("PLDI 8"), "D70A07");
+	BOOST_CHECK_EQUAL(assemble("PLDU 8"), "D70B07");
+	BOOST_CHECK_EQUAL(assemble("LDIQ 8"), "D70C07");
+	BOOST_CHECK_EQUAL(assemble("LDUQ 8"), "D70D07");
+	BOOST_CHECK_EQUAL(assemble("PLDSLICE 8"), "D71D07");
+	BOOST_CHECK_EQUAL(assemble("PLDREFIDX 1"), "D74D");
+}
+
+BOOST_AUTO_TEST_CASE(control_flow)
+{
+	BOOST_CHECK_EQUAL(assemble("CALLXARGS 1, 0"), "DA10");
+	BOOST_CHECK_EQUAL(assemble("JMPXARGS 1"), "DB11");
+	BOOST_CHECK_EQUAL(assemble("RET\nRETALT"), "DB30DB31");
+	BOOST_CHECK_EQUAL(assemble("CALL 5"), "F005");
+	BOOST_CHECK_EQUAL(assemble("CALL 300"), "F1012C");
+	BOOST_CHECK_EQUAL(assemble("JMP 5"), "F14005");
+	BOOST_CHECK_EQUAL(assemble("THROW 5"), "F205");
+	BOOST_CHECK_EQUAL(assemble("THROWIF 5"), "F245");
+	BOOST_CHECK_EQUAL(assemble("THROWIFNOT 5"), "F285");
+	BOOST_CHECK_EQUAL(assemble("THROW 100"), "F2C064");
+	BOOST_CHECK_EQUAL(assemble("THROWIF 100"), "F2D064");
+	BOOST_CHECK_EQUAL(assemble("THROWIFNOT 100"), "F2E064");
+	BOOST_CHECK_EQUAL(assemble("THROWARG 100"), "F2C864");
+	BOOST_CHECK_EQUAL(assemble("THROWANY"), "F2F0");
+	BOOST_CHECK_EQUAL(assemble("PUSHCONT {\n\tADD\n\tINC\n}\nIF"), "92A0A4DE");
+	BOOST_CHECK_EQUAL(assemble("PUSHCONT {\n}"), "90");
+	BOOST_CHECK_EQUAL(assemble("DICTUGETJMP"), "F4A1");
+}
+
+BOOST_AUTO_TEST_CASE(application_instructions)
+{
+	BOOST_CHECK_EQUAL(assemble("ACCEPT"), "F800");
+	BOOST_CHECK_EQUAL(assemble("NOW"), "F823");
+	BOOST_CHECK_EQUAL(assemble("GETPARAM 3"), "F823");
+	BOOST_CHECK_EQUAL(assemble("GETGLOB 1"), "F841");
+	BOOST_CHECK_EQUAL(assemble("SETGLOB 1"), "F861");
+	BOOST_CHECK_EQUAL(assemble("DUMP s1"), "FE21");
+	BOOST_CHECK_EQUAL(assemble("PRINTSTR ab"), "FEF16162");
+	BOOST_CHECK_EQUAL(assemble("SETCP 0"), "FF00");
+}
+
+BOOST_AUTO_TEST_CASE(invalid_operands)
+{
+	BOOST_CHECK(assemblyError("PUSHPOW2 0").find("out of range 1..256") != string::npos);
+	BOOST_CHECK(assemblyError("PUSHPOW2 257").find("out of range 1..256") != string::npos);
+	BOOST_CHECK(assemblyError("PUSHPOW2DEC 0").find("out of range 1..256") != string::npos);
+	BOOST_CHECK(assemblyError("PUSH3 s1, s2, s16").find("out of range 0..15") != string::npos);
+	BOOST_CHECK(assemblyError("XCHG s1, s1").find("same registers") != string::npos);
+	BOOST_CHECK(assemblyError("PUSHINT").find("expected 1 operand(s)") != string::npos);
+	BOOST_CHECK(assemblyError("PUSHREFCONT").find("supported only in .selector") != string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(long_code_is_continued_by_reference)
+{
+	string code;
+	// 129 instructions of 8 bits don't fit into 1023 bits
+	for (int i = 0; i < 129; ++i)
+		code += "INC\n";
+	code += "RET";
+	CodeLines lines;
+	vector<string> parts;
+	boost::algorithm::split(parts, code, [](char _ch) { return _ch == '\n'; });
+	for (string const& line: parts)
+		lines.push(line);
+	Cell::Ptr cell = TVMAssembler::assembleFragment(lines);
+	BOOST_REQUIRE_EQUAL(cell->refs().size(), 1);
+	BOOST_CHECK_EQUAL(cell->data().size() + cell->refs()[0]->data().size(), 129 * 8 + 16);
+	BOOST_CHECK_EQUAL(toHexDigits(cell->refs()[0]->data()).substr(cell->refs()[0]->data().size() / 4 - 4), "DB30");
+}
+
+BOOST_AUTO_TEST_CASE(bag_of_cells)
+{
+	Cell::Ptr empty = CellBuilder{}.build();
+	BOOST_CHECK_EQUAL(toHex(empty->hash()), "96a296d224f285c67bee93c30f8a309157f0daa35dc5b87e410b78630a09cfc7");
+	BOOST_CHECK_EQUAL(toHex(serializeBagOfCells(empty)), "b5ee9c72010101010002000000");
+
+	// equal cells are stored once
+	CellBuilder parent;
+	parent.storeUInt(0xAB, 8);
+	parent.storeRef(empty);
+	parent.storeRef(CellBuilder{}.build());
+	BOOST_CHECK_EQUAL(
+		toHex(serializeBagOfCells(parent.build())),
+		"b5ee9c72" "0101" "02" "01" "00" "07" "00" "0202ab0101" "0000"
+	);
+}
+
+BOOST_AUTO_TEST_CASE(bag_of_cells_round_trip)
+{
+	CellBuilder leaf;
+	leaf.storeUInt(0x5, 3);
+	CellBuilder middle;
+	middle.storeUInt(0x1234, 16);
+	middle.storeRef(leaf.build());
+	CellBuilder root;
+	root.storeBit(true);
+	root.storeRef(middle.build());
+	root.storeRef(leaf.build());
+	Cell::Ptr cell = root.build();
+	bytes boc = serializeBagOfCells(cell);
+	Cell::Ptr parsed = parseBagOfCells(boc);
+	BOOST_CHECK(parsed->hash() == cell->hash());
+	BOOST_CHECK(serializeBagOfCells(parsed) == boc);
+
+	// StateInit of a contract
+	TVMSettings settings;
+	settings.bocStdlib = stdlibPath();
+	TVMCompilationResult result = compileTVM(
+		"pragma solidity >= 0.6.0;\n"
+		"contract Test {\n"
+		"    uint a;\n"
+		"    function f(uint b) public returns (uint) { tvm.accept(); a += b; return a; }\n"
+		"}\n",
+		settings
+	);
+	BOOST_REQUIRE_MESSAGE(result.success, result.errors);
+	bytes stateInit = asBytes(result.artifact(".boc"));
+	Cell::Ptr init = parseBagOfCells(stateInit);
+	BOOST_CHECK(serializeBagOfCells(init) == stateInit);
+	// code and data
+	BOOST_CHECK_EQUAL(toBinaryDigits(init->data()), "00110");
+	BOOST_CHECK_EQUAL(init->refs().size(), 2);
+
+	// c3: DICTPUSHCONST 32, DICTUGETJMP and THROW 60 if there is no function with the id
+	Cell::Ptr dispatcher = findCell(init->refs()[0], "11110100101001" "0000100000");
+	BOOST_REQUIRE(dispatcher);
+	BOOST_CHECK_EQUAL(toHexDigits(dispatcher->data()), "F4A420" "F4A1" "F23C");
+}
+
+BOOST_AUTO_TEST_CASE(dictionary_labels)
+{
+	map<vector<bool>, CellBuilder> values;
+	CellBuilder key;
+	key.storeUInt(5, 8);
+	values[key.data()];
+	// hml_long$10 n:(#<= 8) s:(n * Bit) is the shortest label of 8 bits
+	BOOST_CHECK_EQUAL(toBinaryDigits(buildDictionary(values, 8)->data()), "10" "1000" "00000101");
+
+	values.clear();
+	values[vector<bool>(8, true)];
+	// hml_same$11 v:Bit n:(#<= 8)
+	BOOST_CHECK_EQUAL(toBinaryDigits(buildDictionary(values, 8)->data()), "11" "1" "1000");
+
+	values.clear();
+	values[{false, true}];
+	// hml_short$0 len:(Unary ~n) s:(n * Bit)
+	BOOST_CHECK_EQUAL(toBinaryDigits(buildDictionary(values, 2)->data()), "0" "110" "01");
+}
+
+BOOST_AUTO_TEST_CASE(dictionary_lookup)
+{
+	vector<uint32_t> const keys{0, 1, 2, 3, 12345, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFE, 0xFFFFFFFF};
+	map<vector<bool>, CellBuilder> values;
+	for (uint32_t key: keys)
+		values[keyBits(key)].storeUInt(key % 65521, 16);
+	Cell::Ptr dictionary = buildDictionary(values, 32);
+	for (uint32_t key: keys)
+	{
+		CellBuilder expected;
+		expected.storeUInt(key % 65521, 16);
+		optional<vector<bool>> value = lookup(dictionary, keyBits(key));
+		BOOST_REQUIRE(value);
+		BOOST_CHECK(*value == expected.data());
+	}
+	for (uint32_t key: {4u, 12344u, 0x80000001u})
+		BOOST_CHECK(!lookup(dictionary, keyBits(key)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
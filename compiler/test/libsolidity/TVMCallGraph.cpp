@@ -0,0 +1,175 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Unit tests for the removal of unreachable functions from the generated TVM code.
+ */
+
+#include <libsolidity/codegen/TVMCallGraph.hpp>
+
+#include <test/libsolidity/TVMFramework.h>
+
+#include <libsolutil/CommonIO.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <regex>
+#include <set>
+#include <string>
+
+using namespace std;
+
+namespace solidity::frontend::test
+{
+
+namespace
+{
+
+/// @returns the names of the functions defined in assembly text, e.g. by ".macro name".
+set<string> definedFunctions(string const& _code)
+{
+	set<string> result;
+	regex const directive{R"((^|\n)\.(globl|macro|internal-alias|internal)[ \t]+:?([^ \t,\n]+))"};
+	for (sregex_iterator it{_code.begin(), _code.end(), directive}; it != sregex_iterator{}; ++it)
+		result.insert((*it)[3]);
+	return result;
+}
+
+/// @returns the names of the functions mentioned as "$name$" in assembly text.
+set<string> calledFunctions(string const& _code)
+{
+	set<string> result;
+	regex const call{R"(\$:?([^$\n]+)\$)"};
+	for (sregex_iterator it{_code.begin(), _code.end(), call}; it != sregex_iterator{}; ++it)
+		result.insert((*it)[1]);
+	return result;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(TVMCallGraphTest)
+
+BOOST_AUTO_TEST_CASE(reachability)
+{
+	CodeLines code = codeLines(
+		".globl\tg\n"
+		".public\tg\n"
+		".type\tg, @function\n"
+		"CALL $h$\n"
+		"PUSHCONT {\n"
+		"\tCALL $value$\n"
+		"}\n"
+		"\n"
+		".globl\th\n"
+		".type\th, @function\n"
+		"INC\n"
+		"\n"
+		".macro\tvalue\n"
+		"DEC\n"
+		"\n"
+		".macro\tunused\n"
+		"CALL $h$\n"
+		"\n"
+		".macro\tp\n"
+		"CALL $q$\n"
+		"\n"
+		".macro\tq\n"
+		"CALL $p$\n"
+		"\n"
+		".internal-alias :main_internal, 0\n"
+		".internal\t:main_internal\n"
+		"CALL $fromInternal$\n"
+		"\n"
+		".macro\tfromInternal\n"
+		"NOP\n"
+	);
+	set<string> const reachable = TVMCallGraph{code}.reachableFunctions();
+	for (string const name: {"g", "h", "value", "main_internal", "fromInternal"})
+		BOOST_CHECK_MESSAGE(reachable.count(name), name);
+	// functions calling each other aren't used if nobody calls them
+	for (string const name: {"unused", "p", "q"})
+		BOOST_CHECK_MESSAGE(!reachable.count(name), name);
+
+	TVMCallGraph::removeUnreachableFunctions(code);
+	BOOST_CHECK_EQUAL(
+		code.str(),
+		".globl\tg\n"
+		".public\tg\n"
+		".type\tg, @function\n"
+		"CALL $h$\n"
+		"PUSHCONT {\n"
+		"\tCALL $value$\n"
+		"}\n"
+		".globl\th\n"
+		".type\th, @function\n"
+		"INC\n"
+		".macro\tvalue\n"
+		"DEC\n"
+		".internal-alias\t:main_internal, 0\n"
+		".internal\t:main_internal\n"
+		"CALL $fromInternal$\n"
+		".macro\tfromInternal\n"
+		"NOP\n"
+	);
+}
+
+BOOST_AUTO_TEST_CASE(unused_functions)
+{
+	string const source =
+		"pragma solidity >= 0.6.0;\n"
+		"contract Base {\n"
+		"    function value() internal virtual returns (uint) { return 1; }\n"
+		"}\n"
+		"contract Test is Base {\n"
+		"    function value() internal override returns (uint) { return 2; }\n"
+		"    function used(uint x) private pure returns (uint) { return x * 3; }\n"
+		"    function unused(uint x) private pure returns (uint) { return x * 5; }\n"
+		"    function f() public returns (uint) { return used(value()); }\n"
+		"    function g() public pure returns (uint) { return 7; }\n"
+		"}\n";
+	TVMCompilationResult result = compileTVM(source);
+	BOOST_REQUIRE_MESSAGE(result.success, result.errors);
+	set<string> const defined = definedFunctions(result.artifact(".code"));
+	for (string const name: {"f", "g", "used_internal", "value_internal"})
+		BOOST_CHECK_MESSAGE(defined.count(name), name);
+	// the unused private function and the *_internal copies of public functions are dropped
+	for (string const name: {"unused_internal", "f_internal", "g_internal"})
+		BOOST_CHECK_MESSAGE(!defined.count(name), name);
+}
+
+BOOST_AUTO_TEST_CASE(corpus)
+{
+	set<string> const stdlib = definedFunctions(util::readFileAsString(stdlibPath()));
+	for (string const& name: corpusContracts())
+	{
+		BOOST_TEST_INFO(name);
+		string const code = compileCorpusContract(name);
+		// every called function is still defined
+		set<string> const defined = definedFunctions(code);
+		for (string const& callee: calledFunctions(code))
+			BOOST_CHECK_MESSAGE(defined.count(callee) || stdlib.count(callee), callee);
+
+		// and the code has no other unreachable functions
+		CodeLines lines = codeLines(code);
+		string const before = lines.str();
+		TVMCallGraph::removeUnreachableFunctions(lines);
+		BOOST_CHECK_EQUAL(lines.str(), before);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
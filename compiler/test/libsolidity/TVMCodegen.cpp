@@ -0,0 +1,543 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Unit tests for the code generated by the TVM backend with its optional settings.
+ */
+
+#include <test/libsolidity/TVMFramework.h>
+
+#include <libsolidity/interface/CompilerStack.h>
+
+#include <libsolutil/CommonIO.h>
+#include <libsolutil/JSON.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <regex>
+#include <string>
+
+using namespace std;
+
+namespace fs = boost::filesystem;
+
+namespace solidity::frontend::test
+{
+
+namespace
+{
+
+/// @returns the code of the function @a _name, from its .globl or .macro directive to the next function.
+string functionCode(string const& _code, string const& _name)
+{
+	size_t begin = _code.find(".globl\t" + _name + "\n");
+	if (begin == string::npos)
+		begin = _code.find(".macro\t" + _name + "\n");
+	BOOST_REQUIRE_MESSAGE(begin != string::npos, "No function " + _name);
+	size_t end = _code.size();
+	for (char const* directive: {"\n.globl\t", "\n.macro\t", "\n.internal"})
+		end = min(end, _code.find(directive, begin + 1));
+	return _code.substr(begin, end - begin);
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(TVMCodegen)
+
+BOOST_AUTO_TEST_CASE(lazy_state_first_variable)
+{
+	TVMSettings settings;
+	settings.lazyStateLoad = true;
+	string const code = compileCorpusContract("Wallet.sol", settings);
+	BOOST_CHECK(code.find(".macro\tlazy_c4_to_c7_m_owner") != string::npos);
+	// the mask bit of the first state variable is 2^0, which PUSHPOW2 can't push
+	BOOST_CHECK(!regex_search(code, regex("PUSHPOW2 0\\b")));
+
+	settings.bocStdlib = stdlibPath();
+	TVMCompilationResult result = compileTVM(
+		"pragma solidity >= 0.6.0;\n"
+		"contract Test {\n"
+		"    uint a;\n"
+		"    function f() public { tvm.accept(); a = a + 1; }\n"
+		"}\n",
+		settings
+	);
+	BOOST_REQUIRE_MESSAGE(result.success, result.errors);
+	BOOST_CHECK(!result.artifact(".boc").empty());
+}
+
+BOOST_AUTO_TEST_CASE(lazy_state_all_globals)
+{
+	// globals 10..252 are state variables, 253 and 254 are the rest of c4 and the mask of loaded variables
+	int const variables = 243;
+	string source = "pragma solidity >= 0.6.0;\ncontract Test {\n";
+	for (int i = 0; i < variables; ++i)
+		source += "    uint8 v" + to_string(i) + ";\n";
+	source += "    function f() public { tvm.accept(); v0 = v" + to_string(variables - 1) + "; }\n}\n";
+
+	TVMSettings settings;
+	settings.lazyStateLoad = true;
+	settings.bocStdlib = stdlibPath();
+	TVMCompilationResult result = compileTVM(source, settings);
+	BOOST_REQUIRE_MESSAGE(result.success, result.errors);
+	string const& code = result.artifact(".code");
+	BOOST_CHECK(code.find("PUSHPOW2 " + to_string(variables - 1) + "\n") != string::npos);
+	BOOST_CHECK(code.find("PUSHINT 254\n\tGETGLOBVAR") != string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(lazy_state_keeps_untouched_cells)
+{
+	string source = "pragma solidity >= 0.6.0;\ncontract Test {\n";
+	for (int i = 0; i < 16; ++i)
+		source += "    uint v" + to_string(i) + ";\n";
+	source += "    function f() public { tvm.accept(); v15 = 1; }\n}\n";
+
+	TVMSettings settings;
+	settings.lazyStateLoad = true;
+	settings.bocStdlib = stdlibPath();
+	TVMCompilationResult result = compileTVM(source, settings);
+	BOOST_REQUIRE_MESSAGE(result.success, result.errors);
+	string const code = functionCode(result.artifact(".code"), "c7_to_c4");
+	// The first child of the root cell keeps v2..v4 and its child keeps v14 and v15 (bits 14 and 15 of the mask).
+	// A child is built again if one of its variables is loaded, otherwise it's taken from the rest of c4.
+	BOOST_CHECK(code.find(
+		"GETGLOB 27\n"
+		"PUSHINT 49180\n"
+		"AND\n"
+		"PUSHCONT {\n"
+		"\tNEWC\n"
+		"\tGETGLOB 27\n"
+		"\tPUSHINT 49152\n"
+		"\tAND\n"
+		"\tPUSHCONT {\n"
+		"\t\tNEWC\n"
+		"\t\tCALL $lazy_c4_to_c7_v14$\n"
+	) != string::npos);
+	BOOST_CHECK(code.find("\tPUSHCONT {\n\t\tGETGLOB 26\n\t\tPLDREF\n\t\tCTOS\n\t\tPLDREF\n\t}\n\tIFELSE\n") != string::npos);
+	BOOST_CHECK(code.find("PUSHCONT {\n\tGETGLOB 26\n\tPLDREFIDX 1\n}\nIFELSE\n") != string::npos);
+	BOOST_CHECK(code.find("STBREF") == string::npos);
+	BOOST_CHECK(!result.artifact(".boc").empty());
+
+	// without lazy loading all the cells are built
+	settings.lazyStateLoad = false;
+	result = compileTVM(source, settings);
+	BOOST_REQUIRE_MESSAGE(result.success, result.errors);
+	BOOST_CHECK(functionCode(result.artifact(".code"), "c7_to_c4").find("PLDREF") == string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_codegen)
+{
+	TVMSettings serial;
+	serial.jobs = 1;
+	TVMSettings parallel;
+	parallel.jobs = 8;
+	for (string const& name: corpusContracts())
+	{
+		BOOST_TEST_INFO(name);
+		BOOST_CHECK_EQUAL(compileCorpusContract(name, serial), compileCorpusContract(name, parallel));
+	}
+
+	// super calls are resolved from the contract of the current function
+	string const source =
+		"pragma solidity >= 0.6.0;\n"
+		"contract A {\n"
+		"    uint x;\n"
+		"    function f() public virtual { x = 1; }\n"
+		"    function h() public virtual { x = 3; }\n"
+		"}\n"
+		"contract B is A {\n"
+		"    function f() public virtual override { tvm.accept(); x = 2; super.f(); }\n"
+		"    function h() public override { tvm.accept(); super.h(); }\n"
+		"}\n"
+		"contract C is B {\n"
+		"    function f() public override { tvm.accept(); super.f(); }\n"
+		"}\n";
+	TVMCompilationResult serialResult = compileTVM(source, serial);
+	TVMCompilationResult parallelResult = compileTVM(source, parallel);
+	BOOST_REQUIRE_MESSAGE(serialResult.success, serialResult.errors);
+	BOOST_REQUIRE_MESSAGE(parallelResult.success, parallelResult.errors);
+	BOOST_CHECK_EQUAL(serialResult.artifact(".code"), parallelResult.artifact(".code"));
+	BOOST_CHECK(serialResult.artifact(".code").find("Super call B_f") != string::npos);
+	BOOST_CHECK(serialResult.artifact(".code").find("Super call A_f") != string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_diagnostics)
+{
+	TVMSettings serial;
+	serial.jobs = 1;
+	TVMSettings parallel;
+	parallel.jobs = 8;
+	auto checkSameErrors = [&](string const& _source, vector<string> const& _expected) {
+		TVMCompilationResult serialResult = compileTVM(_source, serial);
+		TVMCompilationResult parallelResult = compileTVM(_source, parallel);
+		BOOST_CHECK(!serialResult.success);
+		BOOST_CHECK(!parallelResult.success);
+		BOOST_CHECK_EQUAL(serialResult.errors, parallelResult.errors);
+		size_t position = 0;
+		for (string const& error: _expected)
+		{
+			BOOST_TEST_INFO(error);
+			position = serialResult.errors.find(error, position);
+			BOOST_CHECK(position != string::npos);
+		}
+		return serialResult.errors;
+	};
+
+	// the type errors of all the contracts are reported in the order of the contracts
+	checkSameErrors(
+		"pragma solidity >= 0.6.0;\n"
+		"contract A { function f() public pure { uint x = \"a\"; x; } }\n"
+		"contract B { function f() public pure { uint y = true; y; } }\n"
+		"contract C { function f() public pure { bool b = 1; b; } }\n"
+		"contract D { function f() public pure { int8 i = 1000; i; } }\n",
+		{"literal_string \"a\"", "Type bool", "int_const 1 ", "int_const 1000"}
+	);
+
+	// a fatal error stops the type checker: the errors of the contracts after it are not reported
+	string const errors = checkSameErrors(
+		"pragma solidity >= 0.6.0;\n"
+		"contract A { function f() public pure { uint x = \"a\"; x; } }\n"
+		"contract B { function f() public pure { (1, ); } function g() public pure { uint y = true; y; } }\n"
+		"contract C { function f() public pure { bool b = 1; b; } }\n",
+		{"literal_string \"a\"", "Tuple component cannot be empty."}
+	);
+	BOOST_CHECK(errors.find("Type bool") == string::npos);
+	BOOST_CHECK(errors.find("int_const 1 ") == string::npos);
+
+	// the same for codegen, which stops at the first function it fails to compile
+	string const codegenErrors = checkSameErrors(
+		"pragma solidity >= 0.6.0;\n"
+		"contract Test {\n"
+		"    function f(address a) public pure returns (uint) { return a.balance; }\n"
+		"    function g() public pure returns (uint) { return 1; }\n"
+		"    function h(address b) public pure returns (uint) { return b.balance + 1; }\n"
+		"}\n",
+		{"test.sol:3:63:"}
+	);
+	BOOST_CHECK(codegenErrors.find("test.sol:5:") == string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(c7_to_c4_of_read_only_functions)
+{
+	TVMCompilationResult result = compileTVM(
+		"pragma solidity >= 0.6.0;\n"
+		"contract Test {\n"
+		"    uint a;\n"
+		"    function tvm_poproot(TvmCell c) private pure {}\n"
+		"    function tvm_popctr(uint8 i, TvmCell c) private pure {}\n"
+		"    function set(uint b) internal virtual { a = b; }\n"
+		"    function read() public returns (uint) { tvm.accept(); return a + 1; }\n"
+		"    function write(uint b) public { tvm.accept(); a = b; }\n"
+		"    function writeByCall(uint b) public { tvm.accept(); set(b); }\n"
+		"    function writeRoot(TvmCell c) public { tvm.accept(); tvm_poproot(c); }\n"
+		"    function writeData(TvmCell c) public { tvm.accept(); tvm_popctr(4, c); }\n"
+		"    function writeGlobals(TvmCell c) public { tvm.accept(); tvm_popctr(7, c); }\n"
+		"}\n"
+	);
+	BOOST_REQUIRE_MESSAGE(result.success, result.errors);
+	string const& code = result.artifact(".code");
+	// a read-only function saves c4 for external messages only, because of replay protection
+	string const unconditional = "\nCALL $c7_to_c4$\n";
+	string const conditional = "EQINT -1\nPUSHCONT {\n\tCALL $c7_to_c4$\n}\nIF\n";
+	BOOST_CHECK(functionCode(code, "read").find(conditional) != string::npos);
+	BOOST_CHECK(functionCode(code, "read").find(unconditional) == string::npos);
+	for (string const name: {"write", "writeByCall", "writeRoot", "writeData", "writeGlobals"})
+	{
+		BOOST_TEST_INFO(name);
+		BOOST_CHECK(functionCode(code, name).find(unconditional) != string::npos);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(hot_cold_layout)
+{
+	string const source =
+		"pragma solidity >= 0.6.0;\n"
+		"contract Test {\n"
+		"    uint a0; uint a1; uint a2; uint a3; uint a4; uint hot;\n"
+		"    function f() public { tvm.accept(); for (uint i = 0; i < 3; i++) { hot += i; } }\n"
+		"    function g() public { tvm.accept(); a0 = 1; }\n"
+		"}\n";
+	// After the header the root cell of c4 has room for two of the variables (globals 10..15),
+	// c4_to_c7 decodes them last.
+	auto rootVariables = [&](TVMSettings const& _settings) {
+		TVMCompilationResult result = compileTVM(source, _settings);
+		BOOST_REQUIRE_MESSAGE(result.success, result.errors);
+		string const code = functionCode(result.artifact(".code"), "c4_to_c7");
+		size_t const end = code.find("TRUE\nSETGLOB 1");
+		BOOST_REQUIRE(end != string::npos);
+		size_t const begin = code.rfind("PLDU 256\n", end);
+		BOOST_REQUIRE(begin != string::npos);
+		return code.substr(begin, end - begin);
+	};
+
+	BOOST_CHECK_EQUAL(rootVariables({}), "PLDU 256\nSETGLOB 11\nSETGLOB 10\n");
+
+	// hot is accessed in a loop
+	TVMSettings settings;
+	settings.hotColdLayout = true;
+	BOOST_CHECK_EQUAL(rootVariables(settings), "PLDU 256\nSETGLOB 10\nSETGLOB 15\n");
+
+	settings.layoutProfile = {{"a3", 100}, {"a4", 50}};
+	BOOST_CHECK_EQUAL(rootVariables(settings), "PLDU 256\nSETGLOB 14\nSETGLOB 13\n");
+
+	// the layout doesn't change the ABI
+	settings.layoutProfile.clear();
+	for (string const& name: corpusContracts())
+	{
+		BOOST_TEST_INFO(name);
+		string const corpusSource = util::readFileAsString(corpusPath(name));
+		TVMCompilationResult withLayout = compileTVM(corpusSource, settings, name);
+		TVMCompilationResult withoutLayout = compileTVM(corpusSource, {}, name);
+		BOOST_REQUIRE_MESSAGE(withLayout.success, withLayout.errors);
+		BOOST_REQUIRE_MESSAGE(withoutLayout.success, withoutLayout.errors);
+		BOOST_CHECK_EQUAL(withLayout.artifact(".abi.json"), withoutLayout.artifact(".abi.json"));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(pack_cells)
+{
+	// 6 * 256 + 2 * 200 bits take 3 cells in the declaration order and 2 cells with packing
+	string const source =
+		"pragma solidity >= 0.6.0;\n"
+		"contract Test {\n"
+		"    struct S { uint256 a; uint256 b; uint256 c; uint256 d; uint256 e; uint256 f; uint200 g; uint200 h; }\n"
+		"    S s;\n"
+		"    function set(S v) public { tvm.accept(); s = v; }\n"
+		"    function get() public view returns (S) { return s; }\n"
+		"}\n";
+	TVMSettings settings;
+	settings.packCells = true;
+	TVMCompilationResult packed = compileTVM(source, settings);
+	TVMCompilationResult unpacked = compileTVM(source);
+	BOOST_REQUIRE_MESSAGE(packed.success, packed.errors);
+	BOOST_REQUIRE_MESSAGE(unpacked.success, unpacked.errors);
+	BOOST_CHECK_EQUAL(packed.artifact(".abi.json"), unpacked.artifact(".abi.json"));
+
+	// the cells are (a, b, c, g) and (d, e, f, h), g is moved back before TUPLE
+	string const load =
+		"LDREF\n"
+		"LDU 256\n"
+		"LDU 256\n"
+		"LDU 256\n"
+		"PLDU 200\n"
+		"BLKSWAP 1, 4\n"
+		"CTOS\n"
+		"LDU 256\n"
+		"LDU 256\n"
+		"LDU 256\n"
+		"PLDU 200\n"
+		"XCHG s3, s4\n"
+		"XCHG s2, s3\n"
+		"XCHG s1, s2\n"
+		"TUPLE 8\n";
+	BOOST_CHECK(functionCode(packed.artifact(".code"), "c4_to_c7").find(load) != string::npos);
+	BOOST_CHECK(functionCode(unpacked.artifact(".code"), "c4_to_c7").find(load) == string::npos);
+	auto count = [](string const& _code, string const& _command) {
+		size_t result = 0;
+		for (size_t pos = _code.find("\n" + _command + "\n"); pos != string::npos; pos = _code.find("\n" + _command + "\n", pos + 1))
+			++result;
+		return result;
+	};
+	string const packedStore = functionCode(packed.artifact(".code"), "c7_to_c4");
+	string const unpackedStore = functionCode(unpacked.artifact(".code"), "c7_to_c4");
+	BOOST_CHECK_EQUAL(count(packedStore, "NEWC") + 1, count(unpackedStore, "NEWC"));
+	BOOST_CHECK_EQUAL(count(packedStore, "STBREFR") + 1, count(unpackedStore, "STBREFR"));
+
+	// the packing doesn't change the ABI
+	for (string const& name: corpusContracts())
+	{
+		BOOST_TEST_INFO(name);
+		string const corpusSource = util::readFileAsString(corpusPath(name));
+		TVMCompilationResult withPacking = compileTVM(corpusSource, settings, name);
+		TVMCompilationResult withoutPacking = compileTVM(corpusSource, {}, name);
+		BOOST_REQUIRE_MESSAGE(withPacking.success, withPacking.errors);
+		BOOST_REQUIRE_MESSAGE(withoutPacking.success, withoutPacking.errors);
+		BOOST_CHECK_EQUAL(withPacking.artifact(".abi.json"), withoutPacking.artifact(".abi.json"));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(auto_inline)
+{
+	// the functions are the same, but one of them is called 12 times
+	string const source =
+		"pragma solidity >= 0.6.0;\n"
+		"contract Test {\n"
+		"    function twice(uint x) private pure returns (uint) { uint y = x * 3 + 7; return y * y + x / 5; }\n"
+		"    function often(uint x) private pure returns (uint) { uint y = x * 3 + 7; return y * y + x / 5; }\n"
+		"    function f(uint x) public pure returns (uint) { return twice(x) + twice(x + 1); }\n"
+		"    function g(uint x) public pure returns (uint) {\n"
+		"        x = often(x); x = often(x); x = often(x); x = often(x); x = often(x); x = often(x);\n"
+		"        x = often(x); x = often(x); x = often(x); x = often(x); x = often(x); x = often(x);\n"
+		"        return x;\n"
+		"    }\n"
+		"}\n";
+	auto isCalled = [&](TvmAutoInline _mode, string const& _name) {
+		TVMSettings settings;
+		settings.autoInline = _mode;
+		TVMCompilationResult result = compileTVM(source, settings);
+		BOOST_REQUIRE_MESSAGE(result.success, result.errors);
+		string const& code = result.artifact(".code");
+		bool const called = code.find("CALL $" + _name + "_internal$") != string::npos;
+		BOOST_CHECK_EQUAL(called, code.find(".globl\t" + _name + "_internal\n") != string::npos);
+		return called;
+	};
+	BOOST_CHECK(isCalled(TvmAutoInline::None, "twice"));
+	BOOST_CHECK(isCalled(TvmAutoInline::None, "often"));
+	// the copies would be longer than the calls
+	BOOST_CHECK(isCalled(TvmAutoInline::Size, "twice"));
+	BOOST_CHECK(isCalled(TvmAutoInline::Size, "often"));
+	// 12 copies of often would add more than one cell of code
+	BOOST_CHECK(!isCalled(TvmAutoInline::Gas, "twice"));
+	BOOST_CHECK(isCalled(TvmAutoInline::Gas, "often"));
+
+	for (string const& name: corpusContracts())
+	{
+		BOOST_TEST_INFO(name);
+		string const corpusSource = util::readFileAsString(corpusPath(name));
+		TVMSettings settings;
+		settings.gasReport = true;
+		TVMCompilationResult plain = compileTVM(corpusSource, settings, name);
+		BOOST_REQUIRE_MESSAGE(plain.success, plain.errors);
+		Json::Value plainGas;
+		BOOST_REQUIRE(util::jsonParseStrict(plain.artifact(".gas.json"), plainGas));
+
+		// the code isn't longer with size and public functions don't cost more with gas
+		settings.autoInline = TvmAutoInline::Size;
+		TVMCompilationResult size = compileTVM(corpusSource, settings, name);
+		BOOST_REQUIRE_MESSAGE(size.success, size.errors);
+		BOOST_CHECK_EQUAL(size.artifact(".abi.json"), plain.artifact(".abi.json"));
+		BOOST_CHECK_LE(codeLines(size.artifact(".code")).bits(), codeLines(plain.artifact(".code")).bits());
+
+		settings.autoInline = TvmAutoInline::Gas;
+		TVMCompilationResult gas = compileTVM(corpusSource, settings, name);
+		BOOST_REQUIRE_MESSAGE(gas.success, gas.errors);
+		BOOST_CHECK_EQUAL(gas.artifact(".abi.json"), plain.artifact(".abi.json"));
+		Json::Value gasGas;
+		BOOST_REQUIRE(util::jsonParseStrict(gas.artifact(".gas.json"), gasGas));
+		for (string const& function: plainGas["functions"].getMemberNames())
+		{
+			Json::Value const& before = plainGas["functions"][function];
+			Json::Value const& after = gasGas["functions"][function];
+			if (before["kind"].asString() != "public" || before["max"].isNull())
+				continue;
+			BOOST_TEST_INFO(function);
+			BOOST_CHECK_LE(after["max"].asInt64(), before["max"].asInt64());
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(typed_instructions)
+{
+	// operands are parsed once and printed as written, with fixed separators
+	Instruction const push = Instruction::parse("\t\tPUSH2   S1 ,s2    ; comment");
+	BOOST_CHECK(push.opcode == Opcode::PUSH2);
+	BOOST_CHECK_EQUAL(push.depth, 2);
+	BOOST_REQUIRE_EQUAL(push.operands.size(), 2);
+	BOOST_CHECK(push.operands[0] == Operand::stackRegister(1));
+	BOOST_CHECK(push.operands[1] == Operand::stackRegister(2));
+	BOOST_CHECK_EQUAL(push.str(), "\t\tPUSH2 S1, s2 ; comment");
+	BOOST_CHECK_EQUAL(Instruction::parse("PUSHINT 007").str(), "PUSHINT 007");
+	BOOST_CHECK_EQUAL(Instruction(Opcode::PUSH, {Operand::stackRegister(3, 'S')}).str(), "PUSH S3");
+
+	BOOST_CHECK(Instruction::parse("CALL $:main$").operands.at(0) == Operand::function(":main"));
+	BOOST_CHECK_EQUAL(Instruction::parse("CALL $:main$").operands.at(0).name(), "main");
+	BOOST_CHECK(Instruction::parse("POPCTR C4").operands.at(0) == Operand::controlRegister(4));
+	BOOST_CHECK(Instruction::parse("PUSHINT -7").operands.at(0) == Operand::integer(-7));
+	BOOST_CHECK(Instruction::parse("STSLICECONST 0").operands.at(0) == Operand::slice("0"));
+	BOOST_CHECK(Instruction::parse("PUSHCONT {").operands.at(0).kind == Operand::Kind::Continuation);
+	// integers which don't fit in 64 bits are kept as text
+	string const big = "115792089237316195423570985008687907853269984665640564039457584007913129639935";
+	BOOST_CHECK(Instruction::parse("PUSHINT " + big).operands.at(0).kind == Operand::Kind::Text);
+	BOOST_CHECK_EQUAL(Instruction::parse("PUSHINT " + big).str(), "PUSHINT " + big);
+	// the string of PRINTSTR isn't split
+	BOOST_CHECK_EQUAL(Instruction::parse("PRINTSTR a, b").operands.size(), 1);
+	BOOST_CHECK_EQUAL(Instruction::parse("PRINTSTR a, b").str(), "PRINTSTR a, b");
+
+	BOOST_CHECK_EQUAL(Instruction::parse(".macro name").str(), ".macro\tname");
+	BOOST_CHECK_EQUAL(Instruction::parse(".internal-alias :f,        1").str(), ".internal-alias\t:f, 1");
+	BOOST_CHECK(Instruction::parse("\t; comment").isCommentOrEmpty());
+	BOOST_CHECK_EQUAL(Instruction::parse("\t; comment").str(), "\t; comment");
+	BOOST_CHECK(Instruction::parse("").empty());
+
+	// codegen pushes typed instructions too
+	BOOST_CHECK(Instruction(Opcode::XCHG, {Operand::stackRegister(1), Operand::stackRegister(3)}) == Instruction::parse("XCHG s1,s3"));
+}
+
+BOOST_AUTO_TEST_CASE(optimizer_big_constants)
+{
+	// integers which don't fit in int aren't folded into ADDCONST
+	TVMSettings settings;
+	settings.optimize = true;
+	TVMCompilationResult result = compileTVM(
+		"pragma solidity >= 0.6.0;\n"
+		"contract Test {\n"
+		"    function f(uint x) public pure returns (uint) { return x + 4294967297; }\n"
+		"    function g(uint x) public pure returns (uint) { return x + 2 ** 255; }\n"
+		"    function h(uint x) public pure returns (uint) { return x + 5; }\n"
+		"}\n",
+		settings
+	);
+	BOOST_REQUIRE_MESSAGE(result.success, result.errors);
+	string const& code = result.artifact(".code");
+	BOOST_CHECK(functionCode(code, "f").find("PUSHINT 4294967297\n") != string::npos);
+	BOOST_CHECK(functionCode(code, "f").find("ADDCONST") == string::npos);
+	BOOST_CHECK(functionCode(code, "g").find("ADDCONST") == string::npos);
+	BOOST_CHECK(functionCode(code, "h").find("ADDCONST 5\n") != string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(streamed_artifacts)
+{
+	fs::path const folder = fs::temp_directory_path() / fs::unique_path("tvm-codegen-%%%%-%%%%");
+	fs::create_directories(folder);
+	auto compileToFolder = [&]()
+	{
+		TVMSettings settings;
+		settings.outputFolder = folder.string();
+		settings.recordArtifacts = false;
+		CompilerStack compiler;
+		ostringstream output;
+		compiler.setTVMSettings(settings);
+		compiler.setTVMOutputStream(&output);
+		compiler.setSources({{"Wallet.sol", util::readFileAsString(corpusPath("Wallet.sol"))}});
+		bool const success = compiler.parse() && compiler.analyze() && compiler.compile();
+		string errors;
+		for (auto const& error: compiler.errors())
+			errors += *error->comment() + "\n";
+		return make_pair(success, errors);
+	};
+
+	// the code written to the file is the same as the one kept in memory
+	auto [success, errors] = compileToFolder();
+	BOOST_REQUIRE_MESSAGE(success, errors);
+	BOOST_CHECK_EQUAL(util::readFileAsString((folder / "Wallet.code").string()), compileCorpusContract("Wallet.sol"));
+
+	// errors of buffered writes are only known after closing the file
+	if (fs::exists("/dev/full"))
+	{
+		fs::remove(folder / "Wallet.code");
+		fs::create_symlink("/dev/full", folder / "Wallet.code");
+		tie(success, errors) = compileToFolder();
+		BOOST_CHECK(!success);
+		BOOST_CHECK_MESSAGE(errors.find("Failed to write the output file") != string::npos, errors);
+	}
+	fs::remove_all(folder);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,99 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Unit tests for the helpers of the TVM backend.
+ */
+
+#include <libsolidity/codegen/TVMCommons.hpp>
+
+#include <libsolidity/interface/CompilerStack.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace solidity::frontend::test
+{
+
+BOOST_AUTO_TEST_SUITE(TVMCommonsTest)
+
+BOOST_AUTO_TEST_CASE(contract_function_index)
+{
+	CompilerStack compiler;
+	compiler.setSources({{"test.sol",
+		"pragma solidity >= 0.6.0;\n"
+		"contract A {\n"
+		"    function f() public virtual {}\n"
+		"    function g() public virtual {}\n"
+		"    function h(uint a) public pure returns (uint) { return a; }\n"
+		"}\n"
+		"contract B is A {\n"
+		"    constructor() public {}\n"
+		"    function f() public virtual override { super.f(); }\n"
+		"    function h(bool b) public pure returns (bool) { return b; }\n"
+		"}\n"
+		"contract C is B {\n"
+		"    function f() public override { super.f(); }\n"
+		"    function g() public override {}\n"
+		"    function k() private {}\n"
+		"}\n"
+	}});
+	BOOST_REQUIRE(compiler.parse() && compiler.analyze());
+	map<string, ContractDefinition const*> contracts;
+	for (ContractDefinition const* contract: ASTNode::filteredNodes<ContractDefinition>(compiler.ast("test.sol").nodes()))
+		contracts[contract->name()] = contract;
+
+	// the index gives the same answers as the lookups which scan the inheritance chain
+	vector<string> const names{"f", "g", "h", "k", "missing"};
+	for (string const contractName: {"A", "B", "C"})
+	{
+		BOOST_TEST_INFO(contractName);
+		ContractDefinition const* contract = contracts.at(contractName);
+		ContractFunctionIndex const index{contract};
+		BOOST_CHECK(index.functionPairs() == getContractFunctionPairs(contract));
+		BOOST_CHECK(index.functions() == getContractFunctions(contract));
+		for (string const& name: names)
+		{
+			BOOST_TEST_INFO(name);
+			BOOST_CHECK(index.functions(name) == getContractFunctions(contract, name));
+			for (ContractDefinition const* base: getContractsChain(contract))
+			{
+				BOOST_TEST_INFO(base->name());
+				BOOST_CHECK_EQUAL(index.function(base, name), getFunction(base, name));
+				BOOST_CHECK_EQUAL(index.superContract(base, name), getSuperContract(base, contract, name));
+			}
+		}
+	}
+
+	ContractDefinition const* a = contracts.at("A");
+	ContractDefinition const* b = contracts.at("B");
+	ContractDefinition const* c = contracts.at("C");
+	ContractFunctionIndex const index{c};
+	BOOST_CHECK_EQUAL(index.functions("f").size(), 3);
+	BOOST_CHECK_EQUAL(index.functions("h").size(), 2);
+	BOOST_CHECK_EQUAL(index.superContract(c, "f"), b);
+	BOOST_CHECK_EQUAL(index.superContract(b, "f"), a);
+	BOOST_CHECK_EQUAL(index.superContract(c, "g"), a);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,267 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Unit tests for compiling several sources and several times in one process with the TVM backend.
+ */
+
+#include <test/libsolidity/TVMFramework.h>
+
+#include <libsolidity/ast/ASTVisitor.h>
+#include <libsolidity/interface/CompilerStack.h>
+#include <liblangutil/SourceReferenceFormatterHuman.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace solidity::langutil;
+
+namespace solidity::frontend::test
+{
+
+namespace
+{
+
+/// Outcome of parsing sources, which are read by the import callback except for the first one.
+struct ParseResult
+{
+	string errors;
+	/// Identifiers of the nodes of each source in the order of a visit, if there are no errors
+	map<string, vector<int64_t>> nodeIDs;
+};
+
+class NodeIDCollector: private ASTConstVisitor
+{
+public:
+	vector<int64_t> collect(ASTNode const& _node)
+	{
+		_node.accept(*this);
+		return m_ids;
+	}
+
+private:
+	bool visitNode(ASTNode const& _node) override
+	{
+		m_ids.push_back(_node.id());
+		return true;
+	}
+
+	vector<int64_t> m_ids;
+};
+
+ParseResult parse(map<string, string> const& _sources, unsigned _jobs)
+{
+	auto readFile = [&](string const&, string const& _path) {
+		if (_sources.count(_path))
+			return ReadCallback::Result{true, _sources.at(_path)};
+		return ReadCallback::Result{false, "File not found."};
+	};
+	CompilerStack compiler{readFile};
+	TVMSettings settings;
+	settings.jobs = _jobs;
+	compiler.setTVMSettings(settings);
+	compiler.setSources({*_sources.begin()});
+	compiler.parse();
+
+	ParseResult result;
+	ostringstream errors;
+	SourceReferenceFormatterHuman formatter(errors, false);
+	for (auto const& error: compiler.errors())
+		formatter.printErrorInformation(*error);
+	result.errors = errors.str();
+	if (Error::containsOnlyWarnings(compiler.errors()))
+		for (string const& name: compiler.sourceNames())
+			result.nodeIDs[name] = NodeIDCollector{}.collect(compiler.ast(name));
+	return result;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(TVMCompilerStackTest)
+
+BOOST_AUTO_TEST_CASE(parallel_parse)
+{
+	// the imports are parsed in threads as soon as they are found, the result is the same as of the serial parse
+	map<string, string> sources{
+		{"a.sol", "pragma solidity >= 0.6.0;\nimport \"b.sol\";\nimport \"c.sol\";\ncontract A is B, C {}\n"},
+		{"b.sol", "pragma solidity >= 0.6.0;\nimport \"d.sol\";\ncontract B is D { function b() public {} }\n"},
+		{"c.sol", "pragma solidity >= 0.6.0;\nimport \"d.sol\";\ncontract C { uint c; }\n"},
+		{"d.sol", "pragma solidity >= 0.6.0;\ncontract D { function d() public {} }\n"}
+	};
+	ParseResult serial = parse(sources, 1);
+	ParseResult parallel = parse(sources, 8);
+	BOOST_CHECK_EQUAL(serial.errors, "");
+	BOOST_CHECK_EQUAL(parallel.errors, "");
+	BOOST_CHECK_EQUAL(serial.nodeIDs.size(), 4);
+	BOOST_CHECK(serial.nodeIDs == parallel.nodeIDs);
+
+	// the node ids continue from source to source in the order of the serial parse
+	set<int64_t> ids;
+	size_t idQty = 0;
+	for (auto const& [name, sourceIDs]: serial.nodeIDs)
+	{
+		ids.insert(sourceIDs.begin(), sourceIDs.end());
+		idQty += sourceIDs.size();
+	}
+	BOOST_CHECK_EQUAL(ids.size(), idQty);
+
+	// the errors are reported in the order of the serial parse
+	sources["b.sol"] = "pragma solidity >= 0.6.0;\nimport \"d.sol\";\ncontract B is D { function }\n";
+	sources["c.sol"] = "pragma solidity >= 0.6.0;\nimport \"d.sol\";\nimport \"e.sol\";\ncontract C { uint c; }\n";
+	sources["d.sol"] = "pragma solidity >= 0.6.0;\ncontract D { uint }\n";
+	serial = parse(sources, 1);
+	parallel = parse(sources, 8);
+	BOOST_CHECK_EQUAL(serial.errors, parallel.errors);
+	size_t const bError = serial.errors.find("b.sol:3:");
+	size_t const eError = serial.errors.find("File not found.");
+	size_t const dError = serial.errors.find("d.sol:2:");
+	BOOST_CHECK(bError != string::npos);
+	BOOST_CHECK(eError != string::npos);
+	BOOST_CHECK(dError != string::npos);
+	BOOST_CHECK(bError < eError && eError < dError);
+}
+
+BOOST_AUTO_TEST_CASE(independent_sessions)
+{
+	// the backend keeps no state of the previous compilation, e.g. its contracts or settings
+	TVMSettings withoutLogstr;
+	withoutLogstr.withoutLogstr = true;
+	string const source =
+		"pragma solidity >= 0.6.0;\n"
+		"contract First { function f() public pure { logtvm(\"first\"); } }\n";
+	TVMCompilationResult first = compileTVM(source, withoutLogstr, "first.sol");
+	BOOST_REQUIRE_MESSAGE(first.success, first.errors);
+	BOOST_CHECK(first.artifact(".code").find("PRINTSTR") == string::npos);
+
+	TVMCompilationResult second = compileTVM(
+		"pragma solidity >= 0.6.0;\n"
+		"contract Second { function f() public pure { logtvm(\"second\"); } }\n",
+		TVMSettings{},
+		"second.sol"
+	);
+	BOOST_REQUIRE_MESSAGE(second.success, second.errors);
+	BOOST_CHECK(second.artifact(".code").find("PRINTSTR second") != string::npos);
+	for (auto const& [path, content]: second.artifacts)
+		BOOST_CHECK_MESSAGE(path.find("first") == string::npos, path);
+
+	// a CompilerStack which is reset keeps its settings but not the results
+	CompilerStack compiler;
+	ostringstream output;
+	TVMSettings settings = withoutLogstr;
+	settings.keepArtifactsInMemory = true;
+	compiler.setTVMSettings(settings);
+	compiler.setTVMOutputStream(&output);
+	compiler.setSources({{"first.sol", source}});
+	BOOST_REQUIRE(compiler.parse() && compiler.analyze() && compiler.compile());
+	BOOST_CHECK(compiler.tvmSession().artifacts().count("first.code"));
+	compiler.reset(true);
+	compiler.setSources({{"second.sol",
+		"pragma solidity >= 0.6.0;\n"
+		"contract Second { function g() public pure { logtvm(\"second\"); } }\n"
+	}});
+	BOOST_REQUIRE(compiler.parse() && compiler.analyze() && compiler.compile());
+	BOOST_CHECK(!compiler.tvmSession().artifacts().count("first.code"));
+	BOOST_REQUIRE(compiler.tvmSession().artifacts().count("second.code"));
+	BOOST_CHECK(compiler.tvmSession().artifacts().at("second.code").find("PRINTSTR") == string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(repeated_compilation)
+{
+	// The members of the TvmCell, TvmSlice and TvmBuilder types are kept by the singleton types.
+	// They must be created again by the next compilation in the process, after the types are reset.
+	string const source =
+		"pragma solidity >= 0.6.0;\n"
+		"contract Test {\n"
+		"    mapping(uint => uint) m;\n"
+		"    function f(TvmCell c) public pure returns (uint, uint) {\n"
+		"        TvmSlice s = c.toSlice();\n"
+		"        TvmBuilder b;\n"
+		"        TvmBuilder r;\n"
+		"        r.store(c);\n"
+		"        b.storeRef(r);\n"
+		"        b.storeUnsigned(s.bits(), 16);\n"
+		"        return (b.bits(), b.toCell().toSlice().refs());\n"
+		"    }\n"
+		"    function g() public view returns (uint) {\n"
+		"        (uint k, , bool ok) = m.min();\n"
+		"        (bool found, uint value) = m.fetch(k);\n"
+		"        return ok && found && m.exists(value) ? value : 0;\n"
+		"    }\n"
+		"}\n";
+	TVMCompilationResult first = compileTVM(source);
+	BOOST_REQUIRE_MESSAGE(first.success, first.errors);
+	for (int i = 0; i < 3; ++i)
+	{
+		TVMCompilationResult again = compileTVM(source);
+		BOOST_REQUIRE_MESSAGE(again.success, again.errors);
+		BOOST_CHECK_EQUAL(first.artifact(".code"), again.artifact(".code"));
+		BOOST_CHECK_EQUAL(first.artifact(".abi.json"), again.artifact(".abi.json"));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(timed_passes)
+{
+	// the same passes are reported for every function, whether they are compiled in threads or not
+	auto timedPasses = [](unsigned _jobs)
+	{
+		util::PassTimer timer;
+		CompilerStack compiler;
+		ostringstream output;
+		TVMSettings settings;
+		settings.jobs = _jobs;
+		settings.keepArtifactsInMemory = true;
+		compiler.setTVMSettings(settings);
+		compiler.setTVMOutputStream(&output);
+		compiler.setPassTimer(&timer);
+		compiler.setSources({{"test.sol",
+			"pragma solidity >= 0.6.0;\n"
+			"contract Test {\n"
+			"    uint x;\n"
+			"    function f() public { x = 1; }\n"
+			"    function g() public view returns (uint) { return x; }\n"
+			"}\n"
+		}});
+		BOOST_REQUIRE(compiler.parse() && compiler.analyze() && compiler.compile());
+		set<string> passes;
+		for (util::PassTimer::Pass const& pass: timer.passes())
+		{
+			BOOST_CHECK_EQUAL(pass.runs, 1);
+			passes.insert(pass.name + " (" + pass.object + ")");
+		}
+		return passes;
+	};
+	set<string> const serial = timedPasses(1);
+	for (string const pass: {
+		"Parser (test.sol)",
+		"TypeChecker ()",
+		"TVM function codegen (Test.f)",
+		"TVM function codegen (Test.g)",
+		"TVM codegen (Test)",
+		"ABI (Test)"
+	})
+		BOOST_CHECK_MESSAGE(serial.count(pass), pass);
+	BOOST_CHECK(serial == timedPasses(4));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
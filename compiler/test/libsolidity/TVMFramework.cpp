@@ -0,0 +1,112 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Helpers compiling contracts with the TVM backend in tests.
+ */
+
+#include <test/libsolidity/TVMFramework.h>
+
+#include <libsolidity/interface/CompilerStack.h>
+#include <liblangutil/SourceReferenceFormatterHuman.h>
+#include <libsolutil/CommonIO.h>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+
+using namespace std;
+using namespace solidity::langutil;
+
+namespace fs = boost::filesystem;
+
+namespace solidity::frontend::test
+{
+
+string const& TVMCompilationResult::artifact(string const& _extension) const
+{
+	for (auto const& [path, content]: artifacts)
+		if (boost::algorithm::ends_with(path, _extension))
+			return content;
+	BOOST_FAIL("No " + _extension + " artifact, errors:\n" + errors);
+	static string const empty;
+	return empty;
+}
+
+TVMCompilationResult compileTVM(string const& _source, TVMSettings _settings, string const& _name)
+{
+	_settings.outputFolder.clear();
+	_settings.keepArtifactsInMemory = true;
+
+	CompilerStack compiler;
+	ostringstream output;
+	compiler.setTVMSettings(_settings);
+	compiler.setTVMOutputStream(&output);
+	compiler.setSources({{_name, _source}});
+
+	TVMCompilationResult result;
+	result.success = compiler.parse() && compiler.analyze() && compiler.compile();
+	ostringstream errors;
+	SourceReferenceFormatterHuman formatter(errors, false);
+	for (auto const& error: compiler.errors())
+		formatter.printErrorInformation(*error);
+	result.errors = errors.str();
+	result.artifacts = compiler.tvmSession().artifacts();
+	return result;
+}
+
+vector<string> corpusContracts()
+{
+	vector<string> names;
+	for (fs::directory_entry const& entry: fs::directory_iterator(SOLC_TVM_CORPUS))
+		if (entry.path().extension() == ".sol")
+			names.push_back(entry.path().filename().string());
+	sort(names.begin(), names.end());
+	return names;
+}
+
+string corpusPath(string const& _name)
+{
+	return (fs::path(SOLC_TVM_CORPUS) / _name).string();
+}
+
+string compileCorpusContract(string const& _name, TVMSettings const& _settings)
+{
+	string const source = util::readFileAsString(corpusPath(_name));
+	TVMCompilationResult result = compileTVM(source, _settings, _name);
+	BOOST_REQUIRE_MESSAGE(result.success, "Failed to compile " + _name + ":\n" + result.errors);
+	return result.artifact(".code");
+}
+
+string stdlibPath()
+{
+	return SOLC_TVM_STDLIB;
+}
+
+CodeLines codeLines(string const& _code)
+{
+	vector<string> lines;
+	boost::algorithm::split(lines, _code, [](char _ch) { return _ch == '\n'; });
+	CodeLines code;
+	for (string const& line: lines)
+		code.push(line);
+	return code;
+}
+
+}
@@ -0,0 +1,68 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Helpers compiling contracts with the TVM backend in tests.
+ */
+
+#pragma once
+
+#include <libsolidity/codegen/TVM.h>
+#include <libsolidity/codegen/TVMPusher.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace solidity::frontend::test
+{
+
+/// Outcome of compiling the main contract of a source with the TVM backend.
+struct TVMCompilationResult
+{
+	bool success = false;
+	/// Errors and warnings, formatted as by solc
+	std::string errors;
+	/// Files the backend would write, e.g. "test.code" and "test.abi.json"
+	std::map<std::string, std::string> artifacts;
+
+	/// @returns the artifact with the given extension, e.g. ".code"
+	std::string const& artifact(std::string const& _extension) const;
+};
+
+/// Compiles @a _source named @a _name with @a _settings. The artifacts are kept in memory.
+TVMCompilationResult compileTVM(
+	std::string const& _source,
+	TVMSettings _settings = TVMSettings{},
+	std::string const& _name = "test.sol"
+);
+
+/// @returns the names of the contracts of the solc-tvm-bench corpus, e.g. "Wallet.sol".
+std::vector<std::string> corpusContracts();
+
+/// @returns the path of a contract of the solc-tvm-bench corpus.
+std::string corpusPath(std::string const& _name);
+
+/// Compiles a contract of the solc-tvm-bench corpus, which has to succeed, and @returns its code.
+std::string compileCorpusContract(std::string const& _name, TVMSettings const& _settings = TVMSettings{});
+
+/// @returns the path of lib/stdlib_sol.tvm.
+std::string stdlibPath();
+
+/// Splits assembly text into lines as codegen pushes them, leading tabs are the nesting depth.
+CodeLines codeLines(std::string const& _code);
+
+}
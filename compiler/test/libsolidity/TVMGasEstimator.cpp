@@ -0,0 +1,182 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Unit tests for the static gas estimation of the generated TVM code (--gas-report).
+ */
+
+#include <libsolidity/codegen/TVMGasEstimator.hpp>
+
+#include <test/libsolidity/TVMFramework.h>
+
+#include <libsolutil/CommonIO.h>
+#include <libsolutil/JSON.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+using namespace std;
+using namespace solidity::util;
+
+namespace solidity::frontend::test
+{
+
+BOOST_AUTO_TEST_SUITE(TVMGasEstimatorTest)
+
+BOOST_AUTO_TEST_CASE(costs)
+{
+	// An instruction costs 10 + its bits, ENDC creates a cell (+500), CTOS loads one (+100)
+	// and the end of a continuation is an implicit RET (+5).
+	CodeLines code = codeLines(
+		".macro f\n"
+		"INC\n"
+		"\n"
+		".globl g\n"
+		".public g\n"
+		".type g, @function\n"
+		"DUP\n"
+		"PUSHCONT {\n"
+		"\tCALL $f$\n"
+		"}\n"
+		"IF\n"
+		"NEWC\n"
+		"ENDC\n"
+		"CTOS\n"
+		"\n"
+		".macro maybe_throw\n"
+		"PUSHCONT {\n"
+		"\tTHROW 100\n"
+		"}\n"
+		"IF\n"
+		"\n"
+		".macro throw\n"
+		"THROW 100\n"
+		"\n"
+		".macro loop\n"
+		"PUSHINT 3\n"
+		"PUSHCONT {\n"
+		"\tINC\n"
+		"}\n"
+		"REPEAT\n"
+		"\n"
+		".macro recursive\n"
+		"CALL $recursive$\n"
+	);
+	Json::Value functions = TVMGasEstimator{code}.report()["functions"];
+
+	BOOST_CHECK_EQUAL(functions["f"]["kind"].asString(), "macro");
+	BOOST_CHECK_EQUAL(functions["f"]["min"].asInt64(), 18 + 5);
+	BOOST_CHECK_EQUAL(functions["f"]["max"].asInt64(), 18 + 5);
+
+	// the body of IF is CALL (26) with f and the implicit RET
+	BOOST_CHECK_EQUAL(functions["g"]["kind"].asString(), "public");
+	BOOST_CHECK_EQUAL(functions["g"]["min"].asInt64(), 18 + 18 + 18 + 18 + 518 + 118 + 5);
+	BOOST_CHECK_EQUAL(functions["g"]["max"].asInt64(), 18 + 18 + 18 + 18 + 518 + 118 + 5 + 26 + 23 + 5);
+	BOOST_CHECK(functions["g"]["loops"].empty());
+
+	// paths ending in an exception are not counted
+	BOOST_CHECK_EQUAL(functions["maybe_throw"]["min"].asInt64(), 18 + 18 + 5);
+	BOOST_CHECK_EQUAL(functions["maybe_throw"]["max"].asInt64(), 18 + 18 + 5);
+	BOOST_CHECK(functions["throw"]["min"].isNull());
+	BOOST_CHECK(functions["throw"]["max"].isNull());
+
+	BOOST_CHECK_EQUAL(functions["loop"]["min"].asInt64(), 18 + 18 + 18 + 5);
+	BOOST_REQUIRE_EQUAL(functions["loop"]["loops"].size(), 1);
+	BOOST_CHECK_EQUAL(functions["loop"]["loops"][0]["min"].asInt64(), 18 + 5);
+	BOOST_CHECK_EQUAL(functions["loop"]["loops"][0]["max"].asInt64(), 18 + 5);
+
+	BOOST_CHECK(functions["recursive"]["recursive"].asBool());
+	BOOST_CHECK_EQUAL(functions["recursive"]["min"].asInt64(), 26 + 5);
+}
+
+BOOST_AUTO_TEST_CASE(tail_jumps)
+{
+	// JMP (24 bits) jumps to the function with that id, JMPX to the continuation on the stack
+	CodeLines code = codeLines(
+		".internal-alias :selector, 1\n"
+		".internal :selector\n"
+		"INC\n"
+		"\n"
+		".macro known\n"
+		"DUP\n"
+		"JMP 1\n"
+		"NEWC\n"
+		"\n"
+		".macro unknown\n"
+		"DUP\n"
+		"JMP 2\n"
+		"\n"
+		".macro continuation\n"
+		"PUSHCONT {\n"
+		"\tINC\n"
+		"}\n"
+		"JMPX\n"
+		"\n"
+		".macro function_value\n"
+		"CALLX\n"
+	);
+	Json::Value functions = TVMGasEstimator{code}.report()["functions"];
+
+	// the tail call returns from selector, the code after JMP is dead
+	BOOST_CHECK_EQUAL(functions["known"]["min"].asInt64(), 18 + 34 + 18 + 5);
+	BOOST_CHECK_EQUAL(functions["known"]["max"].asInt64(), 18 + 34 + 18 + 5);
+	BOOST_CHECK(!functions["known"].isMember("unbounded"));
+
+	// the code of function 2 isn't known: only a lower bound
+	BOOST_CHECK_EQUAL(functions["unknown"]["min"].asInt64(), 18 + 34);
+	BOOST_CHECK(functions["unknown"]["max"].isNull());
+	BOOST_CHECK(functions["unknown"]["unbounded"].asBool());
+
+	BOOST_CHECK_EQUAL(functions["continuation"]["min"].asInt64(), 18 + 18 + 18 + 5);
+	BOOST_CHECK_EQUAL(functions["continuation"]["max"].asInt64(), 18 + 18 + 18 + 5);
+
+	BOOST_CHECK_EQUAL(functions["function_value"]["min"].asInt64(), 18 + 5);
+	BOOST_CHECK(functions["function_value"]["unbounded"].asBool());
+}
+
+BOOST_AUTO_TEST_CASE(corpus)
+{
+	TVMSettings settings;
+	settings.gasReport = true;
+	for (string const& name: corpusContracts())
+	{
+		BOOST_TEST_INFO(name);
+		// the report doesn't change the code
+		BOOST_CHECK_EQUAL(compileCorpusContract(name, settings), compileCorpusContract(name));
+
+		string const source = readFileAsString(corpusPath(name));
+		TVMCompilationResult result = compileTVM(source, settings, name);
+		BOOST_REQUIRE_MESSAGE(result.success, result.errors);
+		Json::Value report;
+		BOOST_REQUIRE(jsonParseStrict(result.artifact(".gas.json"), report));
+		string const& code = result.artifact(".code");
+		for (string const& function: report["functions"].getMemberNames())
+		{
+			BOOST_TEST_INFO(function);
+			BOOST_CHECK(code.find("\t" + function + "\n") != string::npos || code.find(":" + function + "\n") != string::npos);
+			Json::Value const& gas = report["functions"][function];
+			BOOST_CHECK(gas["min"].isNull() || gas["unbounded"].asBool() || gas["min"].asInt64() <= gas["max"].asInt64());
+			BOOST_CHECK(gas["max"].isNull() == (gas["min"].isNull() || gas["unbounded"].asBool()));
+		}
+		BOOST_CHECK(report["functions"].isMember("main_external"));
+		BOOST_CHECK(report["functions"].isMember("c7_to_c4"));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
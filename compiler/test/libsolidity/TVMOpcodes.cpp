@@ -0,0 +1,77 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Unit tests for the table of TVM opcodes.
+ */
+
+#include <libsolidity/codegen/TVMOpcodes.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+#include <string>
+
+using namespace std;
+
+namespace solidity::frontend::test
+{
+
+namespace
+{
+
+set<string> mnemonicsWith(OpcodeFlags _flag)
+{
+	set<string> result;
+	for (unsigned i = unsigned(Opcode::Unknown) + 1; i < unsigned(Opcode::NUM_OPCODES); ++i)
+	{
+		OpcodeInfo const& info = opcodeInfo(Opcode(i));
+		if (info.has(_flag))
+			result.insert(info.mnemonic);
+	}
+	return result;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(TVMOpcodesTest)
+
+BOOST_AUTO_TEST_CASE(find_opcode)
+{
+	for (unsigned i = unsigned(Opcode::Unknown) + 1; i < unsigned(Opcode::NUM_OPCODES); ++i)
+	{
+		OpcodeInfo const& info = opcodeInfo(Opcode(i));
+		BOOST_CHECK(info.opcode == Opcode(i));
+		// aliases, e.g. NULL and PUSHNULL, are different opcodes with different mnemonics
+		BOOST_CHECK(findOpcode(info.mnemonic) == Opcode(i));
+	}
+	BOOST_CHECK(findOpcode("") == Opcode::Unknown);
+	BOOST_CHECK(findOpcode(".macro") == Opcode::Unknown);
+	BOOST_CHECK(findOpcode("EQ") == Opcode::Unknown);
+	BOOST_CHECK(findOpcode("add") == Opcode::Unknown);
+}
+
+BOOST_AUTO_TEST_CASE(peephole_flags)
+{
+	// The sets the peephole optimizer used before the table, SWAP is dropped before these commands
+	BOOST_CHECK(mnemonicsWith(OpCommutative) == (set<string>{"ADD", "MUL", "AND", "OR", "XOR", "EQUAL", "NEQ"}));
+	// and the commands after these ones are deleted
+	BOOST_CHECK(mnemonicsWith(OpNoFallThrough) == (set<string>{"RET", "THROW", "THROWANY"}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
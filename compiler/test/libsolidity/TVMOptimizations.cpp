@@ -0,0 +1,78 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Unit tests for the peephole optimizer of TVM assembly.
+ */
+
+#include <test/libsolidity/TVMFramework.h>
+
+#include <libsolidity/codegen/TVMOptimizations.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+using namespace std;
+
+namespace solidity::frontend::test
+{
+
+namespace
+{
+
+string optimize(string const& _code)
+{
+	return optimize_code(codeLines(_code)).str();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(TVMOptimizerTest)
+
+BOOST_AUTO_TEST_CASE(comments_between_commands)
+{
+	// comments and empty lines don't break a pattern, the comments are kept before the replacement
+	BOOST_CHECK_EQUAL(optimize("PUSHINT 1\n; one\n\nADD\n"), "; one\nINC\n");
+	BOOST_CHECK_EQUAL(optimize("PUSHCONT {\n\tPUSHINT 3\n\t; three\n\tADD\n}\nPUSHINT 1\nADD\n"),
+		"PUSHCONT {\n\t; three\n\tADDCONST 3\n}\nINC\n");
+}
+
+BOOST_AUTO_TEST_CASE(rewrites_after_removal)
+{
+	// the optimizer steps back after removing commands, so the commands around them are matched again
+	BOOST_CHECK_EQUAL(optimize("PUSHINT 1\nPUSH s0\n; x\nDROP\nADD\n"), "; x\nINC\n");
+}
+
+BOOST_AUTO_TEST_CASE(long_code)
+{
+	// The increments are folded one by one and every time the comments before them are moved
+	// to the replacement. That is done without copying, otherwise it takes seconds here.
+	int const repeats = 20000;
+	string code;
+	string expected;
+	for (int i = 0; i < repeats; ++i)
+	{
+		code += "PUSHINT 1\n; step " + to_string(i) + "\nADD\n";
+		expected += "; step " + to_string(i) + "\n";
+	}
+	expected += "PUSHINT " + to_string(repeats) + "\nADD\n";
+	BOOST_CHECK_EQUAL(optimize(code), expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,176 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Unit tests for the outlining of repeated instruction sequences (--tvm-outline).
+ */
+
+#include <libsolidity/codegen/TVMOutliner.hpp>
+
+#include <test/libsolidity/TVMFramework.h>
+
+#include <libsolutil/CommonIO.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace solidity::frontend::test
+{
+
+namespace
+{
+
+/// @returns the code with the calls of the outlined macros replaced by their code, without
+/// the macros, comments and empty lines.
+string inlineOutlinedMacros(string const& _code)
+{
+	CodeLines code = codeLines(_code);
+	map<string, vector<Instruction>> macros;
+	vector<Instruction> lines;
+	vector<Instruction>* current = &lines;
+	for (Instruction const& line: code.lines)
+	{
+		if (line.depth == 0 && line.isDirective())
+		{
+			string const name = line.operands.empty() ? "" : line.operands[0].name();
+			bool const isOutlined = line.name == ".macro" && name.find("outlined_") == 0;
+			current = isOutlined ? &macros[name] : &lines;
+			if (isOutlined)
+				continue;
+		}
+		if (!line.isCommentOrEmpty())
+			current->push_back(line);
+	}
+
+	CodeLines result;
+	function<void(vector<Instruction> const&, int)> expand = [&](vector<Instruction> const& _lines, int _depth) {
+		for (Instruction line: _lines)
+		{
+			line.depth += _depth;
+			if (
+				line.opcode == Opcode::CALL &&
+				line.operands.size() == 1 &&
+				line.operands[0].kind == Operand::Kind::Function &&
+				macros.count(line.operands[0].name())
+			)
+				expand(macros.at(line.operands[0].name()), line.depth);
+			else
+				result.push(line);
+		}
+	};
+	expand(lines, 0);
+	return result.str();
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(TVMOutlinerTest)
+
+BOOST_AUTO_TEST_CASE(repeated_sequence)
+{
+	// 64 bits are repeated 3 times, including a continuation, and a call takes 16 bits
+	string const sequence =
+		"PUSHINT 1\n"
+		"PUSHINT 2\n"
+		"ADD\n"
+		"PUSHINT 3\n"
+		"MUL\n"
+		"PUSHINT 4\n"
+		"SUB\n"
+		"NEGATE\n";
+	BOOST_REQUIRE_EQUAL(codeLines(sequence).bits(), 64);
+	string const code =
+		".globl\tf\n"
+		".public\tf\n"
+		".type\tf, @function\n" +
+		sequence +
+		"; comment\n"
+		"INC\n"
+		"PUSHCONT {\n"
+		"\tPUSHINT 1\n"
+		"\tPUSHINT 2\n"
+		"\tADD\n"
+		"\tPUSHINT 3\n"
+		"\tMUL\n"
+		"\tPUSHINT 4\n"
+		"\tSUB\n"
+		"\tNEGATE\n"
+		"}\n"
+		"IF\n" +
+		sequence;
+	BOOST_CHECK_EQUAL(
+		TVMOutliner{codeLines(code)}.outline().str(),
+		".globl\tf\n"
+		".public\tf\n"
+		".type\tf, @function\n"
+		"CALL $outlined_0$\n"
+		"; comment\n"
+		"INC\n"
+		"PUSHCONT {\n"
+		"\tCALL $outlined_0$\n"
+		"}\n"
+		"IF\n"
+		"CALL $outlined_0$\n"
+		".macro\toutlined_0\n" +
+		sequence +
+		"\n"
+	);
+	BOOST_CHECK_EQUAL(inlineOutlinedMacros(TVMOutliner{codeLines(code)}.outline().str()), inlineOutlinedMacros(code));
+
+	// two copies don't pay for the macro
+	string const twice =
+		".globl\tf\n"
+		".public\tf\n"
+		".type\tf, @function\n" +
+		sequence +
+		"INC\n" +
+		sequence;
+	BOOST_CHECK_EQUAL(TVMOutliner{codeLines(twice)}.outline().str(), codeLines(twice).str());
+}
+
+BOOST_AUTO_TEST_CASE(corpus)
+{
+	TVMSettings settings;
+	settings.outline = true;
+	bool outlined = false;
+	for (string const& name: corpusContracts())
+	{
+		BOOST_TEST_INFO(name);
+		string const source = util::readFileAsString(corpusPath(name));
+		TVMCompilationResult plain = compileTVM(source, {}, name);
+		TVMCompilationResult result = compileTVM(source, settings, name);
+		BOOST_REQUIRE_MESSAGE(plain.success, plain.errors);
+		BOOST_REQUIRE_MESSAGE(result.success, result.errors);
+		BOOST_CHECK_EQUAL(result.artifact(".abi.json"), plain.artifact(".abi.json"));
+
+		string const& code = result.artifact(".code");
+		outlined = outlined || code.find("CALL $outlined_") != string::npos;
+		BOOST_CHECK_LE(codeLines(code).bits(), codeLines(plain.artifact(".code")).bits());
+		// the outlined code does the same
+		BOOST_CHECK_EQUAL(inlineOutlinedMacros(code), inlineOutlinedMacros(plain.artifact(".code")));
+	}
+	BOOST_CHECK(outlined);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
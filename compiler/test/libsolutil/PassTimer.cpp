@@ -0,0 +1,111 @@
+/*
+	This file is part of solidity.
+
+	solidity is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	solidity is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with solidity.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/**
+ * Unit tests for the timer of compilation passes
+ */
+
+#include <libsolutil/PassTimer.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <sstream>
+#include <thread>
+
+using namespace std;
+
+namespace solidity::util::test
+{
+
+BOOST_AUTO_TEST_SUITE(PassTimerTest)
+
+BOOST_AUTO_TEST_CASE(runs_are_summed_up)
+{
+	PassTimer timer;
+	timer.record("Parser", "a.sol", 1.0, 10, 100);
+	timer.record("TypeChecker", "", 2.0, 5, 105);
+	timer.record("Parser", "b.sol", 0.5, 0, 105);
+	timer.record("Parser", "a.sol", 0.25, 20, 125);
+
+	vector<PassTimer::Pass> passes = timer.passes();
+	BOOST_REQUIRE_EQUAL(passes.size(), 3);
+	// in order of the first run
+	BOOST_CHECK_EQUAL(passes[0].name, "Parser");
+	BOOST_CHECK_EQUAL(passes[0].object, "a.sol");
+	BOOST_CHECK_EQUAL(passes[0].runs, 2);
+	BOOST_CHECK_EQUAL(passes[0].seconds, 1.25);
+	BOOST_CHECK_EQUAL(passes[0].peakRSSGrowth, 30);
+	BOOST_CHECK_EQUAL(passes[0].peakRSS, 125);
+	BOOST_CHECK_EQUAL(passes[1].name, "TypeChecker");
+	BOOST_CHECK_EQUAL(passes[1].runs, 1);
+	BOOST_CHECK_EQUAL(passes[2].object, "b.sol");
+
+	Json::Value json = timer.toJson();
+	BOOST_REQUIRE_EQUAL(json.size(), 3);
+	BOOST_CHECK_EQUAL(json[0]["name"].asString(), "Parser");
+	BOOST_CHECK_EQUAL(json[0]["object"].asString(), "a.sol");
+	BOOST_CHECK_EQUAL(json[0]["runs"].asUInt64(), 2);
+	BOOST_CHECK_EQUAL(json[0]["seconds"].asDouble(), 1.25);
+	BOOST_CHECK_EQUAL(json[0]["peakRSSGrowthKiB"].asInt64(), 30);
+	BOOST_CHECK_EQUAL(json[0]["peakRSSKiB"].asInt64(), 125);
+
+	ostringstream table;
+	timer.printTable(table);
+	BOOST_CHECK(table.str().find("Parser (a.sol)") != string::npos);
+	BOOST_CHECK(table.str().find("1250.000") != string::npos);
+
+	timer.clear();
+	BOOST_CHECK(timer.passes().empty());
+}
+
+BOOST_AUTO_TEST_CASE(scopes)
+{
+	PassTimer timer;
+	{
+		PassTimer::Scope scope(&timer, "Codegen", "C.f");
+		this_thread::sleep_for(chrono::milliseconds(5));
+	}
+	{
+		// a null timer doesn't measure anything
+		PassTimer::Scope scope(nullptr, "Codegen", "C.g");
+	}
+	vector<PassTimer::Pass> passes = timer.passes();
+	BOOST_REQUIRE_EQUAL(passes.size(), 1);
+	BOOST_CHECK_EQUAL(passes[0].object, "C.f");
+	BOOST_CHECK_GE(passes[0].seconds, 0.005);
+	BOOST_CHECK_GE(passes[0].peakRSSGrowth, 0);
+}
+
+BOOST_AUTO_TEST_CASE(threads)
+{
+	// runs recorded by several threads are all counted
+	PassTimer timer;
+	vector<thread> threads;
+	for (int i = 0; i < 4; ++i)
+		threads.emplace_back([&timer]() {
+			for (int j = 0; j < 1000; ++j)
+				timer.record("Codegen", "C.f", 0.001, 0, 0);
+		});
+	for (thread& t: threads)
+		t.join();
+	vector<PassTimer::Pass> passes = timer.passes();
+	BOOST_REQUIRE_EQUAL(passes.size(), 1);
+	BOOST_CHECK_EQUAL(passes[0].runs, 4000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,254 @@
+#!/usr/bin/env bash
+
+#------------------------------------------------------------------------------
+# Bash script to test the options of the command line interface which are
+# specific to the TVM compiler.
+#
+# Usage: tvmCmdlineTests.sh [path to solc]
+#
+# ------------------------------------------------------------------------------
+# This file is part of solidity.
+#
+# solidity is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# solidity is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with solidity.  If not, see <http://www.gnu.org/licenses/>
+#------------------------------------------------------------------------------
+
+set -e
+
+## GLOBAL VARIABLES
+
+REPO_ROOT=$(cd $(dirname "$0")/.. && pwd)
+SOLIDITY_BUILD_DIR=${SOLIDITY_BUILD_DIR:-build}
+export TERM="${TERM:-xterm}"
+source "${REPO_ROOT}/scripts/common.sh"
+SOLC=${1:-"$REPO_ROOT/$SOLIDITY_BUILD_DIR/solc/solc"}
+SOLC="$(cd "$(dirname "$SOLC")" && pwd)/$(basename "$SOLC")"
+
+## FUNCTIONS
+
+function fail()
+{
+    printError "$1"
+    if [[ -n "$2" ]]
+    then
+        printError "Got:"
+        echo "$2"
+    fi
+    exit 1
+}
+
+# expectMatch <text> <fixed string> <description of the check>
+function expectMatch()
+{
+    grep -qF -- "$2" <<< "$1" || fail "$3: expected \"$2\"." "$1"
+}
+
+# expectNoMatch <text> <fixed string> <description of the check>
+function expectNoMatch()
+{
+    ! grep -qF -- "$2" <<< "$1" || fail "$3: didn't expect \"$2\"." "$1"
+}
+
+# writeLibrary <string logged by the library>
+function writeLibrary()
+{
+    mkdir -p lib
+    printf 'pragma solidity >= 0.6.0;\ncontract L { function l() public pure { logtvm("%s"); } }\n' "$1" > lib/L.sol
+}
+
+## RUN
+
+WORKDIR=$(mktemp -d)
+trap 'rm -rf "$WORKDIR"' EXIT
+cd "$WORKDIR"
+
+writeLibrary one
+printf 'pragma solidity >= 0.6.0;\nimport "lib/L.sol";\ncontract A is L { function f() public pure { logtvm("hello"); } }\n' > A.sol
+
+printTask "Testing solc --server..."
+(
+    responses=$(printf '%s\n' \
+        '{"id": 1, "files": ["A.sol"]}' \
+        '' \
+        'not a request' \
+        '{"id": "second", "files": ["A.sol"], "settings": {"withoutLogstr": true}}' \
+        '{"id": 3, "files": ["Missing.sol"]}' \
+        '{"id": 4, "sources": {"B.sol": "pragma solidity >= 0.6.0;\ncontract B { uint }\n"}}' \
+        | "$SOLC" --server)
+    [[ $(wc -l <<< "$responses") == 5 ]] || fail "Expected one response per request." "$responses"
+
+    first=$(sed -n 1p <<< "$responses")
+    expectMatch "$first" '"id":1,' "First request"
+    expectMatch "$first" '"success":true' "First request"
+    expectMatch "$first" '"A.code":' "First request"
+    expectMatch "$first" 'PRINTSTR hello' "First request"
+    expectMatch "$first" 'PRINTSTR one' "First request"
+    [[ ! -e A.code ]] || fail "Artifacts must not be written without \"outputDir\"."
+
+    invalid=$(sed -n 2p <<< "$responses")
+    expectMatch "$invalid" '"id":null' "Invalid request"
+    expectMatch "$invalid" '"success":false' "Invalid request"
+    expectMatch "$invalid" 'Invalid request' "Invalid request"
+
+    # settings of a request don't apply to the other ones
+    second=$(sed -n 3p <<< "$responses")
+    expectMatch "$second" '"id":"second"' "Second request"
+    expectMatch "$second" '"success":true' "Second request"
+    expectNoMatch "$second" 'PRINTSTR' "Second request"
+
+    missing=$(sed -n 4p <<< "$responses")
+    expectMatch "$missing" '"id":3,' "Missing file"
+    expectMatch "$missing" 'Missing.sol is not found.' "Missing file"
+
+    failed=$(sed -n 5p <<< "$responses")
+    expectMatch "$failed" '"success":false' "Compilation error"
+    expectMatch "$failed" 'Expected identifier' "Compilation error"
+    expectMatch "$failed" 'B.sol:2:' "Compilation error"
+)
+
+printTask "Testing that solc --server writes artifacts to \"outputDir\"..."
+(
+    response=$(echo '{"id": 1, "files": ["A.sol"], "outputDir": "out"}' | "$SOLC" --server)
+    expectMatch "$response" '"success":true' "Request with outputDir"
+    grep -qF 'PRINTSTR hello' out/A.code || fail "out/A.code isn't written."
+    [[ -e out/A.abi.json ]] || fail "out/A.abi.json isn't written."
+)
+
+printTask "Testing that solc --server reads imports only from the directories of the files..."
+(
+    # The name of an inline source is chosen by the client and must not allow reading files next to it
+    request=$(printf '{"id": 1, "sources": {"%s/X.sol": "pragma solidity >= 0.6.0;\\nimport \\"%s/lib/L.sol\\";\\ncontract X is L {}\\n"}}' "$WORKDIR" "$WORKDIR")
+    response=$(echo "$request" | "$SOLC" --server)
+    expectMatch "$response" '"success":false' "Import next to an inline source"
+    expectMatch "$response" 'File outside of allowed directories.' "Import next to an inline source"
+    expectNoMatch "$response" 'PRINTSTR one' "Import next to an inline source"
+
+    # The allowed directories of a request don't leak into the next one
+    request2=$(printf '{"id": 2, "sources": {"Y.sol": "pragma solidity >= 0.6.0;\\nimport \\"%s/lib/L.sol\\";\\ncontract Y is L {}\\n"}}' "$WORKDIR")
+    responses=$(printf '%s\n' '{"id": 1, "files": ["A.sol"]}' "$request2" | "$SOLC" --server)
+    expectMatch "$(sed -n 1p <<< "$responses")" '"success":true' "Request with files"
+    expectMatch "$(sed -n 2p <<< "$responses")" 'File outside of allowed directories.' "Request after a request with files"
+)
+
+printTask "Testing that solc --server reads an import again after it is modified..."
+(
+    coproc SERVER { "$SOLC" --server; }
+    echo '{"id": 1, "files": ["A.sol"]}' >&"${SERVER[1]}"
+    read -r first <&"${SERVER[0]}"
+    # The file has the same size and is likely modified within the same second
+    writeLibrary two
+    echo '{"id": 2, "files": ["A.sol"]}' >&"${SERVER[1]}"
+    read -r second <&"${SERVER[0]}"
+    server_pid=$SERVER_PID
+    eval "exec ${SERVER[1]}>&-"
+    wait $server_pid
+
+    expectMatch "$first" 'PRINTSTR one' "Request before the modification"
+    expectMatch "$second" 'PRINTSTR two' "Request after the modification"
+    expectNoMatch "$second" 'PRINTSTR one' "Request after the modification"
+    writeLibrary one
+)
+
+printTask "Testing solc --cache-dir..."
+(
+    mkdir cache-test
+    cd cache-test
+    cp -r ../A.sol ../lib .
+    expected=$("$SOLC" A.sol 2>&1)
+    expectedCode=$(cat A.code)
+    rm A.code A.abi.json
+
+    # the first compilation stores its result
+    output=$("$SOLC" A.sol --cache-dir cache 2>&1)
+    [[ "$output" == "$expected" ]] || fail "Output of a compilation with a cache differs." "$output"
+    [[ "$(cat A.code)" == "$expectedCode" ]] || fail "A.code of a compilation with a cache differs."
+    entries=(cache/*.json)
+    [[ ${#entries[@]} == 1 ]] || fail "Expected one cache entry." "$(ls cache)"
+
+    # The next one takes the files and the output from the cache and doesn't compile anything.
+    # The entry is modified to tell it from a compilation.
+    sed -i 's/PRINTSTR hello/PRINTSTR cached/' "${entries[0]}"
+    rm A.code A.abi.json
+    output=$("$SOLC" A.sol --cache-dir cache 2>&1)
+    [[ "$output" == "$expected" ]] || fail "Output taken from the cache differs." "$output"
+    grep -qF 'PRINTSTR cached' A.code || fail "A.code isn't taken from the cache."
+    [[ -e A.abi.json ]] || fail "A.abi.json isn't taken from the cache."
+
+    # an entry is valid only while the imports have the same contents
+    writeLibrary two
+    "$SOLC" A.sol --cache-dir cache > /dev/null 2>&1
+    grep -qF 'PRINTSTR two' A.code || fail "A.code isn't compiled again after an import is modified." "$(cat A.code)"
+    grep -qF 'PRINTSTR hello' A.code || fail "A.code isn't compiled again after an import is modified." "$(cat A.code)"
+    entries=(cache/*.json)
+    [[ ${#entries[@]} == 1 ]] || fail "An entry with a modified import must be replaced." "$(ls cache)"
+
+    # options are a part of the key
+    "$SOLC" A.sol --cache-dir cache --without-logstr > /dev/null 2>&1
+    ! grep -qF 'PRINTSTR' A.code || fail "A.code of other options is taken from the cache." "$(cat A.code)"
+    entries=(cache/*.json)
+    [[ ${#entries[@]} == 2 ]] || fail "Expected an entry for every set of options." "$(ls cache)"
+
+    # failed compilations aren't stored
+    printf 'pragma solidity >= 0.6.0;\ncontract B { uint }\n' > B.sol
+    for i in 1 2
+    do
+        exitCode=0
+        output=$("$SOLC" B.sol --cache-dir cache 2>&1) || exitCode=$?
+        [[ $exitCode != 0 ]] || fail "A failed compilation must fail when it is repeated with a cache."
+        expectMatch "$output" 'Expected identifier' "Failed compilation with a cache"
+    done
+    entries=(cache/*)
+    [[ ${#entries[@]} == 2 ]] || fail "Failed compilations must not be stored in the cache." "$(ls cache)"
+)
+
+printTask "Testing solc --time-passes..."
+(
+    mkdir time-passes-test
+    cd time-passes-test
+    cp -r ../A.sol ../lib .
+    expected=$("$SOLC" A.sol 2> /dev/null)
+
+    # the report goes to stderr, so the output stays the same
+    stdout=$("$SOLC" A.sol --time-passes 2> report.txt)
+    [[ "$stdout" == "$expected" ]] || fail "Output with --time-passes differs." "$stdout"
+    report=$(cat report.txt)
+    expectMatch "$report" 'Time, ms' "--time-passes"
+    expectMatch "$report" 'Parser (lib/L.sol)' "--time-passes"
+    expectMatch "$report" 'TypeChecker' "--time-passes"
+    expectMatch "$report" 'TVM function codegen (A.f)' "--time-passes"
+    expectMatch "$report" 'ABI (A)' "--time-passes"
+
+    report=$("$SOLC" A.sol --time-passes-json -j 4 2>&1 > /dev/null)
+    expectMatch "$report" '"name": "TVM function codegen"' "--time-passes-json"
+    expectMatch "$report" '"object": "A.l"' "--time-passes-json"
+    expectMatch "$report" '"peakRSSKiB"' "--time-passes-json"
+
+    # a result taken from the cache doesn't run any pass
+    "$SOLC" A.sol --cache-dir cache > /dev/null 2>&1
+    report=$("$SOLC" A.sol --cache-dir cache --time-passes 2>&1 > /dev/null)
+    expectMatch "$report" 'Time, ms' "--time-passes with a cache"
+    expectNoMatch "$report" 'Parser' "--time-passes with a cache"
+
+    # every response of the server has the passes of its own request
+    responses=$(printf '%s\n' '{"id": 1, "files": ["A.sol"]}' '{"id": 2, "files": ["A.sol"]}' | "$SOLC" --server --time-passes)
+    for i in 1 2
+    do
+        response=$(sed -n ${i}p <<< "$responses")
+        expectMatch "$response" '"timings":[' "Server response with --time-passes"
+        expectMatch "$response" '"name":"TVM function codegen","object":"A.f","peakRSSGrowthKiB":' "Server response with --time-passes"
+        expectMatch "$response" '"runs":1,' "Server response with --time-passes"
+        expectNoMatch "$response" '"runs":2,' "Server response with --time-passes"
+    done
+)
+
+echo "Done."